@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    BenchmarkSuite.cpp
+    Created: 19 Oct 2026 1:05:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuite.h"
+#include "../../Source/AudioProfiler.h"
+
+#if JUCE_MAC || JUCE_LINUX
+ #include <sys/resource.h>
+#endif
+
+//==============================================================================
+BenchmarkResult::BenchmarkResult(const juce::String& scenario)
+: object(new juce::DynamicObject())
+{
+    object->setProperty("scenario", scenario);
+}
+
+// set a value of the result
+BenchmarkResult& BenchmarkResult::set(const juce::Identifier& name, const juce::var& value)
+{
+    object->setProperty(name, value);
+    return *this;
+}
+
+// the result as an object for the JSON output
+juce::var BenchmarkResult::toVar() const
+{
+    return juce::var(object.get());
+}
+
+//==============================================================================
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& _options)
+: options(_options)
+{
+    // let the format manager know about the basic audio fomats
+    formatManager.registerBasicFormats();
+    options.workDirectory.createDirectory();
+}
+
+BenchmarkSuite::~BenchmarkSuite() {}
+
+// add a scenario to the suite
+void BenchmarkSuite::add(const juce::String& name, Scenario scenario)
+{
+    scenarios.push_back({name, std::move(scenario)});
+}
+
+// run every scenario matching the filter
+juce::var BenchmarkSuite::runAll()
+{
+    juce::Array<juce::var> results;
+
+    for (auto& scenario : scenarios) {
+        // skip scenarios the filter does not ask for
+        if (options.filter.isNotEmpty() && ! scenario.first.contains(options.filter))
+            continue;
+
+        std::cerr << "running " << scenario.first << "..." << std::endl;
+        scenario.second(*this, results);
+    }
+
+    // describe the machine so results from different hosts are not mixed up
+    auto* meta = new juce::DynamicObject();
+    meta->setProperty("label", options.label);
+    meta->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    meta->setProperty("quick", options.quick);
+    meta->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    meta->setProperty("cpu", juce::SystemStats::getCpuModel());
+    meta->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    meta->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    meta->setProperty("allocationsTracked", (bool) OTODESK_TRACK_ALLOCATIONS);
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("meta", juce::var(meta));
+    root->setProperty("results", results);
+    return juce::var(root);
+}
+
+//==============================================================================
+// the options the suite was started with
+const BenchmarkOptions& BenchmarkSuite::getOptions() const
+{
+    return options;
+}
+
+// a format manager that knows the basic formats
+juce::AudioFormatManager& BenchmarkSuite::getFormatManager()
+{
+    return formatManager;
+}
+
+// generate a test track, or reuse the one generated by an earlier run
+juce::File BenchmarkSuite::getTestTrack(double lengthInSeconds, int index, const juce::String& extension, double sampleRate)
+{
+    // a track at another rate than 44.1 kHz has it in its name
+    auto rate = sampleRate != 44100.0 ? "-" + juce::String(sampleRate / 1000.0, 0) + "k" : juce::String();
+    auto file = options.workDirectory.getChildFile("track-" + juce::String(index)
+                                                   + "-" + juce::String(lengthInSeconds, 0) + "s" + rate + extension);
+
+    if (file.existsAsFile())
+        return file;
+
+    auto* format = formatManager.findFormatForFileExtension(extension);
+
+    if (format == nullptr) {
+        std::cerr << "no format can write " << extension << " files" << std::endl;
+        return file;
+    }
+
+    // the same index always gives the same audio
+    juce::Random random {1234 + index};
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    // compressed formats are written at a middle quality, like a typical download
+    auto quality = format->getQualityOptions().size() / 2;
+    std::unique_ptr<juce::AudioFormatWriter> writer (
+        format->createWriterFor(stream.get(), sampleRate, 2, 16, {}, quality));
+
+    if (writer == nullptr) {
+        std::cerr << "could not write " << file.getFullPathName() << std::endl;
+        return file;
+    }
+
+    // the writer owns the stream from now on
+    stream.release();
+
+    // a bass line, a pad and a kick on every beat at a tempo that depends on the index
+    const double bpm = 120.0 + index % 10;
+    const double bass = 55.0 * (1 + index % 3);
+    const auto samplesPerBeat = (juce::int64) (sampleRate * 60.0 / bpm);
+    const auto totalSamples = (juce::int64) (lengthInSeconds * sampleRate);
+
+    juce::AudioBuffer<float> buffer {2, 8192};
+
+    for (juce::int64 start = 0; start < totalSamples; start += buffer.getNumSamples()) {
+        auto numSamples = (int) juce::jmin((juce::int64) buffer.getNumSamples(), totalSamples - start);
+
+        for (int i = 0; i < numSamples; ++i) {
+            auto n = start + i;
+            auto t = (double) n / sampleRate;
+            auto beatTime = (double) (n % samplesPerBeat) / sampleRate;
+
+            auto kick = std::sin(juce::MathConstants<double>::twoPi * 60.0 * beatTime) * std::exp(-beatTime * 18.0);
+            auto tone = 0.3 * std::sin(juce::MathConstants<double>::twoPi * bass * t)
+                      + 0.1 * std::sin(juce::MathConstants<double>::twoPi * bass * 6.0 * t);
+            auto noise = 0.05 * (random.nextFloat() * 2.0f - 1.0f);
+
+            buffer.setSample(0, i, (float) (0.5 * kick + tone + noise));
+            buffer.setSample(1, i, (float) (0.5 * kick + tone - noise));
+        }
+
+        writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+    }
+
+    return file;
+}
+
+//==============================================================================
+// the high-water mark of the resident memory of the process
+juce::int64 BenchmarkSuite::getPeakRssBytes()
+{
+   #if JUCE_MAC || JUCE_LINUX
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // macOS reports bytes, Linux reports kilobytes
+   #if JUCE_MAC
+    return (juce::int64) usage.ru_maxrss;
+   #else
+    return (juce::int64) usage.ru_maxrss * 1024;
+   #endif
+   #else
+    return -1;
+   #endif
+}
+
+// the number of allocations made by the process
+juce::uint64 BenchmarkSuite::getAllocationCount()
+{
+    return AudioProfiler::getTotalAllocations();
+}
+
+// the current time in nanoseconds
+juce::int64 BenchmarkSuite::getNanos()
+{
+    return (juce::int64) (juce::Time::getHighResolutionTicks() * 1.0e9
+                          / (double) juce::Time::getHighResolutionTicksPerSecond());
+}
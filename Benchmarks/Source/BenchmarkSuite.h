@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    BenchmarkSuite.h
+    Created: 19 Oct 2026 1:05:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ The options the benchmarks are run with, read from the command line
+*/
+struct BenchmarkOptions
+{
+    // run shorter versions of every scenario
+    bool quick = false;
+    // only run the scenarios whose name contains this text
+    juce::String filter;
+    // a label stored with the results, e.g. the commit being measured
+    juce::String label;
+    // where generated test tracks are kept between runs
+    juce::File workDirectory;
+};
+
+//==============================================================================
+/*
+ One row of the results, a scenario can add any number of them
+*/
+class BenchmarkResult
+{
+public:
+    BenchmarkResult(const juce::String& scenario);
+
+    /** Sets a value of the result */
+    BenchmarkResult& set(const juce::Identifier& name, const juce::var& value);
+
+    /** Returns the result as an object for the JSON output */
+    juce::var toVar() const;
+
+private:
+    // the values of the result
+    juce::DynamicObject::Ptr object;
+};
+
+//==============================================================================
+/*
+ Runs a list of named scenarios against the engine without any GUI or audio
+ device, and collects their results into a single JSON document
+*/
+class BenchmarkSuite
+{
+public:
+    /** A scenario adds its results to the array it is given */
+    using Scenario = std::function<void (BenchmarkSuite&, juce::Array<juce::var>&)>;
+
+    BenchmarkSuite(const BenchmarkOptions& options);
+    ~BenchmarkSuite();
+
+    /** Adds a scenario to the suite */
+    void add(const juce::String& name, Scenario scenario);
+
+    /** Runs every scenario matching the filter and returns the JSON document */
+    juce::var runAll();
+
+    //==============================================================================
+    /** Returns the options the suite was started with */
+    const BenchmarkOptions& getOptions() const;
+    /** Returns a format manager with the basic formats registered */
+    juce::AudioFormatManager& getFormatManager();
+
+    /** Returns a generated stereo test track, the same index always gives the
+        same audio. The extension picks the format, e.g. ".wav" or ".ogg" */
+    juce::File getTestTrack(double lengthInSeconds,
+                            int index = 0,
+                            const juce::String& extension = ".wav",
+                            double sampleRate = 44100.0);
+
+    /** Returns the high-water mark of the resident memory of the process in bytes */
+    static juce::int64 getPeakRssBytes();
+    /** Returns the number of allocations made by the process so far */
+    static juce::uint64 getAllocationCount();
+    /** Returns the current time in nanoseconds for timing the scenarios */
+    static juce::int64 getNanos();
+
+private:
+    // the options the suite was started with
+    BenchmarkOptions options;
+    // used to open the test tracks
+    juce::AudioFormatManager formatManager;
+    // the scenarios in the order they were added
+    std::vector<std::pair<juce::String, Scenario>> scenarios;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BenchmarkSuite)
+};
+
+/** Adds the scenarios measuring the audio engine and the library */
+void addEngineBenchmarks(BenchmarkSuite& suite);
@@ -0,0 +1,2104 @@
+/*
+  ==============================================================================
+
+    EngineBenchmarks.cpp
+    Created: 19 Oct 2026 1:41:27pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuite.h"
+#include "../../Source/DJAudioPlayer.h"
+#include "../../Source/DeckMixer.h"
+#include "../../Source/TrackLibrary.h"
+#include "../../Source/AudioProfiler.h"
+#include "../../Source/BandWaveform.h"
+#include "../../Source/LoudnessAnalyser.h"
+#include "../../Source/AnalysisPool.h"
+#include "../../Source/OfflineRenderer.h"
+#include "../../Source/Automix.h"
+#include "../../Source/KeyAnalyser.h"
+#include "../../Source/SuggestionIndex.h"
+#include "../../Source/MasterClock.h"
+#include "../../Source/MidiController.h"
+#include "../../Source/SeekCache.h"
+#include "../../Source/SearchIndex.h"
+#include "../../Source/AudioFingerprint.h"
+#include "../../Source/DuplicateIndex.h"
+#include "../../Source/SmartCrate.h"
+#include "../../Source/PlayHistory.h"
+#include "../../Source/SessionState.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+    // every scenario renders at this rate
+    const double sampleRate = 44100.0;
+
+    //==============================================================================
+    /*
+     A number of decks playing test tracks into a mixer, the same way
+     MainComponent sets them up but without an audio device
+    */
+    struct DeckRig
+    {
+        DeckRig(BenchmarkSuite& suite,
+                int numDecks,
+                int blockSize,
+                double trackSeconds,
+                const juce::String& extension = ".wav")
+        {
+            for (int i = 0; i < numDecks; ++i) {
+                players.push_back(std::make_unique<DJAudioPlayer>(suite.getFormatManager()));
+                auto* player = players.back().get();
+
+                player->setProfiler(&profiler, "Deck " + juce::String(i + 1));
+                player->loadURL(juce::URL{suite.getTestTrack(trackSeconds, i, extension)});
+                // every deck runs at a slightly different speed so the resampler has work to do
+                player->setSpeed(1.0 + 0.01 * i);
+                player->start();
+
+                mixer.addDeck(player);
+            }
+
+            mixer.setProfiler(&profiler);
+            profiler.setSampleRate(sampleRate);
+            mixer.prepareToPlay(blockSize, sampleRate);
+            output.setSize(2, blockSize);
+        }
+
+        ~DeckRig()
+        {
+            mixer.releaseResources();
+        }
+
+        // render one block the way the audio callback does
+        void renderBlock()
+        {
+            AudioProfiler::ScopedCallback callback {profiler, output.getNumSamples()};
+            juce::AudioSourceChannelInfo info {&output, 0, output.getNumSamples()};
+            mixer.getNextAudioBlock(info);
+        }
+
+        AudioProfiler profiler;
+        std::vector<std::unique_ptr<DJAudioPlayer>> players;
+        DeckMixer mixer;
+        juce::AudioBuffer<float> output;
+    };
+
+    // adds the timing of the callback recorded by a profiler to a result
+    void addCallbackStats(BenchmarkResult& result, const AudioProfiler& profiler)
+    {
+        auto stats = profiler.getCallbackStats();
+        result.set("callbackMeanMicros", stats.callback.meanMicros)
+              .set("callbackP99Micros", stats.callback.p99Micros)
+              .set("callbackMaxMicros", stats.callback.maxMicros)
+              .set("worstLoad", stats.worstLoad);
+    }
+
+    //==============================================================================
+    // N decks at M buffer sizes
+    void benchmarkDecks(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const double renderSeconds = quick ? 5.0 : 30.0;
+
+        for (int numDecks : {1, 2, 4, 8}) {
+            for (int blockSize : {64, 128, 256, 512, 1024}) {
+                DeckRig rig {suite, numDecks, blockSize, renderSeconds + 5.0};
+                auto numBlocks = (int) (renderSeconds * sampleRate / blockSize);
+
+                // warm up the caches before measuring
+                for (int i = 0; i < 16; ++i)
+                    rig.renderBlock();
+
+                rig.profiler.reset();
+                auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+                auto start = BenchmarkSuite::getNanos();
+
+                for (int i = 0; i < numBlocks; ++i)
+                    rig.renderBlock();
+
+                auto elapsed = BenchmarkSuite::getNanos() - start;
+                auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+                auto numSamples = (double) numBlocks * blockSize;
+
+                BenchmarkResult result {"decks"};
+                result.set("decks", numDecks)
+                      .set("blockSize", blockSize)
+                      .set("nsPerSample", (double) elapsed / numSamples)
+                      .set("nsPerSamplePerDeck", (double) elapsed / numSamples / numDecks)
+                      .set("realtimeFactor", renderSeconds / ((double) elapsed * 1.0e-9))
+                      .set("allocationsPerBlock", (double) allocations / numBlocks)
+                      .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+                addCallbackStats(result, rig.profiler);
+                results.add(result.toVar());
+            }
+        }
+    }
+
+    //==============================================================================
+    // two decks where one of them jumps to a random position every block
+    void benchmarkSeekStorm(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const int numBlocks = quick ? 2000 : 20000;
+
+        DeckRig rig {suite, 2, blockSize, 120.0};
+        juce::Random random {42};
+
+        rig.profiler.reset();
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        auto start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numBlocks; ++i) {
+            rig.players[(size_t) (i % 2)]->setPositionRelative(random.nextDouble() * 0.99);
+            rig.renderBlock();
+        }
+
+        auto elapsed = BenchmarkSuite::getNanos() - start;
+        auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        BenchmarkResult result {"seekStorm"};
+        result.set("decks", 2)
+              .set("blockSize", blockSize)
+              .set("seeks", numBlocks)
+              .set("nsPerSample", (double) elapsed / ((double) numBlocks * blockSize))
+              .set("nsPerSeekBlock", (double) elapsed / numBlocks)
+              .set("allocationsPerBlock", (double) allocations / numBlocks)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        addCallbackStats(result, rig.profiler);
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // the time from a cue press to the end of the block that starts with the
+    // cue, for jumps to cached hot cues and for jumps the cache does not cover
+    void benchmarkCueLatency(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const int numPresses = quick ? 200 : 2000;
+        const double trackSeconds = quick ? 60.0 : 180.0;
+
+        // wav seeks instantly, ogg has to find its way through the compressed stream
+        for (auto extension : {".wav", ".ogg"}) {
+            DeckRig rig {suite, 1, blockSize, trackSeconds, extension};
+            auto* player = rig.players[0].get();
+            juce::Random random {99};
+
+            // spread the hot cues over the track
+            for (int cue = 0; cue < CueLoopSource::numHotCues; ++cue) {
+                player->setPosition(trackSeconds * (cue + 0.5) / CueLoopSource::numHotCues);
+                player->setHotCue(cue);
+            }
+
+            // give the cache up to ten seconds to decode the cues
+            for (int i = 0; i < 1000 && ! player->isPreRollReady(); ++i)
+                juce::Thread::sleep(10);
+
+            for (auto cached : {true, false}) {
+                std::vector<double> latencies;
+                latencies.reserve((size_t) numPresses);
+
+                for (int i = 0; i < numPresses; ++i) {
+                    auto start = BenchmarkSuite::getNanos();
+
+                    if (cached)
+                        player->triggerHotCue(i % CueLoopSource::numHotCues);
+                    else
+                        player->setPosition(random.nextDouble() * (trackSeconds - 10.0));
+
+                    // the jump happens at the start of this block
+                    rig.renderBlock();
+                    latencies.push_back((double) (BenchmarkSuite::getNanos() - start) * 1.0e-3);
+
+                    // play on for a moment, like a DJ would after a jump
+                    for (int j = 0; j < 32; ++j)
+                        rig.renderBlock();
+                }
+
+                std::sort(latencies.begin(), latencies.end());
+                auto mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / numPresses;
+
+                BenchmarkResult result {"cueLatency"};
+                result.set("format", juce::String(extension).substring(1))
+                      .set("cached", cached)
+                      .set("presses", numPresses)
+                      .set("blockSize", blockSize)
+                      .set("blockMicros", blockSize / sampleRate * 1.0e6)
+                      .set("pressToOutputMeanMicros", mean)
+                      .set("pressToOutputP50Micros", latencies[latencies.size() / 2])
+                      .set("pressToOutputP99Micros", latencies[latencies.size() * 99 / 100])
+                      .set("pressToOutputMaxMicros", latencies.back())
+                      .set("preRollReady", player->isPreRollReady());
+                results.add(result.toVar());
+            }
+        }
+    }
+
+    //==============================================================================
+    // the time from pressing load to the end of the first block of the new
+    // track, for tracks opened on the spot and tracks waiting in the preload slot
+    void benchmarkPreload(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const int numLoads = quick ? 8 : 32;
+        const double trackSeconds = quick ? 60.0 : 240.0;
+
+        // wav opens instantly, ogg has to read its headers and scan the stream
+        for (auto extension : {".wav", ".ogg"}) {
+            DeckRig rig {suite, 1, blockSize, trackSeconds, extension};
+            auto* player = rig.players[0].get();
+
+            for (auto preloaded : {false, true}) {
+                std::vector<double> latencies;
+                latencies.reserve((size_t) numLoads);
+                int numReady = 0;
+
+                for (int i = 0; i < numLoads; ++i) {
+                    juce::URL next {suite.getTestTrack(trackSeconds, 1 + i % 4, extension)};
+
+                    // the slot is filled while the deck plays, given up to ten seconds
+                    if (preloaded) {
+                        player->preloadURL(next);
+
+                        for (int j = 0; j < 1000 && ! player->isPreloadReady(); ++j)
+                            juce::Thread::sleep(10);
+
+                        numReady += player->isPreloadReady() ? 1 : 0;
+                    }
+
+                    auto start = BenchmarkSuite::getNanos();
+
+                    if (preloaded)
+                        player->loadPreloaded();
+                    else
+                        player->loadURL(next);
+
+                    player->start();
+                    rig.renderBlock();
+                    latencies.push_back((double) (BenchmarkSuite::getNanos() - start) * 1.0e-3);
+
+                    for (int j = 0; j < 32; ++j)
+                        rig.renderBlock();
+                }
+
+                std::sort(latencies.begin(), latencies.end());
+                auto mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / numLoads;
+
+                BenchmarkResult result {"preload"};
+                result.set("format", juce::String(extension).substring(1))
+                      .set("preloaded", preloaded)
+                      .set("loads", numLoads)
+                      .set("readyBeforeLoad", numReady)
+                      .set("loadToOutputMeanMicros", mean)
+                      .set("loadToOutputP50Micros", latencies[latencies.size() / 2])
+                      .set("loadToOutputMaxMicros", latencies.back())
+                      .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+                results.add(result.toVar());
+            }
+        }
+    }
+
+    //==============================================================================
+    // a deck scratched back and forth with many jog events per block
+    void benchmarkScratch(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const int numBlocks = quick ? 2000 : 20000;
+        const int eventsPerBlock = 8;
+
+        DeckRig rig {suite, 1, blockSize, 60.0};
+        auto* player = rig.players[0].get();
+
+        // start in the middle of the track and give the ring time to fill around it
+        player->setPosition(30.0);
+        rig.renderBlock();
+        juce::Thread::sleep(500);
+
+        player->beginScratch();
+        rig.profiler.reset();
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        auto start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numBlocks; ++i) {
+            // a hand moving the record back and forth twice a second
+            for (int event = 0; event < eventsPerBlock; ++event) {
+                auto t = (i * eventsPerBlock + event) * blockSize / (eventsPerBlock * sampleRate);
+                auto velocity = 3.0 * std::sin(juce::MathConstants<double>::twoPi * 2.0 * t);
+                player->addJogMovement(velocity * blockSize / (eventsPerBlock * sampleRate));
+            }
+
+            rig.renderBlock();
+        }
+
+        auto elapsed = BenchmarkSuite::getNanos() - start;
+        auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+        player->endScratch();
+
+        BenchmarkResult result {"scratch"};
+        result.set("blockSize", blockSize)
+              .set("jogEvents", numBlocks * eventsPerBlock)
+              .set("nsPerSample", (double) elapsed / ((double) numBlocks * blockSize))
+              .set("allocationsPerBlock", (double) allocations / numBlocks)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        addCallbackStats(result, rig.profiler);
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // two decks with the analysers of the decks and the master off, and on with
+    // the analysis thread running them next to the audio
+    void benchmarkAnalysis(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const double renderSeconds = quick ? 5.0 : 30.0;
+        const int numBlocks = (int) (renderSeconds * sampleRate / blockSize);
+
+        for (auto enabled : {false, true}) {
+            DeckRig rig {suite, 2, blockSize, renderSeconds + 5.0};
+
+            juce::Array<AudioAnalyser*> analysers {&rig.players[0]->getAnalyser(),
+                                                   &rig.players[1]->getAnalyser(),
+                                                   &rig.mixer.getMasterAnalyser()};
+
+            for (auto* analyser : analysers)
+                analyser->setEnabled(enabled);
+
+            // the thread empties the FIFOs, so the blocks keep being copied
+            std::unique_ptr<AnalysisThread> thread;
+            if (enabled) {
+                thread = std::make_unique<AnalysisThread>();
+                for (auto* analyser : analysers)
+                    thread->addAnalyser(analyser);
+            }
+
+            for (int i = 0; i < 16; ++i)
+                rig.renderBlock();
+
+            rig.profiler.reset();
+            auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+            auto start = BenchmarkSuite::getNanos();
+
+            for (int i = 0; i < numBlocks; ++i)
+                rig.renderBlock();
+
+            auto elapsed = BenchmarkSuite::getNanos() - start;
+            auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+            if (thread != nullptr)
+                for (auto* analyser : analysers)
+                    thread->removeAnalyser(analyser);
+
+            BenchmarkResult result {"analysis"};
+            result.set("analysers", enabled)
+                  .set("decks", 2)
+                  .set("blockSize", blockSize)
+                  .set("nsPerSample", (double) elapsed / ((double) numBlocks * blockSize))
+                  .set("allocationsPerBlock", (double) allocations / numBlocks)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            addCallbackStats(result, rig.profiler);
+            results.add(result.toVar());
+        }
+    }
+
+    //==============================================================================
+    // a library of 100k tracks: loading it, importing into it, searching it
+    // and reading every row
+    void benchmarkPlaylist(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const int numTracks = 100000;
+        auto dataFile = suite.getOptions().workDirectory.getChildFile("library-100k.txt");
+
+        // write the data file once, the same way the playlist saves it
+        if (! dataFile.existsAsFile()) {
+            juce::Random random {7};
+            juce::String lines;
+
+            for (int i = 0; i < numTracks; ++i) {
+                juce::File track {"/music/Artist " + juce::String(random.nextInt(5000))
+                                  + "/Artist " + juce::String(i % 5000)
+                                  + " - Track " + juce::String(i) + ".mp3"};
+                lines << juce::URL{track}.toString(false) << "\r\n";
+            }
+
+            dataFile.replaceWithText(lines);
+        }
+
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        auto start = BenchmarkSuite::getNanos();
+        TrackLibrary library {dataFile};
+        auto loadNanos = BenchmarkSuite::getNanos() - start;
+        auto loadAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        BenchmarkResult loadResult {"playlistLoad"};
+        loadResult.set("tracks", library.getTotalNumTracks())
+                  .set("totalMillis", (double) loadNanos * 1.0e-6)
+                  .set("allocationsPerTrack", (double) loadAllocations / numTracks)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(loadResult.toVar());
+
+        // a batch of tracks dropped onto the playlist and then a single one,
+        // into a copy so the data file of the other runs stays the same
+        {
+            auto importFile = dataFile.getSiblingFile("library-import.txt");
+            dataFile.copyFileTo(importFile);
+            TrackLibrary importLibrary {importFile};
+
+            const int batchSize = 10000;
+            juce::Array<juce::URL> batch;
+
+            for (int i = 0; i < batchSize; ++i)
+                batch.add(juce::URL{juce::File{"/music/Imported/Imported Track " + juce::String(i) + ".flac"}});
+
+            juce::URL single {juce::File{"/music/Imported/Single Track.flac"}};
+
+            for (auto isBatch : {true, false}) {
+                allocationsBefore = BenchmarkSuite::getAllocationCount();
+                start = BenchmarkSuite::getNanos();
+
+                if (isBatch)
+                    importLibrary.addTracks(batch);
+                else
+                    importLibrary.addTrack(single);
+
+                auto importNanos = BenchmarkSuite::getNanos() - start;
+                auto importAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+                auto numImported = isBatch ? batchSize : 1;
+
+                BenchmarkResult result {"playlistImport"};
+                result.set("libraryTracks", numTracks)
+                      .set("imported", numImported)
+                      .set("millis", (double) importNanos * 1.0e-6)
+                      .set("allocations", (juce::int64) importAllocations)
+                      .set("allocationsPerTrack", (double) importAllocations / numImported);
+                results.add(result.toVar());
+            }
+
+            importFile.deleteFile();
+        }
+
+        // a search as it would be typed, one keystroke at a time, then cleared
+        juce::String query {"Track 4242"};
+
+        for (int length = 1; length <= query.length() + 1; ++length) {
+            auto text = length <= query.length() ? query.substring(0, length) : juce::String();
+
+            allocationsBefore = BenchmarkSuite::getAllocationCount();
+            start = BenchmarkSuite::getNanos();
+            library.setSearchText(text);
+            auto searchNanos = BenchmarkSuite::getNanos() - start;
+            auto searchAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+            BenchmarkResult result {"playlistSearch"};
+            result.set("tracks", numTracks)
+                  .set("query", text)
+                  .set("matches", library.getNumTracks())
+                  .set("millis", (double) searchNanos * 1.0e-6)
+                  .set("allocations", (juce::int64) searchAllocations);
+            results.add(result.toVar());
+        }
+
+        // read the title of every row, as painting a full scroll through the table does
+        allocationsBefore = BenchmarkSuite::getAllocationCount();
+        start = BenchmarkSuite::getNanos();
+        size_t totalLength = 0;
+
+        for (int row = 0; row < library.getNumTracks(); ++row)
+            totalLength += library.getTrackTitle(row).size();
+
+        auto rowNanos = BenchmarkSuite::getNanos() - start;
+        auto rowAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        BenchmarkResult rowResult {"playlistRows"};
+        rowResult.set("rows", library.getNumTracks())
+                 .set("nsPerRow", (double) rowNanos / juce::jmax(1, library.getNumTracks()))
+                 .set("allocationsPerRow", (double) rowAllocations / juce::jmax(1, library.getNumTracks()))
+                 .set("titleBytes", (juce::int64) totalLength);
+        results.add(rowResult.toVar());
+    }
+
+    //==============================================================================
+    // a library of a million analysed tracks: sorting it by several columns
+    // and reading screens of rows from anywhere in it, as scrolling does
+    void benchmarkLargeLibrary(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numTracks = quick ? 100000 : 1000000;
+        auto dataFile = suite.getOptions().workDirectory.getChildFile("library-" + juce::String(numTracks) + ".txt");
+
+        // write the data file once, the same way the playlist saves it
+        if (! dataFile.existsAsFile()) {
+            juce::String lines;
+
+            for (int i = 0; i < numTracks; ++i)
+                lines << juce::URL{juce::File{"/music/Artist " + juce::String(i % 5000)
+                                              + "/Track " + juce::String(i) + ".mp3"}}.toString(false) << "\r\n";
+
+            dataFile.replaceWithText(lines);
+        }
+
+        auto start = BenchmarkSuite::getNanos();
+        TrackLibrary library {dataFile};
+        auto loadNanos = BenchmarkSuite::getNanos() - start;
+
+        // every track gets a key, a tempo and a loudness, as if analysed
+        juce::Random random {11};
+
+        for (int row = 0; row < library.getNumTracks(); ++row) {
+            auto url = library.getTrackURL(row);
+            library.setTrackHarmony(url, {1 + random.nextInt(12), random.nextBool(), 90.0f + random.nextInt(80)});
+            library.setTrackLoudness(url, {-20.0f + random.nextFloat() * 14.0f, -1.0f});
+        }
+
+        BenchmarkResult loadResult {"largeLibraryLoad"};
+        loadResult.set("tracks", library.getTotalNumTracks())
+                  .set("loadMillis", (double) loadNanos * 1.0e-6)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(loadResult.toVar());
+
+        // sorted by key then tempo, by loudness loudest first, and by title again
+        using SortField = TrackLibrary::SortField;
+        using SortKey = TrackLibrary::SortKey;
+        juce::Array<juce::Array<SortKey>> orders;
+        orders.add(juce::Array<SortKey>{SortKey{SortField::key, true}, SortKey{SortField::bpm, true}});
+        orders.add(juce::Array<SortKey>{SortKey{SortField::loudness, false}});
+        orders.add({});
+
+        const juce::StringArray orderNames {"keyThenBpm", "loudnessDescending", "title"};
+
+        for (int i = 0; i < orders.size(); ++i) {
+            auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+            start = BenchmarkSuite::getNanos();
+            library.setSortOrder(orders.getReference(i));
+            auto sortNanos = BenchmarkSuite::getNanos() - start;
+            auto sortAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+            BenchmarkResult result {"largeLibrarySort"};
+            result.set("tracks", numTracks)
+                  .set("order", orderNames[i])
+                  .set("millis", (double) sortNanos * 1.0e-6)
+                  .set("allocations", (juce::int64) sortAllocations);
+            results.add(result.toVar());
+        }
+
+        // a search while sorted, which does not sort again
+        library.setSortOrder(orders.getReference(0));
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        start = BenchmarkSuite::getNanos();
+        library.setSearchText("Track 12");
+        auto searchNanos = BenchmarkSuite::getNanos() - start;
+
+        BenchmarkResult searchResult {"largeLibrarySearch"};
+        searchResult.set("tracks", numTracks)
+                    .set("matches", library.getNumTracks())
+                    .set("millis", (double) searchNanos * 1.0e-6)
+                    .set("allocations", (juce::int64) (BenchmarkSuite::getAllocationCount() - allocationsBefore));
+        results.add(searchResult.toVar());
+        library.setSearchText({});
+
+        // a screen of rows read as the table paints them, from the top, the
+        // middle and the bottom of the library, the time should not change
+        const int rowsPerScreen = 40;
+        const int numScreens = 2000;
+
+        for (auto position : {0.0, 0.5, 1.0}) {
+            auto firstRow = juce::jmax(0, (int) ((library.getNumTracks() - rowsPerScreen) * position));
+            size_t checksum = 0;
+            juce::int64 worstNanos = 0;
+            juce::int64 totalNanos = 0;
+            allocationsBefore = BenchmarkSuite::getAllocationCount();
+
+            for (int screen = 0; screen < numScreens; ++screen) {
+                // scrolling moves the screen by a few rows at a time
+                auto top = juce::jmin(firstRow + (screen % 20), juce::jmax(0, library.getNumTracks() - rowsPerScreen));
+                auto screenStart = BenchmarkSuite::getNanos();
+
+                for (int row = top; row < top + rowsPerScreen; ++row) {
+                    TrackLibrary::Harmony harmony;
+                    TrackLibrary::Loudness loudness;
+                    checksum += library.getTrackTitle(row).size();
+                    checksum += library.getTrackHarmony(row, harmony) ? (size_t) harmony.camelotNumber : 0;
+                    checksum += library.getTrackLoudness(row, loudness) ? 1 : 0;
+                }
+
+                auto screenNanos = BenchmarkSuite::getNanos() - screenStart;
+                totalNanos += screenNanos;
+                worstNanos = juce::jmax(worstNanos, screenNanos);
+            }
+
+            BenchmarkResult result {"largeLibraryScroll"};
+            result.set("tracks", numTracks)
+                  .set("position", position)
+                  .set("nsPerScreen", (double) totalNanos / numScreens)
+                  .set("worstNsPerScreen", worstNanos)
+                  .set("allocationsPerScreen", (double) (BenchmarkSuite::getAllocationCount() - allocationsBefore) / numScreens)
+                  .set("checksum", (juce::int64) checksum);
+            results.add(result.toVar());
+        }
+    }
+
+    //==============================================================================
+    // ranked fuzzy search over a library of 500k tracks: building the index,
+    // typical queries with and without typos, and how quickly a search
+    // stops when the next keystroke comes
+    void benchmarkSearch(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numTracks = quick ? 100000 : 500000;
+        auto dataFile = suite.getOptions().workDirectory.getChildFile("library-search-" + juce::String(numTracks) + ".txt");
+
+        // artist and album folders, the way a music folder is usually laid out
+        if (! dataFile.existsAsFile()) {
+            const juce::StringArray words {"Midnight", "Summer", "Deep", "Electric", "Velvet", "Golden", "Lost", "Neon",
+                                           "River", "Echo", "Shadow", "Fire", "Ocean", "Silver", "Dream", "Storm"};
+            juce::Random random {13};
+            juce::String lines;
+
+            for (int i = 0; i < numTracks; ++i) {
+                auto artist = i % 20000;
+                auto title = words[random.nextInt(words.size())] + " " + words[random.nextInt(words.size())];
+                lines << juce::URL{juce::File{"/music/Artist " + juce::String(artist)
+                                              + "/Album " + juce::String(artist) + "-" + juce::String(i % 7)
+                                              + "/" + title + " " + juce::String(i) + ".mp3"}}.toString(false) << "\r\n";
+            }
+
+            dataFile.replaceWithText(lines);
+        }
+
+        TrackLibrary library {dataFile};
+        juce::Random random {17};
+
+        // half of the tracks have been analysed
+        for (int row = 0; row < library.getNumTracks(); row += 2)
+            library.setTrackHarmony(library.getTrackURL(row), {1 + random.nextInt(12), random.nextBool(), 90.0f + random.nextInt(80)});
+
+        auto start = BenchmarkSuite::getNanos();
+        auto entries = library.getSearchEntries();
+        auto snapshotNanos = BenchmarkSuite::getNanos() - start;
+
+        SearchIndex index;
+        start = BenchmarkSuite::getNanos();
+        index.build(entries, [] { return false; });
+        auto buildNanos = BenchmarkSuite::getNanos() - start;
+
+        BenchmarkResult buildResult {"searchIndexBuild"};
+        buildResult.set("tracks", index.size())
+                   .set("words", index.getNumWords())
+                   .set("snapshotMillis", (double) snapshotNanos * 1.0e-6)
+                   .set("buildMillis", (double) buildNanos * 1.0e-6)
+                   .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(buildResult.toVar());
+
+        // whole words, prefixes as they are typed, typos, a key, a tempo and an artist
+        const juce::StringArray queries {"midnight", "mid", "m", "midnihgt", "summer 4242", "8a", "8a 128",
+                                         "artist 123", "electirc dream", "velvet shadow 9999"};
+
+        for (auto& query : queries) {
+            for (auto allowTypos : {false, true}) {
+                start = BenchmarkSuite::getNanos();
+                auto ids = index.search(query, allowTypos, [] { return false; });
+                auto searchNanos = BenchmarkSuite::getNanos() - start;
+
+                BenchmarkResult result {"searchQuery"};
+                result.set("tracks", index.size())
+                      .set("query", query)
+                      .set("typos", allowTypos)
+                      .set("matches", (int) ids.size())
+                      .set("millis", (double) searchNanos * 1.0e-6);
+                results.add(result.toVar());
+            }
+        }
+
+        // a slow search cancelled as the next keystroke would, the time from
+        // the cancel to the search giving up
+        std::atomic<bool> cancelled {false};
+        std::atomic<juce::int64> finishedNanos {0};
+
+        std::thread searchThread {[&index, &cancelled, &finishedNanos] {
+            index.search("velvet shadow electirc", true, [&cancelled] { return cancelled.load(); });
+            finishedNanos = BenchmarkSuite::getNanos();
+        }};
+
+        juce::Thread::sleep(2);
+        auto cancelledNanos = BenchmarkSuite::getNanos();
+        cancelled = true;
+        searchThread.join();
+
+        BenchmarkResult cancelResult {"searchCancel"};
+        cancelResult.set("tracks", index.size())
+                    .set("finishedBeforeCancel", finishedNanos.load() < cancelledNanos)
+                    .set("cancelMillis", (double) juce::jmax((juce::int64) 0, finishedNanos.load() - cancelledNanos) * 1.0e-6);
+        results.add(cancelResult.toVar());
+    }
+
+    //==============================================================================
+    // waveform thumbnails for a batch of tracks, generated synchronously
+    void benchmarkThumbnails(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numFiles = quick ? 4 : 16;
+        const double trackSeconds = quick ? 20.0 : 60.0;
+
+        juce::Array<juce::File> files;
+        for (int i = 0; i < numFiles; ++i)
+            files.add(suite.getTestTrack(trackSeconds, i));
+
+        juce::AudioThumbnailCache cache {numFiles};
+        juce::AudioBuffer<float> buffer {2, 65536};
+        juce::int64 totalSamples = 0;
+
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        auto start = BenchmarkSuite::getNanos();
+
+        for (auto& file : files) {
+            std::unique_ptr<juce::AudioFormatReader> reader (suite.getFormatManager().createReaderFor(file));
+
+            if (reader == nullptr)
+                continue;
+
+            // the same resolution the waveform display uses
+            juce::AudioThumbnail thumbnail {1000, suite.getFormatManager(), cache};
+            thumbnail.reset((int) reader->numChannels, reader->sampleRate, reader->lengthInSamples);
+
+            for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += buffer.getNumSamples()) {
+                auto numSamples = (int) juce::jmin((juce::int64) buffer.getNumSamples(), reader->lengthInSamples - pos);
+                reader->read(&buffer, 0, numSamples, pos, true, true);
+                thumbnail.addBlock(pos, buffer, 0, numSamples);
+            }
+
+            totalSamples += reader->lengthInSamples;
+        }
+
+        auto elapsed = BenchmarkSuite::getNanos() - start;
+        auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        BenchmarkResult result {"thumbnails"};
+        result.set("files", numFiles)
+              .set("secondsPerFile", trackSeconds)
+              .set("nsPerSample", (double) elapsed / (double) juce::jmax((juce::int64) 1, totalSamples))
+              .set("filesPerSecond", numFiles / ((double) elapsed * 1.0e-9))
+              .set("allocationsPerFile", (double) allocations / numFiles)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // band waveforms for the same batch of tracks, analysed and then read back
+    // from the cache
+    void benchmarkWaveforms(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numFiles = quick ? 4 : 16;
+        const double trackSeconds = quick ? 20.0 : 60.0;
+
+        juce::Array<juce::File> files;
+        for (int i = 0; i < numFiles; ++i)
+            files.add(suite.getTestTrack(trackSeconds, i));
+
+        juce::int64 totalSamples = 0;
+        auto neverStop = [] { return false; };
+
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+        auto start = BenchmarkSuite::getNanos();
+
+        for (auto& file : files) {
+            std::unique_ptr<juce::AudioFormatReader> reader (suite.getFormatManager().createReaderFor(file));
+
+            if (reader == nullptr)
+                continue;
+
+            BandWaveform waveform;
+            waveform.generate(*reader, neverStop);
+            waveform.saveToCache(file);
+            totalSamples += reader->lengthInSamples;
+        }
+
+        auto analyseNanos = BenchmarkSuite::getNanos() - start;
+        auto analyseAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        // the second time a track is loaded
+        int numCached = 0;
+        start = BenchmarkSuite::getNanos();
+
+        for (auto& file : files) {
+            BandWaveform waveform;
+            if (waveform.loadFromCache(file))
+                ++numCached;
+        }
+
+        auto cachedNanos = BenchmarkSuite::getNanos() - start;
+
+        // leave nothing behind in the cache of the app
+        for (auto& file : files)
+            BandWaveform::getCacheFile(file).deleteFile();
+
+        BenchmarkResult result {"waveforms"};
+        result.set("files", numFiles)
+              .set("secondsPerFile", trackSeconds)
+              .set("nsPerSample", (double) analyseNanos / (double) juce::jmax((juce::int64) 1, totalSamples))
+              .set("filesPerSecond", numFiles / ((double) analyseNanos * 1.0e-9))
+              .set("allocationsPerFile", (double) analyseAllocations / numFiles)
+              .set("cachedFiles", numCached)
+              .set("cachedMicrosPerFile", (double) cachedNanos * 1.0e-3 / numFiles)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // the loudness of a batch of tracks, on one thread and on the analysis pool
+    void benchmarkLoudness(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numFiles = quick ? 8 : 32;
+        const double trackSeconds = quick ? 30.0 : 120.0;
+
+        juce::Array<juce::URL> tracks;
+        for (int i = 0; i < numFiles; ++i)
+            tracks.add(juce::URL{suite.getTestTrack(trackSeconds, i)});
+
+        // one track after the other on this thread
+        auto neverStop = [] { return false; };
+        auto start = BenchmarkSuite::getNanos();
+
+        for (auto& track : tracks) {
+            std::unique_ptr<juce::AudioFormatReader> reader (
+                suite.getFormatManager().createReaderFor(track.getLocalFile()));
+
+            LoudnessAnalyser::Result loudness;
+            if (reader != nullptr)
+                LoudnessAnalyser::analyse(*reader, neverStop, loudness);
+        }
+
+        auto serialNanos = BenchmarkSuite::getNanos() - start;
+
+        // one job per track on the pool, the way the library is measured
+        juce::SharedResourcePointer<AnalysisPool> pool;
+        std::vector<std::unique_ptr<LoudnessJob>> jobs;
+        start = BenchmarkSuite::getNanos();
+
+        for (auto& track : tracks) {
+            jobs.push_back(std::make_unique<LoudnessJob>(suite.getFormatManager(), track));
+            pool->addJob(jobs.back().get());
+        }
+
+        for (auto& job : jobs)
+            while (! job->isFinished())
+                juce::Thread::sleep(1);
+
+        auto parallelNanos = BenchmarkSuite::getNanos() - start;
+
+        int numMeasured = 0;
+        for (auto& job : jobs) {
+            pool->removeFinishedJob(job.get());
+            if (job->wasSuccessful())
+                ++numMeasured;
+        }
+
+        auto perMinute = [&] (juce::int64 nanos) { return numFiles / ((double) nanos * 1.0e-9 / 60.0); };
+
+        BenchmarkResult result {"loudness"};
+        result.set("files", numFiles)
+              .set("secondsPerFile", trackSeconds)
+              .set("measured", numMeasured)
+              .set("cores", juce::SystemStats::getNumCpus())
+              .set("serialTracksPerMinute", perMinute(serialNanos))
+              .set("poolTracksPerMinute", perMinute(parallelNanos))
+              .set("speedup", (double) serialNanos / (double) juce::jmax((juce::int64) 1, parallelNanos))
+              .set("realtimeFactor", numFiles * trackSeconds / ((double) parallelNanos * 1.0e-9))
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // an automix of a queue of test tracks rendered offline, and how close
+    // the analysed tempos are to the tempos the tracks were made at
+    void benchmarkAutomix(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numTracks = quick ? 4 : 12;
+        const double trackSeconds = quick ? 60.0 : 180.0;
+
+        juce::Array<juce::URL> queue;
+        for (int i = 0; i < numTracks; ++i)
+            queue.add(juce::URL{suite.getTestTrack(trackSeconds, i)});
+
+        DJAudioPlayer deck1 {suite.getFormatManager()};
+        DJAudioPlayer deck2 {suite.getFormatManager()};
+        DeckMixer mixer;
+        mixer.addDeck(&deck1);
+        mixer.addDeck(&deck2);
+
+        Automix automix {mixer, deck1, deck2, suite.getFormatManager()};
+        auto directory = suite.getOptions().workDirectory.getChildFile("automix");
+
+        auto start = BenchmarkSuite::getNanos();
+        automix.start(queue, true);
+
+        // the queue can never take longer than all its tracks back to back
+        auto written = OfflineRenderer::render(mixer, sampleRate, 512, numTracks * trackSeconds, directory,
+                                               [&automix] { automix.update(); return ! automix.isFinished(); });
+        auto nanos = BenchmarkSuite::getNanos() - start;
+        auto finished = automix.isFinished();
+        automix.stop();
+
+        // the test tracks have a kick on every beat at 120 to 129 bpm
+        double worstBpmError = 0.0;
+        int numAnalysed = 0;
+
+        for (int i = 0; i < numTracks; ++i) {
+            TempoAnalyser::Result tempo;
+            if (automix.getTrackTempo(queue[i], tempo)) {
+                worstBpmError = juce::jmax(worstBpmError, std::abs(tempo.bpm - (120 + i % 10)));
+                ++numAnalysed;
+            }
+        }
+
+        auto renderedSeconds = mixer.getScheduler().getMasterClock() / sampleRate;
+
+        BenchmarkResult result {"automix"};
+        result.set("tracks", numTracks)
+              .set("secondsPerTrack", trackSeconds)
+              .set("written", written)
+              .set("finished", finished)
+              .set("transitions", automix.getNumTransitions())
+              .set("analysed", numAnalysed)
+              .set("worstBpmError", worstBpmError)
+              .set("renderedSeconds", renderedSeconds)
+              .set("realtimeFactor", renderedSeconds / juce::jmax(1.0e-9, (double) nanos * 1.0e-9))
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // the key and tempo of a batch of tracks on the analysis pool, and the
+    // suggestions over a library of 100k tracks with the index and with a scan
+    void benchmarkKeys(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numFiles = quick ? 8 : 32;
+        const double trackSeconds = quick ? 30.0 : 120.0;
+        const int numLibraryTracks = 100000;
+        const int numQueries = quick ? 1000 : 10000;
+
+        // one job per track on the pool, the way the library is analysed
+        juce::SharedResourcePointer<AnalysisPool> pool;
+        std::vector<std::unique_ptr<KeyJob>> jobs;
+
+        for (int i = 0; i < numFiles; ++i)
+            suite.getTestTrack(trackSeconds, i);
+
+        auto start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numFiles; ++i) {
+            jobs.push_back(std::make_unique<KeyJob>(suite.getFormatManager(), juce::URL{suite.getTestTrack(trackSeconds, i)}));
+            pool->addJob(jobs.back().get());
+        }
+
+        for (auto& job : jobs)
+            while (! job->isFinished())
+                juce::Thread::sleep(1);
+
+        auto analysisNanos = BenchmarkSuite::getNanos() - start;
+
+        int numAnalysed = 0;
+        for (auto& job : jobs) {
+            pool->removeFinishedJob(job.get());
+            if (job->wasSuccessful())
+                ++numAnalysed;
+        }
+
+        // a library of random keys and tempos around the usual dance tempos
+        struct Track { int number; bool minor; float bpm; };
+        std::vector<Track> library;
+        library.reserve((size_t) numLibraryTracks);
+        juce::Random random {38};
+
+        for (int i = 0; i < numLibraryTracks; ++i)
+            library.push_back({random.nextInt(12) + 1, random.nextBool(), 80.0f + random.nextFloat() * 100.0f});
+
+        SuggestionIndex index;
+        start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numLibraryTracks; ++i)
+            index.add(i, library[(size_t) i].number, library[(size_t) i].minor, library[(size_t) i].bpm);
+
+        auto buildNanos = BenchmarkSuite::getNanos() - start;
+
+        // the same queries through the index and through a scan of every track
+        std::vector<Track> queries;
+        for (int i = 0; i < numQueries; ++i)
+            queries.push_back(library[(size_t) random.nextInt(numLibraryTracks)]);
+
+        size_t numIndexed = 0;
+        start = BenchmarkSuite::getNanos();
+
+        for (auto& query : queries)
+            numIndexed += index.findCompatible(query.number, query.minor, query.bpm, 50).size();
+
+        auto indexNanos = BenchmarkSuite::getNanos() - start;
+
+        size_t numScanned = 0;
+        start = BenchmarkSuite::getNanos();
+
+        for (auto& query : queries) {
+            std::vector<int> matches;
+            for (int i = 0; i < numLibraryTracks; ++i) {
+                auto& track = library[(size_t) i];
+                if (SuggestionIndex::areCompatible(query.number, query.minor, track.number, track.minor)
+                    && std::abs(track.bpm - query.bpm) <= query.bpm * SuggestionIndex::bpmTolerance)
+                    matches.push_back(i);
+            }
+            numScanned += juce::jmin((size_t) 50, matches.size());
+        }
+
+        auto scanNanos = BenchmarkSuite::getNanos() - start;
+
+        BenchmarkResult result {"keys"};
+        result.set("files", numFiles)
+              .set("secondsPerFile", trackSeconds)
+              .set("analysed", numAnalysed)
+              .set("poolTracksPerMinute", numFiles / ((double) analysisNanos * 1.0e-9 / 60.0))
+              .set("libraryTracks", numLibraryTracks)
+              .set("indexBuildMs", (double) buildNanos * 1.0e-6)
+              .set("indexQueryUs", (double) indexNanos * 1.0e-3 / numQueries)
+              .set("scanQueryUs", (double) scanNanos * 1.0e-3 / numQueries)
+              .set("speedup", (double) scanNanos / (double) juce::jmax((juce::int64) 1, indexNanos))
+              .set("indexResultsPerQuery", (double) numIndexed / numQueries)
+              .set("scanResultsPerQuery", (double) numScanned / numQueries)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // fingerprinting tracks on the pool, how alike a track stays in another
+    // format, and finding the duplicates of a large library
+    void benchmarkDuplicates(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numFiles = quick ? 8 : 32;
+        const double trackSeconds = quick ? 30.0 : 120.0;
+        const int numLibraryTracks = quick ? 20000 : 100000;
+        const int landmarksPerTrack = 300;
+
+        // one job per track on the pool, the way the library is fingerprinted
+        juce::SharedResourcePointer<AnalysisPool> pool;
+        std::vector<std::unique_ptr<FingerprintJob>> jobs;
+
+        for (int i = 0; i < numFiles; ++i)
+            suite.getTestTrack(trackSeconds, i);
+
+        auto start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numFiles; ++i) {
+            jobs.push_back(std::make_unique<FingerprintJob>(suite.getFormatManager(), juce::URL{suite.getTestTrack(trackSeconds, i)}));
+            pool->addJob(jobs.back().get());
+        }
+
+        for (auto& job : jobs)
+            while (! job->isFinished())
+                juce::Thread::sleep(1);
+
+        auto fingerprintNanos = BenchmarkSuite::getNanos() - start;
+
+        int numFingerprinted = 0;
+        for (auto& job : jobs) {
+            pool->removeFinishedJob(job.get());
+            if (job->wasSuccessful() && job->getFingerprint().isValid())
+                ++numFingerprinted;
+        }
+
+        // the same track as a wav, an ogg and a 48 kHz flac, and another track
+        auto fingerprintFile = [&suite] (const juce::File& file)
+        {
+            AudioFingerprint::Fingerprint fingerprint;
+            std::unique_ptr<juce::AudioFormatReader> reader (suite.getFormatManager().createReaderFor(file));
+            if (reader != nullptr)
+                AudioFingerprint::analyse(*reader, [] { return false; }, fingerprint);
+            return fingerprint;
+        };
+
+        auto wav = fingerprintFile(suite.getTestTrack(trackSeconds, 0));
+        auto ogg = fingerprintFile(suite.getTestTrack(trackSeconds, 0, ".ogg"));
+        auto flac48k = fingerprintFile(suite.getTestTrack(trackSeconds, 0, ".flac", 48000.0));
+        auto other = fingerprintFile(suite.getTestTrack(trackSeconds, 1));
+
+        // a library of random landmarks, every hundredth track a copy of the
+        // one before it that keeps most of its landmarks like another format
+        // would, or fewer like an edit would
+        auto makeLandmarks = [&] (int seed, int numKept, int newSeed)
+        {
+            std::vector<juce::uint32> landmarks;
+            juce::Random original {seed};
+            juce::Random changed {newSeed};
+
+            for (int i = 0; i < landmarksPerTrack; ++i) {
+                auto landmark = (juce::uint32) original.nextInt(1 << 21);
+                landmarks.push_back(i < numKept ? landmark : (juce::uint32) changed.nextInt(1 << 21));
+            }
+
+            return landmarks;
+        };
+
+        std::vector<DuplicateIndex::Entry> entries;
+        entries.reserve((size_t) numLibraryTracks);
+
+        for (int i = 0; i < numLibraryTracks; ++i) {
+            auto isCopy = i % 100 == 99;
+            auto isEdit = (i / 100) % 2 == 1;
+            auto numKept = ! isCopy ? landmarksPerTrack : (isEdit ? landmarksPerTrack * 2 / 5 : landmarksPerTrack * 4 / 5);
+
+            entries.push_back({i, AudioFingerprint::fromLandmarks(makeLandmarks(isCopy ? i - 1 : i, numKept, numLibraryTracks + i))});
+        }
+
+        start = BenchmarkSuite::getNanos();
+        auto groups = DuplicateIndex::findGroups(entries, [] { return false; });
+        auto findNanos = BenchmarkSuite::getNanos() - start;
+
+        // a group is false if it holds any track that was not planted
+        std::vector<int> groupOf ((size_t) numLibraryTracks, -1);
+        int numFalseGroups = 0;
+
+        for (size_t group = 0; group < groups.size(); ++group) {
+            auto isFalse = false;
+
+            for (auto id : groups[group].ids) {
+                groupOf[(size_t) id] = (int) group;
+                isFalse = isFalse || (id % 100 != 98 && id % 100 != 99);
+            }
+
+            if (isFalse)
+                ++numFalseGroups;
+        }
+
+        int numCopies = 0, numCopiesFound = 0, numEdits = 0, numEditsFound = 0;
+
+        for (int i = 99; i < numLibraryTracks; i += 100) {
+            auto found = groupOf[(size_t) i] >= 0 && groupOf[(size_t) i] == groupOf[(size_t) i - 1];
+
+            if ((i / 100) % 2 == 1) {
+                ++numEdits;
+                numEditsFound += found ? 1 : 0;
+            }
+            else {
+                ++numCopies;
+                numCopiesFound += found ? 1 : 0;
+            }
+        }
+
+        BenchmarkResult result {"duplicates"};
+        result.set("files", numFiles)
+              .set("secondsPerFile", trackSeconds)
+              .set("fingerprinted", numFingerprinted)
+              .set("poolTracksPerMinute", numFiles / ((double) fingerprintNanos * 1.0e-9 / 60.0))
+              .set("landmarks", wav.numLandmarks)
+              .set("otherFormatSimilarity", AudioFingerprint::getSimilarity(wav, ogg))
+              .set("otherRateSimilarity", AudioFingerprint::getSimilarity(wav, flac48k))
+              .set("otherTrackSimilarity", AudioFingerprint::getSimilarity(wav, other))
+              .set("libraryTracks", numLibraryTracks)
+              .set("findGroupsMillis", (double) findNanos * 1.0e-6)
+              .set("groups", (int) groups.size())
+              .set("copyRecall", (double) numCopiesFound / juce::jmax(1, numCopies))
+              .set("editRecall", (double) numEditsFound / juce::jmax(1, numEdits))
+              .set("falseGroups", numFalseGroups)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // evaluating smart crates over a large library, all at once and as
+    // tracks are analysed one by one
+    void benchmarkCrates(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numTracks = 100000;
+        const int numUpdates = quick ? 10000 : 100000;
+
+        // the values of an analysed track, most tracks are analysed
+        juce::Random random {53};
+        auto makeValues = [&random]
+        {
+            CrateIndex::Values values;
+            values.fill(CrateIndex::unknown);
+
+            if (random.nextInt(10) != 0) {
+                values[SmartCrate::bpmField] = 80.0f + random.nextFloat() * 100.0f;
+                values[SmartCrate::keyField] = SmartCrate::getKeyValue(1 + random.nextInt(12), random.nextBool());
+                values[SmartCrate::loudnessField] = -20.0f + random.nextFloat() * 14.0f;
+            }
+
+            values[SmartCrate::duplicateField] = random.nextInt(50) == 0 ? 1.0f : 0.0f;
+            return values;
+        };
+
+        CrateIndex index;
+        index.reserve(numTracks);
+
+        for (int i = 0; i < numTracks; ++i)
+            index.setTrack(i, true, makeValues());
+
+        // crates of one to four clauses
+        const juce::StringArray queries {"bpm 120-128", "bpm 120-128 and key 8A", "key 8A and not dupes",
+                                         "lufs -10 to -6", "bpm 170-175 and lufs -9 to -6", "dupes",
+                                         "not key 1A and bpm 90-100", "bpm 124 and key 5B and lufs -12 to -8 and not dupes"};
+
+        for (int repeat = 0; repeat < 2; ++repeat) {
+            for (auto& query : queries) {
+                SmartCrate crate;
+                juce::String error;
+                crate.name = query;
+                crate.setQuery(query, error);
+                index.addCrate(crate);
+            }
+        }
+
+        auto start = BenchmarkSuite::getNanos();
+        index.evaluateAll();
+        auto evaluateNanos = BenchmarkSuite::getNanos() - start;
+
+        // tracks analysed again, each tested against every crate on its own
+        start = BenchmarkSuite::getNanos();
+
+        for (int i = 0; i < numUpdates; ++i)
+            index.setTrack(random.nextInt(numTracks), true, makeValues());
+
+        auto updateNanos = BenchmarkSuite::getNanos() - start;
+
+        // the crates kept up to date have to match the crates found again
+        std::vector<int> counts;
+        for (int crate = 0; crate < index.getNumCrates(); ++crate)
+            counts.push_back(index.getNumMatches(crate));
+
+        index.evaluateAll();
+
+        auto consistent = true;
+        for (int crate = 0; crate < index.getNumCrates(); ++crate)
+            consistent = consistent && counts[(size_t) crate] == index.getNumMatches(crate);
+
+        BenchmarkResult result {"crates"};
+        result.set("tracks", numTracks)
+              .set("crates", index.getNumCrates())
+              .set("evaluateAllMillis", (double) evaluateNanos * 1.0e-6)
+              .set("updates", numUpdates)
+              .set("updateMicros", (double) updateNanos * 1.0e-3 / numUpdates)
+              .set("speedup", (double) evaluateNanos * numUpdates / (double) juce::jmax((juce::int64) 1, updateNanos))
+              .set("consistent", consistent)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // the time a deck event costs the message thread, how long the writer
+    // takes to get a burst of them to disk, and reading the log back
+    void benchmarkHistory(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numEvents = quick ? 20000 : 200000;
+        const int numTracks = 1000;
+
+        auto logFile = suite.getOptions().workDirectory.getChildFile("history.log");
+        logFile.deleteFile();
+
+        std::vector<juce::URL> urls;
+        for (int i = 0; i < numTracks; ++i)
+            urls.push_back(juce::URL{juce::File::getCurrentWorkingDirectory().getChildFile("Track " + juce::String(i) + ".mp3")});
+
+        juce::int64 logNanos = 0;
+        juce::int64 slowestLogNanos = 0;
+        juce::int64 drainNanos = 0;
+        int numWritten = 0;
+        juce::uint64 logAllocations = 0;
+
+        {
+            PlayHistory history {logFile};
+            auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+
+            // a load and a play per track, far faster than any DJ
+            for (int i = 0; i < numEvents; ++i) {
+                auto type = i % 2 == 0 ? PlayHistory::EventType::load : PlayHistory::EventType::play;
+
+                auto start = BenchmarkSuite::getNanos();
+                history.log(type, 1 + (i / 2) % 2, urls[(size_t) ((i / 2) % numTracks)]);
+                auto nanos = BenchmarkSuite::getNanos() - start;
+
+                logNanos += nanos;
+                slowestLogNanos = juce::jmax(slowestLogNanos, nanos);
+            }
+
+            logAllocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+            // the burst is on disk once the writer has caught up
+            auto start = BenchmarkSuite::getNanos();
+
+            while (history.getNumWritten() < numEvents && BenchmarkSuite::getNanos() - start < (juce::int64) 10000000000) {
+                history.flush();
+                juce::Thread::sleep(1);
+            }
+
+            drainNanos = BenchmarkSuite::getNanos() - start;
+            numWritten = history.getNumWritten();
+        }
+
+        // what the play count job does when the app starts
+        PlayHistory reader {logFile};
+        int numRead = 0;
+        int numPlays = 0;
+
+        auto start = BenchmarkSuite::getNanos();
+        reader.readLog([&] (const PlayHistory::Event& event)
+        {
+            ++numRead;
+            numPlays += event.type == PlayHistory::EventType::play ? 1 : 0;
+        });
+        auto readNanos = BenchmarkSuite::getNanos() - start;
+
+        BenchmarkResult result {"history"};
+        result.set("events", numEvents)
+              .set("logMicros", (double) logNanos * 1.0e-3 / numEvents)
+              .set("slowestLogMicros", (double) slowestLogNanos * 1.0e-3)
+              .set("allocationsPerLog", (double) logAllocations / numEvents)
+              .set("drainMillis", (double) drainNanos * 1.0e-6)
+              .set("written", numWritten)
+              .set("logBytes", logFile.getSize())
+              .set("readMillis", (double) readNanos * 1.0e-6)
+              .set("read", numRead)
+              .set("plays", numPlays)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+
+        logFile.deleteFile();
+    }
+
+    //==============================================================================
+    // the time a session snapshot costs the message thread while two decks
+    // play, and restoring the decks from it
+    void benchmarkSession(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 512;
+        const int numCaptures = quick ? 200 : 2000;
+        const double trackSeconds = 120.0;
+
+        auto snapshotFile = suite.getOptions().workDirectory.getChildFile("session.bin");
+        snapshotFile.deleteFile();
+
+        DeckRig rig {suite, SessionState::numDecks, blockSize, trackSeconds, ".ogg"};
+        for (auto& player : rig.players)
+            player->start();
+
+        std::vector<double> captureMicros;
+        captureMicros.reserve((size_t) numCaptures);
+        SessionState::Snapshot last;
+        int numWritten = 0;
+        int numUnchanged = 0;
+
+        {
+            SessionState session {snapshotFile};
+            session.onCapture = [&] (SessionState::Snapshot& snapshot)
+            {
+                for (size_t i = 0; i < snapshot.decks.size(); ++i)
+                    SessionState::captureDeck(*rig.players[i], snapshot.decks[i]);
+
+                snapshot.view.searchText = "Track 42";
+                snapshot.view.sortOrder.add({TrackLibrary::SortField::bpm, true});
+                last = snapshot;
+            };
+
+            // the decks play through the first half and are stopped for the
+            // second, when the snapshots do not change
+            for (int i = 0; i < numCaptures; ++i) {
+                if (i == numCaptures / 2)
+                    for (auto& player : rig.players)
+                        player->stop();
+
+                rig.renderBlock();
+                session.capture();
+                captureMicros.push_back(session.getLastCaptureMicros());
+                juce::Thread::sleep(1);
+            }
+
+            numWritten = session.getNumWritten();
+            numUnchanged = session.getNumUnchanged();
+        }
+
+        std::sort(captureMicros.begin(), captureMicros.end());
+        auto meanMicros = std::accumulate(captureMicros.begin(), captureMicros.end(), 0.0) / numCaptures;
+
+        // what the app does when it starts again, both tracks opened at once
+        auto start = BenchmarkSuite::getNanos();
+
+        SessionState session {snapshotFile};
+        SessionState::Snapshot snapshot;
+        auto readable = session.read(snapshot);
+        auto readNanos = BenchmarkSuite::getNanos() - start;
+
+        std::vector<std::unique_ptr<DJAudioPlayer>> players;
+        auto positionsExact = readable;
+
+        for (auto& deck : snapshot.decks) {
+            players.push_back(std::make_unique<DJAudioPlayer>(suite.getFormatManager()));
+            SessionState::applyDeck(deck, *players.back());
+            players.back()->preloadURL(juce::URL{deck.url});
+        }
+
+        for (auto& player : players) {
+            for (int j = 0; j < 1000 && ! player->isPreloadReady(); ++j)
+                juce::Thread::sleep(1);
+
+            player->loadPreloaded();
+        }
+
+        for (size_t i = 0; i < players.size(); ++i) {
+            players[i]->setTrackPosition(snapshot.decks[i].position);
+            positionsExact = positionsExact && snapshot.decks[i].position == last.decks[i].position;
+        }
+
+        auto restoreNanos = BenchmarkSuite::getNanos() - start;
+
+        BenchmarkResult result {"session"};
+        result.set("captures", numCaptures)
+              .set("captureMeanMicros", meanMicros)
+              .set("captureP99Micros", captureMicros[captureMicros.size() * 99 / 100])
+              .set("captureMaxMicros", captureMicros.back())
+              .set("written", numWritten)
+              .set("unchanged", numUnchanged)
+              .set("snapshotBytes", snapshotFile.getSize())
+              .set("readMicros", (double) readNanos * 1.0e-3)
+              .set("restoreMillis", (double) restoreNanos * 1.0e-6)
+              .set("positionsExact", positionsExact)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        results.add(result.toVar());
+
+        snapshotFile.deleteFile();
+    }
+
+    //==============================================================================
+    // the cost of every effect of a deck on its own, and of switching them
+    // all on and off while the deck plays
+    void benchmarkEffects(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const double renderSeconds = quick ? 5.0 : 20.0;
+        const int blockSize = 256;
+        const int numBlocks = (int) (renderSeconds * sampleRate / blockSize);
+
+        DeckRig rig {suite, 1, blockSize, renderSeconds * (EffectsRack::numEffects + 2) + 5.0};
+        auto& rack = rig.players[0]->getEffectsRack();
+
+        // the stage an effect is timed as
+        auto getStage = [&rig] (int effect)
+        {
+            auto name = "Deck 1 " + EffectsRack::getEffectName(effect).toLowerCase();
+            for (auto& stage : rig.profiler.getStageStats())
+                if (stage.name == name)
+                    return stage;
+            return AudioProfiler::StageStats {};
+        };
+
+        for (int effect = 0; effect < EffectsRack::numEffects; ++effect) {
+            rack.setEffectEnabled(effect, true);
+            rack.setEffectAmount(effect, 0.7f);
+
+            // the effect has faded in before it is measured
+            for (int i = 0; i < 64; ++i)
+                rig.renderBlock();
+
+            rig.profiler.reset();
+            auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+
+            for (int i = 0; i < numBlocks; ++i)
+                rig.renderBlock();
+
+            auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+            auto stage = getStage(effect);
+
+            BenchmarkResult result {"effects"};
+            result.set("effect", EffectsRack::getEffectName(effect).toLowerCase())
+                  .set("blockSize", blockSize)
+                  .set("nsPerSample", stage.meanMicros * 1000.0 / blockSize)
+                  .set("p99Micros", stage.p99Micros)
+                  .set("maxMicros", stage.maxMicros)
+                  .set("allocationsPerBlock", (double) allocations / numBlocks)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            addCallbackStats(result, rig.profiler);
+            results.add(result.toVar());
+
+            rack.setEffectEnabled(effect, false);
+        }
+
+        // every effect is switched every few blocks, so they keep fading
+        rig.profiler.reset();
+        auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+
+        for (int i = 0; i < numBlocks; ++i) {
+            if (i % 8 == 0) {
+                auto effect = (i / 8) % EffectsRack::numEffects;
+                rack.setEffectEnabled(effect, ! rack.isEffectEnabled(effect));
+            }
+            rig.renderBlock();
+        }
+
+        auto allocations = BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+        BenchmarkResult result {"effects"};
+        result.set("effect", "switching")
+              .set("blockSize", blockSize)
+              .set("allocationsPerBlock", (double) allocations / numBlocks)
+              .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+        addCallbackStats(result, rig.profiler);
+        results.add(result.toVar());
+    }
+
+    //==============================================================================
+    // the sample accuracy of the ticks of the master clock, the time synced
+    // decks take to lock onto its beat, and the jitter of its MIDI clock
+    // looped back through a virtual MIDI port
+    void benchmarkClock(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const double renderSeconds = quick ? 10.0 : 60.0;
+        const double clockBpm = 123.4;
+
+        // the clock on its own, with blocks of random sizes cut into pieces
+        // the way the mixer cuts them for the automix
+        {
+            MasterClock clock;
+            clock.prepare(sampleRate);
+            clock.setTempo(clockBpm);
+            clock.setQueueTicks(true);
+
+            std::vector<MasterClock::Tick> ticks;
+            ticks.reserve((size_t) (renderSeconds * clockBpm / 60.0 * MasterClock::ticksPerBeat) + 64);
+            MasterClock::Tick popped[256];
+
+            juce::Random random {40};
+            juce::int64 numSamples = 0, numBlocks = 0, clockNanos = 0, allocations = 0;
+
+            while (numSamples < renderSeconds * sampleRate) {
+                auto blockSize = 32 + random.nextInt(1024);
+                auto split = random.nextInt(blockSize);
+
+                auto allocationsBefore = BenchmarkSuite::getAllocationCount();
+                auto start = BenchmarkSuite::getNanos();
+
+                clock.beginBlock(blockSize);
+                clock.advance(split);
+                clock.advance(blockSize - split);
+
+                clockNanos += BenchmarkSuite::getNanos() - start;
+                allocations += BenchmarkSuite::getAllocationCount() - allocationsBefore;
+
+                auto numPopped = clock.popTicks(popped, 256);
+                while (numPopped > 0) {
+                    ticks.insert(ticks.end(), popped, popped + numPopped);
+                    numPopped = clock.popTicks(popped, 256);
+                }
+
+                numSamples += blockSize;
+                ++numBlocks;
+            }
+
+            // tick n is due exactly on n / 24 beats
+            auto samplesPerTick = sampleRate * 60.0 / clockBpm / MasterClock::ticksPerBeat;
+            double maxError = 0.0, maxRoundedError = 0.0;
+
+            for (size_t n = 0; n < ticks.size(); ++n) {
+                auto ideal = (double) n * samplesPerTick;
+                maxError = juce::jmax(maxError, std::abs(ticks[n].sample - ideal));
+                maxRoundedError = juce::jmax(maxRoundedError, std::abs(std::round(ticks[n].sample) - ideal));
+            }
+
+            BenchmarkResult result {"clock"};
+            result.set("test", "ticks")
+                  .set("bpm", clockBpm)
+                  .set("ticks", (int) ticks.size())
+                  .set("expectedTicks", (int) (numSamples / samplesPerTick) + 1)
+                  .set("maxTickErrorSamples", maxError)
+                  .set("maxRoundedTickErrorSamples", maxRoundedError)
+                  .set("nsPerBlock", (double) clockNanos / (double) numBlocks)
+                  .set("allocationsPerBlock", (double) allocations / (double) numBlocks)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            results.add(result.toVar());
+        }
+
+        // two decks at 120 and 121 BPM synced to the clock, the second one
+        // started a third of a beat off
+        {
+            const int blockSize = 256;
+            DeckRig rig {suite, 2, blockSize, renderSeconds + 20.0};
+            auto& clock = rig.mixer.getMasterClock();
+            clock.setTempo(clockBpm);
+
+            for (int i = 0; i < 2; ++i) {
+                rig.players[(size_t) i]->setTrackBpm(120.0 + i);
+                rig.players[(size_t) i]->setSyncEnabled(true);
+            }
+            rig.players[1]->setPosition(60.0 / 121.0 / 3.0);
+
+            // the decks are locked once both stay within a hundredth of a beat
+            // for a whole second
+            const auto numBlocks = (int) (renderSeconds * sampleRate / blockSize);
+            const auto blocksPerSecond = (int) (sampleRate / blockSize);
+            int lockedBlocks = 0, lockBlock = -1;
+            double maxLockedError = 0.0;
+
+            for (int i = 0; i < numBlocks; ++i) {
+                rig.renderBlock();
+
+                auto error = juce::jmax(std::abs(rig.players[0]->getSyncPhaseError()),
+                                        std::abs(rig.players[1]->getSyncPhaseError()));
+
+                if (lockBlock >= 0)
+                    maxLockedError = juce::jmax(maxLockedError, error);
+                else if (error < 0.01 && ++lockedBlocks >= blocksPerSecond)
+                    lockBlock = i - lockedBlocks + 1;
+                else if (error >= 0.01)
+                    lockedBlocks = 0;
+            }
+
+            BenchmarkResult result {"clock"};
+            result.set("test", "sync")
+                  .set("bpm", clockBpm)
+                  .set("blockSize", blockSize)
+                  .set("locked", lockBlock >= 0)
+                  .set("lockSeconds", lockBlock >= 0 ? lockBlock * blockSize / sampleRate : -1.0)
+                  .set("maxLockedErrorBeats", maxLockedError)
+                  .set("maxLockedErrorMs", maxLockedError * 60000.0 / clockBpm)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            addCallbackStats(result, rig.profiler);
+            results.add(result.toVar());
+        }
+
+        // the MIDI clock sent to a virtual port and read back from it, with
+        // the audio callback played by this thread sleeping between blocks
+        {
+            struct Receiver : public juce::MidiInputCallback
+            {
+                void handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message) override
+                {
+                    auto index = count.load();
+                    if (message.isMidiClock() && index < (int) millis.size()) {
+                        millis[(size_t) index] = message.getTimeStamp() * 1000.0;
+                        count = index + 1;
+                    }
+                }
+
+                std::vector<double> millis;
+                std::atomic<int> count {0};
+            };
+
+            const double loopbackSeconds = quick ? 5.0 : 20.0;
+            const int blockSize = 512;
+            const juce::String portName = "Otodesk clock loopback";
+
+            MasterClock clock;
+            Receiver receiver;
+            receiver.millis.resize((size_t) (loopbackSeconds * clockBpm / 60.0 * MasterClock::ticksPerBeat) + 64);
+
+            std::unique_ptr<juce::MidiInput> input;
+
+            if (clock.openVirtualMidiOutput(portName)) {
+                for (auto& device : juce::MidiInput::getAvailableDevices())
+                    if (device.name.contains(portName))
+                        input = juce::MidiInput::openDevice(device.identifier, &receiver);
+            }
+
+            BenchmarkResult result {"clock"};
+            result.set("test", "midiLoopback");
+
+            if (input == nullptr) {
+                result.set("available", false);
+                results.add(result.toVar());
+                return;
+            }
+
+            input->start();
+            clock.prepare(sampleRate);
+            clock.setTempo(clockBpm);
+
+            auto blockMillis = blockSize * 1000.0 / sampleRate;
+            auto next = juce::Time::getMillisecondCounterHiRes();
+            auto end = next + loopbackSeconds * 1000.0;
+
+            while (next < end) {
+                clock.beginBlock(blockSize);
+                clock.advance(blockSize);
+
+                next += blockMillis;
+                auto wait = next - juce::Time::getMillisecondCounterHiRes();
+                if (wait > 0.0)
+                    juce::Thread::sleep((int) wait);
+            }
+
+            clock.closeMidiOutput();
+            juce::Thread::sleep(100);
+            input->stop();
+
+            // the jitter is how far every tick is from a straight line through
+            // all of them, which takes out the drift between the clocks
+            auto count = receiver.count.load();
+            double meanX = (count - 1) / 2.0, meanY = 0.0;
+            for (int i = 0; i < count; ++i)
+                meanY += receiver.millis[(size_t) i] / count;
+
+            double covariance = 0.0, variance = 0.0;
+            for (int i = 0; i < count; ++i) {
+                covariance += (i - meanX) * (receiver.millis[(size_t) i] - meanY);
+                variance += (i - meanX) * (i - meanX);
+            }
+
+            auto interval = variance > 0.0 ? covariance / variance : 0.0;
+            double squares = 0.0, maxJitter = 0.0;
+
+            for (int i = 0; i < count; ++i) {
+                auto residual = receiver.millis[(size_t) i] - (meanY + (i - meanX) * interval);
+                squares += residual * residual;
+                maxJitter = juce::jmax(maxJitter, std::abs(residual));
+            }
+
+            // the tempo a clock following the port would hear
+            MasterClock follower;
+            follower.setSource(MasterClock::Source::midiClock);
+            for (int i = 0; i < count; ++i) {
+                auto tick = juce::MidiMessage::midiClock().withTimeStamp(receiver.millis[(size_t) i] / 1000.0);
+                follower.handleIncomingMidiMessage(nullptr, tick);
+            }
+
+            // the tempo is picked up by the next block of the follower
+            follower.prepare(sampleRate);
+            follower.beginBlock(blockSize);
+
+            result.set("available", true)
+                  .set("bpm", clockBpm)
+                  .set("ticks", count)
+                  .set("expectedTicks", (int) (loopbackSeconds * clockBpm / 60.0 * MasterClock::ticksPerBeat))
+                  .set("measuredBpm", interval > 0.0 ? 60000.0 / (interval * MasterClock::ticksPerBeat) : 0.0)
+                  .set("followerBpm", follower.getTempo())
+                  .set("jitterRmsMs", count > 0 ? std::sqrt(squares / count) : 0.0)
+                  .set("jitterMaxMs", maxJitter)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            results.add(result.toVar());
+        }
+    }
+
+    //==============================================================================
+    // the time from a jog message leaving a controller to the audio thread
+    // applying it, through a virtual MIDI port and straight into the mapping
+    void benchmarkMidi(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numEvents = quick ? 100 : 1000;
+        const int blockSize = 256;
+        const auto blockMillis = blockSize * 1000.0 / sampleRate;
+
+        DeckRig rig {suite, 1, blockSize, numEvents * 0.05 + 30.0};
+        auto* player = rig.players[0].get();
+
+        MidiController controller;
+        controller.addDeck(player);
+        auto jog = juce::MidiMessage::controllerEvent(1, 16, 65);
+        controller.setMapping(jog, {0, DJAudioPlayer::Control::jog, 0});
+
+        // the audio callback, played by a thread that renders a block every
+        // block length like a device would
+        struct AudioLoop : public juce::Thread
+        {
+            AudioLoop(DeckRig& _rig, double _blockMillis)
+            : juce::Thread("Benchmark audio"), rig(_rig), blockMillis(_blockMillis) {}
+
+            void run() override
+            {
+                auto next = juce::Time::getMillisecondCounterHiRes();
+
+                while (! threadShouldExit()) {
+                    rig.renderBlock();
+
+                    next += blockMillis;
+                    auto wait = next - juce::Time::getMillisecondCounterHiRes();
+                    if (wait > 1.0)
+                        juce::Thread::sleep((int) wait);
+                    while (juce::Time::getMillisecondCounterHiRes() < next)
+                        juce::Thread::yield();
+                }
+            }
+
+            DeckRig& rig;
+            double blockMillis;
+        };
+
+        // sends the jog one way or the other and waits for the audio thread
+        auto measure = [&] (const juce::String& path, const std::function<void()>& send)
+        {
+            std::vector<double> latencies;
+            juce::Random random {41};
+
+            for (int i = 0; i < numEvents; ++i) {
+                auto before = player->getLastControlMillis();
+                auto sent = juce::Time::getMillisecondCounterHiRes();
+                send();
+
+                while (player->getLastControlMillis() == before
+                       && juce::Time::getMillisecondCounterHiRes() - sent < 500.0)
+                    juce::Thread::yield();
+
+                if (player->getLastControlMillis() != before)
+                    latencies.push_back(player->getLastControlMillis() - sent);
+
+                // the next message comes in at a random point of a block
+                juce::Thread::sleep(10 + random.nextInt(20));
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+            auto count = (int) latencies.size();
+            auto withinBlock = std::count_if(latencies.begin(), latencies.end(),
+                                             [blockMillis] (double latency) { return latency <= blockMillis; });
+
+            BenchmarkResult result {"midi"};
+            result.set("path", path)
+                  .set("blockSize", blockSize)
+                  .set("blockMillis", blockMillis)
+                  .set("events", numEvents)
+                  .set("applied", count)
+                  .set("meanLatencyMs", count > 0 ? std::accumulate(latencies.begin(), latencies.end(), 0.0) / count : 0.0)
+                  .set("p99LatencyMs", count > 0 ? latencies[(size_t) (count - 1) * 99 / 100] : 0.0)
+                  .set("maxLatencyMs", count > 0 ? latencies.back() : 0.0)
+                  .set("withinOneBlock", count > 0 ? (double) withinBlock / count : 0.0)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            results.add(result.toVar());
+        };
+
+        AudioLoop audioLoop {rig, blockMillis};
+        audioLoop.startThread(9);
+
+        // straight into the mapping, the cost of the queue and the block
+        measure("direct", [&] { controller.handleIncomingMidiMessage(nullptr, jog); });
+
+        // through a virtual port, with the MIDI driver and its thread as well
+        std::unique_ptr<juce::MidiOutput> output;
+       #if JUCE_LINUX || JUCE_MAC
+        output = juce::MidiOutput::createNewDevice("Otodesk controller loopback");
+       #endif
+
+        auto opened = false;
+        if (output != nullptr) {
+            for (auto& device : juce::MidiInput::getAvailableDevices())
+                if (device.name.contains("Otodesk controller loopback"))
+                    opened = controller.openInput(device.identifier);
+        }
+
+        if (opened) {
+            measure("virtualPort", [&] { output->sendMessageNow(jog); });
+        }
+        else {
+            BenchmarkResult result {"midi"};
+            result.set("path", "virtualPort")
+                  .set("available", false);
+            results.add(result.toVar());
+        }
+
+        audioLoop.stopThread(1000);
+    }
+
+    //==============================================================================
+    // reads at random positions of a compressed track, straight from the
+    // decoder and through the seek cache once its copy is ready
+    void benchmarkSeekCache(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int numSeeks = quick ? 200 : 2000;
+        const int blockSize = 512;
+        const double trackSeconds = quick ? 60.0 : 300.0;
+
+        juce::AudioBuffer<float> buffer {2, blockSize};
+
+        // the time of every read at a random position, in microseconds
+        auto seek = [&] (juce::AudioFormatReader& reader)
+        {
+            std::vector<double> micros;
+            juce::Random random {43};
+
+            for (int i = 0; i < numSeeks; ++i) {
+                auto position = (juce::int64) (random.nextDouble() * (double) (reader.lengthInSamples - blockSize));
+                auto start = BenchmarkSuite::getNanos();
+                reader.read(&buffer, 0, blockSize, position, true, true);
+                micros.push_back((double) (BenchmarkSuite::getNanos() - start) * 1.0e-3);
+            }
+
+            std::sort(micros.begin(), micros.end());
+            return micros;
+        };
+
+        auto addResult = [&] (const juce::String& format, const juce::String& path, const std::vector<double>& micros, double buildMs)
+        {
+            BenchmarkResult result {"seekCache"};
+            result.set("format", format)
+                  .set("path", path)
+                  .set("trackSeconds", trackSeconds)
+                  .set("seeks", numSeeks)
+                  .set("meanSeekMicros", std::accumulate(micros.begin(), micros.end(), 0.0) / (double) micros.size())
+                  .set("p99SeekMicros", micros[(micros.size() - 1) * 99 / 100])
+                  .set("maxSeekMicros", micros.back())
+                  .set("buildMs", buildMs)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            results.add(result.toVar());
+        };
+
+        for (auto extension : {".ogg", ".flac"}) {
+            auto file = suite.getTestTrack(trackSeconds, 0, extension);
+            auto format = juce::String(extension).substring(1);
+            SeekCache::getCacheFile(file).deleteFile();
+
+            // before: every seek goes through the compressed stream
+            std::unique_ptr<juce::AudioFormatReader> reader (suite.getFormatManager().createReaderFor(file));
+            if (reader == nullptr)
+                continue;
+
+            addResult(format, "decoder", seek(*reader), 0.0);
+
+            // the pages of the copy are touched here as they are on a deck
+            juce::TimeSliceThread touchThread {"Seek cache pages"};
+            touchThread.startThread(2);
+
+            // after: the first load makes the copy, the second finds it in the cache
+            for (auto path : {"copy", "cachedCopy"}) {
+                SeekCacheReader cached {suite.getFormatManager(),
+                                        juce::URL{file},
+                                        suite.getFormatManager().createReaderFor(file),
+                                        touchThread};
+
+                auto start = juce::Time::getMillisecondCounterHiRes();
+                while (! cached.isUsingCopy() && juce::Time::getMillisecondCounterHiRes() - start < 120000.0) {
+                    cached.read(&buffer, 0, 1, 0, true, true);
+                    juce::Thread::sleep(1);
+                }
+
+                auto buildMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+                if (cached.isUsingCopy())
+                    addResult(format, path, seek(cached), buildMs);
+            }
+
+            // leave nothing behind in the cache of the app
+            SeekCache::getCacheFile(file).deleteFile();
+        }
+    }
+
+    //==============================================================================
+    // a deck and a band waveform for tracks from a minute to a recorded mix,
+    // shortest first so the growth of the peak memory belongs to each length
+    void benchmarkLongTracks(BenchmarkSuite& suite, juce::Array<juce::var>& results)
+    {
+        const bool quick = suite.getOptions().quick;
+        const int blockSize = 256;
+        const double playSeconds = 10.0;
+        juce::Array<double> lengths {60.0, 1800.0};
+        if (! quick)
+            lengths.add(3.0 * 3600.0);
+
+        // renders blocks until one is not silent, waiting a little after a
+        // silent one the way a device would, returns the time it took
+        auto millisToAudio = [] (DeckRig& rig, double startMillis)
+        {
+            while (juce::Time::getMillisecondCounterHiRes() - startMillis < 5000.0) {
+                rig.renderBlock();
+
+                if (rig.output.getMagnitude(0, blockSize) > 0.0f)
+                    break;
+
+                juce::Thread::sleep(1);
+            }
+
+            return juce::Time::getMillisecondCounterHiRes() - startMillis;
+        };
+
+        for (auto trackSeconds : lengths) {
+            auto file = suite.getTestTrack(trackSeconds, 0);
+            auto peakBefore = BenchmarkSuite::getPeakRssBytes();
+
+            DeckRig rig {suite, 1, blockSize, trackSeconds};
+            auto* player = rig.players[0].get();
+
+            // the deck as it is used: load, play, and a jump to the middle
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            player->loadURL(juce::URL{file});
+            player->start();
+            auto firstAudioMs = millisToAudio(rig, start);
+
+            for (int i = 0; i < (int) (playSeconds * sampleRate / blockSize); ++i)
+                rig.renderBlock();
+
+            start = juce::Time::getMillisecondCounterHiRes();
+            player->setPositionRelative(0.5);
+            auto seekAudioMs = millisToAudio(rig, start);
+
+            // the band waveform, and how soon the display gets its first buckets
+            std::unique_ptr<juce::AudioFormatReader> reader (suite.getFormatManager().createReaderFor(file));
+            BandWaveform waveform;
+            auto waveformStart = BenchmarkSuite::getNanos();
+            juce::int64 firstBucketsNanos = -1;
+
+            if (reader != nullptr)
+                waveform.generate(*reader,
+                                  [] { return false; },
+                                  [&] {
+                                      if (firstBucketsNanos < 0)
+                                          firstBucketsNanos = BenchmarkSuite::getNanos() - waveformStart;
+                                  });
+
+            auto waveformNanos = BenchmarkSuite::getNanos() - waveformStart;
+
+            BenchmarkResult result {"longTracks"};
+            result.set("trackSeconds", trackSeconds)
+                  .set("streaming", player->isStreaming())
+                  .set("firstAudioMs", firstAudioMs)
+                  .set("seekAudioMs", seekAudioMs)
+                  .set("waveformFirstBucketsMs", (double) firstBucketsNanos * 1.0e-6)
+                  .set("waveformNsPerSample", (double) waveformNanos / (double) juce::jmax((juce::int64) 1, reader != nullptr ? reader->lengthInSamples : 0))
+                  .set("waveformBuckets", (int) waveform.getBuckets().size())
+                  .set("waveformBytes", (juce::int64) (waveform.getBuckets().size() * sizeof(BandWaveform::Bucket)))
+                  .set("peakRssGrowthBytes", BenchmarkSuite::getPeakRssBytes() - peakBefore)
+                  .set("peakRssBytes", BenchmarkSuite::getPeakRssBytes());
+            addCallbackStats(result, rig.profiler);
+            results.add(result.toVar());
+        }
+    }
+}
+
+//==============================================================================
+// add the scenarios measuring the audio engine and the library
+void addEngineBenchmarks(BenchmarkSuite& suite)
+{
+    suite.add("decks", benchmarkDecks);
+    suite.add("seekStorm", benchmarkSeekStorm);
+    suite.add("cueLatency", benchmarkCueLatency);
+    suite.add("preload", benchmarkPreload);
+    suite.add("scratch", benchmarkScratch);
+    suite.add("analysis", benchmarkAnalysis);
+    suite.add("playlist", benchmarkPlaylist);
+    suite.add("largeLibrary", benchmarkLargeLibrary);
+    suite.add("search", benchmarkSearch);
+    suite.add("thumbnails", benchmarkThumbnails);
+    suite.add("waveforms", benchmarkWaveforms);
+    suite.add("loudness", benchmarkLoudness);
+    suite.add("automix", benchmarkAutomix);
+    suite.add("keys", benchmarkKeys);
+    suite.add("effects", benchmarkEffects);
+    suite.add("clock", benchmarkClock);
+    suite.add("midi", benchmarkMidi);
+    suite.add("longTracks", benchmarkLongTracks);
+    suite.add("seekCache", benchmarkSeekCache);
+    suite.add("duplicates", benchmarkDuplicates);
+    suite.add("crates", benchmarkCrates);
+    suite.add("history", benchmarkHistory);
+    suite.add("session", benchmarkSession);
+}
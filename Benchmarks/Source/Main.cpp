@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    This file contains the startup code for the headless benchmarks.
+
+    Usage: OtodeskBenchmarks [--quick] [--filter=<name>] [--label=<text>]
+                             [--output=<file.json>]
+
+    Offline render: OtodeskBenchmarks --render=<directory> [--seconds=<n>]
+                                      [--deck1=<file>] [--deck2=<file>]
+    plays two decks with the cue of deck 2 on, and writes master.wav and
+    cue.wav into the directory
+
+    Offline automix: OtodeskBenchmarks --render=<directory> --automix=<n>
+                                       [--tracks=<folder>] [--seconds=<n>]
+    mixes n test tracks, or the tracks of a folder, one after the other
+    and stops at the end of the queue or after the given seconds
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchmarkSuite.h"
+#include "../../Source/DJAudioPlayer.h"
+#include "../../Source/DeckMixer.h"
+#include "../../Source/OfflineRenderer.h"
+#include "../../Source/Automix.h"
+
+//==============================================================================
+// render two decks without an audio device and write both buses to files
+static int renderOffline(const juce::ArgumentList& args, const BenchmarkOptions& options)
+{
+    auto seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 30.0;
+    auto directory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--render"));
+
+    // the suite provides the formats and the test tracks
+    BenchmarkSuite suite {options};
+    DJAudioPlayer deck1 {suite.getFormatManager()};
+    DJAudioPlayer deck2 {suite.getFormatManager()};
+    DeckMixer mixer;
+
+    int index = 0;
+    for (auto* deck : {&deck1, &deck2}) {
+        // play the given file or a test track
+        auto path = args.getValueForOption("--deck" + juce::String(index + 1));
+        auto file = path.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(path)
+                                      : suite.getTestTrack(seconds + 5.0, index);
+
+        deck->loadURL(juce::URL{file});
+        deck->start();
+        mixer.addDeck(deck);
+        ++index;
+    }
+
+    // only deck 2 is heard on the headphones
+    deck2.setCueEnabled(true);
+
+    if (! OfflineRenderer::render(mixer, 44100.0, 512, seconds, directory))
+        return 1;
+
+    std::cerr << "wrote " << directory.getFullPathName() << std::endl;
+    return 0;
+}
+
+// mix a queue of tracks without an audio device, as fast as it can be decoded
+static int renderAutomix(const juce::ArgumentList& args, const BenchmarkOptions& options)
+{
+    auto seconds = args.containsOption("--seconds") ? args.getValueForOption("--seconds").getDoubleValue() : 7200.0;
+    auto directory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--render"));
+
+    BenchmarkSuite suite {options};
+    DJAudioPlayer deck1 {suite.getFormatManager()};
+    DJAudioPlayer deck2 {suite.getFormatManager()};
+    DeckMixer mixer;
+    mixer.addDeck(&deck1);
+    mixer.addDeck(&deck2);
+
+    // the tracks of the folder in name order, or test tracks of three minutes
+    juce::Array<juce::URL> queue;
+    auto folder = args.getValueForOption("--tracks");
+
+    if (folder.isNotEmpty()) {
+        auto files = juce::File::getCurrentWorkingDirectory().getChildFile(folder)
+                         .findChildFiles(juce::File::findFiles, false, suite.getFormatManager().getWildcardForAllFormats());
+        files.sort();
+
+        for (auto& file : files)
+            queue.add(juce::URL{file});
+    }
+    else {
+        auto numTracks = args.getValueForOption("--automix").getIntValue();
+        for (int i = 0; i < numTracks; ++i)
+            queue.add(juce::URL{suite.getTestTrack(180.0, i)});
+    }
+
+    if (queue.isEmpty()) {
+        std::cerr << "no tracks to mix" << std::endl;
+        return 1;
+    }
+
+    Automix automix {mixer, deck1, deck2, suite.getFormatManager()};
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    automix.start(queue, true);
+
+    // the automix is moved on after every block instead of by its timer
+    auto written = OfflineRenderer::render(mixer, 44100.0, 512, seconds, directory,
+                                           [&automix] { automix.update(); return ! automix.isFinished(); });
+    automix.stop();
+
+    if (! written)
+        return 1;
+
+    auto rendered = mixer.getScheduler().getMasterClock() / 44100.0;
+    auto elapsed = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    std::cerr << "mixed " << automix.getNumTransitions() + 1 << " tracks, " << rendered << " s in "
+              << elapsed << " s, wrote " << directory.getFullPathName() << std::endl;
+    return 0;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the players send change messages, so a message manager has to exist
+    // even though nothing ever dispatches them
+    juce::MessageManager::getInstance();
+
+    juce::ArgumentList args {argc, argv};
+
+    BenchmarkOptions options;
+    options.quick = args.containsOption("--quick");
+    options.filter = args.getValueForOption("--filter");
+    options.label = args.getValueForOption("--label");
+    options.workDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                .getChildFile("otodesk-benchmarks");
+
+    if (args.containsOption("--render")) {
+        auto result = args.containsOption("--automix") ? renderAutomix(args, options)
+                                                       : renderOffline(args, options);
+        juce::MessageManager::deleteInstance();
+        return result;
+    }
+
+    juce::var results;
+
+    {
+        BenchmarkSuite suite {options};
+        addEngineBenchmarks(suite);
+        results = suite.runAll();
+    }
+
+    auto json = juce::JSON::toString(results);
+    auto output = args.getValueForOption("--output");
+
+    // print the results unless a file was asked for
+    if (output.isEmpty()) {
+        std::cout << json << std::endl;
+    }
+    else if (! juce::File::getCurrentWorkingDirectory().getChildFile(output).replaceWithText(json)) {
+        std::cerr << "could not write " << output << std::endl;
+        return 1;
+    }
+
+    juce::MessageManager::deleteInstance();
+    return 0;
+}
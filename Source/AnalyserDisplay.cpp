@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    AnalyserDisplay.cpp
+    Created: 19 Oct 2026 5:46:10pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AnalyserDisplay.h"
+
+namespace
+{
+    // the range of the meters and the spectrum
+    const float minDecibels = -60.0f;
+    const float minSpectrumDecibels = -90.0f;
+    const float minFrequency = 20.0f;
+    const float maxFrequency = 20000.0f;
+
+    // a loudness as text, or a dash if there is none yet
+    juce::String formatLufs(float lufs)
+    {
+        return lufs > -70.0f ? juce::String(lufs, 1) : juce::String("-");
+    }
+}
+
+//==============================================================================
+AnalyserDisplay::AnalyserDisplay(AudioAnalyser& _analyser, bool _compact)
+: analyser(_analyser),
+  compact(_compact)
+{
+    // the display is only there to look at
+    setInterceptsMouseClicks(false, false);
+}
+
+AnalyserDisplay::~AnalyserDisplay()
+{
+    stopTimer();
+}
+
+// called to draw the component content
+void AnalyserDisplay::paint (juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black.withAlpha(compact ? 1.0f : 0.85f));
+
+    auto area = getLocalBounds().toFloat().reduced(2.0f);
+
+    // the loudness, momentary, short term and integrated
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+
+    auto text = "M " + formatLufs(snapshot.momentary)
+                + "  S " + formatLufs(snapshot.shortTerm)
+                + "  I " + formatLufs(snapshot.integrated) + " LUFS";
+
+    if (compact) {
+        // two horizontal meters above the loudness
+        auto textArea = area.removeFromBottom(13.0f);
+        g.drawText(text, textArea, juce::Justification::centred, false);
+
+        auto meterH = area.getHeight() / 2.0f;
+        paintMeter(g, area.removeFromTop(meterH).reduced(0.0f, 1.0f), 0, false);
+        paintMeter(g, area.reduced(0.0f, 1.0f), 1, false);
+        return;
+    }
+
+    g.drawText(text, area.removeFromTop(13.0f), juce::Justification::centredLeft, false);
+
+    // two vertical meters on the right of the spectrum
+    auto meters = area.removeFromRight(22.0f);
+    paintMeter(g, meters.removeFromLeft(10.0f), 0, true);
+    meters.removeFromLeft(2.0f);
+    paintMeter(g, meters, 1, true);
+
+    area.removeFromRight(4.0f);
+    paintSpectrum(g, area);
+}
+
+// read the latest snapshot and redraw
+void AnalyserDisplay::timerCallback()
+{
+    analyser.getSnapshot(snapshot);
+    repaint();
+}
+
+// only run the analysis while the display can be seen
+void AnalyserDisplay::visibilityChanged()
+{
+    auto showing = isVisible();
+    analyser.setEnabled(showing);
+
+    if (showing)
+        startTimerHz(30);
+    else
+        stopTimer();
+}
+
+//==============================================================================
+// draw the spectrum on a log frequency axis
+void AnalyserDisplay::paintSpectrum(juce::Graphics& g, juce::Rectangle<float> area)
+{
+    const auto binWidth = (float) snapshot.sampleRate / (float) AudioAnalyser::fftSize;
+    const auto logRange = std::log(maxFrequency / minFrequency);
+
+    // the position of a frequency and a level in the area
+    auto toX = [&] (float frequency) {
+        return area.getX() + area.getWidth() * std::log(frequency / minFrequency) / logRange;
+    };
+    auto toY = [&] (float decibels) {
+        auto proportion = juce::jlimit(0.0f, 1.0f, 1.0f - decibels / minSpectrumDecibels);
+        return area.getBottom() - area.getHeight() * proportion;
+    };
+
+    // a line every octave from 31 Hz
+    g.setColour(juce::Colours::white.withAlpha(0.15f));
+    for (auto frequency = 31.25f; frequency < maxFrequency; frequency *= 2.0f)
+        g.drawVerticalLine((int) toX(frequency), area.getY(), area.getBottom());
+
+    spectrumPath.clear();
+    spectrumPath.preallocateSpace(3 * AudioAnalyser::numBins);
+    spectrumPath.startNewSubPath(area.getX(), area.getBottom());
+
+    // the bins are denser than the pixels at the top, so only draw the loudest
+    // bin of every pixel
+    auto lastX = area.getX();
+    auto loudest = minSpectrumDecibels;
+
+    for (int bin = 1; bin < AudioAnalyser::numBins; ++bin) {
+        auto frequency = bin * binWidth;
+
+        if (frequency < minFrequency)
+            continue;
+        if (frequency > maxFrequency)
+            break;
+
+        auto x = toX(frequency);
+        loudest = juce::jmax(loudest, snapshot.spectrum[(size_t) bin]);
+
+        if (x - lastX >= 1.0f) {
+            spectrumPath.lineTo(x, toY(loudest));
+            lastX = x;
+            loudest = minSpectrumDecibels;
+        }
+    }
+
+    spectrumPath.lineTo(lastX, area.getBottom());
+    spectrumPath.closeSubPath();
+
+    g.setColour(juce::Colours::deepskyblue.withAlpha(0.5f));
+    g.fillPath(spectrumPath);
+    g.setColour(juce::Colours::deepskyblue);
+    g.strokePath(spectrumPath, juce::PathStrokeType(1.0f));
+}
+
+// draw the peak and RMS meter of one channel
+void AnalyserDisplay::paintMeter(juce::Graphics& g, juce::Rectangle<float> area, int channel, bool vertical)
+{
+    g.setColour(juce::Colours::darkgrey);
+    g.fillRect(area);
+
+    auto peak = levelToProportion(snapshot.peak[(size_t) channel]);
+    auto rms = levelToProportion(snapshot.rms[(size_t) channel]);
+
+    // the part of the meter up to a level
+    auto part = [&] (float proportion) {
+        return vertical ? area.withTop(area.getBottom() - area.getHeight() * proportion)
+                        : area.withWidth(area.getWidth() * proportion);
+    };
+
+    // the RMS is a bar, the peak a line that turns red near full scale
+    g.setColour(juce::Colours::limegreen);
+    g.fillRect(part(rms));
+
+    g.setColour(snapshot.peak[(size_t) channel] > -1.0f ? juce::Colours::red : juce::Colours::yellow);
+    auto peakArea = part(peak);
+
+    if (vertical)
+        g.fillRect(peakArea.withHeight(2.0f));
+    else
+        g.fillRect(peakArea.withLeft(peakArea.getRight() - 2.0f));
+}
+
+// where a level in dB sits between 0 and 1
+float AnalyserDisplay::levelToProportion(float decibels)
+{
+    return juce::jlimit(0.0f, 1.0f, 1.0f - decibels / minDecibels);
+}
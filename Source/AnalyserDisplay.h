@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    AnalyserDisplay.h
+    Created: 19 Oct 2026 5:46:10pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioAnalyser.h"
+
+//==============================================================================
+/*
+ Draws the spectrum, the level meters and the loudness measured by an
+ AudioAnalyser. The display only reads the analyser while it is visible, and
+ turns the analysis off while it is hidden, so hidden meters cost nothing.
+ The compact version only draws the meters and the loudness.
+*/
+class AnalyserDisplay
+    : public juce::Component,
+    public juce::Timer
+{
+public:
+    AnalyserDisplay(AudioAnalyser& analyser, bool compact);
+    ~AnalyserDisplay() override;
+
+    /** Called to draw component content */
+    void paint (juce::Graphics&) override;
+
+    /** User defined callback that gets called periodically */
+    void timerCallback() override;
+
+    /** Called when the component is shown or hidden */
+    void visibilityChanged() override;
+
+private:
+    /** Draws the spectrum on a log frequency axis */
+    void paintSpectrum(juce::Graphics& g, juce::Rectangle<float> area);
+    /** Draws the peak and RMS meter of one channel */
+    void paintMeter(juce::Graphics& g, juce::Rectangle<float> area, int channel, bool vertical);
+    /** Returns where a level in dB sits between 0 and 1 */
+    static float levelToProportion(float decibels);
+
+    // the analyser to display
+    AudioAnalyser& analyser;
+    // true to only draw the meters and the loudness
+    bool compact;
+
+    // the snapshot shown in the last repaint
+    AudioAnalyser::Snapshot snapshot;
+    // the outline of the spectrum, kept to reuse its memory
+    juce::Path spectrumPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyserDisplay)
+};
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    AnalysisPool.cpp
+    Created: 19 Oct 2026 6:24:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "AnalysisPool.h"
+
+#include <algorithm>
+
+AnalysisPool::AnalysisPool()
+: pool(getNumThreads())
+{
+    // the analysis must never take time from the audio thread
+    pool.setThreadPriorities(2);
+}
+
+AnalysisPool::~AnalysisPool()
+{
+    stopTimer();
+    pool.removeAllJobs(true, 4000);
+}
+
+//==============================================================================
+// add a job to the pool
+void AnalysisPool::addJob(juce::ThreadPoolJob* job)
+{
+    pool.addJob(job, false);
+}
+
+// remove a job that has finished its work, it only has to return
+void AnalysisPool::removeFinishedJob(juce::ThreadPoolJob* job)
+{
+    pool.removeJob(job, false, -1);
+}
+
+// stop a job and delete it once it has stopped
+void AnalysisPool::cancelJob(std::unique_ptr<juce::ThreadPoolJob> job)
+{
+    if (job == nullptr)
+        return;
+
+    // a job waiting in the queue is taken out of it and deleted here, a
+    // running one is asked to stop and checks that between its blocks
+    if (pool.removeJob(job.get(), true, 0))
+        return;
+
+    const juce::ScopedLock lock {cancelledLock};
+    cancelledJobs.push_back(std::move(job));
+
+    if (! deleteStoppedJobs())
+        startTimer(100);
+}
+
+// the folder analysis results are cached in
+juce::File AnalysisPool::getCacheDirectory()
+{
+    auto directory = juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+                         .getChildFile("Otodesk")
+                         .getChildFile("Analysis");
+
+    directory.createDirectory();
+    return directory;
+}
+
+//==============================================================================
+// delete the cancelled jobs that have stopped
+void AnalysisPool::timerCallback()
+{
+    if (deleteStoppedJobs())
+        stopTimer();
+}
+
+// delete the cancelled jobs the pool has let go of
+bool AnalysisPool::deleteStoppedJobs()
+{
+    const juce::ScopedLock lock {cancelledLock};
+
+    cancelledJobs.erase(std::remove_if(cancelledJobs.begin(), cancelledJobs.end(),
+                                       [this] (const std::unique_ptr<juce::ThreadPoolJob>& job)
+                                       {
+                                           return ! pool.contains(job.get());
+                                       }),
+                        cancelledJobs.end());
+
+    return cancelledJobs.empty();
+}
+
+// one core is left for the audio and the message thread
+int AnalysisPool::getNumThreads()
+{
+    return juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+}
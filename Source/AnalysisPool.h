@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    AnalysisPool.h
+    Created: 19 Oct 2026 6:24:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/*
+ The low priority threads that analyse tracks in the background. There is one
+ pool for the whole app, shared with juce::SharedResourcePointer, so opening
+ more decks or importing more tracks never starts more threads than there are
+ cores to spare.
+
+ A job that is cancelled while it runs is handed to the pool, which deletes
+ it once it has stopped, so nothing ever waits for a job to stop.
+*/
+class AnalysisPool : private juce::Timer
+{
+public:
+    AnalysisPool();
+    ~AnalysisPool() override;
+
+    /** Adds a job to the pool, the pool does not delete it */
+    void addJob(juce::ThreadPoolJob* job);
+    /** Removes a job that has said it is finished from the pool, which only
+        waits for it to return from runJob */
+    void removeFinishedJob(juce::ThreadPoolJob* job);
+    /** Asks a job to stop and deletes it, at once if it is not running, or
+        once it has stopped if it is. Never waits */
+    void cancelJob(std::unique_ptr<juce::ThreadPoolJob> job);
+
+    /** Returns the folder analysis results are cached in */
+    static juce::File getCacheDirectory();
+
+private:
+    /** Returns the number of threads to use, one core is left for the audio */
+    static int getNumThreads();
+    /** Deletes the cancelled jobs that have stopped */
+    void timerCallback() override;
+    /** Deletes the cancelled jobs that have stopped, returns true if none are left */
+    bool deleteStoppedJobs();
+
+    // the cancelled jobs still running, declared before the pool so they
+    // are deleted after its threads have stopped
+    juce::CriticalSection cancelledLock;
+    std::vector<std::unique_ptr<juce::ThreadPoolJob>> cancelledJobs;
+
+    // the threads running the jobs
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisPool)
+};
@@ -0,0 +1,311 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.cpp
+    Created: 19 Oct 2026 5:20:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "AudioAnalyser.h"
+#include "LoudnessAnalyser.h"
+
+namespace
+{
+    // the level of a mean square in dB
+    inline float toDecibels(double meanSquare)
+    {
+        return meanSquare > 0.0 ? juce::jmax(-100.0f, (float) (10.0 * std::log10(meanSquare))) : -100.0f;
+    }
+}
+
+AudioAnalyser::AudioAnalyser()
+{
+    spectrum.fill(-100.0f);
+}
+
+AudioAnalyser::~AudioAnalyser() {}
+
+//==============================================================================
+// turn the analysis on or off
+void AudioAnalyser::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+// check if the analysis is on
+bool AudioAnalyser::isEnabled() const
+{
+    return enabled;
+}
+
+// the sample rate of the signal, picked up by the analysis thread
+void AudioAnalyser::prepare(double newSampleRate)
+{
+    pendingSampleRate = newSampleRate;
+}
+
+// start measuring the integrated loudness again
+void AudioAnalyser::reset()
+{
+    pendingReset = true;
+}
+
+//==============================================================================
+// copy a block into the FIFO, called by the audio thread
+void AudioAnalyser::push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (! enabled || buffer.getNumChannels() == 0)
+        return;
+
+    // whatever does not fit is dropped, the analysis thread is behind anyway
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < 2; ++channel) {
+        // a mono buffer fills both channels
+        auto source = juce::jmin(channel, buffer.getNumChannels() - 1);
+
+        if (size1 > 0)
+            fifoBuffer.copyFrom(channel, start1, buffer, source, startSample, size1);
+        if (size2 > 0)
+            fifoBuffer.copyFrom(channel, start2, buffer, source, startSample + size1, size2);
+    }
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+// analyse everything in the FIFO, called by the analysis thread
+void AudioAnalyser::process()
+{
+    auto newSampleRate = pendingSampleRate.load();
+    if (newSampleRate != sampleRate)
+        configure(newSampleRate);
+
+    if (pendingReset.exchange(false))
+        gatingBlocks.clear();
+
+    auto numReady = fifo.getNumReady();
+    if (numReady == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        analyse(start1, size1);
+    if (size2 > 0)
+        analyse(start2, size2);
+
+    fifo.finishedRead(size1 + size2);
+    publish(size1 + size2);
+}
+
+// copy the latest snapshot, called by the GUI
+void AudioAnalyser::getSnapshot(Snapshot& snapshot) const
+{
+    // copy again if a new snapshot was published while copying
+    for (;;) {
+        auto before = sequence.load();
+        snapshot = snapshots[(size_t) published.load()];
+
+        if (sequence.load() == before)
+            return;
+    }
+}
+
+//==============================================================================
+// set up the filters and the block lengths for the sample rate
+void AudioAnalyser::configure(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    blockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    // the loudness is measured on the K-weighted signal, the same way the
+    // library measures whole tracks
+    juce::dsp::IIR::Coefficients<float>::Ptr shelf, highPass;
+    LoudnessAnalyser::createKWeighting(sampleRate, shelf, highPass);
+
+    for (int channel = 0; channel < 2; ++channel) {
+        shelfFilters[(size_t) channel].coefficients = shelf;
+        shelfFilters[(size_t) channel].reset();
+        highPassFilters[(size_t) channel].coefficients = highPass;
+        highPassFilters[(size_t) channel].reset();
+    }
+
+    // start every measurement again
+    blockPosition = 0;
+    weightedSum = 0.0;
+    squareSum.fill(0.0);
+    recentPeak.fill(0.0f);
+    peakLevel.fill(0.0f);
+    weightedBlocks.fill(0.0);
+    for (auto& blocks : channelBlocks)
+        blocks.fill(0.0);
+    blockIndex = 0;
+    numBlocksSeen = 0;
+    gatingBlocks.clear();
+
+    history.fill(0.0f);
+    spectrum.fill(-100.0f);
+    historyIndex = 0;
+    samplesSinceFft = 0;
+}
+
+// analyse part of the FIFO
+void AudioAnalyser::analyse(int startSample, int numSamples)
+{
+    const float* channels[2] = {fifoBuffer.getReadPointer(0, startSample),
+                                fifoBuffer.getReadPointer(1, startSample)};
+
+    for (int i = 0; i < numSamples; ++i) {
+        for (int channel = 0; channel < 2; ++channel) {
+            auto sample = channels[channel][i];
+
+            recentPeak[(size_t) channel] = juce::jmax(recentPeak[(size_t) channel], std::abs(sample));
+            squareSum[(size_t) channel] += sample * sample;
+
+            // the loudness is measured on the K-weighted signal
+            auto weighted = highPassFilters[(size_t) channel].processSample(
+                                shelfFilters[(size_t) channel].processSample(sample));
+            weightedSum += weighted * weighted;
+        }
+
+        // the spectrum is taken every quarter of an FFT
+        history[(size_t) historyIndex] = 0.5f * (channels[0][i] + channels[1][i]);
+        historyIndex = (historyIndex + 1) & (fftSize - 1);
+
+        if (++samplesSinceFft >= fftSize / 4) {
+            updateSpectrum();
+            samplesSinceFft = 0;
+        }
+
+        // the end of a 100 millisecond block
+        if (++blockPosition >= blockLength) {
+            weightedBlocks[(size_t) blockIndex] = weightedSum / blockLength;
+
+            for (int channel = 0; channel < 2; ++channel)
+                channelBlocks[(size_t) channel][(size_t) blockIndex] = squareSum[(size_t) channel] / blockLength;
+
+            blockIndex = (blockIndex + 1) % numBlocks;
+            numBlocksSeen = juce::jmin(numBlocksSeen + 1, numBlocks);
+
+            // every block completes a 400 millisecond gating block
+            if (numBlocksSeen >= 4)
+                gatingBlocks.push_back(getRecentMean(weightedBlocks, 4));
+
+            blockPosition = 0;
+            weightedSum = 0.0;
+            squareSum.fill(0.0);
+        }
+    }
+}
+
+// run the FFT over the latest samples
+void AudioAnalyser::updateSpectrum()
+{
+    // the oldest sample first
+    for (int i = 0; i < fftSize; ++i)
+        fftData[(size_t) i] = history[(size_t) ((historyIndex + i) & (fftSize - 1))];
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // a full scale sine shows at 0 dB, the peaks fall back slowly
+    const auto scale = 4.0f / (float) fftSize;
+
+    for (int bin = 0; bin < numBins; ++bin) {
+        auto level = juce::Decibels::gainToDecibels(fftData[(size_t) bin] * scale, -100.0f);
+        spectrum[(size_t) bin] = juce::jmax(level, spectrum[(size_t) bin] - 0.75f);
+    }
+}
+
+// write the results into the snapshot that is not published and publish it
+void AudioAnalyser::publish(int numSamplesAnalysed)
+{
+    auto& snapshot = snapshots[(size_t) (1 - published.load())];
+
+    snapshot.spectrum = spectrum;
+    snapshot.sampleRate = sampleRate;
+
+    // the peaks fall back by 1/e every half a second
+    auto decay = (float) std::exp(-numSamplesAnalysed / (0.5 * sampleRate));
+
+    for (int channel = 0; channel < 2; ++channel) {
+        auto c = (size_t) channel;
+        peakLevel[c] = juce::jmax(recentPeak[c], peakLevel[c] * decay);
+        recentPeak[c] = 0.0f;
+
+        snapshot.peak[c] = juce::Decibels::gainToDecibels(peakLevel[c], -100.0f);
+        snapshot.rms[c] = toDecibels(getRecentMean(channelBlocks[c], 3));
+    }
+
+    snapshot.momentary = LoudnessAnalyser::toLufs(getRecentMean(weightedBlocks, 4));
+    snapshot.shortTerm = LoudnessAnalyser::toLufs(getRecentMean(weightedBlocks, 30));
+    snapshot.integrated = LoudnessAnalyser::getGatedLoudness(gatingBlocks);
+
+    // the GUI reads the new snapshot from now on
+    published = 1 - published.load();
+    ++sequence;
+}
+
+// the mean of the last few 100 millisecond blocks
+double AudioAnalyser::getRecentMean(const std::array<double, numBlocks>& blocks, int count) const
+{
+    count = juce::jmin(count, numBlocksSeen);
+
+    if (count == 0)
+        return 0.0;
+
+    double sum = 0.0;
+
+    for (int i = 1; i <= count; ++i)
+        sum += blocks[(size_t) ((blockIndex - i + numBlocks) % numBlocks)];
+
+    return sum / count;
+}
+
+//==============================================================================
+AnalysisThread::AnalysisThread()
+: juce::Thread("Audio analysis")
+{
+    // the analysis must never take time from the audio thread
+    startThread(2);
+}
+
+AnalysisThread::~AnalysisThread()
+{
+    stopThread(2000);
+}
+
+// add an analyser to the thread
+void AnalysisThread::addAnalyser(AudioAnalyser* analyser)
+{
+    const juce::ScopedLock sl (lock);
+    analysers.addIfNotAlreadyThere(analyser);
+}
+
+// remove an analyser from the thread
+void AnalysisThread::removeAnalyser(AudioAnalyser* analyser)
+{
+    const juce::ScopedLock sl (lock);
+    analysers.removeFirstMatchingValue(analyser);
+}
+
+// run the analysers every few milliseconds
+void AnalysisThread::run()
+{
+    while (! threadShouldExit()) {
+        {
+            const juce::ScopedLock sl (lock);
+
+            // analysers that are off cost nothing
+            for (auto* analyser : analysers)
+                if (analyser->isEnabled())
+                    analyser->process();
+        }
+
+        wait(10);
+    }
+}
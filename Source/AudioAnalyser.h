@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.h
+    Created: 19 Oct 2026 5:20:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/*
+ Measures the spectrum, the peak and RMS levels and the loudness of a stereo
+ signal. The audio thread only copies its samples into a lock-free FIFO, the
+ FFT, the windowing and the K-weighting filters of the loudness run on an
+ AnalysisThread. The results are published as a snapshot that is double
+ buffered, so the GUI can read it at any time without waiting.
+*/
+class AudioAnalyser
+{
+public:
+    AudioAnalyser();
+    ~AudioAnalyser();
+
+    /** The size of the FFT */
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    /** The number of frequency bins in the spectrum */
+    static constexpr int numBins = fftSize / 2;
+
+    /** The results of the analysis, levels are in dB and loudness in LUFS */
+    struct Snapshot
+    {
+        std::array<float, numBins> spectrum {};
+        std::array<float, 2> peak {{-100.0f, -100.0f}};
+        std::array<float, 2> rms {{-100.0f, -100.0f}};
+        float momentary = -100.0f;
+        float shortTerm = -100.0f;
+        float integrated = -100.0f;
+        double sampleRate = 44100.0;
+    };
+
+    /** Turns the analysis on or off, nothing is copied or analysed while it is off */
+    void setEnabled(bool enabled);
+    /** Returns true if the analysis is on */
+    bool isEnabled() const;
+
+    /** Tells the analyser the sample rate of the signal */
+    void prepare(double sampleRate);
+    /** Starts measuring the integrated loudness again, e.g. for a new track */
+    void reset();
+
+    //==============================================================================
+    /** Copies the first two channels of a block into the FIFO. Called by the
+        audio thread, this is all the analysis costs it */
+    void push(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** Analyses everything in the FIFO and publishes a new snapshot. Called by
+        the analysis thread */
+    void process();
+    /** Copies the latest snapshot. Called by the GUI */
+    void getSnapshot(Snapshot& snapshot) const;
+
+private:
+    // the levels are measured over the last 30 blocks of 100 milliseconds
+    static constexpr int numBlocks = 30;
+
+    /** Sets up the filters and the block lengths for the sample rate */
+    void configure(double sampleRate);
+    /** Analyses part of the FIFO */
+    void analyse(int startSample, int numSamples);
+    /** Runs the FFT over the latest samples */
+    void updateSpectrum();
+    /** Writes the results into the snapshot that is not published and publishes it */
+    void publish(int numSamplesAnalysed);
+    /** Returns the mean of the last few 100 millisecond blocks */
+    double getRecentMean(const std::array<double, numBlocks>& blocks, int count) const;
+
+    // the state of the FIFO, written by the audio thread and read by the analysis thread
+    static constexpr int fifoSize = 16384;
+    juce::AbstractFifo fifo {fifoSize};
+    juce::AudioBuffer<float> fifoBuffer {2, fifoSize};
+    std::atomic<bool> enabled {false};
+
+    // requests for the analysis thread
+    std::atomic<double> pendingSampleRate {44100.0};
+    std::atomic<bool> pendingReset {false};
+
+    // everything below belongs to the analysis thread
+    double sampleRate = 0.0;
+
+    // the spectrum, on a mono mix of the signal
+    juce::dsp::FFT fft {fftOrder};
+    juce::dsp::WindowingFunction<float> window {(size_t) fftSize, juce::dsp::WindowingFunction<float>::hann};
+    std::array<float, fftSize> history {};
+    std::array<float, fftSize * 2> fftData {};
+    std::array<float, numBins> spectrum {};
+    int historyIndex = 0;
+    int samplesSinceFft = 0;
+
+    // the K-weighting filters of the loudness, two stages per channel
+    std::array<juce::dsp::IIR::Filter<float>, 2> shelfFilters;
+    std::array<juce::dsp::IIR::Filter<float>, 2> highPassFilters;
+
+    // the block being measured
+    int blockLength = 4410;
+    int blockPosition = 0;
+    double weightedSum = 0.0;
+    std::array<double, 2> squareSum {};
+    // the peaks since the last snapshot
+    std::array<float, 2> recentPeak {};
+    // the mean squares of the last blocks, weighted and per channel
+    std::array<double, numBlocks> weightedBlocks {};
+    std::array<std::array<double, numBlocks>, 2> channelBlocks {};
+    int blockIndex = 0;
+    int numBlocksSeen = 0;
+    // the loudness of every 400 millisecond gating block since the last reset
+    std::vector<double> gatingBlocks;
+    // the peaks, falling back slowly
+    std::array<float, 2> peakLevel {};
+
+    // the two snapshots, the published one is read by the GUI
+    std::array<Snapshot, 2> snapshots;
+    std::atomic<int> published {0};
+    std::atomic<juce::uint32> sequence {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioAnalyser)
+};
+
+//==============================================================================
+/*
+ A low priority thread that runs every analyser added to it
+*/
+class AnalysisThread : private juce::Thread
+{
+public:
+    AnalysisThread();
+    ~AnalysisThread() override;
+
+    /** Adds an analyser to the thread */
+    void addAnalyser(AudioAnalyser* analyser);
+    /** Removes an analyser from the thread */
+    void removeAnalyser(AudioAnalyser* analyser);
+
+private:
+    /** Runs the analysers every few milliseconds */
+    void run() override;
+
+    // the analysers, only locked by the message thread and this thread
+    juce::CriticalSection lock;
+    juce::Array<AudioAnalyser*> analysers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisThread)
+};
@@ -0,0 +1,317 @@
+/*
+  ==============================================================================
+
+    AudioFingerprint.cpp
+    Created: 20 Oct 2026 12:14:05am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "AudioFingerprint.h"
+
+#include <algorithm>
+
+namespace
+{
+    // the strongest peaks kept per frame, and the peaks each one is paired with
+    const int peaksPerFrame = 3;
+    const int fanOut = 3;
+    // how far the second peak of a landmark may be, in frames and bins
+    const int maxFrameDistance = 31;
+    const int maxBinDistance = 63;
+    // the bins peaks are looked for in, about 100 Hz to 4 kHz
+    const int minBin = 10;
+    const int maxBin = 380;
+    // how far above the average of its frame a peak has to be, in dB
+    const float peakThresholdDb = 10.0f;
+
+    // mixes the bits of a value, the end of MurmurHash3
+    juce::uint32 mix(juce::uint32 value)
+    {
+        value ^= value >> 16;
+        value *= 0x85ebca6bu;
+        value ^= value >> 13;
+        value *= 0xc2b2ae35u;
+        value ^= value >> 16;
+        return value;
+    }
+}
+
+//==============================================================================
+// check if the track had any landmarks
+bool AudioFingerprint::Fingerprint::isValid() const
+{
+    return numLandmarks > 0;
+}
+
+// the fingerprint as base 64 text
+juce::String AudioFingerprint::Fingerprint::toString() const
+{
+    juce::MemoryOutputStream stream;
+    stream.writeInt(numLandmarks);
+
+    for (auto value : signature)
+        stream.writeInt((int) value);
+
+    return stream.getMemoryBlock().toBase64Encoding();
+}
+
+// read a fingerprint from base 64 text
+AudioFingerprint::Fingerprint AudioFingerprint::Fingerprint::fromString(const juce::String& text)
+{
+    Fingerprint fingerprint;
+    juce::MemoryBlock data;
+
+    if (! data.fromBase64Encoding(text) || data.getSize() != sizeof(juce::uint32) * (numHashes + 1))
+        return fingerprint;
+
+    juce::MemoryInputStream stream {data, false};
+    fingerprint.numLandmarks = stream.readInt();
+
+    for (auto& value : fingerprint.signature)
+        value = (juce::uint32) stream.readInt();
+
+    return fingerprint;
+}
+
+//==============================================================================
+// fingerprint a track
+bool AudioFingerprint::analyse(juce::AudioFormatReader& reader,
+                               const std::function<bool()>& shouldStop,
+                               Fingerprint& result)
+{
+    const auto sampleRate = reader.sampleRate > 0.0 ? reader.sampleRate : 44100.0;
+    const auto numChannels = (int) juce::jlimit(1u, 2u, reader.numChannels);
+    const auto length = juce::jmin(reader.lengthInSamples, (juce::int64) (maxSeconds * sampleRate));
+
+    // the track is resampled to exactly the analysis rate, so the bins of a
+    // 44.1 and a 48 kHz copy are the same frequencies, and cut into frames
+    // of 1024 samples that overlap by half
+    const int fftOrder = 10;
+    const int fftSize = 1 << fftOrder;
+    const int hopSize = fftSize / 2;
+    const int chunkSize = 65536;
+    const auto ratio = sampleRate / analysisRate;
+
+    // two low passes in a row keep what folds back when the rate is brought
+    // down out of the peaks
+    juce::dsp::IIR::Filter<float> lowPass1, lowPass2;
+    lowPass1.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, (float) juce::jmin(4500.0, sampleRate * 0.45));
+    lowPass2.coefficients = lowPass1.coefficients;
+    juce::LagrangeInterpolator resampler;
+
+    // the track at the analysis rate, both sides as one, and the filtered
+    // samples the resampler has not used yet
+    std::vector<float> samples;
+    samples.reserve((size_t) ((double) length / ratio + 1.0));
+    std::vector<float> filtered;
+    filtered.reserve((size_t) chunkSize + 8);
+    juce::AudioBuffer<float> buffer {numChannels, chunkSize};
+
+    for (juce::int64 start = 0; start < length; start += chunkSize) {
+        if (shouldStop())
+            return false;
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+        reader.read(&buffer, 0, numSamples, start, true, true);
+
+        if (numChannels > 1) {
+            buffer.addFrom(0, 0, buffer, 1, 0, numSamples);
+            buffer.applyGain(0, 0, numSamples, 0.5f);
+        }
+
+        auto* mono = buffer.getReadPointer(0);
+
+        for (int i = 0; i < numSamples; ++i)
+            filtered.push_back(lowPass2.processSample(lowPass1.processSample(mono[i])));
+
+        // as many samples as the filtered ones make for sure, the few left
+        // over are used with the next chunk
+        auto numOut = (int) ((double) ((int) filtered.size() - 2) / ratio);
+
+        if (numOut > 0) {
+            auto numDone = samples.size();
+            samples.resize(numDone + (size_t) numOut);
+            auto used = resampler.process(ratio, filtered.data(), samples.data() + numDone, numOut);
+            filtered.erase(filtered.begin(), filtered.begin() + juce::jmin(used, (int) filtered.size()));
+        }
+    }
+
+    // the strongest peaks of every frame, in frame order
+    struct Peak
+    {
+        int frame;
+        int bin;
+        float level;
+    };
+
+    std::vector<Peak> peaks;
+    std::vector<Peak> candidates;
+
+    juce::dsp::FFT fft {fftOrder};
+    juce::dsp::WindowingFunction<float> window {(size_t) fftSize, juce::dsp::WindowingFunction<float>::hann};
+    std::vector<float> frame ((size_t) fftSize * 2);
+    std::vector<float> levels ((size_t) fftSize / 2);
+
+    auto numFrames = samples.size() < (size_t) fftSize ? 0 : (int) ((samples.size() - (size_t) fftSize) / (size_t) hopSize) + 1;
+
+    for (int f = 0; f < numFrames; ++f) {
+        if (f % 256 == 0 && shouldStop())
+            return false;
+
+        std::fill(frame.begin(), frame.end(), 0.0f);
+        std::copy_n(samples.begin() + (std::ptrdiff_t) f * hopSize, fftSize, frame.begin());
+        window.multiplyWithWindowingTable(frame.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(frame.data());
+
+        // the level of every bin in dB and their average, silence counts as quiet
+        float average = 0.0f;
+        for (int bin = minBin - 3; bin <= maxBin + 3; ++bin) {
+            levels[(size_t) bin] = juce::Decibels::gainToDecibels(frame[(size_t) bin], -100.0f);
+            average += levels[(size_t) bin];
+        }
+        average /= (float) (maxBin - minBin + 7);
+
+        // a peak is louder than the three bins either side of it
+        candidates.clear();
+
+        for (int bin = minBin; bin <= maxBin; ++bin) {
+            auto level = levels[(size_t) bin];
+            if (level < average + peakThresholdDb || level <= -60.0f)
+                continue;
+
+            auto isPeak = true;
+            for (int offset = 1; offset <= 3 && isPeak; ++offset)
+                isPeak = level > levels[(size_t) (bin - offset)] && level >= levels[(size_t) (bin + offset)];
+
+            if (isPeak)
+                candidates.push_back({f, bin, level});
+        }
+
+        auto numKept = juce::jmin(peaksPerFrame, (int) candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + numKept, candidates.end(), [] (const Peak& a, const Peak& b) {
+            return a.level > b.level;
+        });
+
+        peaks.insert(peaks.end(), candidates.begin(), candidates.begin() + numKept);
+    }
+
+    // every peak paired with the next few peaks near it
+    std::vector<juce::uint32> landmarks;
+    landmarks.reserve(peaks.size() * (size_t) fanOut);
+
+    for (size_t i = 0; i < peaks.size(); ++i) {
+        auto& anchor = peaks[i];
+        auto numPaired = 0;
+
+        for (auto j = i + 1; j < peaks.size() && numPaired < fanOut; ++j) {
+            auto& target = peaks[j];
+            auto frameDistance = target.frame - anchor.frame;
+            auto binDistance = target.bin - anchor.bin;
+
+            if (frameDistance > maxFrameDistance)
+                break;
+
+            if (frameDistance == 0 || std::abs(binDistance) > maxBinDistance)
+                continue;
+
+            // 9 bits of frequency, 7 of the distance in frequency and 5 in time
+            landmarks.push_back(((juce::uint32) anchor.bin << 12)
+                                | ((juce::uint32) (binDistance + 64) << 5)
+                                | (juce::uint32) frameDistance);
+            ++numPaired;
+        }
+    }
+
+    result = fromLandmarks(std::move(landmarks));
+    return true;
+}
+
+// the MinHash signature of a set of landmarks
+AudioFingerprint::Fingerprint AudioFingerprint::fromLandmarks(std::vector<juce::uint32> landmarks)
+{
+    Fingerprint fingerprint;
+
+    // a landmark heard many times counts once
+    std::sort(landmarks.begin(), landmarks.end());
+    landmarks.erase(std::unique(landmarks.begin(), landmarks.end()), landmarks.end());
+    fingerprint.numLandmarks = (int) landmarks.size();
+
+    fingerprint.signature.fill(0xffffffffu);
+
+    for (auto landmark : landmarks) {
+        // every hash function is the same mix with another seed
+        for (int k = 0; k < numHashes; ++k) {
+            auto value = mix(landmark ^ ((juce::uint32) (k + 1) * 0x9e3779b9u));
+            auto& smallest = fingerprint.signature[(size_t) k];
+            smallest = juce::jmin(smallest, value);
+        }
+    }
+
+    return fingerprint;
+}
+
+// the share of the landmarks two tracks have in common
+float AudioFingerprint::getSimilarity(const Fingerprint& a, const Fingerprint& b)
+{
+    if (! a.isValid() || ! b.isValid())
+        return 0.0f;
+
+    int numEqual = 0;
+    for (int k = 0; k < numHashes; ++k)
+        if (a.signature[(size_t) k] == b.signature[(size_t) k])
+            ++numEqual;
+
+    return (float) numEqual / (float) numHashes;
+}
+
+//==============================================================================
+FingerprintJob::FingerprintJob(juce::AudioFormatManager& _formatManager, const juce::URL& _url)
+: juce::ThreadPoolJob("Fingerprint"),
+  formatManager(_formatManager),
+  url(_url) {}
+
+FingerprintJob::~FingerprintJob() {}
+
+// fingerprint the track
+juce::ThreadPoolJob::JobStatus FingerprintJob::runJob()
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (reader == nullptr)
+        std::cout << "FingerprintJob::runJob  could not open " << url.toString(false) << std::endl;
+    else
+        successful = AudioFingerprint::analyse(*reader, [this] { return shouldExit(); }, fingerprint);
+
+    finished = true;
+
+    if (onFinished != nullptr)
+        onFinished();
+
+    return jobHasFinished;
+}
+
+// the track being fingerprinted
+const juce::URL& FingerprintJob::getURL() const
+{
+    return url;
+}
+
+// check if the job is done
+bool FingerprintJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the track could be fingerprinted
+bool FingerprintJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the fingerprint of the track
+const AudioFingerprint::Fingerprint& FingerprintJob::getFingerprint() const
+{
+    return fingerprint;
+}
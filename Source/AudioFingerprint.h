@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    AudioFingerprint.h
+    Created: 20 Oct 2026 12:14:05am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Works out a compact fingerprint of the sound of a track, which stays the
+ same when the track is encoded in another format or at another bit rate,
+ so the same song is found in different folders and formats.
+
+ The track is resampled to 11025 Hz and cut into overlapping frames.
+ The strongest spectral peaks of every frame are paired with the peaks that
+ follow them shortly after, and every pair becomes a landmark: the frequency
+ of the first peak, the distance to the second in frequency and in time.
+ Landmarks do not depend on where the track starts, and most of them survive
+ a lossy encoder.
+
+ Only a MinHash signature of the set of landmarks is kept: the smallest
+ value of numHashes hash functions over the landmarks. The share of equal
+ values of two signatures estimates how many landmarks the tracks have in
+ common, and a signature takes up a few hundred bytes however long the track.
+*/
+class AudioFingerprint
+{
+public:
+    /** The number of values in a signature */
+    static constexpr int numHashes = 64;
+    /** The most of a track that is fingerprinted, in seconds */
+    static constexpr double maxSeconds = 180.0;
+    /** The rate every track is brought to before it is analysed, so the
+        landmarks of a track are the same at any sample rate */
+    static constexpr double analysisRate = 11025.0;
+    /** Changes whenever the landmarks of a track change, a fingerprint of an
+        older version is worked out again */
+    static constexpr int version = 2;
+
+    /** The fingerprint of a track */
+    struct Fingerprint
+    {
+        /** The smallest value of every hash function over the landmarks */
+        std::array<juce::uint32, numHashes> signature {};
+        /** The number of different landmarks, 0 for a silent track */
+        int numLandmarks = 0;
+
+        /** Returns true if the track had any landmarks */
+        bool isValid() const;
+        /** Returns the fingerprint as text for the analysis file */
+        juce::String toString() const;
+        /** Reads a fingerprint from text, it is not valid if it cannot be read */
+        static Fingerprint fromString(const juce::String& text);
+    };
+
+    /** Fingerprints a track. shouldStop is asked between chunks and stops
+        the analysis if it returns true. Returns false if it was stopped */
+    static bool analyse(juce::AudioFormatReader& reader,
+                        const std::function<bool()>& shouldStop,
+                        Fingerprint& result);
+
+    /** Makes the fingerprint of a set of landmarks */
+    static Fingerprint fromLandmarks(std::vector<juce::uint32> landmarks);
+
+    /** Returns how much two tracks sound alike from 0 to 1, the share of the
+        landmarks they have in common */
+    static float getSimilarity(const Fingerprint& a, const Fingerprint& b);
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that fingerprints one track, to find it again in
+ other folders and formats
+*/
+class FingerprintJob : public juce::ThreadPoolJob
+{
+public:
+    FingerprintJob(juce::AudioFormatManager& formatManager, const juce::URL& url);
+    ~FingerprintJob() override;
+
+    /** Fingerprints the track */
+    JobStatus runJob() override;
+
+    /** Called on the pool thread when the job is done, set this before the
+        job is added to the pool */
+    std::function<void()> onFinished;
+
+    /** Returns the track being fingerprinted */
+    const juce::URL& getURL() const;
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the track could be fingerprinted */
+    bool wasSuccessful() const;
+    /** Returns the fingerprint, only use this once isFinished returns true */
+    const AudioFingerprint::Fingerprint& getFingerprint() const;
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to fingerprint
+    juce::URL url;
+
+    // the result and whether it is ready
+    AudioFingerprint::Fingerprint fingerprint;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FingerprintJob)
+};
@@ -0,0 +1,411 @@
+/*
+  ==============================================================================
+
+    AudioProfiler.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "AudioProfiler.h"
+
+namespace
+{
+    // counters shared by the allocation and lock hooks
+    std::atomic<juce::uint64> totalAllocations {0};
+    std::atomic<juce::uint64> audioThreadAllocations {0};
+    std::atomic<juce::uint64> audioThreadLocks {0};
+
+    // true while the current thread is running an audio callback
+    thread_local bool insideAudioCallback = false;
+
+    // raises an atomic to a new value if the new value is bigger
+    template <typename Type>
+    void storeMax (std::atomic<Type>& target, Type value) noexcept
+    {
+        auto previous = target.load (std::memory_order_relaxed);
+        while (previous < value
+               && ! target.compare_exchange_weak (previous, value, std::memory_order_relaxed)) {}
+    }
+
+    // returns the histogram bucket for a duration
+    int bucketForNanos (juce::uint64 nanos) noexcept
+    {
+        auto micros = (juce::uint32) juce::jmin (nanos / 1000, (juce::uint64) 0xffffffff);
+        // bucket 0 holds everything below one microsecond
+        if (micros == 0)
+            return 0;
+
+        return juce::jmin (AudioProfiler::numBuckets - 1, juce::findHighestSetBit (micros) + 1);
+    }
+
+    // returns the upper bound in microseconds of a histogram bucket
+    double bucketLimitMicros (int bucket) noexcept
+    {
+        return (double) (1u << bucket);
+    }
+}
+
+thread_local AudioProfiler::ScopedStage* AudioProfiler::ScopedStage::current = nullptr;
+
+//==============================================================================
+AudioProfiler::AudioProfiler()
+: nanosPerTick (1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond())
+{
+    // start with every counter cleared
+    for (auto& stage : stages)
+        resetStage(stage);
+
+    resetStage(callback);
+    callback.name = "Callback";
+}
+
+AudioProfiler::~AudioProfiler() {}
+
+//==============================================================================
+// register a named stage
+int AudioProfiler::addStage (const juce::String& name)
+{
+    auto index = numStages.load();
+
+    // there is a fixed number of stages so the audio thread never allocates
+    if (index >= maxStages) {
+        std::cout << "AudioProfiler::addStage  too many stages" << std::endl;
+        return -1;
+    }
+
+    stages[(size_t) index].name = name;
+    numStages.store(index + 1);
+    return index;
+}
+
+// add a measured duration to a stage
+void AudioProfiler::recordStage (int stageIndex, juce::uint64 nanos) noexcept
+{
+    // ignore stages that were never registered
+    if (! juce::isPositiveAndBelow(stageIndex, numStages.load(std::memory_order_relaxed)))
+        return;
+
+    auto& stage = stages[(size_t) stageIndex];
+    stage.count.fetch_add(1, std::memory_order_relaxed);
+    stage.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    stage.lastNanos.store(nanos, std::memory_order_relaxed);
+    storeMax(stage.maxNanos, nanos);
+    stage.buckets[(size_t) bucketForNanos(nanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// clear every counter
+void AudioProfiler::reset()
+{
+    for (auto& stage : stages)
+        resetStage(stage);
+
+    resetStage(callback);
+    overruns = 0;
+    worstLoad = 0.0;
+    lastLoad = 0.0;
+
+    // the hooks count for the whole process, so remember where we started
+    allocationsAtReset = audioThreadAllocations.load();
+    locksAtReset = audioThreadLocks.load();
+}
+
+// read the xrun count of the device
+void AudioProfiler::updateDeviceStats (juce::AudioIODevice* device)
+{
+    deviceXRuns = device != nullptr ? device->getXRunCount() : -1;
+}
+
+// set the rate the device runs at, used to find the deadline of a callback
+void AudioProfiler::setSampleRate (double newSampleRate) noexcept
+{
+    if (newSampleRate > 0)
+        sampleRate = newSampleRate;
+}
+
+//==============================================================================
+// return the numbers for every registered stage
+juce::Array<AudioProfiler::StageStats> AudioProfiler::getStageStats() const
+{
+    juce::Array<StageStats> result;
+
+    for (int i = 0; i < numStages.load(); ++i)
+        result.add(readStage(stages[(size_t) i]));
+
+    return result;
+}
+
+// return the numbers for the whole callback
+AudioProfiler::CallbackStats AudioProfiler::getCallbackStats() const
+{
+    CallbackStats result;
+    result.callback = readStage(callback);
+    result.overruns = overruns.load();
+    result.deviceXRuns = deviceXRuns.load();
+    result.worstLoad = worstLoad.load();
+    result.lastLoad = lastLoad.load();
+    result.audioThreadAllocations = audioThreadAllocations.load() - allocationsAtReset;
+    result.audioThreadLocks = audioThreadLocks.load() - locksAtReset;
+    return result;
+}
+
+// write the stages to a CSV file
+bool AudioProfiler::writeCsv (const juce::File& file) const
+{
+    juce::String csv {"stage,count,mean_us,p50_us,p99_us,max_us"};
+
+    // one column per histogram bucket
+    for (int i = 0; i < numBuckets; ++i)
+        csv << ",lt_" << juce::String((juce::uint64) bucketLimitMicros(i)) << "us";
+
+    csv << "\n";
+
+    auto allStages = getStageStats();
+    allStages.insert(0, getCallbackStats().callback);
+
+    for (auto& stage : allStages) {
+        csv << stage.name.quoted() << ","
+            << juce::String(stage.count) << ","
+            << juce::String(stage.meanMicros, 3) << ","
+            << juce::String(stage.p50Micros, 3) << ","
+            << juce::String(stage.p99Micros, 3) << ","
+            << juce::String(stage.maxMicros, 3);
+
+        for (auto bucket : stage.buckets)
+            csv << "," << juce::String(bucket);
+
+        csv << "\n";
+    }
+
+    return file.replaceWithText(csv);
+}
+
+// write the stages and the callback totals to a JSON file
+bool AudioProfiler::writeJson (const juce::File& file) const
+{
+    return file.replaceWithText(juce::JSON::toString(toVar()));
+}
+
+// build the JSON document
+juce::var AudioProfiler::toVar() const
+{
+    // turns the numbers of one stage into an object
+    auto stageToVar = [] (const StageStats& stage)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("name", stage.name);
+        object->setProperty("count", (juce::int64) stage.count);
+        object->setProperty("meanMicros", stage.meanMicros);
+        object->setProperty("p50Micros", stage.p50Micros);
+        object->setProperty("p99Micros", stage.p99Micros);
+        object->setProperty("maxMicros", stage.maxMicros);
+
+        juce::Array<juce::var> buckets;
+        for (auto bucket : stage.buckets)
+            buckets.add((int) bucket);
+
+        object->setProperty("histogram", buckets);
+        return juce::var(object);
+    };
+
+    auto totals = getCallbackStats();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("sampleRate", sampleRate.load());
+    root->setProperty("callback", stageToVar(totals.callback));
+    root->setProperty("overruns", (juce::int64) totals.overruns);
+    root->setProperty("deviceXRuns", totals.deviceXRuns);
+    root->setProperty("worstLoad", totals.worstLoad);
+    root->setProperty("audioThreadAllocations", (juce::int64) totals.audioThreadAllocations);
+    root->setProperty("audioThreadLocks", (juce::int64) totals.audioThreadLocks);
+
+    juce::Array<juce::var> stageList;
+    for (auto& stage : getStageStats())
+        stageList.add(stageToVar(stage));
+
+    root->setProperty("stages", stageList);
+    return juce::var(root);
+}
+
+//==============================================================================
+// copy the numbers of a stage
+AudioProfiler::StageStats AudioProfiler::readStage (const Stage& stage)
+{
+    StageStats result;
+    result.name = stage.name;
+    result.count = stage.count.load();
+
+    // every duration is stored in nanoseconds
+    if (result.count > 0)
+        result.meanMicros = (double) stage.totalNanos.load() / (double) result.count / 1000.0;
+
+    result.maxMicros = (double) stage.maxNanos.load() / 1000.0;
+    result.lastMicros = (double) stage.lastNanos.load() / 1000.0;
+
+    juce::uint64 total = 0;
+    for (size_t i = 0; i < result.buckets.size(); ++i) {
+        result.buckets[i] = stage.buckets[i].load();
+        total += result.buckets[i];
+    }
+
+    // walk up the histogram to find the percentiles
+    juce::uint64 seen = 0;
+    for (int i = 0; i < numBuckets && total > 0; ++i) {
+        seen += result.buckets[(size_t) i];
+
+        if (result.p50Micros == 0.0 && seen * 2 >= total)
+            result.p50Micros = bucketLimitMicros(i);
+
+        if (seen * 100 >= total * 99) {
+            result.p99Micros = bucketLimitMicros(i);
+            break;
+        }
+    }
+
+    return result;
+}
+
+// clear the numbers of a stage
+void AudioProfiler::resetStage (Stage& stage)
+{
+    stage.count = 0;
+    stage.totalNanos = 0;
+    stage.maxNanos = 0;
+    stage.lastNanos = 0;
+
+    for (auto& bucket : stage.buckets)
+        bucket = 0;
+}
+
+// convert high resolution ticks to nanoseconds
+juce::uint64 AudioProfiler::ticksToNanos (juce::int64 ticks) const noexcept
+{
+    return ticks > 0 ? (juce::uint64) ((double) ticks * nanosPerTick) : 0;
+}
+
+//==============================================================================
+// start timing a stage
+AudioProfiler::ScopedStage::ScopedStage (AudioProfiler* p, int index) noexcept
+: profiler(p), stageIndex(index)
+{
+    // a missing profiler turns the timer into a no-op
+    if (profiler == nullptr || stageIndex < 0)
+        return;
+
+    parent = current;
+    current = this;
+    startTicks = juce::Time::getHighResolutionTicks();
+}
+
+// stop timing a stage and record the time not spent in nested stages
+AudioProfiler::ScopedStage::~ScopedStage() noexcept
+{
+    if (profiler == nullptr || stageIndex < 0)
+        return;
+
+    auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+    profiler->recordStage(stageIndex, profiler->ticksToNanos(elapsed - childTicks));
+
+    // the parent stage should not count the time spent in here
+    if (parent != nullptr)
+        parent->childTicks += elapsed;
+
+    current = parent;
+}
+
+//==============================================================================
+// start timing a callback
+AudioProfiler::ScopedCallback::ScopedCallback (AudioProfiler& p, int samples) noexcept
+: profiler(p),
+  numSamples(samples),
+  startTicks(juce::Time::getHighResolutionTicks())
+{
+    insideAudioCallback = true;
+}
+
+// stop timing a callback and check it against its deadline
+AudioProfiler::ScopedCallback::~ScopedCallback() noexcept
+{
+    auto nanos = profiler.ticksToNanos(juce::Time::getHighResolutionTicks() - startTicks);
+    auto& stage = profiler.callback;
+
+    stage.count.fetch_add(1, std::memory_order_relaxed);
+    stage.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    stage.lastNanos.store(nanos, std::memory_order_relaxed);
+    storeMax(stage.maxNanos, nanos);
+    stage.buckets[(size_t) bucketForNanos(nanos)].fetch_add(1, std::memory_order_relaxed);
+
+    // the callback has to finish before the audio it produced runs out
+    auto deadlineNanos = (double) numSamples * 1.0e9 / profiler.sampleRate.load(std::memory_order_relaxed);
+
+    if (deadlineNanos > 0) {
+        auto load = (double) nanos / deadlineNanos;
+        profiler.lastLoad.store(load, std::memory_order_relaxed);
+        storeMax(profiler.worstLoad, load);
+
+        if (load > 1.0)
+            profiler.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    insideAudioCallback = false;
+}
+
+//==============================================================================
+// true while the calling thread runs an audio callback
+bool AudioProfiler::isAudioThread() noexcept
+{
+    return insideAudioCallback;
+}
+
+// count an allocation
+void AudioProfiler::noteAllocation() noexcept
+{
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (insideAudioCallback)
+        audioThreadAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+// count a lock
+void AudioProfiler::noteLock() noexcept
+{
+    if (insideAudioCallback)
+        audioThreadLocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+// the number of allocations the whole process made
+juce::uint64 AudioProfiler::getTotalAllocations() noexcept
+{
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+ProfiledAudioSource::ProfiledAudioSource (juce::AudioSource* s)
+: source(s) {}
+
+// set the stage the source is timed as
+void ProfiledAudioSource::setStage (AudioProfiler* p, int index)
+{
+    profiler = p;
+    stageIndex = index;
+}
+
+// tell the wrapped source to prepare for playing
+void ProfiledAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+// time the wrapped source while it fills the buffer
+void ProfiledAudioSource::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    AudioProfiler::ScopedStage stage {profiler, stageIndex};
+    source->getNextAudioBlock(bufferToFill);
+}
+
+// tell the wrapped source to release its data
+void ProfiledAudioSource::releaseResources()
+{
+    source->releaseResources();
+}
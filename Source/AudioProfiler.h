@@ -0,0 +1,224 @@
+/*
+  ==============================================================================
+
+    AudioProfiler.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+// Allocation and lock tracking on the audio thread is only compiled into
+// debug builds unless a target asks for it explicitly
+#ifndef OTODESK_TRACK_ALLOCATIONS
+ #define OTODESK_TRACK_ALLOCATIONS JUCE_DEBUG
+#endif
+
+#ifndef OTODESK_TRACK_LOCKS
+ #define OTODESK_TRACK_LOCKS (JUCE_DEBUG && (JUCE_MAC || JUCE_LINUX))
+#endif
+
+//==============================================================================
+/*
+ Records how long each stage of the audio callback takes. Every stage keeps a
+ lock-free histogram of its wall time, so the audio thread only ever does a
+ few relaxed atomic adds. The message thread reads the numbers back for the
+ on-screen overlay or to dump them as CSV / JSON.
+*/
+class AudioProfiler
+{
+public:
+    AudioProfiler();
+    ~AudioProfiler();
+
+    /** The maximum number of stages that can be registered */
+    static constexpr int maxStages = 32;
+    /** Number of histogram buckets, bucket n holds times below 2^n microseconds */
+    static constexpr int numBuckets = 24;
+
+    /** Registers a named stage and returns its index, call before audio starts */
+    int addStage (const juce::String& name);
+
+    /** Adds a measured duration in nanoseconds to a stage */
+    void recordStage (int stageIndex, juce::uint64 nanos) noexcept;
+
+    /** Clears all the recorded numbers, stages stay registered */
+    void reset();
+
+    /** Reads the xrun counter of the device, called from the message thread */
+    void updateDeviceStats (juce::AudioIODevice* device);
+
+    //==============================================================================
+    /** A copy of the numbers recorded for a single stage */
+    struct StageStats
+    {
+        juce::String name;
+        juce::uint64 count = 0;
+        double meanMicros = 0.0;
+        double p50Micros = 0.0;
+        double p99Micros = 0.0;
+        double maxMicros = 0.0;
+        double lastMicros = 0.0;
+        std::array<juce::uint32, numBuckets> buckets {};
+    };
+
+    /** A copy of the numbers recorded for the whole callback */
+    struct CallbackStats
+    {
+        StageStats callback;
+        // number of callbacks that took longer than the buffer they filled
+        juce::uint64 overruns = 0;
+        // xruns reported by the audio device itself
+        int deviceXRuns = -1;
+        // the longest callback seen compared to its deadline
+        double worstLoad = 0.0;
+        // the load of the last callback
+        double lastLoad = 0.0;
+        // allocations and locks seen on the audio thread (debug builds only)
+        juce::uint64 audioThreadAllocations = 0;
+        juce::uint64 audioThreadLocks = 0;
+    };
+
+    /** Returns the numbers for every registered stage */
+    juce::Array<StageStats> getStageStats() const;
+    /** Returns the numbers for the whole callback */
+    CallbackStats getCallbackStats() const;
+
+    /** Writes every stage as one row of a CSV file */
+    bool writeCsv (const juce::File& file) const;
+    /** Writes every stage and the callback totals as a JSON document */
+    bool writeJson (const juce::File& file) const;
+    /** Returns the JSON document written by writeJson */
+    juce::var toVar() const;
+
+    //==============================================================================
+    /*
+     Times one stage for as long as it is in scope. Stages nest, so each one
+     records only the time that was not spent inside a nested stage.
+    */
+    class ScopedStage
+    {
+    public:
+        ScopedStage (AudioProfiler* profiler, int stageIndex) noexcept;
+        ~ScopedStage() noexcept;
+
+    private:
+        AudioProfiler* profiler;
+        int stageIndex;
+        juce::int64 startTicks = 0;
+        juce::int64 childTicks = 0;
+        ScopedStage* parent = nullptr;
+
+        // the innermost stage running on this thread
+        static thread_local ScopedStage* current;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    /*
+     Wraps a whole audio callback. It marks the thread as the audio thread,
+     records the total time and counts an overrun when the callback took
+     longer than the audio it produced.
+    */
+    class ScopedCallback
+    {
+    public:
+        ScopedCallback (AudioProfiler& profiler, int numSamples) noexcept;
+        ~ScopedCallback() noexcept;
+
+    private:
+        AudioProfiler& profiler;
+        int numSamples;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCallback)
+    };
+
+    /** Tells the profiler the rate the device runs at */
+    void setSampleRate (double newSampleRate) noexcept;
+
+    /** Returns true if the calling thread is inside an audio callback */
+    static bool isAudioThread() noexcept;
+    /** Called by the allocation hook for every allocation */
+    static void noteAllocation() noexcept;
+    /** Called by the lock hook for every mutex locked */
+    static void noteLock() noexcept;
+    /** Returns the number of allocations made by the whole process so far */
+    static juce::uint64 getTotalAllocations() noexcept;
+
+private:
+    // the numbers kept for one stage
+    struct Stage
+    {
+        juce::String name;
+        std::atomic<juce::uint64> count {0};
+        std::atomic<juce::uint64> totalNanos {0};
+        std::atomic<juce::uint64> maxNanos {0};
+        std::atomic<juce::uint64> lastNanos {0};
+        std::array<std::atomic<juce::uint32>, numBuckets> buckets;
+    };
+
+    /** Copies the numbers of a stage */
+    static StageStats readStage (const Stage& stage);
+    /** Clears the numbers of a stage */
+    static void resetStage (Stage& stage);
+    /** Converts high resolution ticks to nanoseconds */
+    juce::uint64 ticksToNanos (juce::int64 ticks) const noexcept;
+
+    // the registered stages
+    std::array<Stage, maxStages> stages;
+    std::atomic<int> numStages {0};
+
+    // the whole callback is kept like any other stage
+    Stage callback;
+    std::atomic<juce::uint64> overruns {0};
+    std::atomic<double> worstLoad {0.0};
+    std::atomic<double> lastLoad {0.0};
+    std::atomic<int> deviceXRuns {-1};
+    std::atomic<double> sampleRate {44100.0};
+
+    // the number of allocations and locks seen when the profiler was reset
+    juce::uint64 allocationsAtReset = 0;
+    juce::uint64 locksAtReset = 0;
+
+    // factor used to turn high resolution ticks into nanoseconds
+    const double nanosPerTick;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProfiler)
+};
+
+//==============================================================================
+/*
+ An audio source that times another source as one stage of the profiler
+*/
+class ProfiledAudioSource : public juce::AudioSource
+{
+public:
+    ProfiledAudioSource (juce::AudioSource* source);
+
+    /** Sets the profiler and the stage that the source is timed as */
+    void setStage (AudioProfiler* profiler, int stageIndex);
+
+    /** Tells the source to prepare for playing */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    /** Called repeatedly to fetch subsequent blocks of audio data */
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+    /** Allows the source to release anything it no longer needs after playback has stopped */
+    void releaseResources() override;
+
+private:
+    // the source being timed
+    juce::AudioSource* source;
+    // the profiler and the stage the time is recorded to
+    AudioProfiler* profiler = nullptr;
+    int stageIndex = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfiledAudioSource)
+};
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    AudioThreadHooks.cpp
+    Created: 19 Oct 2026 12:31:09pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "AudioProfiler.h"
+
+#include <cstdlib>
+#include <new>
+
+#if OTODESK_TRACK_LOCKS
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+//==============================================================================
+// The hooks below replace the global allocator and the pthread mutex so
+// anything the audio thread does behind our back shows up in the profiler.
+// They live in their own file so that every executable can decide for itself
+// whether it wants them, the benchmarks always count allocations.
+#if OTODESK_TRACK_ALLOCATIONS
+
+void* operator new (std::size_t size)
+{
+    AudioProfiler::noteAllocation();
+
+    if (auto* memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+    AudioProfiler::noteAllocation();
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new (size, tag);
+}
+
+void operator delete (void* memory) noexcept                               { std::free(memory); }
+void operator delete[] (void* memory) noexcept                             { std::free(memory); }
+void operator delete (void* memory, std::size_t) noexcept                  { std::free(memory); }
+void operator delete[] (void* memory, std::size_t) noexcept                { std::free(memory); }
+void operator delete (void* memory, const std::nothrow_t&) noexcept        { std::free(memory); }
+void operator delete[] (void* memory, const std::nothrow_t&) noexcept      { std::free(memory); }
+
+#endif
+
+#if OTODESK_TRACK_LOCKS
+
+namespace
+{
+    using LockFunction = int (*) (pthread_mutex_t*);
+    // the real function from the C library, this is a plain atomic rather than
+    // a function static because static guards can lock a mutex themselves
+    std::atomic<LockFunction> realLock {nullptr};
+}
+
+extern "C" int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    auto lock = realLock.load(std::memory_order_acquire);
+
+    // look the real function up the first time through
+    if (lock == nullptr) {
+        lock = (LockFunction) dlsym(RTLD_NEXT, "pthread_mutex_lock");
+        realLock.store(lock, std::memory_order_release);
+    }
+
+    AudioProfiler::noteLock();
+    return lock(mutex);
+}
+
+#endif
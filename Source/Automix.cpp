@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+    Automix.cpp
+    Created: 19 Oct 2026 8:52:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "Automix.h"
+
+#include <algorithm>
+
+Automix::Automix(DeckMixer& _mixer,
+                 DJAudioPlayer& deckA,
+                 DJAudioPlayer& deckB,
+                 juce::AudioFormatManager& _formatManager)
+: mixer(_mixer),
+  decks {{&deckA, &deckB}},
+  formatManager(_formatManager) {}
+
+Automix::~Automix()
+{
+    stopTimer();
+    cancelJobs();
+}
+
+//==============================================================================
+// start playing a queue of tracks
+void Automix::start(const juce::Array<juce::URL>& newQueue, bool _offline)
+{
+    stop();
+
+    if (newQueue.isEmpty()) {
+        std::cout << "Automix::start  the queue is empty" << std::endl;
+        return;
+    }
+
+    queue = newQueue;
+    offline = _offline;
+    running = true;
+    currentIndex = 0;
+    nextIndex = -1;
+    currentDeck = 0;
+    transitionScheduled = false;
+    incomingStarted = false;
+    queueEnded = false;
+    numTransitions = 0;
+
+    // every track is analysed up front, in parallel
+    for (auto& url : queue) {
+        auto key = url.toString(false).toStdString();
+        auto queued = std::any_of(jobs.begin(), jobs.end(), [&] (auto& job) { return job->getURL() == url; });
+
+        if (tempos.count(key) > 0 || failed.count(key) > 0 || queued)
+            continue;
+
+        jobs.push_back(std::make_unique<TempoJob>(formatManager, url));
+        analysisPool->addJob(jobs.back().get());
+    }
+
+    // the first track starts straight away
+    decks[1]->stop();
+    decks[1]->clearPreload();
+
+    decks[0]->loadURL(queue[0]);
+    if (onTrackLoaded != nullptr)
+        onTrackLoaded(*decks[0], queue[0]);
+
+    decks[0]->setSpeed(1.0);
+    decks[0]->start();
+
+    if (! offline)
+        startTimer(50);
+}
+
+// stop walking the queue
+void Automix::stop()
+{
+    stopTimer();
+
+    if (! running)
+        return;
+
+    running = false;
+
+    // the track that is fading in carries on, a track still waiting for its
+    // transition is stopped
+    auto state = mixer.getScheduler().getState();
+
+    if (state == MixScheduler::pending || state == MixScheduler::armed) {
+        decks[(size_t) (1 - currentDeck)]->stop();
+    }
+    else if (state == MixScheduler::fading || state == MixScheduler::finished) {
+        decks[(size_t) currentDeck]->stop();
+        currentDeck = 1 - currentDeck;
+    }
+
+    mixer.getScheduler().cancel();
+}
+
+// check if the automix walks the queue
+bool Automix::isRunning() const
+{
+    return running;
+}
+
+// check if the last track has played to its end
+bool Automix::isFinished() const
+{
+    return running && queueEnded
+        && mixer.getScheduler().getState() == MixScheduler::idle
+        && ! decks[(size_t) currentDeck]->isPlaying();
+}
+
+//==============================================================================
+// move the automix on
+void Automix::update()
+{
+    collectAnalyses();
+
+    if (! running)
+        return;
+
+    auto& scheduler = mixer.getScheduler();
+    auto state = scheduler.getState();
+
+    // the audio thread holds the incoming deck back, so it can be started
+    if (state == MixScheduler::armed && ! incomingStarted) {
+        decks[(size_t) (1 - currentDeck)]->start();
+        incomingStarted = true;
+    }
+
+    // the crossfade is over, the next track takes over
+    if (state == MixScheduler::finished) {
+        decks[(size_t) currentDeck]->stop();
+        scheduler.acknowledge();
+
+        currentDeck = 1 - currentDeck;
+        currentIndex = nextIndex;
+        nextIndex = -1;
+        transitionScheduled = false;
+        incomingStarted = false;
+        ++numTransitions;
+        state = MixScheduler::idle;
+    }
+
+    if (state == MixScheduler::idle && ! transitionScheduled)
+        prepareNextTransition();
+}
+
+// the index of the track playing
+int Automix::getCurrentIndex() const
+{
+    return currentIndex;
+}
+
+// the number of transitions played
+int Automix::getNumTransitions() const
+{
+    return numTransitions;
+}
+
+// the tempo of a track, if it has been analysed
+bool Automix::getTrackTempo(const juce::URL& url, TempoAnalyser::Result& tempo) const
+{
+    auto found = tempos.find(url.toString(false).toStdString());
+
+    if (found == tempos.end())
+        return false;
+
+    tempo = found->second;
+    return true;
+}
+
+//==============================================================================
+// move the automix on from the message thread
+void Automix::timerCallback()
+{
+    update();
+}
+
+// store the tempos of the finished jobs
+void Automix::collectAnalyses()
+{
+    // the jobs still running, the list is rebuilt so collecting stays linear
+    std::vector<std::unique_ptr<TempoJob>> stillRunning;
+    stillRunning.reserve(jobs.size());
+
+    for (auto& job : jobs) {
+        if (! job->isFinished()) {
+            stillRunning.push_back(std::move(job));
+            continue;
+        }
+
+        // the job has finished running, so this does not wait
+        analysisPool->removeFinishedJob(job.get());
+
+        auto key = job->getURL().toString(false).toStdString();
+        if (job->wasSuccessful())
+            tempos[key] = job->getResult();
+        else
+            failed.insert(key);
+    }
+
+    jobs = std::move(stillRunning);
+}
+
+// preload the next track and plan its transition
+void Automix::prepareNextTransition()
+{
+    // the next track that can be opened
+    if (nextIndex < 0)
+        nextIndex = currentIndex + 1;
+
+    while (nextIndex < queue.size() && failed.count(queue[nextIndex].toString(false).toStdString()) > 0)
+        ++nextIndex;
+
+    if (nextIndex >= queue.size()) {
+        queueEnded = true;
+        return;
+    }
+
+    auto url = queue[nextIndex];
+    auto* incoming = decks[(size_t) (1 - currentDeck)];
+
+    // the idle deck opens the next track in the background
+    if (incoming->getPreloadedURL() != url)
+        incoming->preloadURL(url);
+
+    // a playing track that could not be analysed is mixed out on the next bar
+    TempoAnalyser::Result from, to;
+    auto isReady = [&]
+    {
+        collectAnalyses();
+        auto nextFailed = failed.count(url.toString(false).toStdString()) > 0;
+        auto currentFailed = failed.count(queue[currentIndex].toString(false).toStdString()) > 0;
+        return nextFailed || (incoming->isPreloadReady()
+                              && (currentFailed || getTrackTempo(queue[currentIndex], from))
+                              && getTrackTempo(url, to));
+    };
+
+    if (offline)
+        waitFor(isReady);
+
+    // the next track is skipped if it cannot be opened, and the transition
+    // is planned once everything is known
+    if (! isReady())
+        return;
+
+    if (failed.count(url.toString(false).toStdString()) > 0) {
+        incoming->clearPreload();
+        ++nextIndex;
+        return;
+    }
+
+    double toSpeed = 1.0;
+    auto transition = planTransition(from, to, toSpeed);
+
+    // the incoming deck is cued on its first beat at the matched tempo, the
+    // audio thread holds it there until the transition starts
+    incoming->loadPreloaded();
+    if (onTrackLoaded != nullptr)
+        onTrackLoaded(*incoming, url);
+
+    incoming->setSpeed(toSpeed);
+    incoming->setPosition(to.firstBeatSeconds);
+    // the loops and the synced effects of the deck follow the analysed tempo
+    incoming->setTrackBpm(to.bpm);
+    incoming->setFirstBeat(to.firstBeatSeconds);
+
+    if (mixer.getScheduler().schedule(transition)) {
+        transitionScheduled = true;
+        incomingStarted = false;
+    }
+}
+
+// work out the transition from the playing track to the next one
+MixScheduler::Transition Automix::planTransition(const TempoAnalyser::Result& from,
+                                                 const TempoAnalyser::Result& to,
+                                                 double& toSpeed) const
+{
+    auto* outgoing = decks[(size_t) currentDeck];
+    auto* incoming = decks[(size_t) (1 - currentDeck)];
+    auto fromSpeed = outgoing->getSpeed();
+
+    // the next track plays at the tempo of the playing one, if that is close enough
+    toSpeed = fromSpeed * from.bpm / to.bpm;
+    auto matched = std::abs(toSpeed - 1.0) <= maxTempoChange;
+    if (! matched)
+        toSpeed = 1.0;
+
+    // the next track comes in at the outro, or on the next bar if the
+    // playing track is already past it
+    auto trackRate = outgoing->getTrackSampleRate() > 0.0 ? outgoing->getTrackSampleRate() : 44100.0;
+    auto now = outgoing->getTrackPosition() / trackRate;
+    auto earliestBeat = std::ceil(from.getBeatAt(now + 1.0) / 4.0) * 4.0;
+    auto triggerBeat = juce::jmax(from.getBeatAt(from.outroStartSeconds), earliestBeat);
+
+    // the crossfade covers the shorter of the outro and the intro, in whole bars
+    auto outroBeats = from.getBeatAt(from.lengthSeconds) - triggerBeat;
+    auto introBeats = to.getBeatAt(to.introEndSeconds);
+    auto fadeBeats = juce::jlimit(minFadeBeats, maxFadeBeats, std::floor(juce::jmin(outroBeats, introBeats) / 4.0) * 4.0);
+
+    // beats that do not line up are only crossfaded over one bar
+    if (! matched)
+        fadeBeats = minFadeBeats;
+
+    MixScheduler::Transition transition;
+    transition.fromDeck = mixer.getDeckIndex(outgoing);
+    transition.toDeck = mixer.getDeckIndex(incoming);
+    transition.triggerPosition = (juce::int64) (from.getBeatTime(triggerBeat) * trackRate);
+    // the beats of the crossfade are counted at the tempo the playing track is heard at
+    transition.fadeSeconds = fadeBeats * 60.0 / (from.bpm * fromSpeed);
+    return transition;
+}
+
+// wait until a condition is true
+void Automix::waitFor(const std::function<bool()>& condition)
+{
+    auto timeout = juce::Time::getMillisecondCounter() + 10000;
+
+    while (! condition() && juce::Time::getMillisecondCounter() < timeout)
+        juce::Thread::sleep(1);
+}
+
+// stop the analysis jobs that are still running
+void Automix::cancelJobs()
+{
+    // the pool deletes the jobs once they have stopped
+    for (auto& job : jobs)
+        analysisPool->cancelJob(std::move(job));
+
+    jobs.clear();
+}
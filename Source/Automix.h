@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    Automix.h
+    Created: 19 Oct 2026 8:52:44pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "DeckMixer.h"
+#include "AnalysisPool.h"
+#include "TempoAnalyser.h"
+
+#include <array>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+//==============================================================================
+/*
+ Plays a queue of tracks on two decks, one after the other, with a beatmatched
+ crossfade between every two tracks.
+
+ Every track of the queue is analysed on the analysis pool as soon as the
+ automix starts. While a track plays, the next one is preloaded on the idle
+ deck, and once both tempos are known the transition is planned: the next
+ track comes in on its first beat when the playing track reaches its outro,
+ at the tempo of the playing track, and the crossfade lasts as long as the
+ shorter of the outro and the intro. The plan is handed to the MixScheduler
+ of the mixer, which runs it on the audio thread at an exact sample, so no
+ analysis or planning ever happens there.
+
+ In the app a timer moves the automix on. Offline the renderer calls update
+ after every block instead, and the automix waits for the analysis and the
+ preload rather than coming back later, so a long mix renders as fast as the
+ decks can be decoded.
+*/
+class Automix : private juce::Timer
+{
+public:
+    Automix(DeckMixer& mixer,
+            DJAudioPlayer& deckA,
+            DJAudioPlayer& deckB,
+            juce::AudioFormatManager& formatManager);
+    ~Automix() override;
+
+    /** The most the incoming track is sped up or slowed down to match the
+        tempo, tracks further apart are only crossfaded over one bar */
+    static constexpr double maxTempoChange = 0.08;
+    /** The shortest and longest crossfade in beats */
+    static constexpr double minFadeBeats = 4.0;
+    static constexpr double maxFadeBeats = 32.0;
+
+    /** Starts playing a queue of tracks, the first one straight away on the
+        first deck. Offline the automix is moved on by calling update */
+    void start(const juce::Array<juce::URL>& queue, bool offline = false);
+    /** Stops walking the queue, the track that is playing carries on */
+    void stop();
+    /** Returns true while the automix walks the queue */
+    bool isRunning() const;
+    /** Returns true once the last track of the queue has played to its end */
+    bool isFinished() const;
+
+    /** Collects the analysis, preloads the next track and plans the next
+        transition. Called by the timer in the app and after every block offline */
+    void update();
+
+    /** Returns the index in the queue of the track playing */
+    int getCurrentIndex() const;
+    /** Returns the number of transitions played */
+    int getNumTransitions() const;
+    /** Returns true and fills in the tempo if the track has been analysed */
+    bool getTrackTempo(const juce::URL& url, TempoAnalyser::Result& tempo) const;
+
+    /** Called after the automix loaded a track into a deck */
+    std::function<void(DJAudioPlayer& deck, const juce::URL& url)> onTrackLoaded;
+
+private:
+    /** Moves the automix on */
+    void timerCallback() override;
+    /** Stores the tempos of the tracks analysed since the last call */
+    void collectAnalyses();
+    /** Preloads the next track and plans its transition once it is ready */
+    void prepareNextTransition();
+    /** Works out the transition from the playing track to the next one and
+        the speed of the next one */
+    MixScheduler::Transition planTransition(const TempoAnalyser::Result& from,
+                                            const TempoAnalyser::Result& to,
+                                            double& toSpeed) const;
+    /** Offline, waits until a condition is true or ten seconds have passed */
+    void waitFor(const std::function<bool()>& condition);
+    /** Stops the analysis jobs that are still running */
+    void cancelJobs();
+
+    // the mixer whose scheduler runs the transitions, and the two decks
+    DeckMixer& mixer;
+    std::array<DJAudioPlayer*, 2> decks;
+    // used to open the tracks for the analysis
+    juce::AudioFormatManager& formatManager;
+
+    // the background threads the tracks are analysed on
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+    std::vector<std::unique_ptr<TempoJob>> jobs;
+    // the tempos of the analysed tracks and the tracks that could not be opened
+    std::map<std::string, TempoAnalyser::Result> tempos;
+    std::set<std::string> failed;
+
+    // the tracks to play and where the automix is in them
+    juce::Array<juce::URL> queue;
+    int currentIndex = -1;
+    int nextIndex = -1;
+    // the deck playing the current track, the other one gets the next track
+    int currentDeck = 0;
+
+    // true while walking the queue, and if the renderer moves it on
+    bool running = false;
+    bool offline = false;
+    // true once the next track is loaded and its transition handed over
+    bool transitionScheduled = false;
+    // true once the incoming deck has been started for the audio thread
+    bool incomingStarted = false;
+    // true once there is no next track to prepare
+    bool queueEnded = false;
+    int numTransitions = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Automix)
+};
@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    BandWaveform.cpp
+    Created: 19 Oct 2026 6:31:52pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "BandWaveform.h"
+#include "AnalysisPool.h"
+
+namespace
+{
+    // bumped whenever the layout of the cache files changes
+    const int cacheFormatVersion = 1;
+
+    // a level from 0 to 1 as a byte
+    inline juce::uint8 toByte(float level)
+    {
+        return (juce::uint8) juce::roundToInt(juce::jlimit(0.0f, 1.0f, level) * 255.0f);
+    }
+
+    // the sum of a block of samples
+    inline float sum(const float* samples, int numSamples)
+    {
+        float total = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            total += samples[i];
+        return total;
+    }
+}
+
+BandWaveform::BandWaveform() {}
+
+BandWaveform::~BandWaveform() {}
+
+//==============================================================================
+// analyse a whole track
+bool BandWaveform::generate(juce::AudioFormatReader& reader,
+                            const std::function<bool()>& shouldStop,
+                            const std::function<void()>& onProgress)
+{
+    numReadyBuckets = 0;
+
+    sampleRate = reader.sampleRate > 0.0 ? reader.sampleRate : 44100.0;
+    const auto length = reader.lengthInSamples;
+
+    // long tracks get wider buckets rather than more of them
+    samplesPerBucket = juce::jmax(juce::roundToInt(sampleRate / bucketsPerSecond),
+                                  (int) ((length + maxBuckets - 1) / maxBuckets),
+                                  1);
+
+    buckets.assign((size_t) ((length + samplesPerBucket - 1) / samplesPerBucket), Bucket{});
+
+    // the track is read in chunks of whole buckets, the same size however
+    // long the track is
+    const int bucketsPerChunk = juce::jmax(1, samplesPerChunk / samplesPerBucket);
+    const int chunkSize = bucketsPerChunk * samplesPerBucket;
+
+    juce::AudioBuffer<float> input {2, chunkSize};
+    // the mono mix and the three bands
+    juce::AudioBuffer<float> bands {4, chunkSize};
+
+    // the first crossover splits off the low band, the second splits the rest
+    // into mid and high
+    juce::dsp::ProcessSpec spec {sampleRate, (juce::uint32) chunkSize, 1};
+    juce::dsp::LinkwitzRileyFilter<float> lowSplit, highSplit;
+    lowSplit.prepare(spec);
+    lowSplit.setCutoffFrequency((float) lowMidCrossover);
+    highSplit.prepare(spec);
+    highSplit.setCutoffFrequency((float) midHighCrossover);
+
+    size_t bucketIndex = 0;
+
+    for (juce::int64 start = 0; start < length; start += chunkSize) {
+        if (shouldStop())
+            return false;
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+        reader.read(&input, 0, numSamples, start, true, true);
+
+        auto* left = input.getReadPointer(0);
+        auto* right = input.getReadPointer(1);
+        auto* mono = bands.getWritePointer(0);
+        auto* low = bands.getWritePointer(1);
+        auto* mid = bands.getWritePointer(2);
+        auto* high = bands.getWritePointer(3);
+
+        juce::FloatVectorOperations::copyWithMultiply(mono, left, 0.5f, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(mono, right, 0.5f, numSamples);
+
+        for (int i = 0; i < numSamples; ++i) {
+            float rest;
+            lowSplit.processSample(0, mono[i], low[i], rest);
+            highSplit.processSample(0, rest, mid[i], high[i]);
+        }
+
+        // the bands are only needed as energies from here on
+        juce::FloatVectorOperations::multiply(low, low, numSamples);
+        juce::FloatVectorOperations::multiply(mid, mid, numSamples);
+        juce::FloatVectorOperations::multiply(high, high, numSamples);
+
+        for (int offset = 0; offset < numSamples && bucketIndex < buckets.size(); offset += samplesPerBucket) {
+            auto n = juce::jmin(samplesPerBucket, numSamples - offset);
+
+            auto leftRange = juce::FloatVectorOperations::findMinAndMax(left + offset, n);
+            auto rightRange = juce::FloatVectorOperations::findMinAndMax(right + offset, n);
+            auto peak = juce::jmax(-leftRange.getStart(), leftRange.getEnd(),
+                                   -rightRange.getStart(), rightRange.getEnd());
+
+            auto& bucket = buckets[bucketIndex++];
+            bucket.peak = toByte(peak);
+            bucket.low = toByte(std::sqrt(sum(low + offset, n) / n));
+            bucket.mid = toByte(std::sqrt(sum(mid + offset, n) / n));
+            bucket.high = toByte(std::sqrt(sum(high + offset, n) / n));
+        }
+
+        // the buckets of the chunk can be drawn from now on
+        numReadyBuckets.store((int) bucketIndex, std::memory_order_release);
+
+        if (onProgress != nullptr)
+            onProgress();
+    }
+
+    numReadyBuckets.store((int) buckets.size(), std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+// read the waveform of a track from the cache
+bool BandWaveform::loadFromCache(const juce::File& track)
+{
+    juce::FileInputStream stream {getCacheFile(track)};
+
+    if (stream.failedToOpen() || stream.readInt() != cacheFormatVersion)
+        return false;
+
+    auto cachedSampleRate = stream.readDouble();
+    auto cachedSamplesPerBucket = stream.readInt();
+    auto numBuckets = stream.readInt();
+
+    // a damaged file is treated as a missing one, and one from before long
+    // tracks were capped is made again
+    if (cachedSampleRate <= 0.0 || cachedSamplesPerBucket <= 0 || numBuckets < 0 || numBuckets > maxBuckets
+        || stream.getNumBytesRemaining() != (juce::int64) numBuckets * (juce::int64) sizeof(Bucket))
+        return false;
+
+    numReadyBuckets = 0;
+    buckets.resize((size_t) numBuckets);
+
+    if (stream.read(buckets.data(), numBuckets * (int) sizeof(Bucket)) != numBuckets * (int) sizeof(Bucket))
+        return false;
+
+    sampleRate = cachedSampleRate;
+    samplesPerBucket = cachedSamplesPerBucket;
+    numReadyBuckets.store(numBuckets, std::memory_order_release);
+    return true;
+}
+
+// write the waveform of a track to the cache
+bool BandWaveform::saveToCache(const juce::File& track) const
+{
+    // write to a temporary file first, so a crash never leaves half a file behind
+    juce::TemporaryFile temporary {getCacheFile(track)};
+
+    {
+        juce::FileOutputStream stream {temporary.getFile()};
+
+        if (stream.failedToOpen()) {
+            std::cout << "BandWaveform::saveToCache  could not write " << temporary.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        stream.writeInt(cacheFormatVersion);
+        stream.writeDouble(sampleRate);
+        stream.writeInt(samplesPerBucket);
+        stream.writeInt((int) buckets.size());
+        stream.write(buckets.data(), buckets.size() * sizeof(Bucket));
+    }
+
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+// the cache file of a track, named after its path, size and date
+juce::File BandWaveform::getCacheFile(const juce::File& track)
+{
+    auto key = track.getFullPathName()
+               + "|" + juce::String(track.getSize())
+               + "|" + juce::String(track.getLastModificationTime().toMilliseconds());
+
+    return AnalysisPool::getCacheDirectory().getChildFile(juce::String::toHexString(key.hashCode64()) + ".waveform");
+}
+
+//==============================================================================
+// the buckets, in order
+const std::vector<BandWaveform::Bucket>& BandWaveform::getBuckets() const
+{
+    return buckets;
+}
+
+// the number of buckets worked out so far
+int BandWaveform::getNumReadyBuckets() const
+{
+    return numReadyBuckets.load(std::memory_order_acquire);
+}
+
+// the number of samples of the track in each bucket
+int BandWaveform::getSamplesPerBucket() const
+{
+    return samplesPerBucket;
+}
+
+// the length of the track in seconds
+double BandWaveform::getLengthInSeconds() const
+{
+    return (double) buckets.size() * samplesPerBucket / sampleRate;
+}
+
+//==============================================================================
+WaveformAnalyser::WaveformAnalyser(juce::AudioFormatManager& _formatManager, const juce::URL& _url)
+: juce::ThreadPoolJob("Waveform analysis"),
+  formatManager(_formatManager),
+  url(_url) {}
+
+WaveformAnalyser::~WaveformAnalyser() {}
+
+// load the waveform from the cache or analyse it
+juce::ThreadPoolJob::JobStatus WaveformAnalyser::runJob()
+{
+    // only files on disk can be cached
+    auto track = url.isLocalFile() ? url.getLocalFile() : juce::File();
+    auto cacheable = track.existsAsFile();
+
+    if (! cacheable || ! waveform.loadFromCache(track)) {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+
+        if (reader == nullptr) {
+            std::cout << "WaveformAnalyser::runJob  could not open " << url.toString(false) << std::endl;
+            return jobHasFinished;
+        }
+
+        // the display knows how long the track is before any of it is read
+        lengthInSeconds = reader->sampleRate > 0.0 ? (double) reader->lengthInSamples / reader->sampleRate : 0.0;
+        sendChangeMessage();
+
+        // the display is told about new buckets a few times a second, not
+        // after every chunk
+        auto onProgress = [this] {
+            auto now = juce::Time::getMillisecondCounter();
+
+            if (now - lastProgressMillis >= 200) {
+                lastProgressMillis = now;
+                sendChangeMessage();
+            }
+        };
+
+        // stopped because the deck loaded another track
+        if (! waveform.generate(*reader, [this] { return shouldExit(); }, onProgress))
+            return jobHasFinished;
+
+        if (cacheable)
+            waveform.saveToCache(track);
+    }
+
+    lengthInSeconds = waveform.getLengthInSeconds();
+    finished = true;
+    sendChangeMessage();
+    return jobHasFinished;
+}
+
+// check if the waveform is ready
+bool WaveformAnalyser::isFinished() const
+{
+    return finished;
+}
+
+// the length of the track, once it is open
+double WaveformAnalyser::getLengthInSeconds() const
+{
+    return lengthInSeconds;
+}
+
+// the waveform, filling in until it is ready
+const BandWaveform& WaveformAnalyser::getWaveform() const
+{
+    return waveform;
+}
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    BandWaveform.h
+    Created: 19 Oct 2026 6:31:52pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ The waveform of a track split into low, mid and high bands, so the display
+ can show whether a section is kick heavy, vocal or hats. Every bucket of
+ audio keeps its peak and the RMS of the three bands, each in a byte.
+
+ The bands are split with two Linkwitz-Riley crossovers. The mono mix, the
+ squares and the peaks are worked out with FloatVectorOperations over whole
+ chunks, only the filters run sample by sample since they are recursive.
+ Results are cached on disk, keyed by the path, size and date of the track,
+ so a track is only analysed once.
+
+ Long recordings get wider buckets, so a waveform never holds more than
+ maxBuckets whatever the length of the track, and the audio is read in
+ chunks of a fixed size. The buckets are published as each chunk is done,
+ so the display can draw the start of a long mix while the rest is read.
+*/
+class BandWaveform
+{
+public:
+    BandWaveform();
+    ~BandWaveform();
+
+    /** The peak and the band levels of one bucket, from 0 to 255 */
+    struct Bucket
+    {
+        juce::uint8 peak = 0;
+        juce::uint8 low = 0;
+        juce::uint8 mid = 0;
+        juce::uint8 high = 0;
+    };
+
+    /** The number of buckets per second of audio, for tracks short enough */
+    static constexpr double bucketsPerSecond = 100.0;
+    /** The most buckets a waveform has, 1 MB of them, about 43 minutes at
+        the full rate */
+    static constexpr int maxBuckets = 1 << 18;
+    /** The samples read from the track at a time */
+    static constexpr int samplesPerChunk = 32768;
+    /** Tracks longer than this are only drawn from their band waveform,
+        which fills in as it is analysed */
+    static constexpr double longTrackSeconds = 20.0 * 60.0;
+    /** The crossover frequencies between the bands */
+    static constexpr double lowMidCrossover = 200.0;
+    static constexpr double midHighCrossover = 2500.0;
+
+    /** Analyses a whole track. shouldStop is asked between chunks and stops
+        the analysis if it returns true, onProgress is called after every
+        chunk. Returns false if it was stopped */
+    bool generate(juce::AudioFormatReader& reader,
+                  const std::function<bool()>& shouldStop,
+                  const std::function<void()>& onProgress = nullptr);
+
+    /** Reads the waveform of a track from the cache, returns false if it is not there */
+    bool loadFromCache(const juce::File& track);
+    /** Writes the waveform of a track to the cache */
+    bool saveToCache(const juce::File& track) const;
+    /** Returns the cache file for a track, which changes if the track does */
+    static juce::File getCacheFile(const juce::File& track);
+
+    /** Returns the buckets, in order. While the track is being analysed only
+        the first getNumReadyBuckets of them can be read */
+    const std::vector<Bucket>& getBuckets() const;
+    /** Returns the number of buckets that have been worked out, safe on any thread */
+    int getNumReadyBuckets() const;
+    /** Returns the number of samples of the track in each bucket */
+    int getSamplesPerBucket() const;
+    /** Returns the length of the track in seconds */
+    double getLengthInSeconds() const;
+
+private:
+    // the buckets, in order, and how many of them have been worked out
+    std::vector<Bucket> buckets;
+    std::atomic<int> numReadyBuckets {0};
+    // the sample rate of the track and the samples in each bucket
+    double sampleRate = 44100.0;
+    int samplesPerBucket = 441;
+
+    JUCE_LEAK_DETECTOR (BandWaveform)
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that loads the band waveform of a track from the
+ cache or analyses it. A change message is sent once the track is open, a few
+ times a second while the buckets come in, and when it is done.
+*/
+class WaveformAnalyser
+    : public juce::ThreadPoolJob,
+    public juce::ChangeBroadcaster
+{
+public:
+    WaveformAnalyser(juce::AudioFormatManager& formatManager, const juce::URL& url);
+    ~WaveformAnalyser() override;
+
+    /** Loads or analyses the waveform */
+    JobStatus runJob() override;
+
+    /** Returns true once the waveform is ready */
+    bool isFinished() const;
+    /** Returns the length of the track in seconds, 0 until it has been opened */
+    double getLengthInSeconds() const;
+    /** Returns the waveform, only its ready buckets until isFinished returns true */
+    const BandWaveform& getWaveform() const;
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to analyse
+    juce::URL url;
+
+    // the result, the length of the track and whether it is ready
+    BandWaveform waveform;
+    std::atomic<double> lengthInSeconds {0.0};
+    std::atomic<bool> finished {false};
+    // when the display was last told about new buckets
+    juce::uint32 lastProgressMillis = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformAnalyser)
+};
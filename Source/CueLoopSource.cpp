@@ -0,0 +1,384 @@
+/*
+  ==============================================================================
+
+    CueLoopSource.cpp
+    Created: 19 Oct 2026 2:36:50pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "CueLoopSource.h"
+
+CueLoopSource::CueLoopSource()
+{
+    // no hot cue is set to begin with
+    for (auto& cue : hotCues)
+        cue = -1;
+
+    // nothing to fade until the first jump
+    fadeIndex = fadeLength;
+}
+
+CueLoopSource::~CueLoopSource() {}
+
+//==============================================================================
+// set the source the audio is read from
+void CueLoopSource::setInput(juce::PositionableAudioSource* newInput, double newSampleRate)
+{
+    auto rate = newSampleRate > 0 ? newSampleRate : 44100.0;
+    input = newInput;
+    sampleRate = rate;
+
+    // fade over 5 milliseconds
+    fadeLength = juce::jmax(16, juce::roundToInt(rate * 0.005));
+    fadeBuffer.setSize(2, fadeLength);
+    fadeIndex = fadeLength;
+
+    // the window is allocated here so a loop never allocates on the audio thread
+    window.setSize(2, (int) (maxLoopSeconds * rate) + fadeLength, false, false, true);
+    windowStart = 0;
+    windowEnd = 0;
+    capturing = false;
+
+    // a new track starts at the beginning without any cues or loops
+    position = 0;
+    loopActive = false;
+    rolling = false;
+    pendingJump = -1;
+    pendingLoopLength = 0;
+    pendingExit = false;
+
+    for (auto& cue : hotCues)
+        cue = -1;
+}
+
+// the sample rate of the input
+double CueLoopSource::getSampleRate() const
+{
+    return sampleRate.load();
+}
+
+// set the cache used to play jumps without waiting for the input to seek
+void CueLoopSource::setPreRollCache(PreRollCache* cache)
+{
+    preRollCache = cache;
+}
+
+//==============================================================================
+// jump to a position at the start of the next block
+void CueLoopSource::jumpTo(juce::int64 newPosition, bool crossfade)
+{
+    // the fade flag has to be visible before the position is
+    pendingJumpFade = crossfade;
+    pendingJump = juce::jmax((juce::int64) 0, newPosition);
+}
+
+// store the playhead as a hot cue
+void CueLoopSource::setHotCue(int index)
+{
+    if (juce::isPositiveAndBelow(index, numHotCues))
+        hotCues[(size_t) index] = getNextReadPosition();
+}
+
+// remove a hot cue
+void CueLoopSource::clearHotCue(int index)
+{
+    if (juce::isPositiveAndBelow(index, numHotCues))
+        hotCues[(size_t) index] = -1;
+}
+
+// the position of a hot cue
+juce::int64 CueLoopSource::getHotCue(int index) const
+{
+    return juce::isPositiveAndBelow(index, numHotCues) ? hotCues[(size_t) index].load() : -1;
+}
+
+// jump to a hot cue
+void CueLoopSource::triggerHotCue(int index)
+{
+    auto cue = getHotCue(index);
+
+    if (cue >= 0)
+        jumpTo(cue);
+}
+
+// start a loop at the playhead
+void CueLoopSource::startLoop(juce::int64 lengthInSamples, bool roll)
+{
+    // the roll flag has to be visible before the length is
+    pendingRoll = roll;
+    pendingLoopLength = lengthInSamples;
+}
+
+// end the current loop
+void CueLoopSource::exitLoop()
+{
+    pendingExit = true;
+}
+
+// true while a loop is playing
+bool CueLoopSource::isLoopActive() const
+{
+    return loopActive;
+}
+
+//==============================================================================
+// tells the source to prepare for playing
+void CueLoopSource::prepareToPlay (int samplesPerBlockExpected, double rate)
+{
+    if (input != nullptr)
+        input->prepareToPlay(samplesPerBlockExpected, rate);
+}
+
+// allows source to release data that it does not need
+void CueLoopSource::releaseResources()
+{
+    if (input != nullptr)
+        input->releaseResources();
+}
+
+// called repeatedly to fetch subsequent blocks of audio data
+void CueLoopSource::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // nothing to play without a track
+    if (input == nullptr) {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    applyRequests();
+
+    auto& buffer = *bufferToFill.buffer;
+    auto pos = position.load();
+
+    for (int done = 0; done < bufferToFill.numSamples;) {
+        auto numSamples = bufferToFill.numSamples - done;
+
+        // stop exactly at the end of the loop
+        if (loopActive && pos < loopEnd)
+            numSamples = (int) juce::jmin((juce::int64) numSamples, loopEnd - pos);
+
+        renderSegment(buffer, bufferToFill.startSample + done, numSamples, pos);
+        mixFade(buffer, bufferToFill.startSample + done, numSamples);
+
+        pos += numSamples;
+        done += numSamples;
+
+        // the track keeps moving underneath a roll
+        if (rolling)
+            rollPosition += numSamples;
+
+        // go back to the start of the loop, the audio after the end of the
+        // loop is faded out and kept in the window for the next time round
+        if (loopActive && pos >= loopEnd) {
+            beginFade(pos);
+            capturing = false;
+            pos = loopStart;
+        }
+    }
+
+    position = pos;
+}
+
+// move to a new position at the next block
+void CueLoopSource::setNextReadPosition (juce::int64 newPosition)
+{
+    jumpTo(newPosition);
+}
+
+// the position of the next block, including a jump that has not happened yet
+juce::int64 CueLoopSource::getNextReadPosition() const
+{
+    auto jump = pendingJump.load();
+    return jump >= 0 ? jump : position.load();
+}
+
+// the length of the input
+juce::int64 CueLoopSource::getTotalLength() const
+{
+    return input != nullptr ? input->getTotalLength() : 0;
+}
+
+// the whole stream never loops, only the loops set on the deck do
+bool CueLoopSource::isLooping() const
+{
+    return false;
+}
+
+void CueLoopSource::setLooping (bool) {}
+
+//==============================================================================
+// apply the jumps and loops posted by the message thread
+void CueLoopSource::applyRequests()
+{
+    // end the loop first, so a new loop can replace the old one in one block
+    if (pendingExit.exchange(false) && loopActive) {
+        // a roll carries on where the track would have been
+        if (rolling) {
+            beginFade(position);
+            position = rollPosition;
+        }
+
+        loopActive = false;
+        rolling = false;
+        capturing = false;
+    }
+
+    auto length = juce::jmin(pendingLoopLength.exchange(0),
+                             (juce::int64) (window.getNumSamples() - fadeLength));
+
+    if (length > 0) {
+        auto roll = pendingRoll.load();
+
+        // a roll started during another roll keeps the original track position
+        if (! (loopActive && rolling && roll))
+            rollPosition = position;
+
+        loopStart = position;
+        loopEnd = loopStart + length;
+        rolling = roll;
+        loopActive = true;
+
+        // keep the audio of the loop while it plays for the first time
+        windowStart = loopStart;
+        windowEnd = loopStart;
+        capturing = true;
+    }
+
+    auto jump = pendingJump.exchange(-1);
+
+    if (jump >= 0) {
+        if (pendingJumpFade)
+            beginFade(position);
+
+        position = jump;
+
+        // jumping out of a loop ends it
+        if (loopActive && (jump < loopStart || jump >= loopEnd)) {
+            loopActive = false;
+            rolling = false;
+            capturing = false;
+        }
+    }
+}
+
+// fill part of a buffer with the audio at a position
+void CueLoopSource::renderSegment(juce::AudioBuffer<float>& buffer,
+                                  int startSample,
+                                  int numSamples,
+                                  juce::int64 from)
+{
+    auto numChannels = juce::jmin(buffer.getNumChannels(), window.getNumChannels());
+
+    // serve the audio from memory if the window holds all of it
+    if (from >= windowStart && from + numSamples <= windowEnd) {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+            if (channel < numChannels)
+                buffer.copyFrom(channel, startSample, window, channel, (int) (from - windowStart), numSamples);
+            else
+                buffer.clear(channel, startSample, numSamples);
+        }
+
+        return;
+    }
+
+    // play the start of a jump from the cache, the rest from the input
+    auto cached = readPreRoll(buffer, startSample, numSamples, from);
+
+    if (cached < numSamples)
+        readInput(buffer, startSample + cached, numSamples - cached, from + cached);
+
+    // keep the audio if it carries on from what the window already holds
+    if (capturing
+        && from == windowEnd
+        && from + numSamples - windowStart <= window.getNumSamples()) {
+        for (int channel = 0; channel < window.getNumChannels(); ++channel) {
+            // a mono buffer fills both channels of the window
+            auto source = juce::jmin(channel, buffer.getNumChannels() - 1);
+            window.copyFrom(channel, (int) (from - windowStart), buffer, source, startSample, numSamples);
+        }
+
+        windowEnd += numSamples;
+    }
+}
+
+// copy the start of a segment from the pre-roll cache if the input would have to seek
+int CueLoopSource::readPreRoll(juce::AudioBuffer<float>& buffer,
+                               int startSample,
+                               int numSamples,
+                               juce::int64 from)
+{
+    if (preRollCache == nullptr)
+        return 0;
+
+    // the input must not be touched while the cache thread is seeking it
+    auto busy = preRollCache->isInputBusy();
+
+    // no need for the cache if the input is already at the position
+    if (! busy && input->getNextReadPosition() == from)
+        return 0;
+
+    juce::int64 cachedEnd = 0;
+    auto cached = preRollCache->read(buffer, startSample, numSamples, from, cachedEnd);
+
+    if (busy) {
+        // the cache ran out before the seek finished, which leaves a gap
+        if (cached < numSamples)
+            buffer.clear(startSample + cached, numSamples - cached);
+
+        return numSamples;
+    }
+
+    // seek the input to the end of the cached audio in the background, so it
+    // carries on from there without a seek in the audio callback
+    if (cached == numSamples && input->getNextReadPosition() != cachedEnd)
+        preRollCache->seekInputInBackground(input, cachedEnd);
+
+    return cached;
+}
+
+// read part of a buffer straight from the input
+void CueLoopSource::readInput(juce::AudioBuffer<float>& buffer,
+                              int startSample,
+                              int numSamples,
+                              juce::int64 from)
+{
+    // only seek the reader if it is somewhere else
+    if (input->getNextReadPosition() != from)
+        input->setNextReadPosition(from);
+
+    juce::AudioSourceChannelInfo info {&buffer, startSample, numSamples};
+    input->getNextAudioBlock(info);
+}
+
+// start fading out the audio that would have played from a position
+void CueLoopSource::beginFade(juce::int64 from)
+{
+    renderSegment(fadeBuffer, 0, fadeLength, from);
+    fadeIndex = 0;
+}
+
+// mix the fading audio into part of a buffer
+void CueLoopSource::mixFade(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // check if there is anything left to fade
+    if (fadeIndex >= fadeLength)
+        return;
+
+    auto num = juce::jmin(numSamples, fadeLength - fadeIndex);
+    auto numChannels = juce::jmin(buffer.getNumChannels(), fadeBuffer.getNumChannels());
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto* out = buffer.getWritePointer(channel, startSample);
+        auto* old = fadeBuffer.getReadPointer(channel, fadeIndex);
+
+        // the new audio fades in while the old audio fades out
+        for (int i = 0; i < num; ++i) {
+            auto gain = (float) (fadeIndex + i) / (float) fadeLength;
+            out[i] = out[i] * gain + old[i] * (1.0f - gain);
+        }
+    }
+
+    fadeIndex += num;
+}
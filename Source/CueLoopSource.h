@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    CueLoopSource.h
+    Created: 19 Oct 2026 2:36:50pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PreRollCache.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ Sits between the reader of a track and the transport source and handles hot
+ cues, loops and loop rolls. Jumps and loop wraps happen inside the audio
+ callback at exact sample positions and are crossfaded over a few
+ milliseconds so they do not click. While a loop plays for the first time its
+ audio is kept in a window in memory, so the loop can repeat without reading
+ the file again. Jumps to the start of the track or to a hot cue play from a
+ pre-roll cache while the input seeks in the background.
+
+ The message thread only ever posts requests through atomics, the audio
+ thread picks them up at the start of the next block.
+*/
+class CueLoopSource : public juce::PositionableAudioSource
+{
+public:
+    CueLoopSource();
+    ~CueLoopSource() override;
+
+    /** The number of hot cues per deck */
+    static constexpr int numHotCues = 8;
+    /** The longest loop that can be kept in memory */
+    static constexpr double maxLoopSeconds = 32.0;
+
+    /** Sets the source the audio is read from. Only call this while the
+        transport source is not using this source */
+    void setInput(juce::PositionableAudioSource* input, double sampleRate);
+    /** Returns the sample rate of the input, on any thread */
+    double getSampleRate() const;
+    /** Sets the cache used to play jumps to the start and the cues without
+        waiting for the input to seek. Only call this while the transport
+        source is not using this source */
+    void setPreRollCache(PreRollCache* cache);
+
+    //==============================================================================
+    /** Jumps to a position in samples at the start of the next block. The
+        crossfade can be left out when the audio before the jump already
+        ended at that position */
+    void jumpTo(juce::int64 position, bool crossfade = true);
+
+    /** Stores the playhead as a hot cue */
+    void setHotCue(int index);
+    /** Removes a hot cue */
+    void clearHotCue(int index);
+    /** Returns the position of a hot cue in samples, or -1 if it is not set */
+    juce::int64 getHotCue(int index) const;
+    /** Jumps to a hot cue if it is set */
+    void triggerHotCue(int index);
+
+    /** Starts a loop of the given length at the playhead. A roll keeps the
+        track moving underneath and carries on from there when it ends */
+    void startLoop(juce::int64 lengthInSamples, bool roll);
+    /** Ends the current loop */
+    void exitLoop();
+    /** Returns true while a loop is playing */
+    bool isLoopActive() const;
+
+    //==============================================================================
+    /** Tells the source to prepare for playing */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    /** Allows the source to release anything it no longer needs after playback has stopped */
+    void releaseResources() override;
+    /** Called repeatedly to fetch subsequent blocks of audio data */
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /** Tells the stream to move to a new position, the jump happens at the next block */
+    void setNextReadPosition (juce::int64 newPosition) override;
+    /** Returns the position from which the next block will be returned */
+    juce::int64 getNextReadPosition() const override;
+    /** Returns the total length of the stream in samples */
+    juce::int64 getTotalLength() const override;
+    /** Returns true if this source is actually playing in a loop */
+    bool isLooping() const override;
+    /** Tells the source whether it should loop the whole stream, ignored */
+    void setLooping (bool shouldLoop) override;
+
+private:
+    /** Applies the jumps and loops posted by the message thread */
+    void applyRequests();
+    /** Fills part of a buffer with the audio at a position, from memory if possible */
+    void renderSegment(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, juce::int64 from);
+    /** Copies the start of a segment from the pre-roll cache if the input would
+        have to seek, and returns the number of samples copied */
+    int readPreRoll(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, juce::int64 from);
+    /** Reads part of a buffer straight from the input */
+    void readInput(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, juce::int64 from);
+    /** Starts fading out the audio that would have played from a position */
+    void beginFade(juce::int64 from);
+    /** Mixes the fading audio into part of a buffer */
+    void mixFade(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    // the source the audio is read from
+    juce::PositionableAudioSource* input = nullptr;
+    // the audio thread reads it for the beat of the playhead while a new
+    // track is set on the message thread
+    std::atomic<double> sampleRate {44100.0};
+    // decoded audio around the start and the cues, may be null
+    PreRollCache* preRollCache = nullptr;
+
+    // requests posted by the message thread, -1 or 0 means no request
+    std::atomic<juce::int64> pendingJump {-1};
+    std::atomic<juce::int64> pendingLoopLength {0};
+    std::atomic<bool> pendingJumpFade {true};
+    std::atomic<bool> pendingRoll {false};
+    std::atomic<bool> pendingExit {false};
+
+    // the hot cues in samples, -1 means not set
+    std::array<std::atomic<juce::int64>, numHotCues> hotCues;
+
+    // the playhead, written by the audio thread only
+    std::atomic<juce::int64> position {0};
+    std::atomic<bool> loopActive {false};
+
+    // the current loop, audio thread only
+    juce::int64 loopStart = 0;
+    juce::int64 loopEnd = 0;
+    bool rolling = false;
+    // where the track would be if the roll had not happened
+    juce::int64 rollPosition = 0;
+
+    // audio of the current loop, kept while it plays for the first time
+    juce::AudioBuffer<float> window;
+    juce::int64 windowStart = 0;
+    juce::int64 windowEnd = 0;
+    bool capturing = false;
+
+    // the audio that is faded out after a jump
+    juce::AudioBuffer<float> fadeBuffer;
+    int fadeLength = 256;
+    int fadeIndex = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CueLoopSource)
+};
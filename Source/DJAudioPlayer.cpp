@@ -10,10 +10,23 @@
 
 #include "DJAudioPlayer.h"
 
+// every hot cue has a region of the pre-roll cache after the start of the track
+static_assert(PreRollCache::numRegions == CueLoopSource::numHotCues + 1, "one region per hot cue");
+// and the pages after it in the seek cache are kept in memory
+static_assert(SeekCacheReader::numTouchTargets == CueLoopSource::numHotCues, "one touch target per hot cue");
+
 DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager)
-: formatManager(_formatManager) {}
+: formatManager(_formatManager)
+{
+    // jumps to the start and to the cues play from memory
+    cueLoopSource.setPreRollCache(&preRollCache);
+}
 
-DJAudioPlayer::~DJAudioPlayer() {}
+DJAudioPlayer::~DJAudioPlayer()
+{
+    cancelPendingUpdate();
+    clearPreload();
+}
 
 //==============================================================================
 // tells the source to prepare for playing
@@ -23,14 +36,145 @@ void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRat
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     // tell the resample sourece to prepare for playing
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    // tell the scratch engine the rate it plays at
+    scratchEngine.prepareToPlay(sampleRate);
+    // give the EQ and the effects their memory before the audio starts
+    equaliser.prepare(sampleRate);
+    effectsRack.prepare(sampleRate, samplesPerBlockExpected);
+    // tell the analyser the rate it measures at
+    analyser.prepare(sampleRate);
 }
 
 // called repeatedly to fetch subsequent blocks of audio data
 void DJAudioPlayer::getNextAudioBlock (
     const juce::AudioSourceChannelInfo& bufferToFill
 ) {
+    // time the resampling, the decoding inside it is timed on its own
+    AudioProfiler::ScopedStage stage {profiler, resampleStage};
+    
+    // the controls sent since the last block take effect from its first sample
+    applyControls();
+    
+    // a stop sent by a control holds the deck where it is until the message
+    // thread has stopped the transport
+    if (playPending && ! playWanted) {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+    
+    // a start is counted here, so the play button, a controller and the
+    // automix are all seen without any of them logging
+    auto playing = transportSource.isPlaying();
+    if (playing && ! wasPlaying) {
+        lastStartMillis = juce::Time::currentTimeMillis();
+        ++numStarts;
+    }
+    wasPlaying = playing;
+    
+    // the volume and the auto gain are folded into the gain the transport
+    // source applies anyway
+    gain = (float) (userGain * autoGainFactor);
+    transportSource.setGain(gain);
+    
+    // the motor of the deck only turns while it is playing
+    auto currentSpeed = speed.load();
+    auto motor = transportSource.isPlaying() ? currentSpeed : 0.0;
+    
+    // the scratch engine plays while the jog is held or the deck plays backwards
+    if (scratchEngine.isScratching() || (currentSpeed <= 0.0 && transportSource.isPlaying())) {
+        // take over from where the transport source is
+        if (! scratching) {
+            scratchEngine.startAt(cueLoopSource.getNextReadPosition(), motor);
+            scratching = true;
+        }
+        
+        scratchEngine.render(bufferToFill, motor);
+        
+        // the transport source applies the gain on the normal path
+        auto newGain = gain.load();
+        for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+            bufferToFill.buffer->applyGainRamp(channel, bufferToFill.startSample, bufferToFill.numSamples,
+                                               scratchGain, newGain);
+        scratchGain = newGain;
+        
+        processEffects(bufferToFill, currentSpeed);
+        analyser.push(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+        return;
+    }
+    
+    // carry on from where the scratch ended, the audio already ends there so
+    // there is nothing to crossfade
+    if (scratching) {
+        cueLoopSource.jumpTo(scratchEngine.getPosition(), false);
+        scratching = false;
+    }
+    
+    // keep the audio around the playhead decoded for the next scratch
+    scratchEngine.followPlayhead(cueLoopSource.getNextReadPosition());
+    
+    // a synced deck plays at the speed that keeps it on the beat of the clock
+    currentSpeed = followMasterClock(currentSpeed);
+    
     // pass blocks of audio on to resample source
     resampleSource.getNextAudioBlock(bufferToFill);
+    
+    processEffects(bufferToFill, currentSpeed);
+    
+    // hand the block to the analysis thread, this is only a copy
+    analyser.push(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+// run the EQ and the effects over the block the deck has just rendered
+void DJAudioPlayer::processEffects(const juce::AudioSourceChannelInfo& bufferToFill, double currentSpeed)
+{
+    {
+        AudioProfiler::ScopedStage eqTimer {profiler, eqStage};
+        equaliser.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+    
+    // the tempo the deck is heard at and where the block starts on the grid
+    effectsRack.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples,
+                        trackBpm * std::abs(currentSpeed), getPlayheadBeat());
+}
+
+// the beat of the grid at the playhead
+double DJAudioPlayer::getPlayheadBeat() const
+{
+    auto trackRate = cueLoopSource.getSampleRate() > 0.0 ? cueLoopSource.getSampleRate() : 44100.0;
+    return (getTrackPosition() / trackRate - firstBeat) * trackBpm / 60.0;
+}
+
+// keep a synced deck on the beat of the master clock
+double DJAudioPlayer::followMasterClock(double currentSpeed)
+{
+    // a track without a tempo has no beat to line up
+    auto synced = syncEnabled && masterClock != nullptr && transportSource.isPlaying() && currentSpeed > 0.0
+               && trackBpm > 0.0;
+    
+    if (! synced) {
+        // the speed of the user comes back once the sync lets go
+        if (syncSpeed > 0.0) {
+            if (currentSpeed > 0.0)
+                resampleSource.setResamplingRatio(currentSpeed);
+            syncSpeed = 0.0;
+        }
+        return currentSpeed;
+    }
+    
+    // the place in the beat the deck is behind the clock, from -0.5 to 0.5
+    auto difference = masterClock->getBeat() - getPlayheadBeat();
+    difference -= std::round(difference);
+    
+    // the deck plays at the tempo of the clock and is nudged by a quarter
+    // of the difference per beat, so it slides onto the beat rather than
+    // jumping, by no more than a couple of percent
+    auto nudge = juce::jlimit(-maxSyncNudge, maxSyncNudge, 0.25 * difference);
+    auto ratio = juce::jlimit(0.25, 4.0, masterClock->getTempo() / trackBpm * (1.0 + nudge));
+    
+    resampleSource.setResamplingRatio(ratio);
+    syncSpeed = ratio;
+    syncPhaseError = difference;
+    return ratio;
 }
 
 // Allows source to release data that it does not need
@@ -49,53 +193,119 @@ void DJAudioPlayer::loadURL(juce::URL audioURL)
     
     // if pointer is null the audio format is not supported
     if (reader != nullptr) { // audio format supported
-        // create a unique pointer for the new source of the transport source
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource (
-            new juce::AudioFormatReaderSource (reader, true));
-        
-        // set the source of the transport sort
-        transportSource.setSource(
-                                  newSource.get(),
-                                  0,
-                                  nullptr,
-                                  reader->sampleRate);
-        
-        // reset the reader source
-        readerSource.reset(newSource.release());
+        loadReader(reader, audioURL, nullptr);
     }
 }
 
+// point the deck at an open track
+void DJAudioPlayer::loadReader(juce::AudioFormatReader* reader,
+                               const juce::URL& audioURL,
+                               juce::AudioBuffer<float>* intro)
+{
+    // a long recording is read through a window of a fixed size on the
+    // streaming thread, the jumps to the start and the cues still play from
+    // the pre-roll cache while the window catches up
+    auto lengthInSeconds = reader->sampleRate > 0.0 ? (double) reader->lengthInSamples / reader->sampleRate : 0.0;
+    streaming = lengthInSeconds > streamingSeconds;
+    seekCacheReader = nullptr;
+    
+    if (streaming || SeekCache::isCompressed(*reader)) {
+        if (! streamingThread.isThreadRunning())
+            streamingThread.startThread(8);
+    }
+    
+    if (streaming) {
+        auto* buffered = new juce::BufferingAudioReader(reader,
+                                                        streamingThread,
+                                                        (int) (streamBufferSeconds * reader->sampleRate));
+        // audio that is not in the window yet is silence, the audio thread never waits
+        buffered->setReadTimeout(0);
+        reader = buffered;
+    }
+    // a compressed track is decoded into the seek cache in the background,
+    // and jumps around it cost no decoding once the copy is there, the pages
+    // of the copy are touched on the streaming thread
+    else if (SeekCache::isCompressed(*reader)) {
+        seekCacheReader = new SeekCacheReader(formatManager, audioURL, reader, streamingThread);
+        reader = seekCacheReader;
+    }
+    
+    // create a unique pointer for the new source of the transport source
+    std::unique_ptr<juce::AudioFormatReaderSource> newSource (
+        new juce::AudioFormatReaderSource (reader, true));
+    
+    // stop the transport reading the old track before the cue and loop
+    // source is pointed at the new one
+    transportSource.setSource(nullptr);
+    cueLoopSource.setInput(newSource.get(), reader->sampleRate);
+    // start decoding the start of the new track in the background, unless
+    // the preload slot has decoded it already
+    if (intro != nullptr)
+        preRollCache.loadTrack(audioURL, std::move(*intro));
+    else
+        preRollCache.loadTrack(audioURL);
+    scratchEngine.loadTrack(audioURL, reader->sampleRate, reader->lengthInSamples);
+    // measure the loudness of the new track from its start
+    analyser.reset();
+    // the loudness and the grid of the new track are not known until they are set
+    hasTrackLoudness = false;
+    trackBpm = 0.0;
+    firstBeat = 0.0;
+    updateGain();
+    
+    // set the source of the transport sort
+    transportSource.setSource(
+                              &cueLoopSource,
+                              0,
+                              nullptr,
+                              reader->sampleRate);
+    
+    // reset the reader source
+    readerSource.reset(newSource.release());
+    loadedURL = audioURL;
+}
+
 // Set the volume at which the audio is being played
-void DJAudioPlayer::setGain(double gain)
+void DJAudioPlayer::setGain(double _gain)
 {
     // check if gain is betwen 0 and 1
-    if (gain < 0 || gain > 1.0) { // gain not between 0 and 1
+    if (_gain < 0 || _gain > 1.0) { // gain not between 0 and 1
         std::cout << "DJAudioPlayer::setGain  Gain should be between 0 and 1" << std::endl;
     }
     else { // gain is between 0 and 1
-        // set the gain of the transport source to the
-        // gain passed to the function
-        transportSource.setGain(gain);
+        // the auto gain is applied on top of the gain passed to the function
+        userGain = _gain;
     }
 }
 
+// the volume set on the deck
+double DJAudioPlayer::getGain() const
+{
+    return userGain;
+}
+
 // Sets the speed at which the audio is been played
 void DJAudioPlayer::setSpeed(double ratio)
 {
-    // the speed ratio must be between 0 and 100
-    if (ratio < 0 || ratio > 100.0) { // ratio is not between 0 and 100
-        std::cout << "DJAudioPlayer::setGain  ratio should be between 0 and 100" << std::endl;
+    // the speed ratio must be between -100 and 100
+    if (ratio < -100.0 || ratio > 100.0) { // ratio is not between -100 and 100
+        std::cout << "DJAudioPlayer::setSpeed  ratio should be between -100 and 100" << std::endl;
     }
-    else { // ratio is between 0 and 100
-        // set the speed of resampling source to ratio
-        resampleSource.setResamplingRatio(ratio);
+    else { // ratio is between -100 and 100
+        speed = ratio;
+        
+        // the resampling source only plays forwards, the scratch engine
+        // plays the rest
+        if (ratio > 0)
+            resampleSource.setResamplingRatio(ratio);
     }
 }
 
 // Set the position at which the audio is been played in seconds
 void DJAudioPlayer::setPosition(double positionInSec)
 {
-    transportSource.setPosition(positionInSec);
+    // the jump happens at the start of the next block and is crossfaded
+    cueLoopSource.jumpTo((juce::int64) (positionInSec * cueLoopSource.getSampleRate()));
 }
 
 // set the relative position of the audio being played
@@ -115,16 +325,516 @@ void DJAudioPlayer::setPositionRelative(double pos) {
 // Function called to start or play the audio
 void DJAudioPlayer::start()
 {
+    // the button wins over a control still on its way
+    playPending = false;
     transportSource.start();
 }
 
 // Function called to stop or pause the audio
 void DJAudioPlayer::stop()
 {
+    playPending = false;
     transportSource.stop();
 }
 
 // Function that returns the relative position
 double DJAudioPlayer::getPositionRelative() {
+    // the scratch engine knows where the track is while it plays
+    if (scratching) {
+        auto length = cueLoopSource.getTotalLength();
+        return length > 0 ? (double) scratchEngine.getPosition() / (double) length : 0.0;
+    }
+    
     return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
 }
+
+// check if the track is playing
+bool DJAudioPlayer::isPlaying() const
+{
+    return transportSource.isPlaying();
+}
+
+// the number of times the deck has started
+int DJAudioPlayer::getNumStarts() const
+{
+    return numStarts.load();
+}
+
+// the time the deck last started
+juce::int64 DJAudioPlayer::getLastStartMillis() const
+{
+    return lastStartMillis.load();
+}
+
+// the playhead in samples of the track
+juce::int64 DJAudioPlayer::getTrackPosition() const
+{
+    return cueLoopSource.getNextReadPosition();
+}
+
+// move the playhead to a sample of the track
+void DJAudioPlayer::setTrackPosition(juce::int64 position)
+{
+    cueLoopSource.jumpTo(position);
+}
+
+// the url of the loaded track
+juce::URL DJAudioPlayer::getLoadedURL() const
+{
+    return loadedURL;
+}
+
+// the sample rate of the loaded track
+double DJAudioPlayer::getTrackSampleRate() const
+{
+    return cueLoopSource.getSampleRate();
+}
+
+// the speed the deck plays at
+double DJAudioPlayer::getSpeed() const
+{
+    auto synced = syncSpeed.load();
+    return synced > 0.0 ? synced : speed.load();
+}
+
+// check if the loaded track is read through the streaming thread
+bool DJAudioPlayer::isStreaming() const
+{
+    return streaming;
+}
+
+//==============================================================================
+// open the next track in the background
+void DJAudioPlayer::preloadURL(juce::URL audioURL)
+{
+    clearPreload();
+    
+    // the intro is as long as the start region of the pre-roll cache
+    preloader = std::make_unique<TrackPreloader>(formatManager, audioURL, PreRollCache::regionSeconds);
+    analysisPool->addJob(preloader.get());
+}
+
+// the track waiting in the preload slot
+juce::URL DJAudioPlayer::getPreloadedURL() const
+{
+    return preloader != nullptr ? preloader->getURL() : juce::URL();
+}
+
+// check if the preloaded track can be swapped in instantly
+bool DJAudioPlayer::isPreloadReady() const
+{
+    return preloader != nullptr && preloader->isFinished() && preloader->wasSuccessful();
+}
+
+// swap the preloaded track in
+bool DJAudioPlayer::loadPreloaded()
+{
+    if (preloader == nullptr)
+        return false;
+    
+    auto url = preloader->getURL();
+    
+    // the track is still being opened, it is quicker to open it again here
+    // than to wait for the job
+    if (! preloader->isFinished()) {
+        clearPreload();
+        loadURL(url);
+        return true;
+    }
+    
+    // the job has finished running, so this does not wait
+    analysisPool->removeFinishedJob(preloader.get());
+    
+    auto reader = preloader->takeReader();
+    auto intro = preloader->takeIntro();
+    preloader.reset();
+    
+    if (reader == nullptr) {
+        std::cout << "DJAudioPlayer::loadPreloaded  could not open " << url.toString(false) << std::endl;
+        return true;
+    }
+    
+    loadReader(reader.release(), url, &intro);
+    return true;
+}
+
+// empty the preload slot
+void DJAudioPlayer::clearPreload()
+{
+    // the pool deletes the job once it has stopped
+    analysisPool->cancelJob(std::move(preloader));
+}
+
+//==============================================================================
+// store the playhead as a hot cue
+void DJAudioPlayer::setHotCue(int index)
+{
+    cueLoopSource.setHotCue(index);
+    // keep the audio around the cue in memory, region 0 is the start of the track
+    preRollCache.setRegion(index + 1, cueLoopSource.getHotCue(index));
+    // and the pages of the seek cache the deck carries on from
+    if (seekCacheReader != nullptr)
+        seekCacheReader->setTouchTarget(index, cueLoopSource.getHotCue(index));
+}
+
+// jump to a hot cue
+void DJAudioPlayer::triggerHotCue(int index)
+{
+    cueLoopSource.triggerHotCue(index);
+}
+
+// remove a hot cue
+void DJAudioPlayer::clearHotCue(int index)
+{
+    cueLoopSource.clearHotCue(index);
+    preRollCache.setRegion(index + 1, -1);
+    
+    if (seekCacheReader != nullptr)
+        seekCacheReader->setTouchTarget(index, -1);
+}
+
+// check if a hot cue is set
+bool DJAudioPlayer::hasHotCue(int index) const
+{
+    return cueLoopSource.getHotCue(index) >= 0;
+}
+
+// check if the start of the track and the hot cues are in memory
+bool DJAudioPlayer::isPreRollReady() const
+{
+    return preRollCache.isReady();
+}
+
+// set the tempo of the loaded track
+void DJAudioPlayer::setTrackBpm(double bpm)
+{
+    // the tempo must be a sensible number of beats per minute
+    if (bpm < 20.0 || bpm > 400.0) { // tempo out of range
+        std::cout << "DJAudioPlayer::setTrackBpm  bpm should be between 20 and 400" << std::endl;
+    }
+    else { // tempo in range
+        trackBpm = bpm;
+    }
+}
+
+// the tempo of the loaded track
+double DJAudioPlayer::getTrackBpm() const
+{
+    return trackBpm;
+}
+
+// set where the first beat of the grid is
+void DJAudioPlayer::setFirstBeat(double seconds)
+{
+    firstBeat = juce::jmax(0.0, seconds);
+}
+
+//==============================================================================
+// give the deck the clock it follows
+void DJAudioPlayer::setMasterClock(MasterClock* clock)
+{
+    masterClock = clock;
+}
+
+// lock the deck to the master clock
+void DJAudioPlayer::setSyncEnabled(bool enabled)
+{
+    // a deck outside a mixer has no clock to follow
+    if (enabled && masterClock == nullptr) {
+        std::cout << "DJAudioPlayer::setSyncEnabled  the deck has no master clock" << std::endl;
+        return;
+    }
+    
+    syncEnabled = enabled;
+}
+
+// check if the deck follows the master clock
+bool DJAudioPlayer::isSyncEnabled() const
+{
+    return syncEnabled;
+}
+
+// how far the deck was off the beat of the clock
+double DJAudioPlayer::getSyncPhaseError() const
+{
+    return syncPhaseError;
+}
+
+// start a loop of a number of beats at the playhead
+void DJAudioPlayer::setBeatLoop(double beats, bool roll)
+{
+    // a beat has no length until the tempo of the track is known
+    if (trackBpm <= 0.0) {
+        std::cout << "DJAudioPlayer::setBeatLoop  the tempo of the track is not known" << std::endl;
+        return;
+    }
+    
+    // convert the beats to samples of the track
+    auto seconds = beats * 60.0 / trackBpm;
+    auto length = (juce::int64) (seconds * cueLoopSource.getSampleRate());
+    
+    // the loop must be long enough to hear and short enough to keep in memory
+    if (length <= 0 || seconds > CueLoopSource::maxLoopSeconds) {
+        std::cout << "DJAudioPlayer::setBeatLoop  loop must be shorter than "
+                  << CueLoopSource::maxLoopSeconds << " seconds" << std::endl;
+        return;
+    }
+    
+    cueLoopSource.startLoop(length, roll);
+}
+
+// end the current loop
+void DJAudioPlayer::exitLoop()
+{
+    cueLoopSource.exitLoop();
+}
+
+// check if a loop is playing
+bool DJAudioPlayer::isLoopActive() const
+{
+    return cueLoopSource.isLoopActive();
+}
+
+//==============================================================================
+// the hand touches the jog wheel
+void DJAudioPlayer::beginScratch()
+{
+    scratchEngine.beginScratch();
+}
+
+// move the track with the jog wheel
+void DJAudioPlayer::addJogMovement(double seconds)
+{
+    scratchEngine.addJogMovement(seconds);
+}
+
+// the hand lets go of the jog wheel
+void DJAudioPlayer::endScratch()
+{
+    scratchEngine.endScratch();
+}
+
+// check if the hand is on the jog wheel
+bool DJAudioPlayer::isScratching() const
+{
+    return scratchEngine.isScratching();
+}
+
+//==============================================================================
+// send the deck to the cue bus
+void DJAudioPlayer::setCueEnabled(bool enabled)
+{
+    cueEnabled = enabled;
+}
+
+// check if the deck is sent to the cue bus
+bool DJAudioPlayer::isCueEnabled() const
+{
+    return cueEnabled;
+}
+
+//==============================================================================
+// queue a control for the audio thread
+bool DJAudioPlayer::postControl(Control control, float value, int index)
+{
+    const juce::SpinLock::ScopedLockType lock (controlLock);
+    const auto scope = controlFifo.write(1);
+    
+    if (scope.blockSize1 > 0)
+        controlEvents[(size_t) scope.startIndex1] = {control, value, index};
+    else if (scope.blockSize2 > 0)
+        controlEvents[(size_t) scope.startIndex2] = {control, value, index};
+    else
+        return false;
+    
+    return true;
+}
+
+// when the audio thread last applied a control
+double DJAudioPlayer::getLastControlMillis() const
+{
+    return lastControlMillis;
+}
+
+// apply the controls queued since the last block
+void DJAudioPlayer::applyControls()
+{
+    const auto scope = controlFifo.read(controlFifo.getNumReady());
+    
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return;
+    
+    for (int i = 0; i < scope.blockSize1; ++i) {
+        auto& event = controlEvents[(size_t) (scope.startIndex1 + i)];
+        applyControl(event.control, event.value, event.index);
+    }
+    for (int i = 0; i < scope.blockSize2; ++i) {
+        auto& event = controlEvents[(size_t) (scope.startIndex2 + i)];
+        applyControl(event.control, event.value, event.index);
+    }
+    
+    lastControlMillis = juce::Time::getMillisecondCounterHiRes();
+}
+
+// apply one queued control
+void DJAudioPlayer::applyControl(Control control, float value, int index)
+{
+    switch (control) {
+        case Control::play:
+        {
+            // stopping the transport waits for the next block, so it is left
+            // to the message thread, a stop is silent from this block on
+            auto playing = playPending ? playWanted.load() : transportSource.isPlaying();
+            playWanted = ! playing;
+            playPending = true;
+            triggerAsyncUpdate();
+            break;
+        }
+            
+        case Control::cue:
+            cueEnabled = ! cueEnabled;
+            break;
+            
+        case Control::sync:
+            if (masterClock != nullptr)
+                syncEnabled = ! syncEnabled;
+            break;
+            
+        case Control::hotCue:
+            cueLoopSource.triggerHotCue(index);
+            break;
+            
+        case Control::jog:
+            scratchEngine.addJogMovement(value);
+            break;
+            
+        case Control::jogTouch:
+            if (value > 0.5f)
+                scratchEngine.beginScratch();
+            else
+                scratchEngine.endScratch();
+            break;
+            
+        case Control::volume:
+            userGain = juce::jlimit(0.0f, 1.0f, value);
+            break;
+            
+        case Control::speed:
+            speed = juce::jlimit(-100.0f, 100.0f, value);
+            if (speed > 0.0)
+                resampleSource.setResamplingRatio(speed);
+            break;
+            
+        case Control::eq:
+            equaliser.setGain(index, value);
+            break;
+            
+        default:
+            break;
+    }
+}
+
+// start or stop the transport as a play control asked
+void DJAudioPlayer::handleAsyncUpdate()
+{
+    // a button pressed since has already done it
+    if (! playPending.exchange(false))
+        return;
+    
+    if (playWanted)
+        transportSource.start();
+    else
+        transportSource.stop();
+}
+
+//==============================================================================
+// set the measured loudness of the loaded track
+void DJAudioPlayer::setTrackLoudness(float integratedLufs, float truePeakDb)
+{
+    // silence has nothing to normalise
+    hasTrackLoudness = integratedLufs > -70.0f;
+    trackLufs = integratedLufs;
+    trackTruePeak = truePeakDb;
+    updateGain();
+}
+
+// turn the auto gain on or off
+void DJAudioPlayer::setAutoGainEnabled(bool enabled)
+{
+    autoGainEnabled = enabled;
+    updateGain();
+}
+
+// check if the auto gain is on
+bool DJAudioPlayer::isAutoGainEnabled() const
+{
+    return autoGainEnabled;
+}
+
+// set the loudness every track is brought to
+void DJAudioPlayer::setTargetLoudness(double lufs)
+{
+    targetLoudness = lufs;
+    updateGain();
+}
+
+// the gain in dB the auto gain applies to the loaded track
+double DJAudioPlayer::getAutoGainDecibels() const
+{
+    return autoGainDecibels;
+}
+
+// work out the auto gain and hand the total gain to the audio thread
+void DJAudioPlayer::updateGain()
+{
+    autoGainDecibels = 0.0;
+
+    if (autoGainEnabled && hasTrackLoudness) {
+        // a quiet track is only raised until its true peak reaches -1 dBTP,
+        // and never by more than 12 dB. A track that already peaks above it
+        // is not raised, but it is not cut for it either
+        auto headroom = -1.0 - trackTruePeak;
+        autoGainDecibels = juce::jmin(targetLoudness - trackLufs, juce::jmax(0.0, headroom), 12.0);
+    }
+
+    // the audio thread multiplies it with the volume at the start of the next block
+    autoGainFactor = juce::Decibels::decibelsToGain(autoGainDecibels);
+}
+
+// the analyser that measures the output of this deck
+AudioAnalyser& DJAudioPlayer::getAnalyser()
+{
+    return analyser;
+}
+
+// the effects on the output of this deck
+EffectsRack& DJAudioPlayer::getEffectsRack()
+{
+    return effectsRack;
+}
+
+// the EQ on the output of this deck
+DeckEqualiser& DJAudioPlayer::getEqualiser()
+{
+    return equaliser;
+}
+
+// Register the stages of this player with the profiler
+void DJAudioPlayer::setProfiler(AudioProfiler* _profiler, const juce::String& deckName)
+{
+    profiler = _profiler;
+    
+    // without a profiler the timers do nothing
+    if (profiler == nullptr) {
+        decodeTimer.setStage(nullptr, -1);
+        resampleStage = -1;
+        eqStage = -1;
+        effectsRack.setProfiler(nullptr, deckName);
+        return;
+    }
+    
+    decodeTimer.setStage(profiler, profiler->addStage(deckName + " decode"));
+    resampleStage = profiler->addStage(deckName + " resample");
+    eqStage = profiler->addStage(deckName + " eq");
+    effectsRack.setProfiler(profiler, deckName);
+}
@@ -12,9 +12,21 @@
 
 
 #include <JuceHeader.h>
+#include "AudioProfiler.h"
+#include "CueLoopSource.h"
+#include "PreRollCache.h"
+#include "ScratchEngine.h"
+#include "AudioAnalyser.h"
+#include "AnalysisPool.h"
+#include "TrackPreloader.h"
+#include "EffectsRack.h"
+#include "MasterClock.h"
+#include "DeckEqualiser.h"
+#include "SeekCache.h"
 
 
-class DJAudioPlayer : public juce::AudioSource
+class DJAudioPlayer : public juce::AudioSource,
+                      private juce::AsyncUpdater
 {
 public:
     DJAudioPlayer(juce::AudioFormatManager& _formatManager);
@@ -32,7 +44,9 @@ public:
     void loadURL(juce::URL audioUrl);
     /** Set the gain or the volume at which the audio is playing */
     void setGain(double gain);
-    /** Sets the speed at which the audio plays */
+    /** Returns the volume set with setGain or by a control */
+    double getGain() const;
+    /** Sets the speed at which the audio plays, negative speeds play backwards */
     void setSpeed(double ratio);
     /** Sets the position of the audio in seconds */
     void setPosition(double positionInSec);
@@ -44,19 +58,304 @@ public:
     void stop();
     /** Get the relative position of the playhead */
     double getPositionRelative();
+    /** Returns true while the track is playing */
+    bool isPlaying() const;
+    /** Returns the number of times the deck has started playing, however it
+        was started, counted on the audio thread */
+    int getNumStarts() const;
+    /** Returns the time in milliseconds since 1970 the deck last started playing */
+    juce::int64 getLastStartMillis() const;
+    /** Returns the playhead in samples of the track, safe on the audio thread */
+    juce::int64 getTrackPosition() const;
+    /** Moves the playhead to a position in samples of the track, the exact
+        sample getTrackPosition returned */
+    void setTrackPosition(juce::int64 position);
+    /** Returns the url of the loaded track, empty if there is none */
+    juce::URL getLoadedURL() const;
+    /** Returns the sample rate of the loaded track */
+    double getTrackSampleRate() const;
+    /** Returns the speed the deck plays at, the speed set with setSpeed or
+        the one that follows the master clock while synced. Safe on the
+        audio thread */
+    double getSpeed() const;
+    
+    /** Tracks longer than this, like recorded mixes and podcasts, are streamed */
+    static constexpr double streamingSeconds = 20.0 * 60.0;
+    /** The audio of a streamed track read ahead of the playhead */
+    static constexpr double streamBufferSeconds = 10.0;
+    /** Returns true if the loaded track is streamed. A streamed track is read
+        ahead on a thread of its own into a window of streamBufferSeconds, so
+        memory stays the same however long it is, and a part that has not been
+        read yet after a seek plays as silence rather than holding up the
+        audio thread */
+    bool isStreaming() const;
+    
+    //==============================================================================
+    /** Opens a track and decodes its intro in the background, so that
+        loadPreloaded can swap it in without touching the disk. Replaces the
+        track waiting in the slot, if any */
+    void preloadURL(juce::URL audioURL);
+    /** Returns the track waiting in the preload slot, empty if there is none */
+    juce::URL getPreloadedURL() const;
+    /** Returns true once the preloaded track can be swapped in instantly */
+    bool isPreloadReady() const;
+    /** Loads the track waiting in the preload slot and empties the slot. A
+        track that is not ready yet is loaded the slow way. Returns false if
+        the slot was empty */
+    bool loadPreloaded();
+    /** Empties the preload slot */
+    void clearPreload();
+    
+    //==============================================================================
+    /** Stores the playhead as a hot cue */
+    void setHotCue(int index);
+    /** Jumps to a hot cue if it is set */
+    void triggerHotCue(int index);
+    /** Removes a hot cue */
+    void clearHotCue(int index);
+    /** Returns true if a hot cue is set */
+    bool hasHotCue(int index) const;
+    /** Returns true once the start of the track and every hot cue have been decoded into memory */
+    bool isPreRollReady() const;
+    
+    /** Sets the tempo of the loaded track, used to work out the length of beat
+        loops. Loading a track forgets it, and the beat loops and the sync do
+        nothing until it is set */
+    void setTrackBpm(double bpm);
+    /** Returns the tempo of the loaded track, 0 if it is not known */
+    double getTrackBpm() const;
+    /** Sets where the first beat of the grid is, in seconds of the track */
+    void setFirstBeat(double seconds);
+    
+    //==============================================================================
+    /** The most a synced deck speeds up or slows down to catch the beat of
+        the clock, as a fraction of its tempo */
+    static constexpr double maxSyncNudge = 0.02;
+    
+    /** Gives the deck the clock it follows while synced, the mixer does this */
+    void setMasterClock(MasterClock* clock);
+    /** Locks the tempo and the beat of the deck to the master clock. The
+        speed set with setSpeed comes back when it is turned off */
+    void setSyncEnabled(bool enabled);
+    /** Returns true while the deck follows the master clock */
+    bool isSyncEnabled() const;
+    /** Returns how far the beat of the deck was from the clock at the last
+        block, in beats from -0.5 to 0.5 */
+    double getSyncPhaseError() const;
+    
+    /** Starts a loop of a number of beats at the playhead, a roll keeps the
+        track moving underneath and carries on from there when it ends */
+    void setBeatLoop(double beats, bool roll);
+    /** Ends the current loop */
+    void exitLoop();
+    /** Returns true while a loop is playing */
+    bool isLoopActive() const;
+    
+    //==============================================================================
+    /** The hand touches the jog wheel, the track stops unless the jog moves */
+    void beginScratch();
+    /** Moves the track by a number of seconds, called for every jog event */
+    void addJogMovement(double seconds);
+    /** The hand lets go of the jog wheel */
+    void endScratch();
+    /** Returns true while the hand is on the jog wheel */
+    bool isScratching() const;
+    
+    //==============================================================================
+    /** Sends the deck to the cue bus so it can be heard on the headphones */
+    void setCueEnabled(bool enabled);
+    /** Returns true if the deck is sent to the cue bus */
+    bool isCueEnabled() const;
+    
+    //==============================================================================
+    /** The controls that can be sent to the deck from off the message thread,
+        such as by a MIDI controller */
+    enum class Control
+    {
+        play,       // starts or stops the deck, a stop is silent from the
+                    // next block and a start waits for the message thread
+        cue,        // sends the deck to the cue bus or takes it off
+        sync,       // turns the sync to the master clock on or off
+        hotCue,     // jumps to the hot cue of the index
+        jog,        // moves the track by the value in seconds
+        jogTouch,   // the hand on the jog wheel, 1 to touch and 0 to let go
+        volume,     // the volume from 0 to 1
+        speed,      // the speed, negative plays backwards
+        eq          // the gain in dB of the band of the index
+    };
+    
+    /** Queues a control for the audio thread, which applies it at the start
+        of the next block without going through the message thread. Safe on
+        any thread and never makes the audio thread wait. Returns false if
+        the queue is full */
+    bool postControl(Control control, float value, int index = 0);
+    /** Returns the time the audio thread last applied a queued control, on
+        the millisecond counter */
+    double getLastControlMillis() const;
+    
+    //==============================================================================
+    /** Sets the measured loudness of the loaded track, used by the auto gain */
+    void setTrackLoudness(float integratedLufs, float truePeakDb);
+    /** Turns the auto gain on or off */
+    void setAutoGainEnabled(bool enabled);
+    /** Returns true if the auto gain is on */
+    bool isAutoGainEnabled() const;
+    /** Sets the loudness the auto gain brings every track to */
+    void setTargetLoudness(double lufs);
+    /** Returns the gain in dB the auto gain applies to the loaded track */
+    double getAutoGainDecibels() const;
+    
+    /** Returns the analyser that measures the output of this deck */
+    AudioAnalyser& getAnalyser();
+    
+    /** Returns the effects on the output of this deck */
+    EffectsRack& getEffectsRack();
+    /** Returns the three band EQ of this deck */
+    DeckEqualiser& getEqualiser();
+    
+    /** Times the decoding, the resampling and the effects of this player as
+        stages of the profiler */
+    void setProfiler(AudioProfiler* profiler, const juce::String& deckName);
     
 private:
+    /** Points the deck at an open track, the intro is handed to the pre-roll
+        cache if it has been decoded already */
+    void loadReader(juce::AudioFormatReader* reader,
+                    const juce::URL& audioURL,
+                    juce::AudioBuffer<float>* intro);
+    /** Works out the auto gain and hands it to the audio thread */
+    void updateGain();
+    /** Applies the controls queued since the last block. Audio thread */
+    void applyControls();
+    /** Applies one queued control. Audio thread */
+    void applyControl(Control control, float value, int index);
+    /** Starts or stops the transport as a play control asked. The transport
+        waits for the next block to stop, so it is never stopped by the audio
+        thread */
+    void handleAsyncUpdate() override;
+    /** Runs the EQ and the effects over the block the deck has just rendered */
+    void processEffects(const juce::AudioSourceChannelInfo& bufferToFill, double currentSpeed);
+    /** Returns the beat of the grid at the playhead */
+    double getPlayheadBeat() const;
+    /** Works out the speed that brings the deck in line with the master
+        clock and hands it to the resampler. Audio thread */
+    double followMasterClock(double currentSpeed);
+    
     // A manager that keeps a list of available audio formats and
     // decides which one to use to open a given file
     juce::AudioFormatManager& formatManager;
     
+    // reads long tracks ahead of the playhead and touches the pages of the
+    // seek cache, started with the first track that needs it, it outlives
+    // the reader source that uses it
+    juce::TimeSliceThread streamingThread {"Deck streaming"};
+    // true if the loaded track is read through the streaming thread
+    std::atomic<bool> streaming {false};
+    
     // A unique pointer to a type of AudioSource that will read
     // from an AudioFormatReader
     std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+    // the reader of the loaded track if it goes through the seek cache, it
+    // is owned by the reader source, only used on the message thread
+    SeekCacheReader* seekCacheReader = nullptr;
+    
+    // the track loaded last, only used on the message thread
+    juce::URL loadedURL;
+    
+    // Decoded audio around the start of the track and the hot cues
+    PreRollCache preRollCache {formatManager};
+    
+    // Handles the hot cues and loops of the track, between the reader and the transport
+    CueLoopSource cueLoopSource;
+    
+    // the tempo of the loaded track in beats per minute and its first beat
+    // in seconds, the effects and the sync read them on the audio thread. The
+    // tempo is 0 until it is known, the effects then run at 120 BPM
+    std::atomic<double> trackBpm {0.0};
+    std::atomic<double> firstBeat {0.0};
     
     // An audio source that takes a track and allows it to be played, stopped etc.
     juce::AudioTransportSource transportSource;
     
+    // Times the transport source, which is where the file gets decoded
+    ProfiledAudioSource decodeTimer {&transportSource};
+    
     // A type of AudioSource that takes an input source and changes its sample rate
-    juce::ResamplingAudioSource resampleSource {&transportSource, false, 2};
+    juce::ResamplingAudioSource resampleSource {&decodeTimer, false, 2};
+    
+    // Plays the track backwards and follows the jog wheel
+    ScratchEngine scratchEngine {formatManager};
+    
+    // the speed set by the user, negative plays backwards
+    std::atomic<double> speed {1.0};
+    
+    // the clock the deck follows while synced, the speed it plays at to
+    // follow it, and how far off the beat it was
+    MasterClock* masterClock = nullptr;
+    std::atomic<bool> syncEnabled {false};
+    std::atomic<double> syncSpeed {0.0};
+    std::atomic<double> syncPhaseError {0.0};
+    // the total gain of the block being rendered, only written by the audio
+    // thread, and the gain the scratch engine last played at
+    std::atomic<float> gain {1.0f};
+    float scratchGain = 1.0f;
+    
+    // the gain of the volume slider, the auto gain is applied on top of it
+    std::atomic<double> userGain {1.0};
+    // the auto gain, worked out once per track so it costs nothing while playing
+    bool autoGainEnabled = true;
+    double targetLoudness = -14.0;
+    double autoGainDecibels = 0.0;
+    std::atomic<double> autoGainFactor {1.0};
+    // the loudness of the loaded track, if it has been measured
+    bool hasTrackLoudness = false;
+    float trackLufs = -100.0f;
+    float trackTruePeak = -100.0f;
+    // true while the scratch engine plays instead of the transport source
+    std::atomic<bool> scratching {false};
+    
+    // true if the deck is sent to the cue bus
+    std::atomic<bool> cueEnabled {false};
+    
+    // the controls on their way to the audio thread, the lock only keeps
+    // two senders apart and is never taken by the audio thread
+    struct ControlEvent
+    {
+        Control control;
+        float value;
+        int index;
+    };
+    juce::AbstractFifo controlFifo {256};
+    std::array<ControlEvent, 256> controlEvents;
+    juce::SpinLock controlLock;
+    std::atomic<double> lastControlMillis {0.0};
+    // a start or stop sent by a play control that the message thread has not
+    // applied yet, the deck is silent while a stop is pending
+    std::atomic<bool> playPending {false};
+    std::atomic<bool> playWanted {false};
+    
+    // the starts of the transport seen by the audio thread, the time is
+    // stored before the count so a reader seeing the count sees the time
+    bool wasPlaying = false;
+    std::atomic<int> numStarts {0};
+    std::atomic<juce::int64> lastStartMillis {0};
+    
+    // the low, mid and high EQ on the output
+    DeckEqualiser equaliser;
+    
+    // the filter, flanger, gate, echo and reverb on the output
+    EffectsRack effectsRack;
+    
+    // measures the spectrum, levels and loudness of the output
+    AudioAnalyser analyser;
+    
+    // the background threads the next track is opened on
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+    // the hidden slot holding the next track, null if empty
+    std::unique_ptr<TrackPreloader> preloader;
+    
+    // the profiler and the stages the resampling and the EQ are timed as
+    AudioProfiler* profiler = nullptr;
+    int resampleStage = -1;
+    int eqStage = -1;
 };
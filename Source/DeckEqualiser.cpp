@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    DeckEqualiser.cpp
+    Created: 19 Oct 2026 10:41:53pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "DeckEqualiser.h"
+
+DeckEqualiser::DeckEqualiser()
+{
+    for (auto& gain : gains)
+        gain = 0.0f;
+
+    appliedGains.fill(0.0f);
+}
+
+DeckEqualiser::~DeckEqualiser() {}
+
+// the name of a band
+juce::String DeckEqualiser::getBandName(int band)
+{
+    switch (band) {
+        case low:  return "LOW";
+        case mid:  return "MID";
+        case high: return "HIGH";
+        default:   return {};
+    }
+}
+
+//==============================================================================
+// set the gain of a band
+void DeckEqualiser::setGain(int band, float decibels)
+{
+    if (! juce::isPositiveAndBelow(band, (int) numBands)) {
+        std::cout << "DeckEqualiser::setGain  there is no band " << band << std::endl;
+        return;
+    }
+
+    gains[(size_t) band] = juce::jlimit(minDecibels, maxDecibels, decibels);
+}
+
+// the gain of a band
+float DeckEqualiser::getGain(int band) const
+{
+    return juce::isPositiveAndBelow(band, (int) numBands) ? gains[(size_t) band].load() : 0.0f;
+}
+
+//==============================================================================
+// tell the filters the rate they run at
+void DeckEqualiser::prepare(double _sampleRate)
+{
+    sampleRate = _sampleRate;
+
+    for (int band = 0; band < numBands; ++band) {
+        appliedGains[(size_t) band] = gains[(size_t) band];
+
+        for (auto& filter : filters[(size_t) band]) {
+            filter.setCoefficients(makeCoefficients(band, appliedGains[(size_t) band]));
+            filter.reset();
+        }
+    }
+}
+
+// run the bands that are not flat
+void DeckEqualiser::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    auto numChannels = juce::jmin(2, buffer.getNumChannels());
+
+    for (int band = 0; band < numBands; ++band) {
+        auto& bandFilters = filters[(size_t) band];
+        auto gain = gains[(size_t) band].load();
+
+        // new coefficients only when the gain has moved, the coefficients
+        // are made on the stack so this does not allocate
+        if (gain != appliedGains[(size_t) band]) {
+            // a band coming back from flat starts without the memory of
+            // the last time it ran
+            if (appliedGains[(size_t) band] == 0.0f)
+                for (auto& filter : bandFilters)
+                    filter.reset();
+
+            appliedGains[(size_t) band] = gain;
+            auto coefficients = makeCoefficients(band, gain);
+
+            for (auto& filter : bandFilters)
+                filter.setCoefficients(coefficients);
+        }
+
+        if (gain == 0.0f)
+            continue;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            bandFilters[(size_t) channel].processSamples(buffer.getWritePointer(channel, startSample), numSamples);
+    }
+}
+
+//==============================================================================
+// the coefficients of a band for a gain
+juce::IIRCoefficients DeckEqualiser::makeCoefficients(int band, float decibels) const
+{
+    auto gainFactor = juce::Decibels::decibelsToGain(decibels, minDecibels - 1.0f);
+
+    switch (band) {
+        case low:  return juce::IIRCoefficients::makeLowShelf(sampleRate, 250.0, 0.7, gainFactor);
+        case mid:  return juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 0.7, gainFactor);
+        default:   return juce::IIRCoefficients::makeHighShelf(sampleRate, 4000.0, 0.7, gainFactor);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    DeckEqualiser.h
+    Created: 19 Oct 2026 10:41:53pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ The three band EQ of a deck: a low shelf at 250 Hz, a bell at 1 kHz and a
+ high shelf at 4 kHz, from a kill at -26 dB up to +6 dB.
+
+ The gains are atomics the audio thread reads at the start of every block,
+ and the filters are only given new coefficients when a gain has moved. A
+ band left at 0 dB is not run at all.
+*/
+class DeckEqualiser
+{
+public:
+    DeckEqualiser();
+    ~DeckEqualiser();
+
+    /** The bands, from low to high */
+    enum Band { low = 0, mid, high, numBands };
+
+    /** The range of the gain of a band in dB */
+    static constexpr float minDecibels = -26.0f;
+    static constexpr float maxDecibels = 6.0f;
+
+    /** Returns the name of a band */
+    static juce::String getBandName(int band);
+
+    /** Sets the gain of a band in dB, safe on any thread */
+    void setGain(int band, float decibels);
+    /** Returns the gain of a band in dB */
+    float getGain(int band) const;
+
+    /** Tells the filters the rate they run at, before the audio starts */
+    void prepare(double sampleRate);
+    /** Runs the bands that are not flat over part of a buffer. Audio thread */
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    /** Works out the coefficients of a band for a gain */
+    juce::IIRCoefficients makeCoefficients(int band, float decibels) const;
+
+    // the gain set for every band, and the gain its filters were made for
+    std::array<std::atomic<float>, numBands> gains;
+    std::array<float, numBands> appliedGains;
+
+    // one filter per band and side
+    std::array<std::array<juce::IIRFilter, 2>, numBands> filters;
+
+    double sampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckEqualiser)
+};
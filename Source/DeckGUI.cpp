@@ -16,7 +16,9 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
                  juce::AudioFormatManager& formatManagerToUse,
                  juce::AudioThumbnailCache& cacheToUse
 ) : player(_player), // initialize player
-    waveformDisplay(formatManagerToUse, cacheToUse) // initialize waveform display component
+    waveformDisplay(formatManagerToUse, cacheToUse), // initialize waveform display component
+    jogWheel(_player), // initialize the jog wheel
+    meters(_player->getAnalyser(), false) // initialize the meters
 {
     // make the play button component visible to the screen
     addAndMakeVisible(playButton);
@@ -24,6 +26,48 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     addAndMakeVisible(stopButton);
     // make the Load button component visible to the screen
     addAndMakeVisible(loadButton);
+    // make the cue button visible, it stays on until clicked again
+    addAndMakeVisible(cueButton);
+    cueButton.setClickingTogglesState(true);
+    cueButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::orange);
+    // make the sync button visible, it stays on until clicked again
+    addAndMakeVisible(syncButton);
+    syncButton.setClickingTogglesState(true);
+    
+    // add a button for every hot cue
+    for (int i = 0; i < CueLoopSource::numHotCues; ++i) {
+        auto* button = hotCueButtons.add(new juce::TextButton{juce::String(i + 1)});
+        button->addListener(this);
+        addAndMakeVisible(button);
+    }
+    
+    // add a button for every loop length
+    for (auto beats : loopBeats) {
+        auto* button = loopButtons.add(new juce::TextButton{"LOOP " + juce::String(beats)});
+        button->addListener(this);
+        addAndMakeVisible(button);
+    }
+    
+    // add and make the roll button visible
+    addAndMakeVisible(rollButton);
+    rollButton.addListener(this);
+    
+    // add a button for every effect, it stays on until clicked again
+    for (int i = 0; i < EffectsRack::numEffects; ++i) {
+        auto* button = effectButtons.add(new juce::TextButton{EffectsRack::getEffectName(i)});
+        button->setClickingTogglesState(true);
+        button->setColour(juce::TextButton::buttonOnColourId, juce::Colours::orange);
+        button->addListener(this);
+        addAndMakeVisible(button);
+    }
+    // the amount slider moves the effect picked last
+    addAndMakeVisible(effectAmountSlider);
+    effectAmountSlider.addListener(this);
+    effectAmountSlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+    effectAmountSlider.setRange(0.0, 1.0);
+    effectAmountSlider.setValue(player->getEffectsRack().getEffectAmount(selectedEffect),
+                                juce::NotificationType::dontSendNotification);
+    updateEffectButtons();
     // add and make the volume label visible
     addAndMakeVisible(volumeLabel);
     // make the volume slider component visible to the screen
@@ -38,6 +82,10 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     addAndMakeVisible(posSlider);
     // add and make visible the waveform display component
     addAndMakeVisible(waveformDisplay);
+    // add and make visible the jog wheel
+    addAndMakeVisible(jogWheel);
+    // the meters cover the waveform and are hidden until turned on
+    addChildComponent(meters);
     startTimer(500);
     
     // add a button event listener to the play button
@@ -46,6 +94,10 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     stopButton.addListener(this);
     // add a button event listener to the load button
     loadButton.addListener(this);
+    // add a button event listener to the cue button
+    cueButton.addListener(this);
+    // add a button event listener to the sync button
+    syncButton.addListener(this);
     // add a slider event listener to the volume slider
     volumeSlider.addListener(this);
     // add a slider event listener to the speed slider
@@ -69,8 +121,9 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     
     // set the range of the volume slider from 0 to 1
     volumeSlider.setRange(0.0, 1.0);
-    // set the range of the speed slider from 1 to 10
-    speedSlider.setRange(1.0, 10.0);
+    // set the range of the speed slider from -4 to 10, below 0 plays backwards
+    speedSlider.setRange(-4.0, 10.0);
+    speedSlider.setValue(1.0, juce::NotificationType::dontSendNotification);
     // set the range of the position slider from 0 to 1
     posSlider.setRange(0.0, 1.0);
     
@@ -103,34 +156,62 @@ void DeckGUI::paint (juce::Graphics& g)
 // called when the component size changes
 void DeckGUI::resized()
 {
-    // divide the screen into 8 parts
-    double rowH = getHeight()/8;
+    // divide the screen into 11 parts
+    double rowH = getHeight()/11;
     
     // set the x, y, width and height of the play button
-    playButton.setBounds(10, 10, getWidth()/2 - 11, rowH - 10);
+    playButton.setBounds(10, 10, getWidth()/4 - 11, rowH - 10);
     // set the x, y, width and height of the stop button
-    stopButton.setBounds(getWidth()/2 + 1, 10, getWidth()/2 - 10, rowH - 10);
+    stopButton.setBounds(getWidth()/4 + 1, 10, getWidth()/4 - 2, rowH - 10);
+    // set the x, y, width and height of the cue button
+    cueButton.setBounds(getWidth()/2 + 1, 10, getWidth()/4 - 2, rowH - 10);
+    // set the x, y, width and height of the sync button
+    syncButton.setBounds(getWidth()*3/4 + 1, 10, getWidth()/4 - 11, rowH - 10);
+    
+    // the jog wheel sits to the right of the sliders
+    double jogSize = rowH * 3;
+    jogWheel.setBounds(getWidth() - jogSize - 5, rowH, jogSize, jogSize);
     
     // set the x, y, width and height of the volume label
     volumeLabel.setBounds(2, rowH, getWidth(), rowH);
     // set the x, y, width and height of the volume slider
-    volumeSlider.setBounds(getWidth() / 7, rowH, getWidth() - 75, rowH);
+    volumeSlider.setBounds(getWidth() / 7, rowH, getWidth() - 75 - jogSize, rowH);
     
     // set the x, y, width and height of the speed slider
     speedLabel.setBounds(2, rowH * 2, getWidth(), rowH);
     // set the x, y, width and height of the speed slider
-    speedSlider.setBounds(getWidth() / 7, rowH * 2, getWidth() - 75, rowH);
+    speedSlider.setBounds(getWidth() / 7, rowH * 2, getWidth() - 75 - jogSize, rowH);
     
     // set the x, y, width and height of the speed slider
     posLabel.setBounds(2, rowH * 3, getWidth(), rowH);
     // set the x, y, width and height of the speed slider
-    posSlider.setBounds(getWidth() / 7, rowH * 3, getWidth() - 75, rowH);
+    posSlider.setBounds(getWidth() / 7, rowH * 3, getWidth() - 75 - jogSize, rowH);
     
     // set the x, y, width and height of the waveform display component
     waveformDisplay.setBounds(0, rowH * 4, getWidth(), rowH * 3);
+    // the meters sit on top of the waveform
+    meters.setBounds(0, rowH * 4, getWidth(), rowH * 3);
+    
+    // the hot cue buttons share a row
+    auto cueW = (getWidth() - 20) / hotCueButtons.size();
+    for (int i = 0; i < hotCueButtons.size(); ++i)
+        hotCueButtons[i]->setBounds(10 + cueW * i, rowH * 7 + 5, cueW - 2, rowH - 5);
+    
+    // the loop buttons and the roll button share a row
+    auto loopW = (getWidth() - 20) / (loopButtons.size() + 1);
+    for (int i = 0; i < loopButtons.size(); ++i)
+        loopButtons[i]->setBounds(10 + loopW * i, rowH * 8 + 5, loopW - 2, rowH - 5);
+    rollButton.setBounds(10 + loopW * loopButtons.size(), rowH * 8 + 5, loopW - 2, rowH - 5);
+    
+    // the effect buttons take two thirds of a row and the amount slider the rest
+    auto effectW = (getWidth() * 2 / 3 - 10) / effectButtons.size();
+    for (int i = 0; i < effectButtons.size(); ++i)
+        effectButtons[i]->setBounds(10 + effectW * i, rowH * 9 + 5, effectW - 2, rowH - 5);
+    effectAmountSlider.setBounds(10 + effectW * effectButtons.size(), rowH * 9 + 5,
+                                 getWidth() - 20 - effectW * effectButtons.size(), rowH - 5);
     
     // set the x, y, width and height of the load button
-    loadButton.setBounds(10, rowH * 7 + 10, getWidth() - 20, rowH - 10);
+    loadButton.setBounds(10, rowH * 10 + 5, getWidth() - 20, rowH - 10);
 }
 
 // Button event listener
@@ -146,8 +227,30 @@ void DeckGUI::buttonClicked(juce::Button* button) {
         player->stop();
     }
     // check if the clicked button pointer passed has the same
+    // address as the cueButton
+    if (button == &cueButton) {
+        player->setCueEnabled(cueButton.getToggleState());
+    }
+    // check if the clicked button pointer passed has the same
+    // address as the syncButton
+    if (button == &syncButton) {
+        player->setSyncEnabled(syncButton.getToggleState());
+    }
+    // check if the clicked button pointer passed has the same
     // address as the loadButton
     if (button == &loadButton) {
+        // a queued track is swapped in, shift click empties the slot instead
+        if (! player->getPreloadedURL().isEmpty()) {
+            if (juce::ModifierKeys::getCurrentModifiers().isShiftDown()) {
+                player->clearPreload();
+                waveformDisplay.clearPreload();
+                updateLoadButton();
+            }
+            else {
+                loadURL(player->getPreloadedURL());
+            }
+            return;
+        }
         // open file selector
         juce::FileChooser chooser{"Select a file..."};
         // check if a file is choosen
@@ -156,6 +259,60 @@ void DeckGUI::buttonClicked(juce::Button* button) {
             loadURL(juce::URL{file});
         }
     }
+    // check if one of the hot cue buttons was clicked
+    auto cue = hotCueButtons.indexOf(button);
+    if (cue >= 0) {
+        // shift click clears the cue, otherwise jump to it or set it
+        if (juce::ModifierKeys::getCurrentModifiers().isShiftDown())
+            player->clearHotCue(cue);
+        else if (player->hasHotCue(cue))
+            player->triggerHotCue(cue);
+        else
+            player->setHotCue(cue);
+        
+        updateCueLoopButtons();
+    }
+    // check if one of the loop buttons was clicked
+    auto loop = loopButtons.indexOf(button);
+    if (loop >= 0) {
+        // clicking the active loop again exits it
+        if (player->isLoopActive() && activeLoopBeats == loopBeats[loop]) {
+            player->exitLoop();
+            activeLoopBeats = 0.0;
+        }
+        else {
+            player->setBeatLoop(loopBeats[loop], false);
+            activeLoopBeats = loopBeats[loop];
+        }
+        
+        updateCueLoopButtons();
+    }
+    // check if one of the effect buttons was clicked
+    auto effect = effectButtons.indexOf(button);
+    if (effect >= 0) {
+        // the effect fades in or out, and the amount slider moves it from now on
+        player->getEffectsRack().setEffectEnabled(effect, button->getToggleState());
+        selectedEffect = effect;
+        effectAmountSlider.setValue(player->getEffectsRack().getEffectAmount(effect),
+                                    juce::NotificationType::dontSendNotification);
+        updateEffectButtons();
+    }
+}
+
+// called when a button is pressed or released
+void DeckGUI::buttonStateChanged(juce::Button* button) {
+    // the roll plays while the roll button is held down
+    if (button == &rollButton) {
+        auto down = rollButton.isDown();
+        
+        // only act when the button goes down or comes back up
+        if (down && ! rolling)
+            player->setBeatLoop(0.25, true);
+        else if (! down && rolling)
+            player->exitLoop();
+        
+        rolling = down;
+    }
 }
 
 // slider event listener
@@ -177,6 +334,11 @@ void DeckGUI::sliderValueChanged (juce::Slider* slider) {
         // set the position in seconds of the audio the value of the posSlider
         player->setPositionRelative(slider->getValue());
     }
+    // check if the slider pointer passed has the same
+    // address as the effectAmountSlider
+    if (slider == &effectAmountSlider) {
+        player->getEffectsRack().setEffectAmount(selectedEffect, (float) slider->getValue());
+    }
 }
 
 // check whether this target is interested in the set of files being offered
@@ -196,12 +358,151 @@ void DeckGUI::filesDropped (const juce::StringArray &files, int x, int y) {
 // a callback that gets called periodically
 void DeckGUI::timerCallback () {
     waveformDisplay.setPositionRelative(player->getPositionRelative());
+    
+    // the loop ends when the deck jumps away, so forget it
+    if (! player->isLoopActive() && ! rolling)
+        activeLoopBeats = 0.0;
+    
+    updateCueLoopButtons();
+    updateLoadButton();
+    
+    // the player counts its starts, starts closer together than the timer
+    // are passed on as the last one
+    auto numStarts = player->getNumStarts();
+    if (numStarts != lastNumStarts) {
+        lastNumStarts = numStarts;
+        
+        if (onPlayStarted != nullptr)
+            onPlayStarted(player->getLastStartMillis());
+    }
+    
+    // a MIDI controller moves the deck without the GUI, so the GUI follows
+    // the deck unless it is being dragged
+    if (! volumeSlider.isMouseButtonDown())
+        volumeSlider.setValue(player->getGain(), juce::NotificationType::dontSendNotification);
+    if (! speedSlider.isMouseButtonDown())
+        speedSlider.setValue(player->getSpeed(), juce::NotificationType::dontSendNotification);
+    cueButton.setToggleState(player->isCueEnabled(), juce::NotificationType::dontSendNotification);
+    syncButton.setToggleState(player->isSyncEnabled(), juce::NotificationType::dontSendNotification);
+    // the effects too, such as when a session is restored
+    if (! effectAmountSlider.isMouseButtonDown())
+        effectAmountSlider.setValue(player->getEffectsRack().getEffectAmount(selectedEffect),
+                                    juce::NotificationType::dontSendNotification);
+    updateEffectButtons();
+    
+    // the sync button is green once the deck is on the beat of the clock,
+    // orange while it catches up
+    auto locked = player->isPlaying() && std::abs(player->getSyncPhaseError()) < 0.02;
+    syncButton.setColour(juce::TextButton::buttonOnColourId,
+                         locked ? juce::Colours::green : juce::Colours::orange);
+}
+
+// colour the effect buttons to show what is on and what is picked
+void DeckGUI::updateEffectButtons() {
+    auto& rack = player->getEffectsRack();
+    
+    for (int i = 0; i < effectButtons.size(); ++i) {
+        auto* button = effectButtons[i];
+        button->setToggleState(rack.isEffectEnabled(i), juce::NotificationType::dontSendNotification);
+        
+        // the picked effect has yellow text
+        auto text = i == selectedEffect ? juce::Colours::yellow : juce::Colours::white;
+        button->setColour(juce::TextButton::textColourOffId, text);
+        button->setColour(juce::TextButton::textColourOnId, text);
+    }
+}
+
+// colour the hot cue and loop buttons to show what is set
+void DeckGUI::updateCueLoopButtons() {
+    // a set hot cue is coloured
+    for (int i = 0; i < hotCueButtons.size(); ++i) {
+        auto colour = player->hasHotCue(i) ? juce::Colours::orange : juce::Colours::darkgrey;
+        hotCueButtons[i]->setColour(juce::TextButton::buttonColourId, colour);
+    }
+    
+    // the active loop is coloured
+    for (int i = 0; i < loopButtons.size(); ++i) {
+        auto active = activeLoopBeats == loopBeats[i];
+        loopButtons[i]->setColour(juce::TextButton::buttonColourId,
+                                  active ? juce::Colours::green : juce::Colours::darkgrey);
+    }
+}
+
+// show the track waiting in the preload slot on the load button
+void DeckGUI::updateLoadButton() {
+    auto next = player->getPreloadedURL();
+    
+    // the plain load button when the slot is empty
+    if (next.isEmpty()) {
+        loadButton.setButtonText("LOAD");
+        loadButton.removeColour(juce::TextButton::buttonColourId);
+        return;
+    }
+    
+    // green once the track can be swapped in instantly
+    loadButton.setButtonText("LOAD NEXT: " + next.getFileName());
+    loadButton.setColour(juce::TextButton::buttonColourId,
+                         player->isPreloadReady() ? juce::Colours::green : juce::Colours::orange);
 }
 
 // function to load a file into the player and wave form display
 void DeckGUI::loadURL(juce::URL url) {
-    // load the file in the audio player
-    player->loadURL(url);
+    // load the file in the audio player, straight from the preload slot if
+    // the track is waiting there
+    if (! url.isEmpty() && url == player->getPreloadedURL()) {
+        player->loadPreloaded();
+    }
+    else {
+        player->clearPreload();
+        player->loadURL(url);
+    }
     // load the file into the waveformdispaly component
     waveformDisplay.loadURL(url);
+    updateLoadButton();
+    
+    // let the playlist pass on what it knows about the track
+    if (onTrackLoaded != nullptr)
+        onTrackLoaded(url);
+}
+
+// show a track loaded into the player from elsewhere
+void DeckGUI::showTrack(juce::URL url) {
+    waveformDisplay.loadURL(url);
+    speedSlider.setValue(player->getSpeed(), juce::NotificationType::dontSendNotification);
+    updateLoadButton();
+    
+    if (onTrackLoaded != nullptr)
+        onTrackLoaded(url);
+}
+
+// queue a track in the preload slot
+void DeckGUI::preloadURL(juce::URL url) {
+    player->preloadURL(url);
+    waveformDisplay.preloadURL(url);
+    updateLoadButton();
+}
+
+// check if the deck is playing
+bool DeckGUI::isPlaying() const {
+    return player->isPlaying();
+}
+
+// the speed of the player
+double DeckGUI::getSpeed() const {
+    return player->getSpeed();
+}
+
+// pass the loudness of the loaded track on to the player
+void DeckGUI::setTrackLoudness(float integratedLufs, float truePeakDb) {
+    player->setTrackLoudness(integratedLufs, truePeakDb);
+}
+
+// pass the tempo of the loaded track on to the player
+void DeckGUI::setTrackBpm(double bpm) {
+    player->setTrackBpm(bpm);
+}
+
+// show or hide the spectrum and meters
+void DeckGUI::setMetersVisible(bool visible) {
+    meters.setVisible(visible);
 }
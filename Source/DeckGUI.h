@@ -13,6 +13,8 @@
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "JogWheel.h"
+#include "AnalyserDisplay.h"
 
 //==============================================================================
 /*
@@ -39,6 +41,8 @@ public:
 
     /** function called when a button is clicked  */
     void buttonClicked (juce::Button *) override;
+    /** function called when a button is pressed or released */
+    void buttonStateChanged (juce::Button *) override;
     
     /** function called when the slider value changes  */
     void sliderValueChanged (juce::Slider* slider) override;
@@ -57,15 +61,80 @@ public:
     */
     void loadURL(juce::URL url);
     
+    /** Shows a track that was loaded into the player without the deck, such
+        as by the automix, with the speed it was set to */
+    void showTrack(juce::URL url);
+    
+    /** Queues a track in the hidden preload slot of the deck. It is opened,
+        its intro decoded and its waveform worked out in the background, and
+        the LOAD button then swaps it in instantly */
+    void preloadURL(juce::URL url);
+    
+    /** Returns true while the deck is playing */
+    bool isPlaying() const;
+    /** Returns the speed the deck plays at, 1 for the tempo of the track */
+    double getSpeed() const;
+    
+    /** Called on the message thread after a track has been loaded into the
+        deck, however it was loaded */
+    std::function<void(const juce::URL&)> onTrackLoaded;
+    /** Called on the message thread after the deck has started playing,
+        however it was started, with the time in milliseconds since 1970 */
+    std::function<void(juce::int64)> onPlayStarted;
+    
+    /** Passes the measured loudness of the loaded track on to the auto gain */
+    void setTrackLoudness(float integratedLufs, float truePeakDb);
+    /** Passes the tempo of the loaded track on to the loops and the effects */
+    void setTrackBpm(double bpm);
+    
+    /** Shows or hides the spectrum and meters over the waveform */
+    void setMetersVisible(bool visible);
+    
 private:
     // private members go here
     
+    /** Colours the hot cue and loop buttons to show what is set */
+    void updateCueLoopButtons();
+    /** Shows the track waiting in the preload slot on the load button */
+    void updateLoadButton();
+    /** Colours the effect buttons to show which effects are on and which
+        one the amount slider moves */
+    void updateEffectButtons();
+    
     // play button
     juce::TextButton playButton{"PLAY"};
     // stop button
     juce::TextButton stopButton{"STOP"};
     // Load button
     juce::TextButton loadButton{"LOAD"};
+    // cue button, sends the deck to the headphones
+    juce::TextButton cueButton{"CUE"};
+    // sync button, locks the deck to the master clock
+    juce::TextButton syncButton{"SYNC"};
+    
+    // hot cue buttons, click to set or jump, shift click to clear
+    juce::OwnedArray<juce::TextButton> hotCueButtons;
+    // beat loop buttons, click again to exit the loop
+    juce::OwnedArray<juce::TextButton> loopButtons;
+    // the length in beats of each loop button
+    const juce::Array<double> loopBeats {1.0, 2.0, 4.0, 8.0};
+    // the length in beats of the loop started from this deck, 0 if none
+    double activeLoopBeats = 0.0;
+    // loop roll button, rolls a quarter beat while held down
+    juce::TextButton rollButton{"ROLL"};
+    // true while the roll button is held down
+    bool rolling = false;
+    
+    // the starts of the player already passed on to onPlayStarted
+    int lastNumStarts = 0;
+    
+    // effect buttons, click to turn an effect on or off and pick it for the
+    // amount slider
+    juce::OwnedArray<juce::TextButton> effectButtons;
+    // the amount of the picked effect
+    juce::Slider effectAmountSlider{};
+    // the effect the amount slider moves
+    int selectedEffect = EffectsRack::filter;
     
     // label for volume slider
     juce::Label volumeLabel;
@@ -88,5 +157,11 @@ private:
     // implement the WaveformDisplay component in the DeckGUI component
     WaveformDisplay waveformDisplay;
     
+    // platter for scratching the deck
+    JogWheel jogWheel;
+    
+    // spectrum and meters of the deck, hidden until turned on
+    AnalyserDisplay meters;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI)
 };
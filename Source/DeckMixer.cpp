@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    DeckMixer.cpp
+    Created: 19 Oct 2026 11:48:52am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "DeckMixer.h"
+
+DeckMixer::DeckMixer() {}
+
+DeckMixer::~DeckMixer() {}
+
+//==============================================================================
+// add a deck to the mix
+void DeckMixer::addDeck(DJAudioPlayer* deck)
+{
+    // a deck can only be mixed in once
+    decks.addIfNotAlreadyThere(deck);
+    deck->setMasterClock(&masterClock);
+}
+
+// the number of decks in the mix
+int DeckMixer::getNumDecks() const
+{
+    return decks.size();
+}
+
+// the index of a deck in the mix
+int DeckMixer::getDeckIndex(DJAudioPlayer* deck) const
+{
+    return decks.indexOf(deck);
+}
+
+// split a stereo output into cue and master
+void DeckMixer::setSplitCue(bool split)
+{
+    splitCue = split;
+}
+
+// check if a stereo output is split
+bool DeckMixer::isSplitCue() const
+{
+    return splitCue;
+}
+
+// the analyser that measures the master output
+AudioAnalyser& DeckMixer::getMasterAnalyser()
+{
+    return masterAnalyser;
+}
+
+// the scheduler that runs the transitions of the automix
+MixScheduler& DeckMixer::getScheduler()
+{
+    return scheduler;
+}
+
+// the clock the synced decks follow
+MasterClock& DeckMixer::getMasterClock()
+{
+    return masterClock;
+}
+
+// register the mix with the profiler
+void DeckMixer::setProfiler(AudioProfiler* _profiler)
+{
+    profiler = _profiler;
+    mixStage = profiler != nullptr ? profiler->addStage("Mix") : -1;
+}
+
+//==============================================================================
+// tells the source to prepare for playing
+void DeckMixer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    // allocate the deck and cue buffers up front so the mix never has to
+    deckBuffer.setSize(2, samplesPerBlockExpected);
+    cueBuffer.setSize(2, samplesPerBlockExpected);
+    masterAnalyser.prepare(sampleRate);
+    scheduler.prepare(sampleRate);
+    masterClock.prepare(sampleRate);
+
+    // let every deck prepare to play the audio
+    for (auto* deck : decks)
+        deck->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+// called repeatedly to fetch subsequent blocks of audio data
+void DeckMixer::getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // time the mix, the decks inside it are timed on their own
+    AudioProfiler::ScopedStage stage {profiler, mixStage};
+
+    bufferToFill.clearActiveBufferRegion();
+
+    auto* output = bufferToFill.buffer;
+    auto numChannels = juce::jmin(output->getNumChannels(), deckBuffer.getNumChannels());
+
+    // where the cue bus goes depends on the number of outputs
+    auto cueToOutputs = output->getNumChannels() >= 4;
+    auto cueToSplit = ! cueToOutputs && output->getNumChannels() == 2 && splitCue;
+
+    // the clock picks up a new tempo once per block
+    masterClock.beginBlock(bufferToFill.numSamples);
+
+    // a device can ask for more samples than it said it would, so the block
+    // is rendered in pieces no bigger than the deck buffer
+    for (int done = 0; done < bufferToFill.numSamples;) {
+        auto numSamples = juce::jmin(bufferToFill.numSamples - done, deckBuffer.getNumSamples());
+
+        if (numSamples <= 0)
+            break;
+
+        // a transition of the automix starts or ends exactly where the piece ends
+        numSamples = scheduler.beginPiece(decks, numSamples);
+
+        auto start = bufferToFill.startSample + done;
+        cueBuffer.clear(0, numSamples);
+
+        for (int i = 0; i < decks.size(); ++i) {
+            auto* deck = decks.getUnchecked(i);
+
+            // a deck waiting for its transition is not pulled, so it does not move
+            float startGain, endGain;
+            if (! scheduler.getDeckGain(i, startGain, endGain))
+                continue;
+
+            // let the deck fill the deck buffer
+            juce::AudioSourceChannelInfo deckInfo {&deckBuffer, 0, numSamples};
+            deck->getNextAudioBlock(deckInfo);
+
+            // the crossfade of the automix
+            if (startGain != 1.0f || endGain != 1.0f)
+                deckBuffer.applyGainRamp(0, numSamples, startGain, endGain);
+
+            // add it to the output
+            for (int channel = 0; channel < numChannels; ++channel) {
+                output->addFrom(channel,
+                                start,
+                                deckBuffer,
+                                channel,
+                                0,
+                                numSamples);
+            }
+
+            // and to the cue bus if the cue of the deck is on
+            if ((cueToOutputs || cueToSplit) && deck->isCueEnabled()) {
+                for (int channel = 0; channel < cueBuffer.getNumChannels(); ++channel)
+                    cueBuffer.addFrom(channel, 0, deckBuffer, channel, 0, numSamples);
+            }
+        }
+
+        // measure the master before a split output folds it to mono
+        masterAnalyser.push(*output, start, numSamples);
+
+        if (cueToOutputs) {
+            // the cue bus has a stereo pair of its own
+            output->copyFrom(2, start, cueBuffer, 0, 0, numSamples);
+            output->copyFrom(3, start, cueBuffer, 1, 0, numSamples);
+        }
+        else if (cueToSplit) {
+            // the master in mono on the right
+            output->addFrom(1, start, *output, 0, start, numSamples);
+            output->applyGain(1, start, numSamples, 0.5f);
+
+            // the cue in mono on the left
+            output->copyFrom(0, start, cueBuffer.getReadPointer(0), numSamples, 0.5f);
+            output->addFrom(0, start, cueBuffer.getReadPointer(1), numSamples, 0.5f);
+        }
+
+        scheduler.endPiece(numSamples);
+        masterClock.advance(numSamples);
+        done += numSamples;
+    }
+}
+
+// allows source to release data that it does not need
+void DeckMixer::releaseResources()
+{
+    // let every deck release its resources
+    for (auto* deck : decks)
+        deck->releaseResources();
+
+    deckBuffer.setSize(2, 0);
+    cueBuffer.setSize(2, 0);
+}
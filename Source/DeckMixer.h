@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    DeckMixer.h
+    Created: 19 Oct 2026 11:48:52am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "AudioProfiler.h"
+#include "AudioAnalyser.h"
+#include "MixScheduler.h"
+#include "MasterClock.h"
+
+//==============================================================================
+/*
+ Mixes the output of a number of decks. Every deck renders into a buffer that
+ is allocated in prepareToPlay, so the mix itself never allocates.
+
+ Decks with their cue turned on are also mixed into a cue bus for the
+ headphones, in the same pass. The master goes to the first two outputs. On a
+ device with four or more outputs the cue bus goes to the third and fourth, on
+ a stereo device it can be split with the cue in the left ear and the master
+ in the right, both in mono.
+
+ The automix runs its transitions through the scheduler of the mixer, which
+ can end a piece of the block at the exact sample a transition starts or ends.
+
+ The master clock is moved on by every piece as it is rendered, so a synced
+ deck reads the beat of the first sample of its piece.
+*/
+class DeckMixer : public juce::AudioSource
+{
+public:
+    DeckMixer();
+    ~DeckMixer() override;
+
+    /** Adds a deck to the mix, call this before the audio starts */
+    void addDeck(DJAudioPlayer* deck);
+    /** Returns the number of decks in the mix */
+    int getNumDecks() const;
+    /** Returns the index of a deck in the mix, or -1 if it is not in it */
+    int getDeckIndex(DJAudioPlayer* deck) const;
+
+    /** Splits a stereo output into the cue on the left and the master on the right */
+    void setSplitCue(bool split);
+    /** Returns true if a stereo output is split */
+    bool isSplitCue() const;
+
+    /** Returns the analyser that measures the master output */
+    AudioAnalyser& getMasterAnalyser();
+    /** Returns the scheduler that runs the transitions of the automix */
+    MixScheduler& getScheduler();
+    /** Returns the clock the synced decks follow */
+    MasterClock& getMasterClock();
+
+    /** Times the mix as a stage of the profiler */
+    void setProfiler(AudioProfiler* profiler);
+
+    /** Tells the source to prepare for playing */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    /** Called repeatedly to fetch subsequent blocks of audio data */
+    void getNextAudioBlock (const juce::AudioSourceChannelInfo& bufferToFill) override;
+    /** Allows the source to release anything it no longer needs after playback has stopped */
+    void releaseResources() override;
+
+private:
+    // the decks being mixed
+    juce::Array<DJAudioPlayer*> decks;
+
+    // every deck renders into this buffer before it is added to the mix
+    juce::AudioBuffer<float> deckBuffer;
+    // the decks with their cue turned on are added up here
+    juce::AudioBuffer<float> cueBuffer;
+
+    // true if a stereo output is split into cue and master
+    std::atomic<bool> splitCue {false};
+
+    // measures the spectrum, levels and loudness of the master
+    AudioAnalyser masterAnalyser;
+
+    // starts and crossfades the decks of the automix at exact samples
+    MixScheduler scheduler;
+
+    // the tempo and the beat the synced decks follow
+    MasterClock masterClock;
+
+    // the profiler and the stage the mix is timed as
+    AudioProfiler* profiler = nullptr;
+    int mixStage = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckMixer)
+};
@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    DuplicateIndex.cpp
+    Created: 20 Oct 2026 12:31:47am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "DuplicateIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // the signature is cut into bands of two values, two tracks half alike
+    // share a band with a chance of one in four, and one of 32 almost surely
+    const int rowsPerBand = 2;
+    const int numBands = AudioFingerprint::numHashes / rowsPerBand;
+    // a band shared by more tracks than this is skipped
+    const size_t maxBucketSize = 64;
+}
+
+//==============================================================================
+// find the tracks that sound the same
+std::vector<DuplicateIndex::Group> DuplicateIndex::findGroups(const std::vector<Entry>& entries,
+                                                              const std::function<bool()>& shouldStop)
+{
+    // the tracks with landmarks, silent tracks are not duplicates of each other
+    std::vector<int> valid;
+    valid.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].fingerprint.isValid())
+            valid.push_back((int) i);
+
+    // the tracks sorted by one band, and the candidates as two entries in one number
+    std::vector<std::pair<juce::uint64, int>> bands (valid.size());
+    std::vector<juce::uint64> candidates;
+
+    for (int band = 0; band < numBands; ++band) {
+        if (shouldStop())
+            return {};
+
+        for (size_t n = 0; n < valid.size(); ++n) {
+            auto& signature = entries[(size_t) valid[n]].fingerprint.signature;
+            auto first = (size_t) (band * rowsPerBand);
+            bands[n] = {((juce::uint64) signature[first] << 32) | signature[first + 1], valid[n]};
+        }
+
+        std::sort(bands.begin(), bands.end());
+
+        // the tracks with an equal band are next to each other, in entry order
+        for (size_t start = 0; start < bands.size();) {
+            auto end = start + 1;
+            while (end < bands.size() && bands[end].first == bands[start].first)
+                ++end;
+
+            if (end - start > 1 && end - start <= maxBucketSize)
+                for (auto a = start; a < end; ++a)
+                    for (auto b = a + 1; b < end; ++b)
+                        candidates.push_back(((juce::uint64) bands[a].second << 32) | (juce::uint64) bands[b].second);
+
+            start = end;
+        }
+    }
+
+    // two tracks sharing many bands are compared once
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // every entry points towards the first entry of its group
+    std::vector<int> parent (entries.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<float> lowest (entries.size(), 1.0f);
+
+    auto findFirst = [&parent] (int entry)
+    {
+        while (parent[(size_t) entry] != entry) {
+            parent[(size_t) entry] = parent[(size_t) parent[(size_t) entry]];
+            entry = parent[(size_t) entry];
+        }
+        return entry;
+    };
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (i % 4096 == 0 && shouldStop())
+            return {};
+
+        auto a = (int) (candidates[i] >> 32);
+        auto b = (int) (candidates[i] & 0xffffffffu);
+        auto similarity = AudioFingerprint::getSimilarity(entries[(size_t) a].fingerprint, entries[(size_t) b].fingerprint);
+
+        if (similarity < nearDuplicateSimilarity)
+            continue;
+
+        auto firstA = findFirst(a);
+        auto firstB = findFirst(b);
+        if (firstA == firstB)
+            continue;
+
+        // the group keeps the earlier first entry and the weakest link of both
+        auto first = juce::jmin(firstA, firstB);
+        auto other = juce::jmax(firstA, firstB);
+        parent[(size_t) other] = first;
+        lowest[(size_t) first] = juce::jmin(lowest[(size_t) first], lowest[(size_t) other], similarity);
+    }
+
+    // the groups in the order of their first entry, tracks alone are left out
+    std::vector<int> sizes (entries.size(), 0);
+    for (size_t i = 0; i < entries.size(); ++i)
+        ++sizes[(size_t) findFirst((int) i)];
+
+    std::vector<int> groupOf (entries.size(), -1);
+    std::vector<Group> groups;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto first = (size_t) findFirst((int) i);
+        if (sizes[first] < 2)
+            continue;
+
+        if (groupOf[first] < 0) {
+            groupOf[first] = (int) groups.size();
+            groups.push_back({{}, lowest[first]});
+        }
+
+        groups[(size_t) groupOf[first]].ids.push_back(entries[i].id);
+    }
+
+    return groups;
+}
+
+//==============================================================================
+DuplicateJob::DuplicateJob(std::vector<DuplicateIndex::Entry> _entries)
+: juce::ThreadPoolJob("Duplicates"),
+  entries(std::move(_entries)) {}
+
+DuplicateJob::~DuplicateJob() {}
+
+// find the duplicates
+juce::ThreadPoolJob::JobStatus DuplicateJob::runJob()
+{
+    groups = DuplicateIndex::findGroups(entries, [this] { return shouldExit(); });
+    successful = ! shouldExit();
+    finished = true;
+
+    if (onFinished != nullptr)
+        onFinished();
+
+    return jobHasFinished;
+}
+
+// check if the job is done
+bool DuplicateJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the job was not stopped
+bool DuplicateJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the groups of tracks that sound the same
+const std::vector<DuplicateIndex::Group>& DuplicateJob::getGroups() const
+{
+    return groups;
+}
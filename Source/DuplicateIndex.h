@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    DuplicateIndex.h
+    Created: 20 Oct 2026 12:31:47am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFingerprint.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Finds the tracks that sound the same among the fingerprints of a library,
+ without comparing every track with every other one.
+
+ The signature of a fingerprint is cut into bands of two values, and the
+ tracks are sorted by every band in turn. Tracks with an equal band are
+ candidates, which two tracks with many landmarks in common almost always
+ are somewhere, and two different songs hardly ever. Only the candidates are
+ compared, and the ones that are similar enough are joined into groups.
+
+ A band shared by a great many tracks, such as the one of near silence, says
+ nothing about them and is skipped.
+*/
+class DuplicateIndex
+{
+public:
+    /** A track to look for duplicates of */
+    struct Entry
+    {
+        /** The id the groups give the track by */
+        int id = 0;
+        AudioFingerprint::Fingerprint fingerprint;
+    };
+
+    /** Tracks that sound the same */
+    struct Group
+    {
+        /** The ids of the tracks, in the order they were given */
+        std::vector<int> ids;
+        /** The lowest similarity that joined a track to the group */
+        float similarity = 0.0f;
+    };
+
+    /** The similarity above which two tracks are the same recording, such as
+        one file in two formats */
+    static constexpr float duplicateSimilarity = 0.5f;
+    /** The similarity above which two tracks are near duplicates, such as an
+        edit or a remaster of the same song */
+    static constexpr float nearDuplicateSimilarity = 0.2f;
+
+    /** Returns the groups of tracks at least nearDuplicateSimilarity alike,
+        by the order of their first track. Returns nothing if shouldStop
+        stopped it */
+    static std::vector<Group> findGroups(const std::vector<Entry>& entries,
+                                         const std::function<bool()>& shouldStop);
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that finds the duplicates among the fingerprints
+ of a library, which takes a few seconds for a large one
+*/
+class DuplicateJob : public juce::ThreadPoolJob
+{
+public:
+    DuplicateJob(std::vector<DuplicateIndex::Entry> entries);
+    ~DuplicateJob() override;
+
+    /** Finds the duplicates */
+    JobStatus runJob() override;
+
+    /** Called on the pool thread when the job is done, set this before the
+        job is added to the pool */
+    std::function<void()> onFinished;
+
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the job was not stopped */
+    bool wasSuccessful() const;
+    /** Returns the groups, only use this once isFinished returns true */
+    const std::vector<DuplicateIndex::Group>& getGroups() const;
+
+private:
+    // the fingerprints of the library when the job was made
+    std::vector<DuplicateIndex::Entry> entries;
+
+    // the result and whether it is ready
+    std::vector<DuplicateIndex::Group> groups;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DuplicateJob)
+};
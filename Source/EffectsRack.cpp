@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+    EffectsRack.cpp
+    Created: 19 Oct 2026 9:52:17pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "EffectsRack.h"
+
+EffectsRack::EffectsRack() {}
+
+EffectsRack::~EffectsRack() {}
+
+// the name of an effect
+juce::String EffectsRack::getEffectName(int effect)
+{
+    switch (effect) {
+        case filter:  return "FILTER";
+        case flanger: return "FLANGER";
+        case gate:    return "GATE";
+        case echo:    return "ECHO";
+        case reverb:  return "REVERB";
+        default:      return {};
+    }
+}
+
+//==============================================================================
+// turn an effect on or off
+void EffectsRack::setEffectEnabled(int effect, bool enabled)
+{
+    if (! juce::isPositiveAndBelow(effect, (int) numEffects)) {
+        std::cout << "EffectsRack::setEffectEnabled  there is no effect " << effect << std::endl;
+        return;
+    }
+
+    slots[(size_t) effect].enabled = enabled;
+}
+
+// check if an effect is on
+bool EffectsRack::isEffectEnabled(int effect) const
+{
+    return juce::isPositiveAndBelow(effect, (int) numEffects) && slots[(size_t) effect].enabled;
+}
+
+// set the amount of an effect
+void EffectsRack::setEffectAmount(int effect, float amount)
+{
+    if (! juce::isPositiveAndBelow(effect, (int) numEffects)) {
+        std::cout << "EffectsRack::setEffectAmount  there is no effect " << effect << std::endl;
+        return;
+    }
+
+    slots[(size_t) effect].amount = juce::jlimit(0.0f, 1.0f, amount);
+}
+
+// the amount of an effect
+float EffectsRack::getEffectAmount(int effect) const
+{
+    return juce::isPositiveAndBelow(effect, (int) numEffects) ? slots[(size_t) effect].amount.load() : 0.0f;
+}
+
+// time every effect as a stage of the profiler
+void EffectsRack::setProfiler(AudioProfiler* _profiler, const juce::String& deckName)
+{
+    profiler = _profiler;
+
+    for (int effect = 0; effect < numEffects; ++effect) {
+        slots[(size_t) effect].stage = profiler != nullptr
+            ? profiler->addStage(deckName + " " + getEffectName(effect).toLowerCase())
+            : -1;
+    }
+}
+
+//==============================================================================
+// give every effect its memory
+void EffectsRack::prepare(double _sampleRate, int _maximumBlockSize)
+{
+    sampleRate = _sampleRate;
+    maximumBlockSize = juce::jmax(1, _maximumBlockSize);
+
+    juce::dsp::ProcessSpec spec {sampleRate, (juce::uint32) maximumBlockSize, 2};
+
+    lowHighPass.prepare(spec);
+    lowHighPass.setResonance(0.9f);
+
+    // the flanger sweeps between 1 and 5 ms, the echo repeats after up to two seconds
+    flangerDelay.setMaximumDelayInSamples((int) (0.01 * sampleRate) + 2);
+    flangerDelay.prepare(spec);
+    echoDelay.setMaximumDelayInSamples((int) (2.0 * sampleRate) + 2);
+    echoDelay.prepare(spec);
+    echoSamples.reset(sampleRate, 0.2);
+    echoSamples.setCurrentAndTargetValue((float) (0.375 * sampleRate));
+
+    roomReverb.prepare(spec);
+    gateGain = 1.0f;
+
+    dryBuffer.setSize(2, maximumBlockSize);
+    gains.allocate((size_t) maximumBlockSize, true);
+
+    // an effect that is on carries on without fading in again
+    for (auto& slot : slots) {
+        slot.mix.reset(sampleRate, crossfadeSeconds);
+        slot.mix.setCurrentAndTargetValue(slot.enabled ? 1.0f : 0.0f);
+        slot.needsReset = false;
+    }
+}
+
+// run the effects that are on
+void EffectsRack::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                          double bpm, double beat)
+{
+    // nothing has been allocated before prepare
+    if (maximumBlockSize == 0)
+        return;
+
+    // a deck that is stopped or scratched keeps a sensible tempo for the echo
+    if (bpm <= 0.0)
+        bpm = 120.0;
+
+    auto beatsPerSample = bpm / 60.0 / sampleRate;
+
+    // the buffers hold one prepared block
+    for (int done = 0; done < numSamples; done += maximumBlockSize) {
+        auto chunk = juce::jmin(maximumBlockSize, numSamples - done);
+        processChunk(buffer, startSample + done, chunk, bpm, beat + done * beatsPerSample);
+    }
+}
+
+//==============================================================================
+// run the effects over a part of the buffer
+void EffectsRack::processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                               double bpm, double beat)
+{
+    auto numChannels = juce::jmin(2, buffer.getNumChannels());
+
+    for (int effect = 0; effect < numEffects; ++effect) {
+        auto& slot = slots[(size_t) effect];
+        slot.mix.setTargetValue(slot.enabled ? 1.0f : 0.0f);
+
+        // an effect that is off and faded out costs nothing, its memory is
+        // cleared once so it starts clean the next time
+        if (! slot.mix.isSmoothing() && slot.mix.getCurrentValue() <= 0.0f) {
+            if (slot.needsReset) {
+                resetEffect(effect);
+                slot.needsReset = false;
+            }
+            continue;
+        }
+
+        AudioProfiler::ScopedStage stage {profiler, slot.stage};
+        slot.needsReset = true;
+
+        // the dry signal is kept while the effect fades in or out
+        auto fading = slot.mix.isSmoothing();
+        if (fading) {
+            for (int channel = 0; channel < numChannels; ++channel)
+                dryBuffer.copyFrom(channel, 0, buffer, channel, startSample, numSamples);
+        }
+
+        juce::dsp::AudioBlock<float> block {buffer.getArrayOfWritePointers(), (size_t) numChannels,
+                                            (size_t) startSample, (size_t) numSamples};
+        runEffect(effect, block, slot.amount, bpm, beat);
+
+        // dry + mix * (wet - dry), with vector operations over the whole block
+        if (fading) {
+            for (int i = 0; i < numSamples; ++i)
+                gains[i] = slot.mix.getNextValue();
+
+            for (int channel = 0; channel < numChannels; ++channel) {
+                auto* wet = buffer.getWritePointer(channel, startSample);
+                auto* dry = dryBuffer.getReadPointer(channel);
+
+                juce::FloatVectorOperations::subtract(wet, dry, numSamples);
+                juce::FloatVectorOperations::multiply(wet, gains, numSamples);
+                juce::FloatVectorOperations::add(wet, dry, numSamples);
+            }
+        }
+    }
+}
+
+// run one effect
+void EffectsRack::runEffect(int effect, juce::dsp::AudioBlock<float>& block, float amount, double bpm, double beat)
+{
+    juce::dsp::ProcessContextReplacing<float> context {block};
+
+    switch (effect) {
+        case filter: {
+            // a low pass from 20 kHz down to 20 Hz on the left half, a high
+            // pass from 20 Hz up to 20 kHz on the right half
+            auto lowPass = amount < 0.5f;
+            auto position = lowPass ? amount * 2.0f : (amount - 0.5f) * 2.0f;
+            auto cutoff = 20.0f * std::pow(1000.0f, position);
+
+            lowHighPass.setType(lowPass ? juce::dsp::StateVariableTPTFilterType::lowpass
+                                        : juce::dsp::StateVariableTPTFilterType::highpass);
+            lowHighPass.setCutoffFrequency(juce::jmin(cutoff, (float) (sampleRate * 0.45)));
+            lowHighPass.process(context);
+            break;
+        }
+
+        case flanger:
+            runFlanger(block, amount, bpm, beat);
+            break;
+
+        case gate:
+            runGate(block, amount, beat, bpm / 60.0 / sampleRate);
+            break;
+
+        case echo:
+            runEcho(block, amount, bpm);
+            break;
+
+        case reverb: {
+            juce::dsp::Reverb::Parameters parameters;
+            parameters.roomSize = 0.4f + 0.55f * amount;
+            parameters.damping = 0.5f;
+            parameters.wetLevel = 0.6f * amount;
+            parameters.dryLevel = 1.0f - 0.3f * amount;
+            parameters.width = 1.0f;
+            roomReverb.setParameters(parameters);
+            roomReverb.process(context);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// a delay swept between 1 and 5 ms once every four beats, fed back on itself
+void EffectsRack::runFlanger(juce::dsp::AudioBlock<float>& block, float amount, double bpm, double beat)
+{
+    const auto minDelay = 0.001 * sampleRate;
+    const auto depth = 0.004 * sampleRate;
+    const auto beatsPerSample = bpm / 60.0 / sampleRate;
+    const auto feedback = 0.3f + 0.6f * amount;
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i) {
+        auto cycles = (beat + (double) i * beatsPerSample) / 4.0;
+        auto sweep = 0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * cycles);
+        auto delay = (float) (minDelay + depth * sweep);
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+            auto input = block.getSample((int) channel, (int) i);
+            auto delayed = flangerDelay.popSample((int) channel, delay);
+            flangerDelay.pushSample((int) channel, input + feedback * delayed);
+            block.setSample((int) channel, (int) i, 0.7f * (input + delayed));
+        }
+    }
+}
+
+// cut the level on the second half of every quarter beat of the grid
+void EffectsRack::runGate(juce::dsp::AudioBlock<float>& block, float amount, double beat, double beatsPerSample)
+{
+    auto numSamples = (int) block.getNumSamples();
+    auto closedGain = 1.0f - amount;
+    // the edges are smoothed over about 2 ms so the gate does not click
+    auto smoothing = (float) (1.0 - std::exp(-1.0 / (0.002 * sampleRate)));
+
+    for (int i = 0; i < numSamples; ++i) {
+        auto step = (beat + i * beatsPerSample) * 4.0;
+        auto open = step - std::floor(step) < 0.5;
+        gateGain += ((open ? 1.0f : closedGain) - gateGain) * smoothing;
+        gains[i] = gateGain;
+    }
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        juce::FloatVectorOperations::multiply(block.getChannelPointer(channel), gains, numSamples);
+}
+
+// repeat the signal three quarters of a beat later, fading away
+void EffectsRack::runEcho(juce::dsp::AudioBlock<float>& block, float amount, double bpm)
+{
+    auto maximumDelay = (float) (2.0 * sampleRate);
+    echoSamples.setTargetValue(juce::jlimit(1.0f, maximumDelay, (float) (0.75 * 60.0 / bpm * sampleRate)));
+
+    const auto feedback = 0.25f + 0.5f * amount;
+    const auto wet = 0.3f + 0.5f * amount;
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i) {
+        auto delay = echoSamples.getNextValue();
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
+            auto input = block.getSample((int) channel, (int) i);
+            auto delayed = echoDelay.popSample((int) channel, delay);
+            echoDelay.pushSample((int) channel, input + feedback * delayed);
+            block.setSample((int) channel, (int) i, input + wet * delayed);
+        }
+    }
+}
+
+// clear the memory of an effect
+void EffectsRack::resetEffect(int effect)
+{
+    switch (effect) {
+        case filter:  lowHighPass.reset(); break;
+        case flanger: flangerDelay.reset(); break;
+        case gate:    gateGain = 1.0f; break;
+        case echo:    echoDelay.reset(); break;
+        case reverb:  roomReverb.reset(); break;
+        default:      break;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    EffectsRack.h
+    Created: 19 Oct 2026 9:52:17pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioProfiler.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ The effects of one deck: a filter, a flanger, a gate, an echo and a reverb,
+ always in that order, on the output of the deck.
+
+ Every effect is built and given its memory in prepare, and the chain never
+ changes shape after that, so the audio thread never allocates or locks.
+ Turning an effect on or off and moving its amount only store an atomic,
+ which the audio thread reads at the start of every block. An effect is
+ crossfaded in and out with its dry signal over 50 ms, so it can be switched
+ at any time without a click, and is skipped completely while it is off.
+
+ The flanger sweeps over four beats, the gate chops every quarter beat in
+ time with the grid of the track, and the echo repeats after three quarters
+ of a beat, all worked out from the tempo the deck plays at.
+*/
+class EffectsRack
+{
+public:
+    EffectsRack();
+    ~EffectsRack();
+
+    /** The effects, in the order they are run */
+    enum Effect { filter = 0, flanger, gate, echo, reverb, numEffects };
+
+    /** The time an effect takes to fade in or out */
+    static constexpr double crossfadeSeconds = 0.05;
+
+    /** Returns the name of an effect, for the buttons and the profiler */
+    static juce::String getEffectName(int effect);
+
+    //==============================================================================
+    /** Turns an effect on or off, it fades in or out from the next block */
+    void setEffectEnabled(int effect, bool enabled);
+    /** Returns true if an effect is on */
+    bool isEffectEnabled(int effect) const;
+    /** Sets the amount of an effect from 0 to 1. The filter is a low pass
+        below 0.5 and a high pass above, and does nothing at 0.5 */
+    void setEffectAmount(int effect, float amount);
+    /** Returns the amount of an effect */
+    float getEffectAmount(int effect) const;
+
+    /** Times every effect as a stage of the profiler */
+    void setProfiler(AudioProfiler* profiler, const juce::String& deckName);
+
+    //==============================================================================
+    /** Gives every effect its memory, call before the audio starts */
+    void prepare(double sampleRate, int maximumBlockSize);
+    /** Runs the effects that are on over part of a buffer. The tempo is the
+        tempo the deck plays at and beat the position of the start of the
+        block on the grid of the track. Audio thread */
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                 double bpm, double beat);
+
+private:
+    /** Runs the effects over a part of the buffer no longer than the prepared block */
+    void processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                      double bpm, double beat);
+    /** Runs one effect on a block in place */
+    void runEffect(int effect, juce::dsp::AudioBlock<float>& block, float amount, double bpm, double beat);
+    /** Runs the flanger on a block in place */
+    void runFlanger(juce::dsp::AudioBlock<float>& block, float amount, double bpm, double beat);
+    /** Runs the gate on a block in place */
+    void runGate(juce::dsp::AudioBlock<float>& block, float amount, double beat, double beatsPerSample);
+    /** Runs the echo on a block in place */
+    void runEcho(juce::dsp::AudioBlock<float>& block, float amount, double bpm);
+    /** Clears the memory of an effect once it has faded out */
+    void resetEffect(int effect);
+
+    // what the message thread sets for one effect, and how far it is faded in
+    struct Slot
+    {
+        std::atomic<bool> enabled {false};
+        std::atomic<float> amount {0.5f};
+        juce::SmoothedValue<float> mix;
+        bool needsReset = false;
+        int stage = -1;
+    };
+
+    std::array<Slot, numEffects> slots;
+
+    // the effects themselves
+    juce::dsp::StateVariableTPTFilter<float> lowHighPass;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> flangerDelay;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> echoDelay;
+    juce::SmoothedValue<float> echoSamples;
+    juce::dsp::Reverb roomReverb;
+    // the gain of the gate at the end of the last block
+    float gateGain = 1.0f;
+
+    // the dry signal of the effect being faded, and the gain of every
+    // sample of a crossfade or of the gate
+    juce::AudioBuffer<float> dryBuffer;
+    juce::HeapBlock<float> gains;
+
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 0;
+
+    // the profiler the effects are timed by
+    AudioProfiler* profiler = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EffectsRack)
+};
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    JogWheel.cpp
+    Created: 19 Oct 2026 4:21:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "JogWheel.h"
+
+JogWheel::JogWheel(DJAudioPlayer* _player)
+: player(_player) {}
+
+JogWheel::~JogWheel() {}
+
+// called to draw the content of the component
+void JogWheel::paint (juce::Graphics& g)
+{
+    // the platter is the largest circle that fits
+    auto size = (float) juce::jmin(getWidth(), getHeight()) - 4.0f;
+    auto bounds = juce::Rectangle<float>(size, size).withCentre(getLocalBounds().toFloat().getCentre());
+
+    g.setColour(player->isScratching() ? juce::Colours::darkgrey : juce::Colours::black);
+    g.fillEllipse(bounds);
+
+    // draw a marker so the rotation can be seen
+    auto centre = bounds.getCentre();
+    auto marker = centre.getPointOnCircumference(size * 0.45f, rotation);
+    g.setColour(juce::Colours::white);
+    g.drawLine({centre, marker}, 2.0f);
+}
+
+// the hand touches the platter
+void JogWheel::mouseDown (const juce::MouseEvent& event)
+{
+    lastAngle = getAngle(event.position);
+    player->beginScratch();
+    repaint();
+}
+
+// move the track by the angle the mouse moved around the centre
+void JogWheel::mouseDrag (const juce::MouseEvent& event)
+{
+    auto angle = getAngle(event.position);
+    auto delta = angle - lastAngle;
+
+    // take the short way round when the angle wraps
+    if (delta > juce::MathConstants<float>::pi)
+        delta -= juce::MathConstants<float>::twoPi;
+    else if (delta < -juce::MathConstants<float>::pi)
+        delta += juce::MathConstants<float>::twoPi;
+
+    player->addJogMovement(delta / juce::MathConstants<float>::twoPi * ScratchEngine::secondsPerTurn);
+
+    lastAngle = angle;
+    rotation += delta;
+    repaint();
+}
+
+// the hand lets go of the platter
+void JogWheel::mouseUp (const juce::MouseEvent&)
+{
+    player->endScratch();
+    repaint();
+}
+
+// the angle of a point around the centre, clockwise from the top
+float JogWheel::getAngle(juce::Point<float> point) const
+{
+    return getLocalBounds().toFloat().getCentre().getAngleToPoint(point);
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    JogWheel.h
+    Created: 19 Oct 2026 4:21:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+
+//==============================================================================
+/*
+ A platter that scratches the deck. Pressing the mouse on it holds the track
+ still and dragging around the centre moves the track like a record.
+*/
+class JogWheel : public juce::Component
+{
+public:
+    JogWheel(DJAudioPlayer* player);
+    ~JogWheel() override;
+
+    /** Called to draw the content of the component */
+    void paint (juce::Graphics&) override;
+
+    /** Called when the mouse is pressed on the platter */
+    void mouseDown (const juce::MouseEvent& event) override;
+    /** Called when the mouse is dragged around the platter */
+    void mouseDrag (const juce::MouseEvent& event) override;
+    /** Called when the mouse is released */
+    void mouseUp (const juce::MouseEvent& event) override;
+
+private:
+    /** Returns the angle of a point around the centre of the platter */
+    float getAngle(juce::Point<float> point) const;
+
+    // the deck that is scratched
+    DJAudioPlayer* player;
+
+    // the angle of the mouse at the last event
+    float lastAngle = 0.0f;
+    // the angle the platter is drawn at
+    float rotation = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JogWheel)
+};
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    KeyAnalyser.cpp
+    Created: 19 Oct 2026 9:14:26pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "KeyAnalyser.h"
+
+#include <algorithm>
+#include <vector>
+
+//==============================================================================
+// work out the key of a whole track
+bool KeyAnalyser::analyse(juce::AudioFormatReader& reader,
+                          const std::function<bool()>& shouldStop,
+                          Result& result)
+{
+    const auto sampleRate = reader.sampleRate > 0.0 ? reader.sampleRate : 44100.0;
+    const auto numChannels = (int) juce::jlimit(1u, 2u, reader.numChannels);
+    const auto length = reader.lengthInSamples;
+
+    // the track is brought down to about 11 kHz, which leaves room for
+    // everything up to 2 kHz, and cut into frames of 8192 samples
+    const int fftOrder = 13;
+    const int fftSize = 1 << fftOrder;
+    const int factor = juce::jmax(1, (int) (sampleRate / 11025.0));
+    const double frameRate = sampleRate / factor;
+    const int chunkSize = fftSize * factor;
+
+    // two low passes in a row keep what folds back when the rate is
+    // brought down out of the pitches that are counted
+    juce::dsp::IIR::Filter<float> lowPass1, lowPass2;
+    lowPass1.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 2500.0f);
+    lowPass2.coefficients = lowPass1.coefficients;
+
+    // the pitch class of every bin between 55 Hz and 2 kHz, and how close
+    // it is to the centre of its semitone
+    std::vector<int> binPitchClass ((size_t) fftSize / 2, -1);
+    std::vector<float> binWeight ((size_t) fftSize / 2, 0.0f);
+
+    for (int bin = 1; bin < fftSize / 2; ++bin) {
+        auto frequency = bin * frameRate / fftSize;
+        if (frequency < 55.0 || frequency > 2000.0)
+            continue;
+
+        auto note = 69.0 + 12.0 * std::log2(frequency / 440.0);
+        auto nearest = std::round(note);
+        auto weight = std::cos(juce::MathConstants<double>::pi * (note - nearest));
+
+        binPitchClass[(size_t) bin] = ((int) nearest % 12 + 12) % 12;
+        binWeight[(size_t) bin] = (float) (weight * weight);
+    }
+
+    juce::dsp::FFT fft {fftOrder};
+    juce::dsp::WindowingFunction<float> window {(size_t) fftSize, juce::dsp::WindowingFunction<float>::hann};
+    std::vector<float> frame ((size_t) fftSize * 2);
+    juce::AudioBuffer<float> buffer {numChannels, chunkSize};
+
+    std::array<double, 12> chroma {};
+
+    for (juce::int64 start = 0; start < length; start += chunkSize) {
+        if (shouldStop())
+            return false;
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+        reader.read(&buffer, 0, numSamples, start, true, true);
+
+        // both sides are analysed as one
+        if (numChannels > 1) {
+            buffer.addFrom(0, 0, buffer, 1, 0, numSamples);
+            buffer.applyGain(0, 0, numSamples, 0.5f);
+        }
+
+        // the frame at the lower rate, the end of the track is padded with silence
+        auto* mono = buffer.getReadPointer(0);
+        std::fill(frame.begin(), frame.end(), 0.0f);
+
+        for (int i = 0; i < numSamples; ++i) {
+            auto filtered = lowPass2.processSample(lowPass1.processSample(mono[i]));
+            if (i % factor == 0)
+                frame[(size_t) (i / factor)] = filtered;
+        }
+
+        window.multiplyWithWindowingTable(frame.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(frame.data());
+
+        // every frame counts the same, so the loud parts do not drown the
+        // quiet ones
+        std::array<double, 12> frameChroma {};
+        double frameMax = 0.0;
+
+        for (int bin = 1; bin < fftSize / 2; ++bin) {
+            auto pitchClass = binPitchClass[(size_t) bin];
+            if (pitchClass >= 0)
+                frameChroma[(size_t) pitchClass] += frame[(size_t) bin] * binWeight[(size_t) bin];
+        }
+
+        for (auto value : frameChroma)
+            frameMax = juce::jmax(frameMax, value);
+
+        // silent frames say nothing about the key
+        if (frameMax > 1.0e-3) {
+            for (size_t i = 0; i < 12; ++i)
+                chroma[i] += frameChroma[i] / frameMax;
+        }
+    }
+
+    result = findKey(chroma);
+    return true;
+}
+
+// the number on the wheel, C major is 8B and A minor is 8A
+int KeyAnalyser::getCamelotNumber(int tonic, bool minor)
+{
+    // a minor key sits on the number of its relative major, three semitones up
+    auto major = ((minor ? tonic + 3 : tonic) % 12 + 12) % 12;
+
+    // the wheel goes round in fifths, seven semitones a step
+    return (major * 7 % 12 + 7) % 12 + 1;
+}
+
+//==============================================================================
+// the key whose profile matches the chroma best
+KeyAnalyser::Result KeyAnalyser::findKey(const std::array<double, 12>& chroma)
+{
+    // how strongly each degree of the scale is heard in a major and a minor
+    // key, from Krumhansl and Kessler
+    static const double majorProfile[12] = {6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+    static const double minorProfile[12] = {6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+
+    Result result;
+
+    double chromaMean = 0.0;
+    for (auto value : chroma)
+        chromaMean += value / 12.0;
+
+    // a silent track has no key
+    if (chromaMean <= 0.0)
+        return result;
+
+    // the correlation of the chroma with a profile starting on a tonic
+    auto correlate = [&chroma, chromaMean] (const double* profile, int tonic)
+    {
+        double profileMean = 0.0;
+        for (int i = 0; i < 12; ++i)
+            profileMean += profile[i] / 12.0;
+
+        double sum = 0.0, chromaSquares = 0.0, profileSquares = 0.0;
+        for (int i = 0; i < 12; ++i) {
+            auto c = chroma[(size_t) ((tonic + i) % 12)] - chromaMean;
+            auto p = profile[i] - profileMean;
+            sum += c * p;
+            chromaSquares += c * c;
+            profileSquares += p * p;
+        }
+
+        return chromaSquares > 0.0 ? sum / std::sqrt(chromaSquares * profileSquares) : 0.0;
+    };
+
+    double best = -2.0, secondBest = -2.0;
+
+    for (int tonic = 0; tonic < 12; ++tonic) {
+        for (auto minor : {false, true}) {
+            auto score = correlate(minor ? minorProfile : majorProfile, tonic);
+
+            if (score > best) {
+                secondBest = best;
+                best = score;
+                result.camelotNumber = getCamelotNumber(tonic, minor);
+                result.minor = minor;
+            }
+            else if (score > secondBest) {
+                secondBest = score;
+            }
+        }
+    }
+
+    result.confidence = (float) juce::jlimit(0.0, 1.0, best > 0.0 ? (best - secondBest) / best : 0.0);
+    return result;
+}
+
+//==============================================================================
+KeyJob::KeyJob(juce::AudioFormatManager& _formatManager, const juce::URL& _url)
+: juce::ThreadPoolJob("Key analysis"),
+  formatManager(_formatManager),
+  url(_url) {}
+
+KeyJob::~KeyJob() {}
+
+// work out the key and the tempo of the track
+juce::ThreadPoolJob::JobStatus KeyJob::runJob()
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+    auto shouldStop = [this] { return shouldExit(); };
+
+    if (reader == nullptr)
+        std::cout << "KeyJob::runJob  could not open " << url.toString(false) << std::endl;
+    else
+        successful = KeyAnalyser::analyse(*reader, shouldStop, key)
+                  && TempoAnalyser::analyse(*reader, shouldStop, tempo);
+
+    finished = true;
+
+    if (onFinished != nullptr)
+        onFinished();
+
+    return jobHasFinished;
+}
+
+// the track being analysed
+const juce::URL& KeyJob::getURL() const
+{
+    return url;
+}
+
+// check if the job is done
+bool KeyJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the track could be analysed
+bool KeyJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the key of the track
+const KeyAnalyser::Result& KeyJob::getKey() const
+{
+    return key;
+}
+
+// the tempo of the track
+const TempoAnalyser::Result& KeyJob::getTempo() const
+{
+    return tempo;
+}
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    KeyAnalyser.h
+    Created: 19 Oct 2026 9:14:26pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TempoAnalyser.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+
+//==============================================================================
+/*
+ Works out the musical key of a whole track and names it in Camelot notation,
+ the wheel DJs use to find tracks that mix in harmony: 1A to 12A are the minor
+ keys, 1B to 12B the major ones, and a key mixes with its neighbours on the
+ wheel and with the other letter of its own number.
+
+ The track is low-passed, brought down to about 11 kHz and cut into frames
+ that are turned into a spectrum. The energy between 55 Hz and 2 kHz is added
+ up per pitch class into a chroma vector for the whole track, which is then
+ compared with the Krumhansl profiles of the 24 keys. The best match is the
+ key and the gap to the next best is its confidence.
+*/
+class KeyAnalyser
+{
+public:
+    /** The key of a track */
+    struct Result
+    {
+        /** The number on the Camelot wheel from 1 to 12, 0 if the key is not known */
+        int camelotNumber = 0;
+        /** True for the minor keys, the A side of the wheel */
+        bool minor = false;
+        /** How much better the key matched than the next best, from 0 to 1 */
+        float confidence = 0.0f;
+    };
+
+    /** Analyses a whole track. shouldStop is asked between chunks and stops
+        the analysis if it returns true. Returns false if it was stopped */
+    static bool analyse(juce::AudioFormatReader& reader,
+                        const std::function<bool()>& shouldStop,
+                        Result& result);
+
+    /** Returns the Camelot number of a key, from its tonic as a pitch class
+        where C is 0 */
+    static int getCamelotNumber(int tonic, bool minor);
+
+private:
+    /** Finds the key whose profile matches the chroma best */
+    static Result findKey(const std::array<double, 12>& chroma);
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that works out the key and the tempo of one
+ track, everything the library suggests compatible tracks with
+*/
+class KeyJob : public juce::ThreadPoolJob
+{
+public:
+    KeyJob(juce::AudioFormatManager& formatManager, const juce::URL& url);
+    ~KeyJob() override;
+
+    /** Works out the key and the tempo of the track */
+    JobStatus runJob() override;
+
+    /** Called on the pool thread when the job is done, set this before the
+        job is added to the pool */
+    std::function<void()> onFinished;
+
+    /** Returns the track being analysed */
+    const juce::URL& getURL() const;
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the track could be analysed */
+    bool wasSuccessful() const;
+    /** Returns the key, only use this once isFinished returns true */
+    const KeyAnalyser::Result& getKey() const;
+    /** Returns the tempo, only use this once isFinished returns true */
+    const TempoAnalyser::Result& getTempo() const;
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to analyse
+    juce::URL url;
+
+    // the results and whether they are ready
+    KeyAnalyser::Result key;
+    TempoAnalyser::Result tempo;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KeyJob)
+};
@@ -0,0 +1,247 @@
+/*
+  ==============================================================================
+
+    LibraryAnalyser.cpp
+    Created: 19 Oct 2026 7:40:18pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "LibraryAnalyser.h"
+
+LibraryAnalyser::LibraryAnalyser(TrackLibrary& _library, juce::AudioFormatManager& _formatManager)
+: library(_library),
+  formatManager(_formatManager),
+  owner(std::make_shared<Owner>())
+{
+    owner->analyser = this;
+}
+
+LibraryAnalyser::~LibraryAnalyser()
+{
+    // a job still running must not call back into the analyser
+    {
+        const juce::ScopedLock lock {owner->lock};
+        owner->analyser = nullptr;
+    }
+
+    cancelPendingUpdate();
+
+    // the pool deletes the jobs once they have stopped
+    for (auto& job : jobs)
+        analysisPool->cancelJob(std::move(job));
+
+    for (auto& job : keyJobs)
+        analysisPool->cancelJob(std::move(job));
+
+    for (auto& job : fingerprintJobs)
+        analysisPool->cancelJob(std::move(job));
+
+    analysisPool->cancelJob(std::move(duplicateJob));
+    analysisPool->cancelJob(std::move(playCountJob));
+}
+
+//==============================================================================
+// queue every track that has not been analysed or queued yet
+void LibraryAnalyser::analyseNewTracks()
+{
+    queueJobs(library.getTracksWithoutLoudness(), jobs, queuedURLs);
+    queueJobs(library.getTracksWithoutHarmony(), keyJobs, queuedKeyURLs);
+    queueJobs(library.getTracksWithoutFingerprint(), fingerprintJobs, queuedFingerprintURLs);
+
+    // the fingerprints of the analysis file are searched straight away
+    if (getNumPending() == 0)
+        findDuplicates();
+}
+
+// count the plays of the history log in the background
+void LibraryAnalyser::countPlays(const PlayHistory& history)
+{
+    if (playCountJob != nullptr)
+        return;
+
+    playCountJob = std::make_unique<PlayCountJob>(history);
+    playCountJob->onFinished = getFinishedCallback();
+    analysisPool->addJob(playCountJob.get());
+}
+
+// the number of analyses still running
+int LibraryAnalyser::getNumPending() const
+{
+    return (int) (jobs.size() + keyJobs.size() + fingerprintJobs.size());
+}
+
+// the tracks per minute of the current or last batch
+double LibraryAnalyser::getTracksPerMinute() const
+{
+    auto end = getNumPending() == 0 ? batchEndMillis : juce::Time::getMillisecondCounterHiRes();
+    auto minutes = (end - batchStartMillis) / 60000.0;
+
+    return minutes > 0.0 ? batchCount / minutes : 0.0;
+}
+
+//==============================================================================
+// store the results of the finished jobs in the library
+void LibraryAnalyser::handleAsyncUpdate()
+{
+    auto stored = false;
+
+    auto collected = collectJobs(jobs, queuedURLs, [this, &stored] (LoudnessJob& job)
+    {
+        auto& result = job.getResult();
+        library.setTrackLoudness(job.getURL(), {result.integratedLufs, result.truePeakDb});
+        stored = true;
+    });
+
+    collected = collectJobs(keyJobs, queuedKeyURLs, [this, &stored] (KeyJob& job)
+    {
+        auto& key = job.getKey();
+        library.setTrackHarmony(job.getURL(), {key.camelotNumber, key.minor, (float) job.getTempo().bpm});
+        stored = true;
+    }) || collected;
+
+    collected = collectJobs(fingerprintJobs, queuedFingerprintURLs, [this, &stored] (FingerprintJob& job)
+    {
+        library.setTrackFingerprint(job.getURL(), job.getFingerprint());
+        duplicatesOutOfDate = true;
+        stored = true;
+    }) || collected;
+
+    // the groups of a finished search replace the ones shown, they are not
+    // saved as they are found again from the fingerprints
+    auto grouped = false;
+
+    if (duplicateJob != nullptr && duplicateJob->isFinished()) {
+        analysisPool->removeFinishedJob(duplicateJob.get());
+
+        if (duplicateJob->wasSuccessful()) {
+            library.setDuplicateGroups(duplicateJob->getGroups());
+            grouped = true;
+        }
+
+        duplicateJob.reset();
+    }
+
+    // the plays of the log add to the ones counted since the app started
+    auto counted = false;
+
+    if (playCountJob != nullptr && playCountJob->isFinished()) {
+        analysisPool->removeFinishedJob(playCountJob.get());
+
+        if (playCountJob->wasSuccessful()) {
+            for (auto& plays : playCountJob->getPlays())
+                library.addTrackPlays(juce::URL{plays.url}, plays.count, plays.lastPlayedMillis);
+            counted = true;
+        }
+
+        playCountJob.reset();
+    }
+
+    // a big batch is saved every few seconds rather than after every track
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    unsavedResults = unsavedResults || stored;
+
+    if (unsavedResults && (getNumPending() == 0 || now - lastSaveMillis > 5000.0)) {
+        library.saveAnalysis();
+        lastSaveMillis = now;
+        unsavedResults = false;
+    }
+
+    // the duplicates are looked for once the whole batch is fingerprinted
+    if (getNumPending() == 0)
+        findDuplicates();
+
+    if (collected && getNumPending() == 0) {
+        batchEndMillis = now;
+        std::cout << "LibraryAnalyser: analysed " << batchCount << " tracks at "
+                  << juce::String(getTracksPerMinute(), 1) << " tracks/minute on "
+                  << juce::SystemStats::getNumCpus() << " cores" << std::endl;
+    }
+
+    if ((stored || grouped || counted) && onTracksAnalysed != nullptr)
+        onTracksAnalysed();
+}
+
+// move the finished jobs out of a list and store their results
+template <typename JobType, typename StoreFunction>
+bool LibraryAnalyser::collectJobs(std::vector<std::unique_ptr<JobType>>& jobList,
+                                  std::set<std::string>& queued,
+                                  StoreFunction store)
+{
+    auto collected = false;
+
+    // the jobs still running, the list is rebuilt so collecting a large
+    // batch stays linear
+    std::vector<std::unique_ptr<JobType>> running;
+    running.reserve(jobList.size());
+
+    for (auto& job : jobList) {
+        if (! job->isFinished()) {
+            running.push_back(std::move(job));
+            continue;
+        }
+
+        // the job has finished running, so this does not wait
+        analysisPool->removeFinishedJob(job.get());
+
+        // a track that could not be opened is tried again next time
+        if (job->wasSuccessful())
+            store(*job);
+
+        ++batchCount;
+        collected = true;
+        queued.erase(job->getURL().toString(false).toStdString());
+    }
+
+    jobList = std::move(running);
+    return collected;
+}
+
+// queue a job for every track that is not queued yet
+template <typename JobType>
+void LibraryAnalyser::queueJobs(const juce::Array<juce::URL>& urls,
+                                std::vector<std::unique_ptr<JobType>>& jobList,
+                                std::set<std::string>& queued)
+{
+    for (auto& url : urls) {
+        // skip the tracks that are already queued
+        if (! queued.insert(url.toString(false).toStdString()).second)
+            continue;
+
+        // a new batch starts when nothing was being analysed
+        if (getNumPending() == 0) {
+            batchStartMillis = juce::Time::getMillisecondCounterHiRes();
+            batchCount = 0;
+        }
+
+        jobList.push_back(std::make_unique<JobType>(formatManager, url));
+        jobList.back()->onFinished = getFinishedCallback();
+        analysisPool->addJob(jobList.back().get());
+    }
+}
+
+// look for duplicates among the fingerprints
+void LibraryAnalyser::findDuplicates()
+{
+    // a search that is running is started again when it finishes
+    if (! duplicatesOutOfDate || duplicateJob != nullptr)
+        return;
+
+    duplicatesOutOfDate = false;
+    duplicateJob = std::make_unique<DuplicateJob>(library.getFingerprintEntries());
+    duplicateJob->onFinished = getFinishedCallback();
+    analysisPool->addJob(duplicateJob.get());
+}
+
+// the function a job calls when it finishes
+std::function<void()> LibraryAnalyser::getFinishedCallback() const
+{
+    return [owner = owner]
+    {
+        const juce::ScopedLock lock {owner->lock};
+
+        if (owner->analyser != nullptr)
+            owner->analyser->triggerAsyncUpdate();
+    };
+}
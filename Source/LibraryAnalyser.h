@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    LibraryAnalyser.h
+    Created: 19 Oct 2026 7:40:18pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include "AnalysisPool.h"
+#include "LoudnessAnalyser.h"
+#include "KeyAnalyser.h"
+#include "AudioFingerprint.h"
+#include "DuplicateIndex.h"
+#include "PlayHistory.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+//==============================================================================
+/*
+ Measures the loudness and works out the key and tempo of every track in a
+ library that has not been analysed yet, one job per track and analysis on
+ the AnalysisPool so all spare cores are used. The results are stored in the
+ library on the message thread and saved every few seconds and at the end of
+ a batch.
+
+ Every track is fingerprinted too, and once no track is left to analyse the
+ duplicates among the fingerprints are looked for in one more job. The plays
+ of the history log are counted in a job as well when the app starts.
+*/
+class LibraryAnalyser : private juce::AsyncUpdater
+{
+public:
+    LibraryAnalyser(TrackLibrary& library, juce::AudioFormatManager& formatManager);
+    ~LibraryAnalyser() override;
+
+    /** Queues every track of the library that has not been analysed or queued yet */
+    void analyseNewTracks();
+    /** Counts the plays in the log of a history in the background and adds
+        them to the plays of the library */
+    void countPlays(const PlayHistory& history);
+
+    /** Returns the number of analyses still running, not counting the
+        search for duplicates */
+    int getNumPending() const;
+    /** Returns how many tracks per minute the current or last batch was measured at */
+    double getTracksPerMinute() const;
+
+    /** Called on the message thread whenever results have been stored */
+    std::function<void()> onTracksAnalysed;
+
+private:
+    /** Stores the results of the finished jobs in the library */
+    void handleAsyncUpdate() override;
+    /** Moves the finished jobs out of a list and stores their results with
+        a function. Returns true if any job was finished */
+    template <typename JobType, typename StoreFunction>
+    bool collectJobs(std::vector<std::unique_ptr<JobType>>& jobList,
+                     std::set<std::string>& queued,
+                     StoreFunction store);
+    /** Queues a job for every track of a list that is not queued yet */
+    template <typename JobType>
+    void queueJobs(const juce::Array<juce::URL>& urls,
+                   std::vector<std::unique_ptr<JobType>>& jobList,
+                   std::set<std::string>& queued);
+    /** Starts looking for duplicates if fingerprints came in since the last
+        search and none is running */
+    void findDuplicates();
+    /** Returns the function a job calls when it finishes, which does nothing
+        once the analyser has been deleted */
+    std::function<void()> getFinishedCallback() const;
+
+    // the library to measure and the manager to open its tracks with
+    TrackLibrary& library;
+    juce::AudioFormatManager& formatManager;
+
+    // the analyser as the jobs see it, cleared when it is deleted as a
+    // cancelled job can finish after that
+    struct Owner
+    {
+        juce::CriticalSection lock;
+        LibraryAnalyser* analyser = nullptr;
+    };
+    std::shared_ptr<Owner> owner;
+
+    // the background threads shared by the whole app
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+    // the jobs that have not been collected yet
+    std::vector<std::unique_ptr<LoudnessJob>> jobs;
+    std::vector<std::unique_ptr<KeyJob>> keyJobs;
+    std::vector<std::unique_ptr<FingerprintJob>> fingerprintJobs;
+    // the urls of those jobs, to find queued tracks quickly
+    std::set<std::string> queuedURLs;
+    std::set<std::string> queuedKeyURLs;
+    std::set<std::string> queuedFingerprintURLs;
+
+    // the search for duplicates, and whether fingerprints came in since it
+    // was started, the ones loaded from the analysis file included
+    std::unique_ptr<DuplicateJob> duplicateJob;
+    bool duplicatesOutOfDate = true;
+
+    // counts the plays of the history log
+    std::unique_ptr<PlayCountJob> playCountJob;
+
+    // the start of the batch and the tracks measured in it
+    double batchStartMillis = 0.0;
+    double batchEndMillis = 0.0;
+    int batchCount = 0;
+
+    // results not saved yet and when they were last saved
+    bool unsavedResults = false;
+    double lastSaveMillis = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryAnalyser)
+};
@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    LoudnessAnalyser.cpp
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "LoudnessAnalyser.h"
+
+//==============================================================================
+// measure the integrated loudness and the true peak of a whole track
+bool LoudnessAnalyser::analyse(juce::AudioFormatReader& reader,
+                               const std::function<bool()>& shouldStop,
+                               Result& result)
+{
+    const auto sampleRate = reader.sampleRate > 0.0 ? reader.sampleRate : 44100.0;
+    const auto numChannels = (int) juce::jlimit(1u, 2u, reader.numChannels);
+    const auto length = reader.lengthInSamples;
+
+    // the track is read in chunks of whole 100 millisecond blocks
+    const int blockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    const int blocksPerChunk = 4;
+    const int chunkSize = blockLength * blocksPerChunk;
+
+    juce::AudioBuffer<float> buffer {numChannels, chunkSize};
+
+    juce::dsp::IIR::Coefficients<float>::Ptr shelf, highPass;
+    createKWeighting(sampleRate, shelf, highPass);
+
+    std::vector<juce::dsp::IIR::Filter<float>> shelfFilters ((size_t) numChannels);
+    std::vector<juce::dsp::IIR::Filter<float>> highPassFilters ((size_t) numChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        shelfFilters[(size_t) channel].coefficients = shelf;
+        highPassFilters[(size_t) channel].coefficients = highPass;
+    }
+
+    // the true peak is the peak of the signal oversampled four times
+    juce::dsp::Oversampling<float> oversampling {(size_t) numChannels, 2,
+        juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true};
+    oversampling.initProcessing((size_t) chunkSize);
+
+    // a mono track is played on both sides of the decks, so it counts twice
+    const double channelWeight = numChannels == 1 ? 2.0 : 1.0;
+
+    std::vector<double> blocks;
+    blocks.reserve((size_t) (length / blockLength + 1));
+    std::vector<double> gatingBlocks;
+    gatingBlocks.reserve(blocks.capacity());
+    float peak = 0.0f;
+
+    for (juce::int64 start = 0; start < length; start += chunkSize) {
+        if (shouldStop())
+            return false;
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+        reader.read(&buffer, 0, numSamples, start, true, true);
+
+        juce::dsp::AudioBlock<float> block {buffer.getArrayOfWritePointers(), (size_t) numChannels, (size_t) numSamples};
+
+        // the true peak is taken before the K-weighting changes the buffer
+        auto upsampled = oversampling.processSamplesUp(block);
+
+        for (size_t channel = 0; channel < upsampled.getNumChannels(); ++channel) {
+            auto range = juce::FloatVectorOperations::findMinAndMax(upsampled.getChannelPointer(channel),
+                                                                    (int) upsampled.getNumSamples());
+            peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        }
+
+        // the K-weighted squares of every channel
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto channelBlock = block.getSingleChannelBlock((size_t) channel);
+            juce::dsp::ProcessContextReplacing<float> context {channelBlock};
+            shelfFilters[(size_t) channel].process(context);
+            highPassFilters[(size_t) channel].process(context);
+
+            auto* samples = buffer.getWritePointer(channel);
+            juce::FloatVectorOperations::multiply(samples, samples, numSamples);
+        }
+
+        // the mean square of every complete 100 millisecond block
+        for (int offset = 0; offset + blockLength <= numSamples; offset += blockLength) {
+            double sum = 0.0;
+
+            for (int channel = 0; channel < numChannels; ++channel) {
+                auto* squares = buffer.getReadPointer(channel, offset);
+                for (int i = 0; i < blockLength; ++i)
+                    sum += squares[i];
+            }
+
+            blocks.push_back(sum * channelWeight / blockLength);
+
+            // every block completes a 400 millisecond gating block, overlapping by 75%
+            auto n = blocks.size();
+            if (n >= 4)
+                gatingBlocks.push_back((blocks[n - 1] + blocks[n - 2] + blocks[n - 3] + blocks[n - 4]) / 4.0);
+        }
+    }
+
+    result.integratedLufs = getGatedLoudness(gatingBlocks);
+    result.truePeakDb = juce::Decibels::gainToDecibels(peak, -100.0f);
+    return true;
+}
+
+// the K-weighting of ITU-R BS.1770, a high shelf followed by a high pass
+void LoudnessAnalyser::createKWeighting(double sampleRate,
+                                        juce::dsp::IIR::Coefficients<float>::Ptr& shelf,
+                                        juce::dsp::IIR::Coefficients<float>::Ptr& highPass)
+{
+    const auto pi = juce::MathConstants<double>::pi;
+
+    // the first stage is a high shelf around 1.7 kHz
+    {
+        const double f0 = 1681.974450955533, gain = 3.999843853973347, q = 0.7071752369554196;
+        auto k = std::tan(pi * f0 / sampleRate);
+        auto vh = std::pow(10.0, gain / 20.0);
+        auto vb = std::pow(vh, 0.4996667741545416);
+        auto a0 = 1.0 + k / q + k * k;
+
+        shelf = new juce::dsp::IIR::Coefficients<float>(
+            (float) ((vh + vb * k / q + k * k) / a0),
+            (float) (2.0 * (k * k - vh) / a0),
+            (float) ((vh - vb * k / q + k * k) / a0),
+            1.0f,
+            (float) (2.0 * (k * k - 1.0) / a0),
+            (float) ((1.0 - k / q + k * k) / a0));
+    }
+
+    // the second stage is a high pass at 38 Hz
+    {
+        const double f0 = 38.13547087602444, q = 0.5003270373238773;
+        auto k = std::tan(pi * f0 / sampleRate);
+        auto a0 = 1.0 + k / q + k * k;
+
+        highPass = new juce::dsp::IIR::Coefficients<float>(
+            1.0f,
+            -2.0f,
+            1.0f,
+            1.0f,
+            (float) (2.0 * (k * k - 1.0) / a0),
+            (float) ((1.0 - k / q + k * k) / a0));
+    }
+}
+
+// gate out silence at -70 LUFS, then everything 10 LU below the loudness of
+// what is left
+float LoudnessAnalyser::getGatedLoudness(const std::vector<double>& gatingBlocks)
+{
+    const auto absoluteGate = std::pow(10.0, (-70.0 + 0.691) / 10.0);
+    double sum = 0.0;
+    int count = 0;
+
+    for (auto block : gatingBlocks) {
+        if (block > absoluteGate) {
+            sum += block;
+            ++count;
+        }
+    }
+
+    if (count == 0)
+        return -100.0f;
+
+    auto relativeGate = sum / count * 0.1;
+    sum = 0.0;
+    count = 0;
+
+    for (auto block : gatingBlocks) {
+        if (block > relativeGate) {
+            sum += block;
+            ++count;
+        }
+    }
+
+    return count > 0 ? toLufs(sum / count) : -100.0f;
+}
+
+// the loudness of a mean square in LUFS
+float LoudnessAnalyser::toLufs(double meanSquare)
+{
+    return meanSquare > 0.0 ? (float) (-0.691 + 10.0 * std::log10(meanSquare)) : -100.0f;
+}
+
+//==============================================================================
+LoudnessJob::LoudnessJob(juce::AudioFormatManager& _formatManager, const juce::URL& _url)
+: juce::ThreadPoolJob("Loudness analysis"),
+  formatManager(_formatManager),
+  url(_url) {}
+
+LoudnessJob::~LoudnessJob() {}
+
+// measure the loudness of the track
+juce::ThreadPoolJob::JobStatus LoudnessJob::runJob()
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (reader == nullptr)
+        std::cout << "LoudnessJob::runJob  could not open " << url.toString(false) << std::endl;
+    else
+        successful = LoudnessAnalyser::analyse(*reader, [this] { return shouldExit(); }, result);
+
+    finished = true;
+
+    if (onFinished != nullptr)
+        onFinished();
+
+    return jobHasFinished;
+}
+
+// the track being measured
+const juce::URL& LoudnessJob::getURL() const
+{
+    return url;
+}
+
+// check if the job is done
+bool LoudnessJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the track could be measured
+bool LoudnessJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the loudness of the track
+const LoudnessAnalyser::Result& LoudnessJob::getResult() const
+{
+    return result;
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    LoudnessAnalyser.h
+    Created: 19 Oct 2026 7:12:40pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Measures the integrated loudness of a whole track following EBU R128
+ (ITU-R BS.1770), and its true peak on a signal oversampled four times.
+ The K-weighting and the gating are shared with the live AudioAnalyser, so
+ the meters and the library agree.
+*/
+class LoudnessAnalyser
+{
+public:
+    /** The loudness of a track */
+    struct Result
+    {
+        /** The integrated loudness in LUFS, -100 for silence */
+        float integratedLufs = -100.0f;
+        /** The true peak in dBTP */
+        float truePeakDb = -100.0f;
+    };
+
+    /** Analyses a whole track. shouldStop is asked between chunks and stops
+        the analysis if it returns true. Returns false if it was stopped */
+    static bool analyse(juce::AudioFormatReader& reader,
+                        const std::function<bool()>& shouldStop,
+                        Result& result);
+
+    /** Creates the two stages of the K-weighting filter for a sample rate */
+    static void createKWeighting(double sampleRate,
+                                 juce::dsp::IIR::Coefficients<float>::Ptr& shelf,
+                                 juce::dsp::IIR::Coefficients<float>::Ptr& highPass);
+
+    /** Returns the integrated loudness of the mean squares of a list of 400
+        millisecond gating blocks, gated at -70 LUFS and 10 LU below */
+    static float getGatedLoudness(const std::vector<double>& gatingBlocks);
+
+    /** Returns the loudness of a mean square in LUFS */
+    static float toLufs(double meanSquare);
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that measures the loudness of one track
+*/
+class LoudnessJob : public juce::ThreadPoolJob
+{
+public:
+    LoudnessJob(juce::AudioFormatManager& formatManager, const juce::URL& url);
+    ~LoudnessJob() override;
+
+    /** Measures the loudness of the track */
+    JobStatus runJob() override;
+
+    /** Called on the pool thread when the job is done, set this before the
+        job is added to the pool */
+    std::function<void()> onFinished;
+
+    /** Returns the track being measured */
+    const juce::URL& getURL() const;
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the track could be measured */
+    bool wasSuccessful() const;
+    /** Returns the loudness, only use this once isFinished returns true */
+    const LoudnessAnalyser::Result& getResult() const;
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to measure
+    juce::URL url;
+
+    // the result and whether it is ready
+    LoudnessAnalyser::Result result;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessJob)
+};
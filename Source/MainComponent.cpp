@@ -1,5 +1,18 @@
 #include "MainComponent.h"
 
+namespace
+{
+    // how often the tempo of the clock is shown, and how often the decks are
+    // checked while a session is restored
+    const int clockIntervalMillis = 250;
+    const int restoreIntervalMillis = 10;
+    // a track of the session that is not open by then is opened on the
+    // message thread instead
+    const int restoreTimeoutMillis = 800;
+    // how often a snapshot of the session is taken
+    const int snapshotIntervalMillis = 500;
+}
+
 //==============================================================================
 MainComponent::MainComponent()
 {
@@ -7,19 +20,38 @@ MainComponent::MainComponent()
     // you add any child components.
     setSize (800, 600);
 
+    // let the mixer know about player 1 and 2 to be able to mix audio
+    mixer.addDeck(&player1);
+    mixer.addDeck(&player2);
+
+    // register the stages of the audio callback before the audio starts
+    player1.setProfiler(&profiler, "Deck 1");
+    player2.setProfiler(&profiler, "Deck 2");
+    mixer.setProfiler(&profiler);
+    
+    // the analysers are only run while their meters are shown
+    analysisThread.addAnalyser(&player1.getAnalyser());
+    analysisThread.addAnalyser(&player2.getAnalyser());
+    analysisThread.addAnalyser(&mixer.getMasterAnalyser());
+
     // Some platforms require permissions to open input channels so request that here
     if (juce::RuntimePermissions::isRequired (juce::RuntimePermissions::recordAudio)
         && ! juce::RuntimePermissions::isGranted (juce::RuntimePermissions::recordAudio))
     {
         juce::RuntimePermissions::request (juce::RuntimePermissions::recordAudio,
-                                           [&] (bool granted) { setAudioChannels (granted ? 2 : 0, 2); });
+                                           [&] (bool granted) { setAudioChannels (granted ? 2 : 0, 4); });
     }
     else
     {
-        // Specify the number of input and output channels that we want to open
-        setAudioChannels (0, 2);
+        // Specify the number of input and output channels that we want to open,
+        // the third and fourth outputs carry the cue bus on devices that have them
+        setAudioChannels (0, 4);
     }
     
+    // the split cue button is only useful on a stereo device
+    deviceManager.addChangeListener(this);
+    changeListenerCallback(&deviceManager);
+    
     // make the first deck gui visible
     addAndMakeVisible(deck1);
     // make the second deck gui visible
@@ -28,6 +60,64 @@ MainComponent::MainComponent()
     // make the playlist component visible
     addAndMakeVisible(playlist);
     
+    // the split cue button stays on until clicked again
+    addAndMakeVisible(splitCueButton);
+    splitCueButton.setClickingTogglesState(true);
+    splitCueButton.onClick = [this] { mixer.setSplitCue(splitCueButton.getToggleState()); };
+    
+    // the meters button shows the meters of both decks and the master
+    addAndMakeVisible(metersButton);
+    metersButton.setClickingTogglesState(true);
+    metersButton.onClick = [this]
+    {
+        auto visible = metersButton.getToggleState();
+        deck1.setMetersVisible(visible);
+        deck2.setMetersVisible(visible);
+        masterMeters.setVisible(visible);
+    };
+    addChildComponent(masterMeters);
+    
+    // the automix button walks the playlist until clicked again
+    addAndMakeVisible(automixButton);
+    automixButton.setClickingTogglesState(true);
+    automixButton.onClick = [this]
+    {
+        if (automixButton.getToggleState())
+            automix.start(playlist.getAutomixQueue());
+        else
+            automix.stop();
+    };
+    // the tempo of the master clock, it follows the slider unless it
+    // follows a MIDI clock or a session
+    addAndMakeVisible(clockTempoSlider);
+    clockTempoSlider.setRange(MasterClock::minBpm, MasterClock::maxBpm, 0.1);
+    clockTempoSlider.setValue(mixer.getMasterClock().getTempo(), juce::NotificationType::dontSendNotification);
+    clockTempoSlider.setTextValueSuffix(" BPM");
+    clockTempoSlider.onValueChange = [this] { mixer.getMasterClock().setTempo(clockTempoSlider.getValue()); };
+    addAndMakeVisible(clockButton);
+    clockButton.onClick = [this] { showClockMenu(); };
+    startTimer(clockIntervalMillis);
+    
+    // MIDI controllers reach the decks without going through this thread,
+    // the mappings and inputs from last time are loaded straight away
+    midiController.addDeck(&player1);
+    midiController.addDeck(&player2);
+    if (MidiController::getDefaultMappingsFile().existsAsFile())
+        midiController.loadMappings(MidiController::getDefaultMappingsFile());
+    midiController.onMappingLearnt = [this] (const MidiController::Target&) { midiButton.setButtonText("MIDI"); };
+    addAndMakeVisible(midiButton);
+    midiButton.onClick = [this] { showMidiMenu(); };
+    
+    // the decks show the tracks the automix loads into the players
+    automix.onTrackLoaded = [this] (DJAudioPlayer& player, const juce::URL& url)
+    {
+        (&player == &player1 ? deck1 : deck2).showTrack(url);
+    };
+    
+    // the profiler overlay is hidden until cmd+P is pressed
+    addChildComponent(profilerOverlay);
+    setWantsKeyboardFocus(true);
+    
     // let the format manager know about the basic audio fomats
     formatManager.registerBasicFormats();
 
@@ -37,12 +127,33 @@ MainComponent::MainComponent()
     getLookAndFeel().setColour(juce::TextButton::textColourOffId, juce::Colours::white);
     // set the color of the label text to black
     getLookAndFeel().setColour(juce::Label::textColourId, juce::Colours::black);
+    
+    // pick the session up where it was left, which needs the formats
+    sessionState.onCapture = [this] (SessionState::Snapshot& snapshot) { captureSession(snapshot); };
+    restoreSession();
 }
 
 MainComponent::~MainComponent()
 {
+    stopTimer();
+    
+    // the last snapshot is taken while the decks are still there, unless
+    // the session before has not come back yet
+    if (restoreStartMillis == 0)
+        sessionState.capture();
+    
+    // the automix stops before the decks it drives
+    automix.stop();
+    automix.onTrackLoaded = nullptr;
+    
     // This shuts down the audio device and clears the audio source.
+    deviceManager.removeChangeListener(this);
     shutdownAudio();
+    
+    // stop the analysis thread using the analysers before they go
+    analysisThread.removeAnalyser(&player1.getAnalyser());
+    analysisThread.removeAnalyser(&player2.getAnalyser());
+    analysisThread.removeAnalyser(&mixer.getMasterAnalyser());
 }
 
 //==============================================================================
@@ -51,31 +162,29 @@ void MainComponent::prepareToPlay (
     int samplesPerBlockExpected,
     double sampleRate
 ) {
-    // let player 1 and 2 prepare to play the audio
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    // the profiler needs the rate to know the deadline of each callback
+    profiler.setSampleRate(sampleRate);
     
-    // let the mixer source know about player 1 and 2 to be able to mix audio
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
+    // let the mixer and player 1 and 2 prepare to play the audio
+    mixer.prepareToPlay(samplesPerBlockExpected, sampleRate);
 }
 
 // Called repeatedly to fetch subsequent blocks of audio data
 void MainComponent::getNextAudioBlock (
    const juce::AudioSourceChannelInfo& bufferToFill
 ) {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    // time the whole callback, the mixer times its own stages
+    AudioProfiler::ScopedCallback callback {profiler, bufferToFill.numSamples};
+    
+    mixer.getNextAudioBlock(bufferToFill);
 }
 
 // Allows the source to release anything it no longer needs after playback
 // has stopped
 void MainComponent::releaseResources()
 {
-    // let player 1 and 2 release their resources
-    player1.releaseResources();
-    player2.releaseResources();
-    // let the mixer release its resources
-    mixerSource.releaseResources();
+    // let the mixer and player 1 and 2 release their resources
+    mixer.releaseResources();
 }
 
 //==============================================================================
@@ -93,6 +202,260 @@ void MainComponent::resized()
     // set bounds for the second deck GUI component
     deck2.setBounds(getWidth()/2, 0, getWidth()/2, getHeight()/1.6);
     
+    // the split cue button sits between the decks and the playlist, with
+    // the automix button and the master clock before it
+    clockButton.setBounds(getWidth()/2 - 322, getHeight()/1.6 + 2, 60, 26);
+    clockTempoSlider.setBounds(getWidth()/2 - 258, getHeight()/1.6 + 2, 120, 26);
+    automixButton.setBounds(getWidth()/2 - 134, getHeight()/1.6 + 2, 80, 26);
+    splitCueButton.setBounds(getWidth()/2 - 50, getHeight()/1.6 + 2, 100, 26);
+    // the meters button and the master meters sit next to it
+    metersButton.setBounds(getWidth()/2 + 54, getHeight()/1.6 + 2, 80, 26);
+    masterMeters.setBounds(getWidth()/2 + 138, getHeight()/1.6 + 2, 220, 26);
+    // the MIDI button comes after the meters
+    midiButton.setBounds(getWidth()/2 + 362, getHeight()/1.6 + 2, 80, 26);
+    
     // set bound for the playlist component
-    playlist.setBounds(0, getHeight()/1.6, getWidth(), getHeight()/2);
+    playlist.setBounds(0, getHeight()/1.6 + 30, getWidth(), getHeight()/2);
+    
+    // the profiler overlay covers the top of the window, with room for the
+    // stages of every effect
+    profilerOverlay.setBounds(getWidth()/4, 0, getWidth()/2, getHeight()/2);
+}
+
+// pick the cue routing when the audio device changes
+void MainComponent::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    auto numOutputs = device != nullptr ? device->getActiveOutputChannels().countNumberOfSetBits() : 0;
+    
+    // a device with four outputs has a pair for the headphones, so there is nothing to split
+    splitCueButton.setEnabled(numOutputs < 4);
+}
+
+// toggle the profiler overlay with cmd+P
+bool MainComponent::keyPressed (const juce::KeyPress& key)
+{
+    if (key == juce::KeyPress('p', juce::ModifierKeys::commandModifier, 0)) {
+        profilerOverlay.setVisible(! profilerOverlay.isVisible());
+        return true;
+    }
+    
+    return false;
+}
+
+// show the tempo of the master clock when it follows something else
+void MainComponent::timerCallback()
+{
+    if (restoreStartMillis > 0)
+        finishRestore();
+    
+    auto& clock = mixer.getMasterClock();
+    
+    // the slider only sets the tempo when the clock follows nothing
+    auto following = clock.getSource() == MasterClock::Source::midiClock;
+    clockTempoSlider.setEnabled(! following);
+    
+    if (clock.getSource() != MasterClock::Source::internal && ! clockTempoSlider.isMouseButtonDown())
+        clockTempoSlider.setValue(clock.getTempo(), juce::NotificationType::dontSendNotification);
+    
+    // the button says what the clock follows
+    auto text = juce::String("CLOCK");
+    if (clock.getSource() == MasterClock::Source::midiClock)
+        text = "MIDI";
+    else if (clock.getSource() == MasterClock::Source::session)
+        text = "LINK " + juce::String(clock.getNumSessionPeers());
+    clockButton.setButtonText(text);
+}
+
+// pick what the master clock follows and where it sends its MIDI clock
+void MainComponent::showClockMenu()
+{
+    auto& clock = mixer.getMasterClock();
+    auto inputs = juce::MidiInput::getAvailableDevices();
+    auto outputs = juce::MidiOutput::getAvailableDevices();
+    
+    juce::PopupMenu menu;
+    menu.addItem(1, "Internal", true, clock.getSource() == MasterClock::Source::internal);
+    menu.addItem(2, "Tempo session on the network", true, clock.getSource() == MasterClock::Source::session);
+    
+    // the clock follows one MIDI input at a time
+    juce::PopupMenu inputMenu;
+    for (int i = 0; i < inputs.size(); ++i)
+        inputMenu.addItem(100 + i, inputs[i].name, true,
+                          clock.getSource() == MasterClock::Source::midiClock
+                          && clock.getMidiInputName() == inputs[i].name);
+    menu.addSubMenu("Follow MIDI clock from", inputMenu, ! inputs.isEmpty());
+    
+    // and sends to one MIDI output at a time
+    juce::PopupMenu outputMenu;
+    for (int i = 0; i < outputs.size(); ++i)
+        outputMenu.addItem(200 + i, outputs[i].name, true, clock.getMidiOutputName() == outputs[i].name);
+    outputMenu.addItem(300, "New virtual output");
+    outputMenu.addSeparator();
+    outputMenu.addItem(301, "Stop sending", clock.getMidiOutputName().isNotEmpty());
+    menu.addSubMenu("Send MIDI clock to", outputMenu);
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&clockButton),
+                       [this, inputs, outputs] (int result)
+    {
+        auto& clock = mixer.getMasterClock();
+        
+        if (result == 1 || result == 2) {
+            // a session is only joined while the clock follows it
+            clock.closeMidiInput();
+            clock.setSource(result == 2 ? MasterClock::Source::session : MasterClock::Source::internal);
+            clock.setSessionEnabled(result == 2);
+        }
+        else if (juce::isPositiveAndBelow(result - 100, inputs.size())) {
+            clock.setSessionEnabled(false);
+            if (clock.openMidiInput(inputs[result - 100].identifier))
+                clock.setSource(MasterClock::Source::midiClock);
+        }
+        else if (juce::isPositiveAndBelow(result - 200, outputs.size())) {
+            clock.openMidiOutput(outputs[result - 200].identifier);
+        }
+        else if (result == 300) {
+            clock.openVirtualMidiOutput("Otodesk Clock");
+        }
+        else if (result == 301) {
+            clock.closeMidiOutput();
+        }
+        
+        timerCallback();
+    });
+}
+
+// open MIDI controllers and learn their mappings
+void MainComponent::showMidiMenu()
+{
+    auto inputs = juce::MidiInput::getAvailableDevices();
+    auto targets = MidiController::getLearnableTargets(2);
+    
+    juce::PopupMenu menu;
+    
+    // any number of controllers can be open at once
+    juce::PopupMenu inputMenu;
+    for (int i = 0; i < inputs.size(); ++i)
+        inputMenu.addItem(100 + i, inputs[i].name, true, midiController.isInputOpen(inputs[i].identifier));
+    menu.addSubMenu("Controllers", inputMenu, ! inputs.isEmpty());
+    
+    // the targets of each deck in a menu of their own
+    juce::PopupMenu deckMenus[2];
+    for (int i = 0; i < targets.size(); ++i)
+        deckMenus[targets[i].deck].addItem(1000 + i, targets[i].getName());
+    menu.addSubMenu("Learn deck 1", deckMenus[0]);
+    menu.addSubMenu("Learn deck 2", deckMenus[1]);
+    
+    menu.addSeparator();
+    menu.addItem(1, "Stop learning", midiController.isLearning());
+    menu.addItem(2, "Clear " + juce::String(midiController.getNumMappings()) + " mappings",
+                 midiController.getNumMappings() > 0);
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&midiButton),
+                       [this, inputs, targets] (int result)
+    {
+        if (juce::isPositiveAndBelow(result - 100, inputs.size())) {
+            auto identifier = inputs[result - 100].identifier;
+            if (midiController.isInputOpen(identifier))
+                midiController.closeInput(identifier);
+            else
+                midiController.openInput(identifier);
+        }
+        else if (juce::isPositiveAndBelow(result - 1000, targets.size())) {
+            // the next note or controller that comes in is mapped
+            midiController.startLearning(targets[result - 1000]);
+            midiButton.setButtonText("LEARN...");
+            return;
+        }
+        else if (result == 1) {
+            midiController.stopLearning();
+        }
+        else if (result == 2) {
+            midiController.clearMappings();
+        }
+        else {
+            return;
+        }
+        
+        midiButton.setButtonText("MIDI");
+        midiController.saveMappings(MidiController::getDefaultMappingsFile());
+    });
+}
+
+//==============================================================================
+// a snapshot of the decks, the mixer and the playlist
+void MainComponent::captureSession(SessionState::Snapshot& snapshot)
+{
+    SessionState::captureDeck(player1, snapshot.decks[0]);
+    SessionState::captureDeck(player2, snapshot.decks[1]);
+    
+    snapshot.mixer.splitCue = mixer.isSplitCue();
+    snapshot.mixer.clockTempo = mixer.getMasterClock().getTempo();
+    
+    snapshot.view = playlist.getSessionView();
+}
+
+// put the last snapshot back
+void MainComponent::restoreSession()
+{
+    if (! sessionState.read(restoredSession)) {
+        sessionState.start(snapshotIntervalMillis);
+        return;
+    }
+    
+    // the mixer and the playlist come back at once
+    splitCueButton.setToggleState(restoredSession.mixer.splitCue, juce::NotificationType::dontSendNotification);
+    mixer.setSplitCue(restoredSession.mixer.splitCue);
+    clockTempoSlider.setValue(restoredSession.mixer.clockTempo, juce::NotificationType::sendNotificationSync);
+    playlist.restoreSessionView(restoredSession.view);
+    
+    // both tracks are opened at the same time on the background threads,
+    // the controls of the decks are set while they open
+    for (size_t i = 0; i < restoredSession.decks.size(); ++i) {
+        auto& deckState = restoredSession.decks[i];
+        
+        SessionState::applyDeck(deckState, i == 0 ? player1 : player2);
+        restoringDecks[i] = deckState.url.isNotEmpty();
+        
+        if (restoringDecks[i])
+            (i == 0 ? deck1 : deck2).preloadURL(juce::URL{deckState.url});
+    }
+    
+    restoreStartMillis = juce::Time::currentTimeMillis();
+    startTimer(restoreIntervalMillis);
+    finishRestore();
+}
+
+// swap the tracks of the session in once they are open
+void MainComponent::finishRestore()
+{
+    auto timedOut = juce::Time::currentTimeMillis() - restoreStartMillis > restoreTimeoutMillis;
+    auto waiting = false;
+    
+    for (size_t i = 0; i < restoredSession.decks.size(); ++i) {
+        if (! restoringDecks[i])
+            continue;
+        
+        auto& player = i == 0 ? player1 : player2;
+        if (! player.isPreloadReady() && ! timedOut) {
+            waiting = true;
+            continue;
+        }
+        
+        // the load button swaps the open track in, and the playhead goes
+        // back to the sample it was on. A deck that was playing is left
+        // cued there rather than started on its own
+        auto& deckState = restoredSession.decks[i];
+        (i == 0 ? deck1 : deck2).loadURL(juce::URL{deckState.url});
+        player.setTrackPosition(deckState.position);
+        restoringDecks[i] = false;
+    }
+    
+    if (waiting)
+        return;
+    
+    // the snapshots start from the restored session
+    restoreStartMillis = 0;
+    startTimer(clockIntervalMillis);
+    sessionState.start(snapshotIntervalMillis);
 }
@@ -4,13 +4,25 @@
 #include "DJAudioPlayer.h"
 #include "DeckGUI.h"
 #include "PlaylistComponent.h"
+#include "DeckMixer.h"
+#include "AudioProfiler.h"
+#include "ProfilerOverlay.h"
+#include "AudioAnalyser.h"
+#include "AnalyserDisplay.h"
+#include "Automix.h"
+#include "MidiController.h"
+#include "SessionState.h"
+
+#include <array>
 
 //==============================================================================
 /*
     This component lives inside our window, and this is where you should put all
     your controls and content.
 */
-class MainComponent : public juce::AudioAppComponent
+class MainComponent : public juce::AudioAppComponent,
+                      public juce::ChangeListener,
+                      public juce::Timer
 {
 public:
     //==============================================================================
@@ -31,13 +43,42 @@ public:
     /** Called when the component size has been changed */
     void resized() override;
     
+    /** Called when the audio device changes, to pick the cue routing */
+    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
+    
+    /** Called when a key is pressed, cmd+P toggles the profiler overlay */
+    bool keyPressed (const juce::KeyPress& key) override;
+    
+    /** Shows the tempo of the master clock when it follows something else,
+        and swaps the tracks of a session in as they open */
+    void timerCallback() override;
+    
 private:
+    /** Shows the menu that picks what the master clock follows and where it
+        sends its MIDI clock */
+    void showClockMenu();
+    /** Shows the menu that opens MIDI controllers and learns their mappings */
+    void showMidiMenu();
+    
+    /** Fills in a snapshot of the decks, the mixer and the playlist */
+    void captureSession(SessionState::Snapshot& snapshot);
+    /** Puts the mixer and the playlist of the last snapshot back, and opens
+        the tracks of its decks in the background */
+    void restoreSession();
+    /** Swaps the tracks of the session into the decks once they are open,
+        at the sample they were on, and starts taking snapshots after */
+    void finishRestore();
+    
+
     // A manager that keeps a list of available audio formats and
     // decides which one to use to open a given file
     juce::AudioFormatManager formatManager;
     // used to manage multiple AudioThumbnail objects
     juce::AudioThumbnailCache thumbCache{20};
     
+    // records how long each stage of the audio callback takes
+    AudioProfiler profiler;
+    
     // Audio player for the first deck
     DJAudioPlayer player1{formatManager};
     // GUI for the first deck
@@ -48,11 +89,47 @@ private:
     // GUI for the second deck
     DeckGUI deck2{&player2, formatManager, thumbCache};
     
-    // An audio source that allows mixing of multiple audio sources
-    juce::MixerAudioSource mixerSource;
+    // An audio source that mixes the two decks
+    DeckMixer mixer;
+    
+    // splits a stereo output into cue and master for headphones
+    juce::TextButton splitCueButton{"SPLIT CUE"};
+    
+    // the tempo of the master clock the synced decks follow, and the menu
+    // of what it follows and sends to
+    juce::Slider clockTempoSlider{juce::Slider::IncDecButtons, juce::Slider::TextBoxLeft};
+    juce::TextButton clockButton{"CLOCK"};
+    
+    // maps MIDI controllers onto the decks, and the menu that sets it up
+    MidiController midiController;
+    juce::TextButton midiButton{"MIDI"};
+    
+    // plays the playlist from the selected track with beatmatched crossfades
+    Automix automix{mixer, player1, player2, formatManager};
+    juce::TextButton automixButton{"AUTOMIX"};
+    
+    // shows the spectrum and meters of the decks and the master
+    juce::TextButton metersButton{"METERS"};
+    // meters of the master, next to the buttons
+    AnalyserDisplay masterMeters{mixer.getMasterAnalyser(), true};
+    
+    // runs the FFTs and loudness filters of every analyser
+    AnalysisThread analysisThread;
     
     // A custom component to display and use a playlist for multiple tracks
-    PlaylistComponent playlist{&deck1, &formatManager};
+    PlaylistComponent playlist{&deck1, &deck2, &formatManager};
+    
+    // shows the numbers recorded by the profiler
+    ProfilerOverlay profilerOverlay{profiler, deviceManager};
+    
+    // takes snapshots of the decks, the mixer and the playlist, declared
+    // after them as it reads them
+    SessionState sessionState{SessionState::getDefaultFile()};
+    // the snapshot being restored, the decks still waiting for their
+    // tracks, and when the restore started, 0 once it is done
+    SessionState::Snapshot restoredSession;
+    std::array<bool, SessionState::numDecks> restoringDecks {};
+    juce::int64 restoreStartMillis = 0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
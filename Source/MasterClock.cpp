@@ -0,0 +1,465 @@
+/*
+  ==============================================================================
+
+    MasterClock.cpp
+    Created: 19 Oct 2026 10:14:39pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "MasterClock.h"
+#include "TempoSession.h"
+
+#include <chrono>
+#include <thread>
+
+MasterClock::MasterClock()
+: juce::Thread("Master clock") {}
+
+MasterClock::~MasterClock()
+{
+    setSessionEnabled(false);
+    closeMidiInput();
+    closeMidiOutput();
+}
+
+//==============================================================================
+// set the tempo
+void MasterClock::setTempo(double bpm)
+{
+    // the tempo must be one the clock can run at
+    if (bpm < minBpm || bpm > maxBpm) { // tempo out of range
+        std::cout << "MasterClock::setTempo  bpm should be between " << minBpm << " and " << maxBpm << std::endl;
+        return;
+    }
+
+    targetTempo = bpm;
+
+    // the other programs in the session take the new tempo as well
+    if (session != nullptr)
+        session->announceTempo(bpm);
+}
+
+// the tempo of the clock
+double MasterClock::getTempo() const
+{
+    return tempo;
+}
+
+// the beat at the start of the piece being rendered
+double MasterClock::getBeat() const
+{
+    return beat;
+}
+
+// the beat at a time on the millisecond counter
+double MasterClock::getBeatAtTime(double millis) const
+{
+    Timeline timeline;
+    if (! published.read(timeline))
+        return beat;
+
+    return timeline.beat + (millis - timeline.millis) * timeline.bpm / 60000.0;
+}
+
+// choose what the tempo follows
+void MasterClock::setSource(Source _source)
+{
+    source = _source;
+
+    // a clock that follows something new starts from where it is
+    const juce::SpinLock::ScopedLockType lock (referenceLock);
+    reference.write({});
+}
+
+// what the tempo follows
+MasterClock::Source MasterClock::getSource() const
+{
+    return source;
+}
+
+//==============================================================================
+// send the clock to a MIDI output
+bool MasterClock::openMidiOutput(const juce::String& identifier)
+{
+    closeMidiOutput();
+
+    midiOutput = juce::MidiOutput::openDevice(identifier);
+
+    if (midiOutput == nullptr) {
+        std::cout << "MasterClock::openMidiOutput  could not open " << identifier << std::endl;
+        return false;
+    }
+
+    updateOutputThread();
+    return true;
+}
+
+// send the clock to a new virtual MIDI output
+bool MasterClock::openVirtualMidiOutput(const juce::String& name)
+{
+    closeMidiOutput();
+
+   #if JUCE_LINUX || JUCE_MAC || JUCE_IOS
+    midiOutput = juce::MidiOutput::createNewDevice(name);
+   #endif
+
+    if (midiOutput == nullptr) {
+        std::cout << "MasterClock::openVirtualMidiOutput  could not create " << name << std::endl;
+        return false;
+    }
+
+    updateOutputThread();
+    return true;
+}
+
+// stop sending the clock
+void MasterClock::closeMidiOutput()
+{
+    if (midiOutput == nullptr)
+        return;
+
+    // the thread sends the stop on its way out
+    ticksWanted = queueTicks.load();
+    stopThread(1000);
+    midiOutput.reset();
+}
+
+// the name of the MIDI output
+juce::String MasterClock::getMidiOutputName() const
+{
+    return midiOutput != nullptr ? midiOutput->getName() : juce::String();
+}
+
+// listen to a MIDI input for a clock
+bool MasterClock::openMidiInput(const juce::String& identifier)
+{
+    closeMidiInput();
+
+    midiInput = juce::MidiInput::openDevice(identifier, this);
+
+    if (midiInput == nullptr) {
+        std::cout << "MasterClock::openMidiInput  could not open " << identifier << std::endl;
+        return false;
+    }
+
+    // the clock coming in is measured from its first tick
+    lastInputMillis = 0.0;
+    inputTickMillis = 0.0;
+    rejectedTicks = 0;
+    midiInput->start();
+    return true;
+}
+
+// stop listening to the MIDI input
+void MasterClock::closeMidiInput()
+{
+    if (midiInput == nullptr)
+        return;
+
+    midiInput->stop();
+    midiInput.reset();
+}
+
+// the name of the MIDI input
+juce::String MasterClock::getMidiInputName() const
+{
+    return midiInput != nullptr ? midiInput->getName() : juce::String();
+}
+
+// join or leave the tempo session
+void MasterClock::setSessionEnabled(bool enabled)
+{
+    if (enabled == (session != nullptr))
+        return;
+
+    if (enabled) {
+        session = std::make_unique<TempoSession>(*this);
+        session->announceTempo(targetTempo);
+        session->startThread();
+    }
+    else {
+        session->stopThread(2000);
+        session.reset();
+    }
+}
+
+// check if the clock is in a session
+bool MasterClock::isSessionEnabled() const
+{
+    return session != nullptr;
+}
+
+// the number of other programs in the session
+int MasterClock::getNumSessionPeers() const
+{
+    return session != nullptr ? session->getNumPeers() : 0;
+}
+
+// keep the ticks for popTicks
+void MasterClock::setQueueTicks(bool queue)
+{
+    queueTicks = queue;
+    ticksWanted = queue || midiOutput != nullptr;
+}
+
+// take the oldest ticks
+int MasterClock::popTicks(Tick* ticks, int maxTicks)
+{
+    const auto scope = tickFifo.read(juce::jmin(maxTicks, tickFifo.getNumReady()));
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        ticks[i] = tickBuffer[(size_t) (scope.startIndex1 + i)];
+    for (int i = 0; i < scope.blockSize2; ++i)
+        ticks[scope.blockSize1 + i] = tickBuffer[(size_t) (scope.startIndex2 + i)];
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+//==============================================================================
+// tell the clock the rate it counts at
+void MasterClock::prepare(double _sampleRate)
+{
+    sampleRate = _sampleRate > 0.0 ? _sampleRate : 44100.0;
+    samplePosition = 0;
+    blockMillis = 0.0;
+    nextBlockMillis = 0.0;
+    lastTick = (juce::int64) std::ceil(beat * ticksPerBeat) - 1;
+}
+
+// pick up the tempo and what the clock follows
+void MasterClock::beginBlock(int numSamples)
+{
+    // the callbacks come in with jitter, so the time of a block is where the
+    // last one said it would start, pulled a little towards the time now.
+    // A jump, after a stall or the first time, is taken as it is
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    auto error = now - nextBlockMillis;
+    blockMillis = nextBlockMillis <= 0.0 || std::abs(error) > 50.0 ? now : nextBlockMillis + 0.05 * error;
+    nextBlockMillis = blockMillis + numSamples * 1000.0 / sampleRate;
+    blockOffset = 0;
+
+    auto newTempo = targetTempo.load();
+    auto currentBeat = beat.load();
+
+    // the beat is pulled towards what the clock follows over half a second,
+    // and moved straight there if it is a beat or more away
+    Timeline followed;
+    if (source != Source::internal && reference.read(followed) && followed.bpm > 0.0
+        && std::abs(blockMillis - followed.millis) < 2000.0) {
+        auto expected = followed.beat + (blockMillis - followed.millis) * followed.bpm / 60000.0;
+        auto difference = expected - currentBeat;
+
+        // in a session only the place in the bar counts
+        if (followed.quantum > 0.0)
+            difference -= followed.quantum * std::round(difference / followed.quantum);
+
+        if (std::abs(difference) >= 1.0)
+            currentBeat += difference;
+        else
+            currentBeat += difference * juce::jmin(1.0, numSamples / (phaseSeconds * sampleRate));
+    }
+
+    tempo = juce::jlimit(minBpm, maxBpm, newTempo);
+    beat = currentBeat;
+}
+
+// move the beat on by a piece of the block
+void MasterClock::advance(int numSamples)
+{
+    auto currentBeat = beat.load();
+    auto beatsPerSample = tempo.load() / 60.0 / sampleRate;
+    auto endBeat = currentBeat + numSamples * beatsPerSample;
+    auto pieceMillis = blockMillis + blockOffset * 1000.0 / sampleRate;
+
+    // work out every tick that falls inside the piece, a jump of the beat
+    // does not send the ticks it skipped
+    if (ticksWanted) {
+        auto firstTick = juce::jmax((juce::int64) std::ceil(currentBeat * ticksPerBeat), lastTick + 1);
+
+        for (auto tick = firstTick; tick < endBeat * ticksPerBeat; ++tick) {
+            auto offset = ((double) tick / ticksPerBeat - currentBeat) / beatsPerSample;
+            pushTick({(double) samplePosition + offset, pieceMillis + offset * 1000.0 / sampleRate});
+            lastTick = tick;
+        }
+
+        // wake the sending thread, which sleeps while it has nothing to send
+        if (firstTick < endBeat * ticksPerBeat)
+            notify();
+    }
+    else {
+        lastTick = (juce::int64) std::ceil(endBeat * ticksPerBeat) - 1;
+    }
+
+    published.write({tempo.load(), currentBeat, pieceMillis, 0.0});
+
+    beat = endBeat;
+    samplePosition += numSamples;
+    blockOffset += numSamples;
+}
+
+// store a tick for the sending thread
+void MasterClock::pushTick(const Tick& tick)
+{
+    // a tick that does not fit is dropped rather than waited for
+    const auto scope = tickFifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        tickBuffer[(size_t) scope.startIndex1] = tick;
+    else if (scope.blockSize2 > 0)
+        tickBuffer[(size_t) scope.startIndex2] = tick;
+}
+
+//==============================================================================
+// keep track of the clock coming in
+void MasterClock::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+{
+    // the time stamps of a MIDI input are on the millisecond counter
+    auto millis = message.getTimeStamp() * 1000.0;
+
+    if (message.isMidiStart()) {
+        inputTicks = 0;
+        return;
+    }
+
+    if (message.isSongPositionPointer()) {
+        inputTicks = message.getSongPositionPointerMidiBeat() * (ticksPerBeat / 4);
+        return;
+    }
+
+    if (! message.isMidiClock())
+        return;
+
+    // the time of a tick is smoothed over the last few dozen, a tick that
+    // is far out is ignored unless the clock really has changed tempo
+    if (lastInputMillis > 0.0) {
+        auto interval = millis - lastInputMillis;
+
+        if (inputTickMillis <= 0.0 || rejectedTicks > ticksPerBeat) {
+            inputTickMillis = interval;
+            rejectedTicks = 0;
+        }
+        else if (interval > inputTickMillis * 0.5 && interval < inputTickMillis * 2.0) {
+            inputTickMillis += 0.05 * (interval - inputTickMillis);
+            rejectedTicks = 0;
+        }
+        else {
+            ++rejectedTicks;
+        }
+    }
+
+    lastInputMillis = millis;
+    ++inputTicks;
+
+    if (source != Source::midiClock || inputTickMillis <= 0.0)
+        return;
+
+    auto bpm = 60000.0 / (inputTickMillis * ticksPerBeat);
+    if (bpm < minBpm || bpm > maxBpm)
+        return;
+
+    targetTempo = bpm;
+
+    const juce::SpinLock::ScopedLockType lock (referenceLock);
+    reference.write({bpm, (double) inputTicks / ticksPerBeat, millis, 0.0});
+}
+
+// the tempo the session has agreed on
+void MasterClock::setSessionTempo(double bpm)
+{
+    if (source == Source::session)
+        targetTempo = juce::jlimit(minBpm, maxBpm, bpm);
+}
+
+// the beat of the program that leads the session
+void MasterClock::setSessionPhase(double bpm, double sessionBeat, double millis)
+{
+    if (source != Source::session)
+        return;
+
+    // the beats of a session line up in bars of four
+    const juce::SpinLock::ScopedLockType lock (referenceLock);
+    reference.write({bpm, sessionBeat, millis, bpm > 0.0 ? 4.0 : 0.0});
+}
+
+//==============================================================================
+// send the ticks of the MIDI output at their times
+void MasterClock::run()
+{
+    while (! threadShouldExit()) {
+        if (startPending.exchange(false))
+            midiOutput->sendMessageNow(juce::MidiMessage::midiStart());
+
+        Tick tick;
+        while (! threadShouldExit() && popTicks(&tick, 1) == 1) {
+            // block until the tick is due, the whole milliseconds on the
+            // event so the thread can be stopped and the rest in a sleep of
+            // its own, so the tick goes out within a fraction of a millisecond
+            for (;;) {
+                auto remaining = tick.millis - juce::Time::getMillisecondCounterHiRes();
+                if (remaining <= 0.0 || threadShouldExit())
+                    break;
+
+                if (remaining >= 1.0)
+                    wait((int) remaining);
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds((juce::int64) (remaining * 1000.0)));
+            }
+
+            midiOutput->sendMessageNow(juce::MidiMessage::midiClock());
+        }
+
+        // the audio thread wakes the thread once it has worked out more ticks
+        wait(-1);
+    }
+
+    midiOutput->sendMessageNow(juce::MidiMessage::midiStop());
+}
+
+// start the sending thread with a new output
+void MasterClock::updateOutputThread()
+{
+    // the ticks left over from before are thrown away
+    tickFifo.reset();
+    startPending = true;
+    ticksWanted = true;
+    startThread(9);
+}
+
+//==============================================================================
+// write a timeline without waiting, readers see an odd sequence while it changes
+void MasterClock::TimelineSlot::write(const Timeline& timeline)
+{
+    auto current = sequence.load(std::memory_order_relaxed);
+    sequence.store(current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    bpm.store(timeline.bpm, std::memory_order_relaxed);
+    beat.store(timeline.beat, std::memory_order_relaxed);
+    millis.store(timeline.millis, std::memory_order_relaxed);
+    quantum.store(timeline.quantum, std::memory_order_relaxed);
+
+    sequence.store(current + 2, std::memory_order_release);
+}
+
+// read a timeline that was not written in the meantime
+bool MasterClock::TimelineSlot::read(Timeline& timeline) const
+{
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        auto before = sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        timeline.bpm = bpm.load(std::memory_order_relaxed);
+        timeline.beat = beat.load(std::memory_order_relaxed);
+        timeline.millis = millis.load(std::memory_order_relaxed);
+        timeline.quantum = quantum.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    MasterClock.h
+    Created: 19 Oct 2026 10:14:39pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+class TempoSession;
+
+//==============================================================================
+/*
+ A tempo and a beat that the decks can follow.
+
+ The beat is counted on the audio thread, by the mixer, in samples: it moves
+ on by exactly the number of samples of every piece the mixer renders, so the
+ clock never drifts from the audio and a deck reading it in the middle of a
+ block gets the beat of the first sample of its piece.
+
+ The tempo is set from the message thread, or follows a MIDI clock coming in
+ or a tempo session on the network. Whatever it follows only stores a tempo
+ and a point on its timeline, which the audio thread picks up at the start
+ of the next block and pulls the beat towards smoothly.
+
+ The MIDI clock that goes out is worked out on the audio thread as well. The
+ sample every tick falls on is turned into a time on a smoothed copy of the
+ wall clock, which takes the jitter of the audio callbacks out, and a thread
+ of its own sends every tick at its time.
+*/
+class MasterClock : public juce::MidiInputCallback,
+                    private juce::Thread
+{
+public:
+    MasterClock();
+    ~MasterClock() override;
+
+    /** The ticks of a MIDI clock in one beat */
+    static constexpr int ticksPerBeat = 24;
+    /** The slowest and fastest tempo of the clock */
+    static constexpr double minBpm = 40.0;
+    static constexpr double maxBpm = 240.0;
+    /** The time the beat takes to catch up with what it follows */
+    static constexpr double phaseSeconds = 0.5;
+
+    /** What the tempo of the clock comes from */
+    enum class Source { internal, midiClock, session };
+
+    /** A MIDI clock tick worked out on the audio thread */
+    struct Tick
+    {
+        /** The sample of the clock the tick falls on, with a fraction */
+        double sample = 0.0;
+        /** The time the tick is due, on the millisecond counter */
+        double millis = 0.0;
+    };
+
+    //==============================================================================
+    /** Sets the tempo, used when the clock follows nothing or a session */
+    void setTempo(double bpm);
+    /** Returns the tempo the clock runs at */
+    double getTempo() const;
+    /** Returns the beat at the start of the piece being rendered, safe on any
+        thread and exact on the audio thread */
+    double getBeat() const;
+    /** Returns the beat at a time on the millisecond counter */
+    double getBeatAtTime(double millis) const;
+
+    /** Chooses what the tempo of the clock follows */
+    void setSource(Source source);
+    /** Returns what the tempo of the clock follows */
+    Source getSource() const;
+
+    //==============================================================================
+    /** Sends the clock to a MIDI output, returns false if it cannot be opened */
+    bool openMidiOutput(const juce::String& identifier);
+    /** Sends the clock to a new virtual MIDI output other programs can
+        follow, returns false where there are no virtual ports */
+    bool openVirtualMidiOutput(const juce::String& name);
+    /** Stops sending the clock */
+    void closeMidiOutput();
+    /** Returns the name of the MIDI output, empty if there is none */
+    juce::String getMidiOutputName() const;
+
+    /** Listens to a MIDI input for a clock, returns false if it cannot be opened */
+    bool openMidiInput(const juce::String& identifier);
+    /** Stops listening to the MIDI input */
+    void closeMidiInput();
+    /** Returns the name of the MIDI input, empty if there is none */
+    juce::String getMidiInputName() const;
+
+    /** Joins or leaves the tempo session on the local network */
+    void setSessionEnabled(bool enabled);
+    /** Returns true while the clock is in a tempo session */
+    bool isSessionEnabled() const;
+    /** Returns the number of other programs in the tempo session */
+    int getNumSessionPeers() const;
+
+    /** Keeps the ticks worked out on the audio thread for popTicks, when no
+        MIDI output takes them */
+    void setQueueTicks(bool queue);
+    /** Takes the oldest ticks, returns how many were taken */
+    int popTicks(Tick* ticks, int maxTicks);
+
+    //==============================================================================
+    /** Tells the clock the rate it counts at, before the audio starts */
+    void prepare(double sampleRate);
+    /** Picks up the tempo and what the clock follows at the start of a block.
+        Audio thread */
+    void beginBlock(int numSamples);
+    /** Moves the beat on by a piece of the block. Audio thread */
+    void advance(int numSamples);
+
+    //==============================================================================
+    /** Called by the MIDI input, keeps track of the clock coming in */
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+
+    /** Called by the tempo session with the tempo it has agreed on */
+    void setSessionTempo(double bpm);
+    /** Called by the tempo session with the beat of the program that leads
+        it at a time, or with a tempo of 0 when this clock leads */
+    void setSessionPhase(double bpm, double beat, double millis);
+
+private:
+    /** Sends the ticks of the MIDI output at their times */
+    void run() override;
+    /** Starts or stops the sending thread and the ticks with the output */
+    void updateOutputThread();
+    /** Stores a tick for the sending thread. Audio thread */
+    void pushTick(const Tick& tick);
+
+    /** A point on a timeline, with the tempo it moves at */
+    struct Timeline
+    {
+        double bpm = 0.0;
+        double beat = 0.0;
+        double millis = 0.0;
+        double quantum = 0.0;
+    };
+
+    /** A timeline shared between threads. The writer never waits, and a
+        reader tries again if it was written while it read */
+    class TimelineSlot
+    {
+    public:
+        void write(const Timeline& timeline);
+        bool read(Timeline& timeline) const;
+
+    private:
+        std::atomic<juce::uint32> sequence {0};
+        std::atomic<double> bpm {0.0}, beat {0.0}, millis {0.0}, quantum {0.0};
+    };
+
+    // the tempo set by the message thread, a MIDI clock or a session, and
+    // the tempo the audio thread runs at
+    std::atomic<double> targetTempo {120.0};
+    std::atomic<double> tempo {120.0};
+    std::atomic<Source> source {Source::internal};
+
+    // the beat at the start of the current piece, only written by the audio thread
+    std::atomic<double> beat {0.0};
+    // the samples counted since prepare, and since the start of the block
+    juce::int64 samplePosition = 0;
+    int blockOffset = 0;
+    // the smoothed wall clock at the start of the block, and where the next
+    // block is expected to start on it
+    double blockMillis = 0.0;
+    double nextBlockMillis = 0.0;
+    double sampleRate = 44100.0;
+    // the last tick that was worked out
+    juce::int64 lastTick = -1;
+
+    // what the clock follows, written by the MIDI input or the session, and
+    // the beat of this clock as the other threads see it
+    TimelineSlot reference;
+    TimelineSlot published;
+    // the MIDI input and the session never write the reference at the same time
+    juce::SpinLock referenceLock;
+
+    // the ticks on their way from the audio thread to the sending thread
+    juce::AbstractFifo tickFifo {1024};
+    std::array<Tick, 1024> tickBuffer;
+    std::atomic<bool> queueTicks {false};
+    std::atomic<bool> ticksWanted {false};
+    // a MIDI start is sent before the first tick to a new output
+    std::atomic<bool> startPending {false};
+
+    // the clock going out and coming in
+    std::unique_ptr<juce::MidiOutput> midiOutput;
+    std::unique_ptr<juce::MidiInput> midiInput;
+
+    // the clock coming in, only touched by the MIDI input
+    juce::int64 inputTicks = 0;
+    double lastInputMillis = 0.0;
+    double inputTickMillis = 0.0;
+    int rejectedTicks = 0;
+
+    // the tempo session on the local network, null when not in one
+    std::unique_ptr<TempoSession> session;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterClock)
+};
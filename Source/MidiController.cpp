@@ -0,0 +1,422 @@
+/*
+  ==============================================================================
+
+    MidiController.cpp
+    Created: 19 Oct 2026 10:41:53pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "MidiController.h"
+
+MidiController::MidiController()
+{
+    for (auto& mapping : mappings)
+        mapping = 0;
+}
+
+MidiController::~MidiController()
+{
+    // the inputs stop calling in before anything else goes
+    for (auto* input : inputs)
+        input->stop();
+
+    inputs.clear();
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+// check if the target points at a deck
+bool MidiController::Target::isValid() const
+{
+    return deck >= 0;
+}
+
+// the name shown in the menus
+juce::String MidiController::Target::getName() const
+{
+    auto name = "Deck " + juce::String(deck + 1) + " ";
+
+    switch (control) {
+        case DJAudioPlayer::Control::play:     return name + "play";
+        case DJAudioPlayer::Control::cue:      return name + "cue";
+        case DJAudioPlayer::Control::sync:     return name + "sync";
+        case DJAudioPlayer::Control::hotCue:   return name + "hot cue " + juce::String(index + 1);
+        case DJAudioPlayer::Control::jog:      return name + "jog wheel";
+        case DJAudioPlayer::Control::jogTouch: return name + "jog touch";
+        case DJAudioPlayer::Control::volume:   return name + "volume";
+        case DJAudioPlayer::Control::speed:    return name + "pitch fader";
+        case DJAudioPlayer::Control::eq:       return name + "EQ " + DeckEqualiser::getBandName(index).toLowerCase();
+        default:                               return name;
+    }
+}
+
+// every target that can be learnt
+juce::Array<MidiController::Target> MidiController::getLearnableTargets(int numDecks)
+{
+    using Control = DJAudioPlayer::Control;
+    juce::Array<Target> targets;
+
+    for (int deck = 0; deck < numDecks; ++deck) {
+        for (auto control : {Control::play, Control::cue, Control::sync, Control::jog,
+                             Control::jogTouch, Control::volume, Control::speed})
+            targets.add({deck, control, 0});
+
+        for (int cue = 0; cue < CueLoopSource::numHotCues; ++cue)
+            targets.add({deck, Control::hotCue, cue});
+
+        for (int band = 0; band < DeckEqualiser::numBands; ++band)
+            targets.add({deck, Control::eq, band});
+    }
+
+    return targets;
+}
+
+// the file the mappings are kept in
+juce::File MidiController::getDefaultMappingsFile()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+               .getChildFile("Otodesk")
+               .getChildFile("midi-mappings.xml");
+}
+
+//==============================================================================
+// add a deck the mappings can point at
+void MidiController::addDeck(DJAudioPlayer* deck)
+{
+    decks.addIfNotAlreadyThere(deck);
+}
+
+// start listening to a MIDI input
+bool MidiController::openInput(const juce::String& identifier)
+{
+    if (isInputOpen(identifier))
+        return true;
+
+    auto input = juce::MidiInput::openDevice(identifier, this);
+
+    if (input == nullptr) {
+        std::cout << "MidiController::openInput  could not open " << identifier << std::endl;
+        return false;
+    }
+
+    input->start();
+    inputs.add(input.release());
+    return true;
+}
+
+// stop listening to a MIDI input
+void MidiController::closeInput(const juce::String& identifier)
+{
+    for (int i = inputs.size(); --i >= 0;) {
+        if (inputs[i]->getIdentifier() == identifier) {
+            inputs[i]->stop();
+            inputs.remove(i);
+        }
+    }
+}
+
+// check if a MIDI input is being listened to
+bool MidiController::isInputOpen(const juce::String& identifier) const
+{
+    for (auto* input : inputs)
+        if (input->getIdentifier() == identifier)
+            return true;
+
+    return false;
+}
+
+//==============================================================================
+// map the next note or controller to a target
+void MidiController::startLearning(const Target& target)
+{
+    learnTarget = encode(target);
+}
+
+// stop waiting for a note or controller
+void MidiController::stopLearning()
+{
+    learnTarget = 0;
+}
+
+// check if a mapping is being learnt
+bool MidiController::isLearning() const
+{
+    return learnTarget != 0;
+}
+
+// map the note or controller of a message to a target
+void MidiController::setMapping(const juce::MidiMessage& message, const Target& target)
+{
+    auto slot = getSlot(message);
+    if (slot < 0)
+        return;
+
+    // a target is only moved by one note or controller
+    auto code = encode(target);
+    for (auto& mapping : mappings)
+        if (mapping == code)
+            mapping = 0;
+
+    mappings[(size_t) slot] = code;
+}
+
+// remove every mapping
+void MidiController::clearMappings()
+{
+    for (auto& mapping : mappings)
+        mapping = 0;
+}
+
+// the number of mapped notes and controllers
+int MidiController::getNumMappings() const
+{
+    int numMappings = 0;
+
+    for (auto& mapping : mappings)
+        if (mapping != 0)
+            ++numMappings;
+
+    return numMappings;
+}
+
+// write the mappings and the open inputs to a file
+bool MidiController::saveMappings(const juce::File& file) const
+{
+    juce::XmlElement xml {"MIDIMAPPINGS"};
+
+    for (auto* input : inputs) {
+        auto* element = xml.createNewChildElement("INPUT");
+        element->setAttribute("identifier", input->getIdentifier());
+        element->setAttribute("name", input->getName());
+    }
+
+    for (int slot = 0; slot < numSlots; ++slot) {
+        auto target = decode(mappings[(size_t) slot]);
+        if (! target.isValid())
+            continue;
+
+        auto* element = xml.createNewChildElement("MAPPING");
+        element->setAttribute("channel", slot / 256 + 1);
+        element->setAttribute("type", (slot / 128) % 2 == 0 ? "note" : "controller");
+        element->setAttribute("number", slot % 128);
+        element->setAttribute("deck", target.deck);
+        element->setAttribute("control", getControlName(target.control));
+        element->setAttribute("index", target.index);
+    }
+
+    file.getParentDirectory().createDirectory();
+
+    if (! xml.writeTo(file)) {
+        std::cout << "MidiController::saveMappings  could not write " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// read the mappings from a file
+bool MidiController::loadMappings(const juce::File& file)
+{
+    auto xml = juce::XmlDocument::parse(file);
+
+    if (xml == nullptr || ! xml->hasTagName("MIDIMAPPINGS")) {
+        std::cout << "MidiController::loadMappings  could not read " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    clearMappings();
+
+    for (auto* element : xml->getChildWithTagNameIterator("MAPPING")) {
+        // the control is stored by name, so the file survives new controls
+        Target target;
+        target.deck = element->getIntAttribute("deck", -1);
+        target.index = element->getIntAttribute("index");
+        auto controlName = element->getStringAttribute("control");
+
+        auto found = false;
+        for (int control = 0; control <= (int) DJAudioPlayer::Control::eq && ! found; ++control) {
+            if (getControlName((DJAudioPlayer::Control) control) == controlName) {
+                target.control = (DJAudioPlayer::Control) control;
+                found = true;
+            }
+        }
+
+        if (! found || ! target.isValid())
+            continue;
+
+        auto channel = element->getIntAttribute("channel", 1);
+        auto number = element->getIntAttribute("number");
+        auto message = element->getStringAttribute("type") == "note"
+            ? juce::MidiMessage::noteOn(channel, number, (juce::uint8) 127)
+            : juce::MidiMessage::controllerEvent(channel, number, 127);
+
+        setMapping(message, target);
+    }
+
+    // the inputs that were open last time are opened again if they are there
+    auto available = juce::MidiInput::getAvailableDevices();
+
+    for (auto* element : xml->getChildWithTagNameIterator("INPUT")) {
+        for (auto& device : available) {
+            if (device.identifier == element->getStringAttribute("identifier"))
+                openInput(device.identifier);
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+// turn a message into a control of a deck
+void MidiController::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+{
+    // the thread of the input is raised the first time it calls in, so a
+    // busy message thread or analysis cannot hold the controls up
+    thread_local bool raised = false;
+    if (! raised) {
+        juce::Thread::setCurrentThreadPriority(9);
+        raised = true;
+    }
+
+    auto slot = getSlot(message);
+    if (slot < 0)
+        return;
+
+    // a note on or a controller is learnt, it does not move anything itself
+    auto learning = learnTarget.load();
+    if (learning != 0 && (message.isNoteOn() || message.isController())) {
+        setMapping(message, decode(learning));
+        learnTarget = 0;
+        learntTarget = learning;
+        triggerAsyncUpdate();
+        return;
+    }
+
+    auto target = decode(mappings[(size_t) slot]);
+    if (! juce::isPositiveAndBelow(target.deck, decks.size()))
+        return;
+
+    auto* deck = decks.getUnchecked(target.deck);
+
+    // a note is pressed or let go, a controller goes from 0 to 1
+    auto isController = message.isController();
+    auto value = isController ? message.getControllerValue() / 127.0f
+                              : (message.isNoteOn() ? 1.0f : 0.0f);
+
+    using Control = DJAudioPlayer::Control;
+
+    switch (target.control) {
+        case Control::play:
+        case Control::cue:
+        case Control::sync:
+        case Control::hotCue:
+            // buttons act when they are pressed
+            if (value >= 0.5f)
+                deck->postControl(target.control, 1.0f, target.index);
+            break;
+
+        case Control::jog: {
+            // a jog wheel sends how far it turned as a signed step from 64
+            if (! isController)
+                break;
+
+            auto step = message.getControllerValue();
+            auto ticks = step < 64 ? step : step - 128;
+            deck->postControl(Control::jog, (float) (ticks / jogTicksPerTurn * ScratchEngine::secondsPerTurn));
+            break;
+        }
+
+        case Control::jogTouch:
+            deck->postControl(Control::jogTouch, value >= 0.5f ? 1.0f : 0.0f);
+            break;
+
+        case Control::volume:
+            deck->postControl(Control::volume, value);
+            break;
+
+        case Control::speed:
+            // the middle of the pitch fader is the tempo of the track
+            deck->postControl(Control::speed, (float) (1.0 + (value * 2.0 - 1.0) * pitchRange));
+            break;
+
+        case Control::eq: {
+            // the middle of the knob is flat, all the way down kills the band
+            auto decibels = value < 0.5f ? DeckEqualiser::minDecibels * (1.0f - value * 2.0f)
+                                         : DeckEqualiser::maxDecibels * (value * 2.0f - 1.0f);
+            deck->postControl(Control::eq, decibels, target.index);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// tell the message thread a mapping has been learnt
+void MidiController::handleAsyncUpdate()
+{
+    saveMappings(getDefaultMappingsFile());
+
+    if (onMappingLearnt != nullptr)
+        onMappingLearnt(decode(learntTarget));
+}
+
+//==============================================================================
+// the slot of the note or controller of a message
+int MidiController::getSlot(const juce::MidiMessage& message)
+{
+    auto channel = message.getChannel() - 1;
+    if (! juce::isPositiveAndBelow(channel, 16))
+        return -1;
+
+    if (message.isNoteOnOrOff())
+        return channel * 256 + message.getNoteNumber();
+
+    if (message.isController())
+        return channel * 256 + 128 + message.getControllerNumber();
+
+    return -1;
+}
+
+// pack a target into one int
+int MidiController::encode(const Target& target)
+{
+    if (! target.isValid())
+        return 0;
+
+    return 1 + (target.deck << 12) + ((int) target.control << 6) + (target.index & 63);
+}
+
+// unpack a target
+MidiController::Target MidiController::decode(int code)
+{
+    Target target;
+
+    if (code <= 0)
+        return target;
+
+    code -= 1;
+    target.deck = code >> 12;
+    target.control = (DJAudioPlayer::Control) ((code >> 6) & 63);
+    target.index = code & 63;
+    return target;
+}
+
+// the name of a control in the mappings file
+juce::String MidiController::getControlName(DJAudioPlayer::Control control)
+{
+    switch (control) {
+        case DJAudioPlayer::Control::play:     return "play";
+        case DJAudioPlayer::Control::cue:      return "cue";
+        case DJAudioPlayer::Control::sync:     return "sync";
+        case DJAudioPlayer::Control::hotCue:   return "hotCue";
+        case DJAudioPlayer::Control::jog:      return "jog";
+        case DJAudioPlayer::Control::jogTouch: return "jogTouch";
+        case DJAudioPlayer::Control::volume:   return "volume";
+        case DJAudioPlayer::Control::speed:    return "speed";
+        case DJAudioPlayer::Control::eq:       return "eq";
+        default:                               return {};
+    }
+}
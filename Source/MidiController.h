@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    MidiController.h
+    Created: 19 Oct 2026 10:41:53pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ Maps the buttons, faders, knobs and jog wheels of MIDI controllers onto the
+ controls of the decks.
+
+ Incoming MIDI is handled on the thread of the MIDI input, which is raised to
+ a high priority the first time it calls in, and is never passed through the
+ message loop. Every note and controller of every channel has a slot in a
+ table of atomics, so looking up a mapping is one load, and the control is
+ posted straight into the lock-free queue of the deck, which the audio thread
+ empties at the start of every block. A jog wheel moves the track within one
+ block of the message arriving.
+
+ A mapping is learnt by picking a control of a deck and moving something on
+ the controller, the first note or controller that comes in is mapped to it.
+ The mappings and the inputs that were open are saved to a file.
+*/
+class MidiController : public juce::MidiInputCallback,
+                       private juce::AsyncUpdater
+{
+public:
+    MidiController();
+    ~MidiController() override;
+
+    /** The ticks of a jog wheel in one turn, most controllers send about this many */
+    static constexpr double jogTicksPerTurn = 128.0;
+    /** The range of a pitch fader either side of the tempo of the track */
+    static constexpr double pitchRange = 0.08;
+
+    /** What a note or controller is mapped to */
+    struct Target
+    {
+        /** The deck in the order they were added, -1 for nothing */
+        int deck = -1;
+        DJAudioPlayer::Control control = DJAudioPlayer::Control::play;
+        /** The hot cue or the band of the EQ */
+        int index = 0;
+
+        /** Returns true if the target points at a deck */
+        bool isValid() const;
+        /** Returns the name shown in the menus, like "Deck 1 hot cue 3" */
+        juce::String getName() const;
+    };
+
+    /** Returns every target that can be learnt for a number of decks */
+    static juce::Array<Target> getLearnableTargets(int numDecks);
+    /** Returns the file the mappings are kept in */
+    static juce::File getDefaultMappingsFile();
+
+    //==============================================================================
+    /** Adds a deck the mappings can point at, call this before opening inputs */
+    void addDeck(DJAudioPlayer* deck);
+
+    /** Starts listening to a MIDI input, returns false if it cannot be opened */
+    bool openInput(const juce::String& identifier);
+    /** Stops listening to a MIDI input */
+    void closeInput(const juce::String& identifier);
+    /** Returns true if a MIDI input is being listened to */
+    bool isInputOpen(const juce::String& identifier) const;
+
+    //==============================================================================
+    /** Maps the next note or controller that comes in to a target */
+    void startLearning(const Target& target);
+    /** Stops waiting for a note or controller to learn */
+    void stopLearning();
+    /** Returns true while waiting for a note or controller to learn */
+    bool isLearning() const;
+    /** Called on the message thread after a mapping has been learnt */
+    std::function<void(const Target&)> onMappingLearnt;
+
+    /** Maps the note or controller of a message to a target, replacing
+        whatever was mapped to either of them */
+    void setMapping(const juce::MidiMessage& message, const Target& target);
+    /** Removes every mapping */
+    void clearMappings();
+    /** Returns the number of notes and controllers that are mapped */
+    int getNumMappings() const;
+
+    /** Writes the mappings and the open inputs to a file */
+    bool saveMappings(const juce::File& file) const;
+    /** Reads the mappings from a file and opens the inputs it lists */
+    bool loadMappings(const juce::File& file);
+
+    //==============================================================================
+    /** Called by the MIDI inputs, turns a message into a control of a deck */
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+
+private:
+    /** Tells the message thread a mapping has been learnt */
+    void handleAsyncUpdate() override;
+
+    /** Returns the slot of the note or controller of a message, -1 if it has none */
+    static int getSlot(const juce::MidiMessage& message);
+    /** Packs a target into one int, 0 is no target */
+    static int encode(const Target& target);
+    /** Unpacks a target */
+    static Target decode(int code);
+    /** Returns the name of a control in the mappings file */
+    static juce::String getControlName(DJAudioPlayer::Control control);
+
+    // 16 channels of 128 notes and 128 controllers
+    static constexpr int numSlots = 16 * 2 * 128;
+
+    // the target of every slot, read by the MIDI thread and written by
+    // whoever maps it
+    std::array<std::atomic<int>, numSlots> mappings;
+
+    // the decks the targets point at
+    juce::Array<DJAudioPlayer*> decks;
+
+    // the target being learnt, 0 if none, and the one that was learnt last
+    std::atomic<int> learnTarget {0};
+    std::atomic<int> learntTarget {0};
+
+    // the inputs being listened to
+    juce::OwnedArray<juce::MidiInput> inputs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiController)
+};
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    MixScheduler.cpp
+    Created: 19 Oct 2026 8:36:12pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "MixScheduler.h"
+
+MixScheduler::MixScheduler() {}
+
+MixScheduler::~MixScheduler() {}
+
+//==============================================================================
+// hand a transition to the audio thread
+bool MixScheduler::schedule(const Transition& newTransition)
+{
+    if (state != idle || newTransition.fromDeck < 0 || newTransition.toDeck < 0
+        || newTransition.fromDeck == newTransition.toDeck) {
+        std::cout << "MixScheduler::schedule  the transition cannot be run" << std::endl;
+        return false;
+    }
+
+    // the audio thread does not read the transition while it is idle
+    transition = newTransition;
+    cancelRequested = false;
+    state = pending;
+    return true;
+}
+
+// drop the transition
+void MixScheduler::cancel()
+{
+    // a transition the audio thread has not seen yet or is done with is
+    // simply taken back, otherwise the audio thread drops it at the next piece
+    for (auto waiting : {pending, finished}) {
+        int expected = waiting;
+        if (state.compare_exchange_strong(expected, idle))
+            return;
+    }
+
+    if (state != idle)
+        cancelRequested = true;
+}
+
+// let the scheduler take the next transition
+void MixScheduler::acknowledge()
+{
+    int expected = finished;
+    state.compare_exchange_strong(expected, idle);
+}
+
+// the state of the transition
+MixScheduler::State MixScheduler::getState() const
+{
+    return (State) state.load();
+}
+
+// the transition being run
+const MixScheduler::Transition& MixScheduler::getTransition() const
+{
+    return transition;
+}
+
+// the sample the last crossfade started at
+juce::int64 MixScheduler::getFadeStartSample() const
+{
+    return fadeStartSample;
+}
+
+// the number of samples rendered
+juce::int64 MixScheduler::getMasterClock() const
+{
+    return masterClock;
+}
+
+//==============================================================================
+// tell the scheduler the rate of the output
+void MixScheduler::prepare(double _sampleRate)
+{
+    sampleRate = _sampleRate;
+}
+
+// work out how long the next piece may be
+int MixScheduler::beginPiece(const juce::Array<DJAudioPlayer*>& decks, int numSamples)
+{
+    pieceLength = numSamples;
+
+    if (cancelRequested.exchange(false))
+        state = idle;
+
+    // take a new transition, a transition between decks the mixer does not
+    // have is dropped
+    int current = state.load();
+    if (current == pending) {
+        if (juce::isPositiveAndBelow(transition.fromDeck, decks.size())
+            && juce::isPositiveAndBelow(transition.toDeck, decks.size())) {
+            // the message thread may have taken it back in the meantime
+            if (state.compare_exchange_strong(current, armed))
+                current = armed;
+        }
+        else {
+            state.compare_exchange_strong(current, idle);
+            current = state.load();
+        }
+    }
+
+    // find the sample in this piece at which the outgoing track reaches the
+    // trigger, the incoming deck has to be running by then
+    if (current == armed && decks.getUnchecked(transition.toDeck)->isPlaying()) {
+        auto* from = decks.getUnchecked(transition.fromDeck);
+        auto offset = (juce::int64) numSamples;
+
+        if (! from->isPlaying()) {
+            // the outgoing track stopped or ran out, so the next one comes in now
+            offset = 0;
+        }
+        else {
+            // the samples of the track played for every sample of the output
+            auto rate = from->getSpeed() * from->getTrackSampleRate() / sampleRate;
+            auto remaining = transition.triggerPosition - from->getTrackPosition();
+
+            if (remaining <= 0)
+                offset = 0;
+            else if (rate > 0.0)
+                offset = (juce::int64) std::ceil(remaining / rate);
+        }
+
+        if (offset == 0) {
+            fadeSamples = juce::jmax((juce::int64) 1, (juce::int64) (transition.fadeSeconds * sampleRate));
+            fadeDone = 0;
+            fadeStartSample = masterClock.load();
+            state = fading;
+            current = fading;
+        }
+        else if (offset < numSamples) {
+            // the piece ends where the transition starts
+            pieceLength = (int) offset;
+        }
+    }
+
+    // the piece ends where the crossfade ends
+    if (current == fading)
+        pieceLength = (int) juce::jmin((juce::int64) pieceLength, fadeSamples - fadeDone);
+
+    pieceState = current;
+    return pieceLength;
+}
+
+// the gain of a deck over the piece
+bool MixScheduler::getDeckGain(int deck, float& startGain, float& endGain) const
+{
+    startGain = 1.0f;
+    endGain = 1.0f;
+
+    switch (pieceState) {
+        case armed:
+            // the incoming deck waits, cued, until the transition starts
+            return deck != transition.toDeck;
+
+        case fading: {
+            if (deck != transition.fromDeck && deck != transition.toDeck)
+                return true;
+
+            // an equal power crossfade keeps the level of the mix steady
+            const auto halfPi = juce::MathConstants<double>::halfPi;
+            auto start = halfPi * (double) fadeDone / (double) fadeSamples;
+            auto end = halfPi * (double) (fadeDone + pieceLength) / (double) fadeSamples;
+
+            if (deck == transition.fromDeck) {
+                startGain = (float) std::cos(start);
+                endGain = (float) std::cos(end);
+            }
+            else {
+                startGain = (float) std::sin(start);
+                endGain = (float) std::sin(end);
+            }
+            return true;
+        }
+
+        case finished:
+            // the outgoing deck is silent until the message thread stops it
+            return deck != transition.fromDeck;
+
+        default:
+            return true;
+    }
+}
+
+// move the clock and the crossfade on
+void MixScheduler::endPiece(int numSamples)
+{
+    masterClock += numSamples;
+
+    if (pieceState == fading) {
+        fadeDone += numSamples;
+
+        if (fadeDone >= fadeSamples)
+            state = finished;
+    }
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    MixScheduler.h
+    Created: 19 Oct 2026 8:36:12pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+
+#include <atomic>
+
+//==============================================================================
+/*
+ Runs the transitions of the automix on the audio thread. A transition is
+ planned on the message thread and handed over as a few numbers: the deck
+ going out, the deck coming in, the position of the outgoing track at which
+ the incoming one starts, and the length of the crossfade. The mixer asks the
+ scheduler at the start of every piece it renders, and the scheduler ends the
+ piece exactly at the sample where the transition starts or the crossfade
+ ends, so both happen at an exact sample whatever the block size.
+
+ The incoming deck is loaded, cued, set to its tempo and started by the
+ message thread, but the mixer does not pull any audio from it until the
+ transition starts, so it starts playing at that exact sample. The outgoing
+ deck is no longer pulled once the crossfade is over.
+
+ The transition moves through its states with atomics only:
+ idle -> pending (message thread) -> armed (audio thread) -> fading (audio
+ thread) -> finished (audio thread) -> idle (message thread)
+*/
+class MixScheduler
+{
+public:
+    MixScheduler();
+    ~MixScheduler();
+
+    /** A transition between two decks, worked out on the message thread */
+    struct Transition
+    {
+        /** The indices in the mixer of the deck going out and the deck coming in */
+        int fromDeck = -1;
+        int toDeck = -1;
+        /** The position of the outgoing track in its own samples at which
+            the incoming deck starts */
+        juce::int64 triggerPosition = 0;
+        /** The length of the crossfade in seconds of the output */
+        double fadeSeconds = 0.0;
+    };
+
+    /** The states a transition moves through */
+    enum State { idle = 0, pending = 1, armed = 2, fading = 3, finished = 4 };
+
+    //==============================================================================
+    /** Hands a transition to the audio thread. Returns false if another one
+        is still running. Message thread */
+    bool schedule(const Transition& transition);
+    /** Drops the transition, both decks are mixed in at full level from the
+        next block. Message thread */
+    void cancel();
+    /** Lets the scheduler take the next transition once the outgoing deck
+        has been stopped. Message thread */
+    void acknowledge();
+    /** Returns the state of the transition */
+    State getState() const;
+    /** Returns the transition being run, only use this while the state is
+        not idle */
+    const Transition& getTransition() const;
+    /** Returns the sample of the master clock at which the last crossfade
+        started, -1 if none has */
+    juce::int64 getFadeStartSample() const;
+    /** Returns the number of samples the mixer has rendered */
+    juce::int64 getMasterClock() const;
+
+    //==============================================================================
+    /** Tells the scheduler the rate of the output */
+    void prepare(double sampleRate);
+    /** Called by the mixer before it renders a piece, returns the number of
+        samples the piece may have so it ends where the transition changes.
+        Audio thread */
+    int beginPiece(const juce::Array<DJAudioPlayer*>& decks, int numSamples);
+    /** Returns false if a deck must not be pulled in this piece, otherwise
+        fills in the gain at its start and end. Audio thread */
+    bool getDeckGain(int deck, float& startGain, float& endGain) const;
+    /** Called by the mixer after it rendered a piece. Audio thread */
+    void endPiece(int numSamples);
+
+private:
+    // the transition, written while idle and read by the audio thread once it is pending
+    Transition transition;
+    std::atomic<int> state {idle};
+    std::atomic<bool> cancelRequested {false};
+
+    // the rate of the output
+    double sampleRate = 44100.0;
+    // the samples rendered so far and the sample the last crossfade started at
+    std::atomic<juce::int64> masterClock {0};
+    std::atomic<juce::int64> fadeStartSample {-1};
+
+    // the crossfade, audio thread only
+    juce::int64 fadeSamples = 0;
+    juce::int64 fadeDone = 0;
+    // the state and length of the piece being rendered, audio thread only
+    int pieceState = idle;
+    int pieceLength = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixScheduler)
+};
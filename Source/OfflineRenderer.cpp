@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 19 Oct 2026 4:47:03pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+// render the mixer and write the master and the cue bus to files
+bool OfflineRenderer::render(DeckMixer& mixer,
+                             double sampleRate,
+                             int blockSize,
+                             double lengthInSeconds,
+                             const juce::File& directory,
+                             const std::function<bool()>& afterBlock)
+{
+    directory.createDirectory();
+
+    auto masterWriter = createWriter(directory.getChildFile("master.wav"), sampleRate);
+    auto cueWriter = createWriter(directory.getChildFile("cue.wav"), sampleRate);
+
+    if (masterWriter == nullptr || cueWriter == nullptr)
+        return false;
+
+    // four outputs, so the cue bus gets a stereo pair of its own
+    juce::AudioBuffer<float> buffer {4, blockSize};
+    mixer.prepareToPlay(blockSize, sampleRate);
+
+    auto totalSamples = (juce::int64) (lengthInSeconds * sampleRate);
+
+    for (juce::int64 done = 0; done < totalSamples; done += blockSize) {
+        auto numSamples = (int) juce::jmin((juce::int64) blockSize, totalSamples - done);
+
+        juce::AudioSourceChannelInfo info {&buffer, 0, numSamples};
+        mixer.getNextAudioBlock(info);
+
+        // the two buses are views onto the channels of the buffer
+        juce::AudioBuffer<float> master {buffer.getArrayOfWritePointers(), 2, numSamples};
+        juce::AudioBuffer<float> cue {buffer.getArrayOfWritePointers() + 2, 2, numSamples};
+
+        masterWriter->writeFromAudioSampleBuffer(master, 0, numSamples);
+        cueWriter->writeFromAudioSampleBuffer(cue, 0, numSamples);
+
+        if (afterBlock != nullptr && ! afterBlock())
+            break;
+    }
+
+    mixer.releaseResources();
+    return true;
+}
+
+// open a 24 bit stereo wav file for writing
+std::unique_ptr<juce::AudioFormatWriter> OfflineRenderer::createWriter(const juce::File& file, double sampleRate)
+{
+    // start from an empty file
+    file.deleteFile();
+
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->failedToOpen()) {
+        std::cout << "OfflineRenderer::render  could not open " << file.getFullPathName() << std::endl;
+        return nullptr;
+    }
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer (
+        wavFormat.createWriterFor(stream.get(), sampleRate, 2, 24, {}, 0));
+
+    if (writer == nullptr) {
+        std::cout << "OfflineRenderer::render  could not write " << file.getFullPathName() << std::endl;
+        return nullptr;
+    }
+
+    // the writer owns the stream from now on
+    stream.release();
+    return writer;
+}
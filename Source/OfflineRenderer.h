@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 19 Oct 2026 4:47:03pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckMixer.h"
+
+#include <functional>
+
+//==============================================================================
+/*
+ Renders a mixer without an audio device, as fast as it can, and writes the
+ master and the cue bus to separate files. Used to check the mix and the cue
+ routing on machines without headphones or a multichannel interface.
+*/
+class OfflineRenderer
+{
+public:
+    /** Renders a number of seconds of the mixer and writes master.wav and
+        cue.wav into a directory. The decks must already be loaded and
+        playing. afterBlock is called after every block, to move an automix on
+        the way the message thread would, and the render ends early when it
+        returns false. Returns false if a file could not be written */
+    static bool render(DeckMixer& mixer,
+                       double sampleRate,
+                       int blockSize,
+                       double lengthInSeconds,
+                       const juce::File& directory,
+                       const std::function<bool()>& afterBlock = nullptr);
+
+private:
+    /** Opens a 24 bit stereo wav file for writing */
+    static std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& file, double sampleRate);
+};
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    PlayHistory.cpp
+    Created: 20 Oct 2026 1:47:38am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "PlayHistory.h"
+
+#include <algorithm>
+#include <map>
+#include <string_view>
+
+namespace
+{
+    // the writer is woken once this many events are waiting
+    const int batchSize = 256;
+    // a reader is asked whether to stop this often
+    const int stopCheckLines = 4096;
+    // and writes what there is at least this often
+    const int flushIntervalMillis = 2000;
+
+    // the name of an event in the log
+    const char* getTypeName(PlayHistory::EventType type)
+    {
+        return type == PlayHistory::EventType::play ? "play" : "load";
+    }
+}
+
+//==============================================================================
+PlayHistory::PlayHistory(const juce::File& _logFile)
+: juce::Thread("Play history"),
+  logFile(_logFile),
+  lengthAtStart(_logFile.getSize()),
+  events((size_t) fifo.getTotalSize())
+{
+    startThread(2);
+}
+
+PlayHistory::~PlayHistory()
+{
+    // the writer is never killed halfway through a batch
+    stopThread(-1);
+
+    // the writer has stopped, so what is left is written from here
+    do {
+        moveOverflow();
+        writePending();
+    } while (! overflow.empty());
+}
+
+//==============================================================================
+// log an event for the writer
+void PlayHistory::log(EventType type, int deck, const juce::URL& url, juce::int64 timeMillis)
+{
+    if (timeMillis == 0)
+        timeMillis = juce::Time::currentTimeMillis();
+
+    overflow.push_back({type, deck, timeMillis, url.toString(false)});
+    moveOverflow();
+
+    if (fifo.getNumReady() >= batchSize)
+        notify();
+}
+
+// wake the writer
+void PlayHistory::flush()
+{
+    moveOverflow();
+    notify();
+}
+
+// read the events logged before the history was created
+bool PlayHistory::readLog(const std::function<void(const Event&)>& callback) const
+{
+    return readLog(logFile, lengthAtStart, [] { return false; }, callback);
+}
+
+// read the events of the start of a log in order, the writer only ever
+// appends after it
+bool PlayHistory::readLog(const juce::File& logFile, juce::int64 numBytes,
+                          const std::function<bool()>& shouldStop,
+                          const std::function<void(const Event&)>& callback)
+{
+    if (numBytes <= 0)
+        return true;
+
+    juce::MemoryBlock data;
+    juce::FileInputStream stream {logFile};
+
+    if (stream.failedToOpen() || stream.readIntoMemoryBlock(data, numBytes) != (size_t) numBytes) {
+        std::cout << "PlayHistory::readLog: could not read " << logFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    std::string_view text {static_cast<const char*>(data.getData()), data.getSize()};
+    Event event;
+
+    for (int numLines = 1; ! text.empty(); ++numLines) {
+        if (numLines % stopCheckLines == 0 && shouldStop())
+            return false;
+
+        auto end = text.find('\n');
+        // a last line without an end was cut short
+        if (end == std::string_view::npos)
+            break;
+
+        auto line = text.substr(0, end);
+        text.remove_prefix(end + 1);
+
+        // the time, the event, the deck and the url
+        std::string_view fields[4];
+        size_t numFields = 0;
+
+        while (numFields < 3) {
+            auto tab = line.find('\t');
+            if (tab == std::string_view::npos)
+                break;
+
+            fields[numFields++] = line.substr(0, tab);
+            line.remove_prefix(tab + 1);
+        }
+
+        if (numFields < 3 || line.empty() || (fields[1] != "load" && fields[1] != "play"))
+            continue;
+
+        event.timeMillis = juce::String(fields[0].data(), fields[0].size()).getLargeIntValue();
+        event.type = fields[1] == "play" ? EventType::play : EventType::load;
+        event.deck = juce::String(fields[2].data(), fields[2].size()).getIntValue();
+        event.url = juce::String::fromUTF8(line.data(), (int) line.size());
+        callback(event);
+    }
+
+    return true;
+}
+
+// the number of events written
+int PlayHistory::getNumWritten() const
+{
+    return numWritten.load();
+}
+
+// the log file
+const juce::File& PlayHistory::getLogFile() const
+{
+    return logFile;
+}
+
+// the length of the log before it was appended to
+juce::int64 PlayHistory::getLengthAtStart() const
+{
+    return lengthAtStart;
+}
+
+//==============================================================================
+// write the events in batches
+void PlayHistory::run()
+{
+    while (! threadShouldExit()) {
+        wait(flushIntervalMillis);
+        writePending();
+    }
+}
+
+// move what the queue had no room for into it
+void PlayHistory::moveOverflow()
+{
+    if (overflow.empty())
+        return;
+
+    auto numToMove = std::min(fifo.getFreeSpace(), (int) overflow.size());
+    if (numToMove == 0)
+        return;
+
+    {
+        const auto scope = fifo.write(numToMove);
+        auto next = overflow.begin();
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            events[(size_t) (scope.startIndex1 + i)] = std::move(*next++);
+        for (int i = 0; i < scope.blockSize2; ++i)
+            events[(size_t) (scope.startIndex2 + i)] = std::move(*next++);
+    }
+
+    overflow.erase(overflow.begin(), overflow.begin() + numToMove);
+}
+
+// append the waiting events to the log
+void PlayHistory::writePending()
+{
+    auto numReady = fifo.getNumReady();
+    if (numReady == 0)
+        return;
+
+    lines.clear();
+
+    {
+        const auto scope = fifo.read(numReady);
+
+        auto addLine = [this] (const Event& event)
+        {
+            lines << event.timeMillis << '\t' << getTypeName(event.type) << '\t'
+                  << event.deck << '\t' << event.url << '\n';
+        };
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            addLine(events[(size_t) (scope.startIndex1 + i)]);
+        for (int i = 0; i < scope.blockSize2; ++i)
+            addLine(events[(size_t) (scope.startIndex2 + i)]);
+    }
+
+    // the slots are free again before the disk is touched
+    juce::FileOutputStream stream {logFile};
+
+    if (stream.failedToOpen()) {
+        std::cout << "PlayHistory::writePending: could not open " << logFile.getFullPathName() << std::endl;
+        return;
+    }
+
+    stream.writeText(lines, false, false, nullptr);
+    stream.flush();
+    numWritten += numReady;
+}
+
+//==============================================================================
+PlayCountJob::PlayCountJob(const PlayHistory& history)
+: juce::ThreadPoolJob("Play counts"),
+  logFile(history.getLogFile()),
+  logLength(history.getLengthAtStart()) {}
+
+PlayCountJob::~PlayCountJob() {}
+
+// count the plays of every track in the log
+juce::ThreadPoolJob::JobStatus PlayCountJob::runJob()
+{
+    // the position of the plays of every url in the result
+    std::map<juce::String, size_t> positions;
+
+    successful = PlayHistory::readLog(logFile, logLength, [this] { return shouldExit(); },
+                                      [this, &positions] (const PlayHistory::Event& event)
+    {
+        if (event.type != PlayHistory::EventType::play)
+            return;
+
+        auto position = positions.emplace(event.url, plays.size());
+        if (position.second)
+            plays.push_back({event.url, 0, 0});
+
+        auto& track = plays[position.first->second];
+        ++track.count;
+        // the log is in order, but a deck may report a start late
+        track.lastPlayedMillis = juce::jmax(track.lastPlayedMillis, event.timeMillis);
+    });
+
+    finished = true;
+
+    if (onFinished != nullptr)
+        onFinished();
+
+    return jobHasFinished;
+}
+
+// check if the job is done
+bool PlayCountJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the log was read to the end
+bool PlayCountJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the plays of every track played
+const std::vector<PlayCountJob::Plays>& PlayCountJob::getPlays() const
+{
+    return plays;
+}
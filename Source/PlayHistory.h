@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    PlayHistory.h
+    Created: 20 Oct 2026 1:47:38am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Records every track loaded into a deck and every time a deck starts
+ playing, in a log file that is only ever appended to.
+
+ Events are logged on the message thread into a lock free queue and written
+ by a thread of its own, in batches every few seconds or once enough have
+ come in, so logging never waits for the disk. A queue that is full keeps the
+ events on the message thread until the writer has caught up, none are lost.
+
+ Every line of the log is the time in milliseconds since 1970, the event,
+ the deck and the url, separated by tabs. A line cut short by a crash is
+ skipped when the log is read.
+*/
+class PlayHistory : private juce::Thread
+{
+public:
+    /** Creates a history that appends to the given file */
+    PlayHistory(const juce::File& logFile);
+    /** Writes the events that are left before returning */
+    ~PlayHistory() override;
+
+    /** The things that happen to a deck */
+    enum class EventType { load, play };
+
+    /** A line of the log */
+    struct Event
+    {
+        EventType type = EventType::load;
+        /** The deck, 1 for the first one */
+        int deck = 0;
+        /** The time in milliseconds since 1970 */
+        juce::int64 timeMillis = 0;
+        juce::String url;
+    };
+
+    /** Logs an event, message thread only. The time is now if it is not given */
+    void log(EventType type, int deck, const juce::URL& url, juce::int64 timeMillis = 0);
+    /** Asks the writer to write the events logged so far without waiting
+        for the next batch, message thread only */
+    void flush();
+
+    /** Reads every event logged before the history was created in the order
+        they happened, on any thread. Returns false if the log could not be read */
+    bool readLog(const std::function<void(const Event&)>& callback) const;
+    /** Reads the events in the first bytes of a log. shouldStop is asked
+        every so many lines and stops the reading if it returns true */
+    static bool readLog(const juce::File& logFile, juce::int64 numBytes,
+                        const std::function<bool()>& shouldStop,
+                        const std::function<void(const Event&)>& callback);
+
+    /** Returns the number of events written to the log since it was created */
+    int getNumWritten() const;
+    /** Returns the log file */
+    const juce::File& getLogFile() const;
+    /** Returns the length of the log when the history was created */
+    juce::int64 getLengthAtStart() const;
+
+private:
+    /** Writes the events in batches until the history is deleted */
+    void run() override;
+    /** Moves the events the queue had no room for into it. Message thread */
+    void moveOverflow();
+    /** Writes the events in the queue to the log. Writer thread */
+    void writePending();
+
+    // the file the events are appended to, and its length before this
+    // history appended to it
+    juce::File logFile;
+    juce::int64 lengthAtStart = 0;
+
+    // the events waiting for the writer, the message thread is the only
+    // one adding to it and the writer the only one taking from it
+    juce::AbstractFifo fifo {4096};
+    std::vector<Event> events;
+    // the events the queue had no room for, only used by the message thread
+    std::vector<Event> overflow;
+
+    // the events written so far
+    std::atomic<int> numWritten {0};
+    // the lines of a batch, kept so a batch does not allocate once it is as
+    // long as the longest one
+    juce::String lines;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlayHistory)
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that counts the plays of every track in the log
+ of a history, which takes a while once the log is years long
+*/
+class PlayCountJob : public juce::ThreadPoolJob
+{
+public:
+    /** Creates a job that reads the events logged before a history was created */
+    PlayCountJob(const PlayHistory& history);
+    ~PlayCountJob() override;
+
+    /** The plays of a track */
+    struct Plays
+    {
+        juce::String url;
+        int count = 0;
+        /** The time of the last play in milliseconds since 1970 */
+        juce::int64 lastPlayedMillis = 0;
+    };
+
+    /** Counts the plays */
+    JobStatus runJob() override;
+
+    /** Called on the pool thread when the job is done, set this before the
+        job is added to the pool */
+    std::function<void()> onFinished;
+
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the log was read to the end */
+    bool wasSuccessful() const;
+    /** Returns the plays of every track played, in the order they were first
+        played. Only use this once isFinished returns true */
+    const std::vector<Plays>& getPlays() const;
+
+private:
+    // the part of the log to read
+    juce::File logFile;
+    juce::int64 logLength = 0;
+
+    // the result and whether it is ready
+    std::vector<Plays> plays;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlayCountJob)
+};
@@ -13,49 +13,21 @@
 
 //==============================================================================
 PlaylistComponent::PlaylistComponent(
-    DeckGUI* _deck,
+    DeckGUI* _deck1,
+    DeckGUI* _deck2,
     juce::AudioFormatManager* _formatManager
-) : deck(_deck),
+) : deck1(_deck1),
+    deck2(_deck2),
     formatManager(_formatManager)
 {
-    // check if the data file exits or not
-    if (!dataFile.existsAsFile()) { // data file does not exists
-        // create a new file
-        auto result = dataFile.create();
-        // check if file was succesfully created
-        if (result.failed()) {
-            // print error - if any
-            std::cout << result.getErrorMessage() << std::endl;
-        }
-    }
-    
-    // read data from the data file
-    dataFile.readLines(lines);
-    // check if there is any data
-    if (lines.size() != 0) {
-        // iterate over the lines of the data file
-        for (auto& line : lines) {
-            // check if line is empty
-            if (line != "") { // line is not empty
-                // create a url from the string
-                juce::URL trackURL {line};
-                // create a file from the url
-                juce::File trackFile {trackURL.getLocalFile()};
-                // create a pair for the name and url of the track
-                std::pair<std::string, juce::URL> savedTrack;
-                savedTrack.first = trackFile.getFileName().toStdString();
-                savedTrack.second = trackURL;
-                
-                // insert the saved track to the tracks list
-                tracks.insert(savedTrack);
-            } // end if
-        } // end for
-    } // end if
-    
     // add and the load button visible
     addAndMakeVisible(loadButton);
     // add and make the search box visible
     addAndMakeVisible(searchBox);
+    // add and make the key filter visible
+    addAndMakeVisible(keyFilter);
+    // add and make the crate filter visible
+    addAndMakeVisible(crateFilter);
     // add and make the table list component visible
     addAndMakeVisible(tableComponent);
     
@@ -66,10 +38,141 @@ PlaylistComponent::PlaylistComponent(
     // set the model of the table
     tableComponent.setModel(this);
     
+    // the columns of the buttons cannot be sorted by
+    auto buttonFlags = juce::TableHeaderComponent::visible | juce::TableHeaderComponent::resizable;
+    
     // add a column to the table for the track titles
-    tableComponent.getHeader().addColumn("Track title", 1, 550);
+    tableComponent.getHeader().addColumn("Track title", titleColumn, 400, 100);
+    // add columns to the table for the key and tempo of the tracks
+    tableComponent.getHeader().addColumn("Key", keyColumn, 50, 40);
+    tableComponent.getHeader().addColumn("BPM", bpmColumn, 50, 40);
+    // add a column to the table for the loudness of the tracks
+    tableComponent.getHeader().addColumn("LUFS", loudnessColumn, 60, 40);
+    // add a column to the table for the group of tracks that sound the same
+    tableComponent.getHeader().addColumn("Dupes", dupesColumn, 60, 40);
+    // add columns to the table for how often and when the tracks were played
+    tableComponent.getHeader().addColumn("Plays", playsColumn, 50, 40);
+    tableComponent.getHeader().addColumn("Last played", lastPlayedColumn, 90, 40);
     // add a column to the table for the play button
-    tableComponent.getHeader().addColumn("", 2, 175);
+    tableComponent.getHeader().addColumn("", playColumn, 75, 40, -1, buttonFlags);
+    // add a column to the table for the button queuing the next track
+    tableComponent.getHeader().addColumn("", nextColumn, 75, 40, -1, buttonFlags);
+    // the columns share the width of the table instead of a fixed one
+    tableComponent.getHeader().setStretchToFitActive(true);
+    
+    // the plays of the tracks are counted again from the history log in
+    // the background, a long log would hold up the start of the app
+    libraryAnalyser.countPlays(history);
+    
+    // the auto gain of a deck needs the loudness of every track it loads,
+    // including a queued track when it is swapped in, and the key filter
+    // matches the track of a deck
+    for (auto* deck : {deck1, deck2}) {
+        auto deckNumber = deck == deck1 ? 1 : 2;
+        
+        deck->onTrackLoaded = [this, deck, deckNumber] (const juce::URL& url)
+        {
+            (deck == deck1 ? deck1URL : deck2URL) = url;
+            history.log(PlayHistory::EventType::load, deckNumber, url);
+            sendAnalysisToDeck(deck, url);
+            
+            auto choice = keyFilter.getSelectedId();
+            if ((choice == matchDeck1 && deck == deck1) || (choice == matchDeck2 && deck == deck2))
+                updateKeyFilter();
+        };
+        
+        // a play is logged and counted at once, the log is written later
+        deck->onPlayStarted = [this, deck, deckNumber] (juce::int64 timeMillis)
+        {
+            auto& url = deck == deck1 ? deck1URL : deck2URL;
+            if (url.isEmpty())
+                return;
+            
+            history.log(PlayHistory::EventType::play, deckNumber, url, timeMillis);
+            library.setTrackPlayed(url, timeMillis);
+            
+            // the crates took in the play, the rows are only found again
+            // if they may have changed
+            updateCrateList();
+            if (library.getCrateFilter() >= 0 || ! library.getSortOrder().isEmpty()) {
+                library.setCrateFilter(library.getCrateFilter());
+                tableComponent.updateContent();
+            }
+            tableComponent.repaint();
+        };
+    }
+    
+    // the key filter lists every key in the order of the wheel
+    keyFilter.addItem("All keys", allKeys);
+    keyFilter.addItem("Match deck 1", matchDeck1);
+    keyFilter.addItem("Match deck 2", matchDeck2);
+    keyFilter.addSeparator();
+    for (int number = 1; number <= 12; ++number) {
+        for (auto minor : {true, false}) {
+            TrackLibrary::Harmony key {number, minor};
+            keyFilter.addItem(key.getCamelot(), firstKey + (number - 1) * 2 + (minor ? 0 : 1));
+        }
+    }
+    keyFilter.setSelectedId(allKeys, juce::dontSendNotification);
+    keyFilter.onChange = [this] { updateKeyFilter(); };
+    
+    // the crate filter shows the tracks of a crate, or opens the editor
+    updateCrateList();
+    crateFilter.onChange = [this]
+    {
+        auto choice = crateFilter.getSelectedId();
+        
+        if (choice == addCrate) {
+            showCrateEditor(-1);
+        }
+        else if (choice == changeCrate) {
+            showCrateEditor(library.getCrateFilter());
+        }
+        else {
+            library.setCrateFilter(choice >= firstCrate ? choice - firstCrate : -1);
+            updateCrateList();
+            tableComponent.updateContent();
+            tableComponent.repaint();
+        }
+    };
+    
+    // the results of a search replace the tracks shown as they come in,
+    // first without typos and then with them
+    trackSearch.onResults = [this] (const std::vector<int>& ids)
+    {
+        library.setSearchResults(ids);
+        tableComponent.updateContent();
+        tableComponent.repaint();
+    };
+    
+    // show the analysis of the tracks as it comes in, the suggestions
+    // change with every key found
+    libraryAnalyser.onTracksAnalysed = [this]
+    {
+        // the keys and tempos are searched from the next keystroke on
+        searchTracksOutOfDate = true;
+        
+        // the crates took in the analysed tracks and the plays of the log as
+        // they came, only the rows shown have to be found again
+        updateCrateList();
+        if (library.getCrateFilter() >= 0 || ! library.getSortOrder().isEmpty()) {
+            library.setCrateFilter(library.getCrateFilter());
+            tableComponent.updateContent();
+        }
+        
+        if (keyFilter.getSelectedId() == allKeys)
+            tableComponent.repaint();
+        else
+            updateKeyFilter();
+    };
+    
+    // measure the tracks that were imported before, once the formats have
+    // been registered, which happens after the playlist is created
+    juce::Component::SafePointer<PlaylistComponent> safeThis {this};
+    juce::MessageManager::callAsync([safeThis] {
+        if (safeThis != nullptr)
+            safeThis->libraryAnalyser.analyseNewTracks();
+    });
     
     // disable multiline feature
     searchBox.setMultiLine(false);
@@ -88,6 +191,11 @@ PlaylistComponent::PlaylistComponent(
 
 PlaylistComponent::~PlaylistComponent()
 {
+    // the decks outlive the playlist
+    deck1->onTrackLoaded = nullptr;
+    deck2->onTrackLoaded = nullptr;
+    deck1->onPlayStarted = nullptr;
+    deck2->onPlayStarted = nullptr;
 }
 
 void PlaylistComponent::paint (juce::Graphics& g)
@@ -107,14 +215,75 @@ void PlaylistComponent::resized()
     
     // set the size of the search box
     searchBox.setBounds(getWidth() - getWidth()/3 - 10, 5, getWidth() / 3, getHeight()/12);
+    // the key filter sits before the search box
+    keyFilter.setBounds(getWidth() - getWidth()/3 - 140, 5, 120, getHeight()/12);
+    // the crate filter sits before the key filter
+    crateFilter.setBounds(getWidth() - getWidth()/3 - 270, 5, 120, getHeight()/12);
     
     // set the size of the table component (it takes the whole area)
     tableComponent.setBounds(0, getHeight()/8, getWidth(), getHeight());
 }
 
+// the tracks for the automix, from the selected row down
+juce::Array<juce::URL> PlaylistComponent::getAutomixQueue() {
+    juce::Array<juce::URL> queue;
+    
+    for (int row = juce::jmax(0, tableComponent.getSelectedRow()); row < library.getNumTracks(); ++row)
+        queue.add(library.getTrackURL(row));
+    
+    return queue;
+}
+
+// what the table shows, for a session snapshot
+SessionState::View PlaylistComponent::getSessionView() const {
+    SessionState::View view;
+    view.searchText = searchBox.getText();
+    view.keyFilter = keyFilter.getSelectedId();
+    if (library.getCrateFilter() >= 0)
+        view.crate = library.getCrate(library.getCrateFilter()).name;
+    view.sortOrder = library.getSortOrder();
+    return view;
+}
+
+// show what the table showed when the snapshot was taken
+void PlaylistComponent::restoreSessionView(const SessionState::View& view) {
+    using SortField = TrackLibrary::SortField;
+    
+    // the header shows the first field sorted by, the ones after it are
+    // kept when it tells the table
+    library.setSortOrder(view.sortOrder);
+    if (! view.sortOrder.isEmpty()) {
+        int column = titleColumn;
+        switch (view.sortOrder.getReference(0).field) {
+            case SortField::title:      column = titleColumn;      break;
+            case SortField::key:        column = keyColumn;        break;
+            case SortField::bpm:        column = bpmColumn;        break;
+            case SortField::loudness:   column = loudnessColumn;   break;
+            case SortField::duplicate:  column = dupesColumn;      break;
+            case SortField::plays:      column = playsColumn;      break;
+            case SortField::lastPlayed: column = lastPlayedColumn; break;
+        }
+        tableComponent.getHeader().setSortColumnId(column, view.sortOrder.getReference(0).forwards);
+    }
+    
+    // a crate that has been deleted since shows all tracks
+    for (int crate = 0; crate < library.getNumCrates(); ++crate)
+        if (library.getCrate(crate).name == view.crate)
+            library.setCrateFilter(crate);
+    updateCrateList();
+    
+    // the key filter and the search box filter the table as if they were used
+    if (keyFilter.indexOfItemId(view.keyFilter) >= 0)
+        keyFilter.setSelectedId(view.keyFilter, juce::sendNotificationSync);
+    searchBox.setText(view.searchText, true);
+    
+    tableComponent.updateContent();
+    tableComponent.repaint();
+}
+
 // function that returns the number of rows currently in the table
 int PlaylistComponent::getNumRows () {
-    return static_cast<int>(tracks.size());
+    return library.getNumTracks();
 }
 
 // Draws the background behind one of the rows in the table
@@ -144,54 +313,136 @@ void PlaylistComponent::paintCell (
    int height,
    bool rowIsSelected
 ) {
-    // integer to keep track of the row number
-    unsigned int counter = 0;
-    // iterate over all the tracks
-    for (auto& item: tracks) {
-        // if rowNumber is equal to the row counter display the
-        // track name at the respective row
-        if (counter == rowNumber) {
-            // draw the track title
-            g.drawText(item.first,
-                       2,
-                       0,
-                       width - 4,
-                       height,
-                       juce::Justification::centredLeft,
-                       true);
-            // break out of the loop
-            break;
-        } // end of if
-        // increment the row counter
-        counter ++;
-    } // end of for
+    // the buttons of the row are drawn, not made, so scrolling through a
+    // large library does not create a component per row
+    if (columnId == playColumn || columnId == nextColumn) {
+        paintCellButton(g, columnId == playColumn ? "play" : "next", width, height);
+        return;
+    }
+    
+    // draw the key or the tempo of the track, once they have been found
+    if (columnId == keyColumn || columnId == bpmColumn) {
+        TrackLibrary::Harmony harmony;
+        juce::String text {"..."};
+        
+        if (library.getTrackHarmony(rowNumber, harmony))
+            text = columnId == keyColumn ? harmony.getCamelot() : juce::String(harmony.bpm, 0);
+        
+        g.drawText(text, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        return;
+    }
+    
+    // draw the loudness of the track, once it has been measured
+    if (columnId == loudnessColumn) {
+        TrackLibrary::Loudness loudness;
+        auto text = library.getTrackLoudness(rowNumber, loudness)
+            ? juce::String(loudness.integratedLufs, 1)
+            : juce::String("...");
+        
+        g.drawText(text, 2, 0, width - 4, height, juce::Justification::centredRight, true);
+        return;
+    }
+    
+    // flag the tracks that sound like others, the tracks of a group share
+    // its number
+    if (columnId == dupesColumn) {
+        int group = 0;
+        float similarity = 0.0f;
+        juce::String text;
+        
+        if (library.getDuplicateGroup(rowNumber, group, similarity))
+            text = (similarity >= DuplicateIndex::duplicateSimilarity ? "dup " : "near ") + juce::String(group);
+        
+        g.drawText(text, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        return;
+    }
+    
+    // draw how often the track was played and the day it last was, empty
+    // if it never was
+    if (columnId == playsColumn || columnId == lastPlayedColumn) {
+        int playCount = 0;
+        juce::int64 lastPlayedMillis = 0;
+        juce::String text;
+        
+        if (library.getTrackPlays(rowNumber, playCount, lastPlayedMillis))
+            text = columnId == playsColumn
+                ? juce::String(playCount)
+                : juce::Time(lastPlayedMillis).formatted("%d %b %Y");
+        
+        g.drawText(text, 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        return;
+    }
+    
+    // draw the track title, which the library keeps as UTF-8
+    auto title = library.getTrackTitle(rowNumber);
+    g.drawText(juce::String::fromUTF8(title.data(), (int) title.size()),
+               2,
+               0,
+               width - 4,
+               height,
+               juce::Justification::centredLeft,
+               true);
 } // end of function
 
-// function used to create or update a custom component that goes into a cell
-juce::Component* PlaylistComponent::refreshComponentForCell (
-    int rowNumber,
-    int columnId,
-    bool isRowSelected,
-    Component* existingComponentToUpdate
-) {
-    // add a custom play button to the third column for every row
-    if (columnId == 2) {
-        // check if the already exisiting component is a null pointer
-        if (existingComponentToUpdate == nullptr) {
-            // pointer to the play button
-            juce::TextButton* btn = new juce::TextButton{"play"};
-            // create and add an id to the button
-            juce::String id{std::to_string(rowNumber)};
-            btn->setComponentID(id);
-            // add an event listener to the button
-            btn->addListener(this);
-            // set existingComponentToUpdate to the button pointer
-            existingComponentToUpdate = btn;
+// draw a button into a cell, in the colours of a text button
+void PlaylistComponent::paintCellButton(juce::Graphics& g, const juce::String& text, int width, int height) {
+    auto area = juce::Rectangle<int>(width, height).reduced(2).toFloat();
+    
+    g.setColour(getLookAndFeel().findColour(juce::TextButton::buttonColourId));
+    g.fillRoundedRectangle(area, 4.0f);
+    
+    g.setColour(getLookAndFeel().findColour(juce::TextButton::textColourOffId));
+    g.drawText(text, area, juce::Justification::centred, true);
+}
+
+// function called when a cell is clicked
+void PlaylistComponent::cellClicked (int rowNumber, int columnId, const juce::MouseEvent&) {
+    // the play button loads the track to the first deck, which passes its
+    // loudness on
+    if (columnId == playColumn) {
+        deck1->loadURL(library.getTrackURL(rowNumber));
+    } // end of if
+    
+    // the next button queues the track on the idle deck
+    else if (columnId == nextColumn) {
+        auto* deck = getIdleDeck();
+        
+        // a track can only be queued on a deck that is not playing
+        if (deck == nullptr) {
+            std::cout << "PlaylistComponent::cellClicked  both decks are playing" << std::endl;
+            return;
         }
+        
+        // open the track and work out its waveform in the background
+        deck->preloadURL(library.getTrackURL(rowNumber));
+    } // end of else if
+} // end of function
+
+// function called when a column header is clicked
+void PlaylistComponent::sortOrderChanged (int newSortColumnId, bool isForwards) {
+    using SortField = TrackLibrary::SortField;
+    
+    SortField field;
+    switch (newSortColumnId) {
+        case titleColumn:      field = SortField::title;      break;
+        case keyColumn:        field = SortField::key;        break;
+        case bpmColumn:        field = SortField::bpm;        break;
+        case loudnessColumn:   field = SortField::loudness;   break;
+        case dupesColumn:      field = SortField::duplicate;  break;
+        case playsColumn:      field = SortField::plays;      break;
+        case lastPlayedColumn: field = SortField::lastPlayed; break;
+        default:               return;
     }
     
-    // return the component pointer
-    return existingComponentToUpdate;
+    // the clicked column goes first, the columns clicked before it follow
+    auto order = library.getSortOrder();
+    order.removeIf([field] (const TrackLibrary::SortKey& key) { return key.field == field; });
+    order.insert(0, {field, isForwards});
+    order.removeRange(maxSortColumns, order.size());
+    
+    library.setSortOrder(order);
+    tableComponent.updateContent();
+    tableComponent.repaint();
 } // end of function
 
 // function called when a button is clicked
@@ -204,50 +455,79 @@ void PlaylistComponent::buttonClicked (juce::Button* btn) {
         // check if file chooser returns anything
         if (chooser.browseForMultipleFilesToOpen()) {
             auto results = chooser.getResults();
+            // the urls of the choosen files that can be played
+            juce::Array<juce::URL> newTracks;
             // iterate over each choosen file
             for(auto& file: results) {
                 if (formatManager->findFormatForFileExtension(file.getFileExtension())) {
                     // get the url for the file
-                    juce::URL fileURL {file};
-                    
-                    // create a new pair that is then to be appended to the tracks
-                    std::pair<std::string, juce::URL> newTrack;
-                    newTrack.first = file.getFileName().toStdString();
-                    newTrack.second = fileURL;
-                    
-                    // add the choosen files to the tracks map
-                    tracks.insert(newTrack);
-                    
-                    // add the track to the data file
-                    dataFile.appendText(fileURL.toString(false).toStdString() + "\r\n");
+                    newTracks.add(juce::URL{file});
                 }
-                // update the contents of the table
-                tableComponent.updateContent();
             } // end of for loop
+            
+            // add the choosen files to the library and the data file
+            library.addTracks(newTracks);
+            // search the new tracks too
+            searchTracksOutOfDate = true;
+            if (library.isShowingSearchResults())
+                startSearch();
+            // analyse the loudness, key and fingerprint of the new tracks
+            libraryAnalyser.analyseNewTracks();
+            // update the contents of the table
+            tableComponent.updateContent();
         } // end of if
     } // end of if
+} // end of function
+
+// the deck that is not playing, the first one if both are idle
+DeckGUI* PlaylistComponent::getIdleDeck() {
+    if (! deck1->isPlaying())
+        return deck1;
     
-    else {
-        // get the of the button clicked from the button pointer
-        int id = std::stoi(btn->getComponentID().toStdString());
-        // implement the play button here
+    if (! deck2->isPlaying())
+        return deck2;
+    
+    return nullptr;
+}
+
+// pass the loudness and tempo of a track on to a deck
+void PlaylistComponent::sendAnalysisToDeck(DeckGUI* deck, const juce::URL& url) {
+    // the auto gain of the deck needs the loudness of the track
+    TrackLibrary::Loudness loudness;
+    if (library.getTrackLoudness(url, loudness))
+        deck->setTrackLoudness(loudness.integratedLufs, loudness.truePeakDb);
+    
+    // the loops and the synced effects need the tempo of the track
+    TrackLibrary::Harmony harmony;
+    if (library.getTrackHarmony(url, harmony) && harmony.bpm > 0.0f)
+        deck->setTrackBpm(harmony.bpm);
+}
+
+// filter the library by the choice of the key filter
+void PlaylistComponent::updateKeyFilter() {
+    auto choice = keyFilter.getSelectedId();
+    
+    if (choice == matchDeck1 || choice == matchDeck2) {
+        // the key of the track on the deck, at the tempo the deck plays it
+        auto* deck = choice == matchDeck1 ? deck1 : deck2;
+        TrackLibrary::Harmony target;
         
-        // positive integer to keep track of the row number
-        unsigned int counter = 0;
-        // iterate over all the maps in tracks
-        for (auto& item: tracks) {
-            // if id is equal to row counter -- do somethings
-            if (counter == id) {
-                // load the track to the deck
-                deck->loadURL(item.second);
-                // break out of the loop
-                break;
-            }
-            // increment the row counter
-            counter ++;
-        } // end of for
-    } // end of else
-} // end of function
+        if (library.getTrackHarmony(choice == matchDeck1 ? deck1URL : deck2URL, target))
+            target.bpm *= (float) deck->getSpeed();
+        else
+            std::cout << "PlaylistComponent::updateKeyFilter  the key of the deck is not known yet" << std::endl;
+        
+        library.setKeyFilter({});
+        library.setSuggestionTarget(target);
+    }
+    else {
+        library.setSuggestionTarget({});
+        library.setKeyFilter(choice >= firstKey ? keyFilter.getText() : juce::String());
+    }
+    
+    tableComponent.updateContent();
+    tableComponent.repaint();
+}
 
 // Callback to check whether this target is interested in the set
 // of files being offered.
@@ -262,88 +542,135 @@ void PlaylistComponent::filesDropped (
    int x,
    int y
 ) {
-    // check if any files exist
-    if (files.size() != 0) {
-        // iterate over dropped files and add them to the table
-        for (auto& item: files) {
-            // create an instance of the file class
-            juce::File file = juce::File{item};
-            if (formatManager->findFormatForFileExtension(file.getFileExtension())) {
-                // create a url variable for the file
-                juce::URL fileURL{file};
-                
-                // create a new pair that is then to be appended to the tracks
-                std::pair<std::string, juce::URL> newTrack;
-                // add the name and the url of the file to the pair
-                newTrack.first = file.getFileName().toStdString();
-                newTrack.second = fileURL;
-                // add the choosen files to the tracks map
-                tracks.insert(newTrack);
-                
-                // add the track to the data file
-                dataFile.appendText(fileURL.toString(false).toStdString() + "\r\n");
-            }
-            // update the contents of the table
-            tableComponent.updateContent();
-        } // end for
-    } // end if
+    // the urls of the dropped files that can be played
+    juce::Array<juce::URL> newTracks;
+    // iterate over dropped files and add them to the table
+    for (auto& item: files) {
+        // create an instance of the file class
+        juce::File file = juce::File{item};
+        if (formatManager->findFormatForFileExtension(file.getFileExtension())) {
+            // create a url variable for the file
+            newTracks.add(juce::URL{file});
+        }
+    } // end for
+    
+    // add the dropped files to the library and the data file
+    library.addTracks(newTracks);
+    // search the new tracks too
+    searchTracksOutOfDate = true;
+    if (library.isShowingSearchResults())
+        startSearch();
+    // analyse the loudness, key and fingerprint of the new tracks
+    libraryAnalyser.analyseNewTracks();
+    // update the contents of the table
+    tableComponent.updateContent();
 } // end function
 
 // called when the user changes the text in the text editor
-void PlaylistComponent::textEditorTextChanged  (juce::TextEditor& editor) {
-    // check if everything in the editor is cleaned up
-    if (editor.getText().toStdString() == ""){ // text in the text editor is empty
-        // check if filtered track is empty
-        if (filteredTracks.size() != 0) { // filtered track is not empty
-            // iterate over all the tracks in the filtered tracks
-            for (auto& t : filteredTracks) {
-                // add each track to the track list
-                tracks.insert(t);
-            } // end for
-            
-            // clear all the tracks in the filtered list
-            filteredTracks.clear();
-        } // end if
-    } // end if
-    else { // text in the text editor is not empty
-        // get the value in the editor
-        std::string value = editor.getText().toStdString();
-        // vector to store the track names
-        std::vector<std::string> trackNames;
-        // vector to store the track URLs
-        std::vector<juce::URL> trackURLs;
-        // iterate over all the tracks
-        for (auto& t : tracks) {
-            // get the track name
-            std::string name = t.first;
-            
-            // check if the value in editor is in the name of the track
-            if (name.find(value) != std::string::npos) {
-                // push the track name and URL to their respective vectors
-                trackNames.push_back(name);
-                trackURLs.push_back(t.second);
-            } // end if
-            else { // value in editor not in the name of the track
-                // insert the track to the filtered list
-                filteredTracks.insert(t);
-            } // end else
-        } // end for
+void PlaylistComponent::textEditorTextChanged  (juce::TextEditor&) {
+    // the search runs in the background, the table shows the results of
+    // the last one until the new ones come in
+    startSearch();
+} // end function
+
+// search the library for the text of the search box
+void PlaylistComponent::startSearch() {
+    // an empty search box shows all the tracks again
+    if (searchBox.getText().trim().isEmpty()) {
+        trackSearch.cancel();
+        library.clearSearchResults();
+        tableComponent.updateContent();
+        return;
+    }
+    
+    // the search thread is only given the tracks again when they changed
+    if (searchTracksOutOfDate) {
+        trackSearch.setTracks(library.getSearchEntries(), library.getRevision());
+        searchTracksOutOfDate = false;
+    }
+    
+    trackSearch.search(searchBox.getText());
+} // end function
+
+// list the smart crates in the crate box
+void PlaylistComponent::updateCrateList() {
+    auto crate = library.getCrateFilter();
+    
+    crateFilter.clear(juce::dontSendNotification);
+    crateFilter.addItem("All tracks", allTracks);
+    crateFilter.addItem("New crate...", addCrate);
+    crateFilter.addItem("Edit crate...", changeCrate);
+    // only the crate shown can be changed
+    crateFilter.setItemEnabled(changeCrate, crate >= 0);
+    crateFilter.addSeparator();
+    
+    for (int index = 0; index < library.getNumCrates(); ++index)
+        crateFilter.addItem(library.getCrate(index).name + " (" + juce::String(library.getNumTracksInCrate(index)) + ")",
+                            firstCrate + index);
+    
+    crateFilter.setSelectedId(crate >= 0 ? firstCrate + crate : allTracks, juce::dontSendNotification);
+} // end function
+
+// ask for the name and query of a smart crate
+void PlaylistComponent::showCrateEditor(int crate) {
+    crateEditor = std::make_unique<juce::AlertWindow>(crate >= 0 ? "Edit crate" : "New crate",
+                                                      "The tracks matching every clause, such as: bpm 120-128 and key 8A and not dupes",
+                                                      juce::AlertWindow::NoIcon);
+    
+    crateEditor->addTextEditor("name", crate >= 0 ? library.getCrate(crate).name : juce::String(), "Name");
+    crateEditor->addTextEditor("query", crate >= 0 ? library.getCrate(crate).query : juce::String(), "Query");
+    crateEditor->addButton("Save", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    if (crate >= 0)
+        crateEditor->addButton("Delete", 2);
+    crateEditor->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    
+    enterCrateEditor(crate);
+} // end function
+
+// show the crate editor without blocking the message thread
+void PlaylistComponent::enterCrateEditor(int crate) {
+    // the editor is closed with result 0 when the playlist deletes it
+    juce::Component::SafePointer<PlaylistComponent> playlist {this};
+    
+    crateEditor->enterModalState(true, juce::ModalCallbackFunction::create([playlist, crate] (int result) {
+        if (playlist != nullptr && playlist->crateEditor != nullptr)
+            playlist->crateEditorClosed(crate, result);
+    }));
+} // end function
+
+// save or delete the crate of the crate editor
+void PlaylistComponent::crateEditorClosed(int crate, int result) {
+    if (result == 2) {
+        library.removeCrate(crate);
+    }
+    else if (result == 1) {
+        SmartCrate newCrate;
+        juce::String error;
+        newCrate.name = crateEditor->getTextEditorContents("name").trim();
+        
+        // a crate without a name or with a query that cannot be read is not
+        // saved, the editor shows why and keeps what was typed
+        if (newCrate.name.isEmpty())
+            error = "a crate needs a name";
+        else if (newCrate.setQuery(crateEditor->getTextEditorContents("query"), error))
+            error.clear();
+        
+        if (error.isNotEmpty()) {
+            crateEditor->setMessage("The crate cannot be saved, " + error);
+            enterCrateEditor(crate);
+            return;
+        }
         
-        // clear everything in tracks
-        tracks.clear();
-        // repopulate the tracks map with new values
-        for (int i = 0; i < trackNames.size(); i++ ) {
-            // create a new string and URL pair
-            std::pair<std::string, juce::URL> newPair;
-            // set the string value
-            newPair.first = trackNames[i];
-            // set the string url
-            newPair.second = trackURLs[i];
-            // insert the pair to the tracks
-            tracks.insert(newPair);
-        } // end for
-    } // end else
-    
-    // update the content of the table
+        // a crate that is renamed replaces the old one
+        if (crate >= 0 && ! library.getCrate(crate).name.equalsIgnoreCase(newCrate.name))
+            library.removeCrate(crate);
+        
+        library.setCrateFilter(library.setCrate(newCrate));
+    }
+    
+    crateEditor.reset();
+    
+    updateCrateList();
     tableComponent.updateContent();
+    tableComponent.repaint();
 } // end function
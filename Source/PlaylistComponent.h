@@ -13,10 +13,11 @@
 #include <JuceHeader.h>
 #include "DeckGUI.h"
 #include "DJAudioPlayer.h"
-
-#include <vector>
-#include <string>
-#include <map>
+#include "TrackLibrary.h"
+#include "TrackSearch.h"
+#include "LibraryAnalyser.h"
+#include "PlayHistory.h"
+#include "SessionState.h"
 
 
 //==============================================================================
@@ -31,7 +32,8 @@ class PlaylistComponent  : public juce::Component,
 {
 public:
     PlaylistComponent(
-      DeckGUI* deck,
+      DeckGUI* deck1,
+      DeckGUI* deck2,
       juce::AudioFormatManager* formatManager);
     
     ~PlaylistComponent() override;
@@ -61,13 +63,13 @@ public:
                     int height,
                     bool rowIsSelected) override;
     
-    /** used to create or update a custom component that goes into a cell */
-    Component* refreshComponentForCell (
-                            int rowNumber,
-                            int columnId,
-                            bool isRowSelected,
-                            Component *existingComponentToUpdate)
-    override;
+    /** Called when a cell is clicked, the play and next buttons are drawn
+        into their cells so no component is made per row */
+    void cellClicked (int rowNumber, int columnId, const juce::MouseEvent&) override;
+    
+    /** Called when a column header is clicked, the column becomes the first
+        one the tracks are sorted by and the ones sorted by before it break ties */
+    void sortOrderChanged (int newSortColumnId, bool isForwards) override;
     
     // pure virtual functions from Button listener class
     /** Called when a button is clicked */
@@ -84,41 +86,95 @@ public:
     /** Called when the user changes the text in some way */
     void textEditorTextChanged (juce::TextEditor &) override;
     
+    /** Returns the tracks shown in the table from the selected row down, or
+        all of them if no row is selected, for the automix to play */
+    juce::Array<juce::URL> getAutomixQueue();
+    
+    /** Returns the search text, the filters and the sort order of the
+        table for a session snapshot */
+    SessionState::View getSessionView() const;
+    /** Shows the search text, the filters and the sort order of a session
+        snapshot again */
+    void restoreSessionView(const SessionState::View& view);
+    
 private:
+    /** Returns the deck that is not playing, or nullptr if both are */
+    DeckGUI* getIdleDeck();
+    /** Passes the loudness and tempo of a track the library has analysed on to a deck */
+    void sendAnalysisToDeck(DeckGUI* deck, const juce::URL& url);
+    /** Filters the library by the choice of the key filter */
+    void updateKeyFilter();
+    /** Searches the library for the text of the search box in the background */
+    void startSearch();
+    /** Lists the smart crates and the number of their tracks in the crate box */
+    void updateCrateList();
+    /** Asks for the name and query of a new smart crate, or of a crate to
+        change or delete */
+    void showCrateEditor(int crate);
+    /** Shows the crate editor until one of its buttons is clicked */
+    void enterCrateEditor(int crate);
+    /** Saves or deletes the crate by the button the crate editor was closed
+        with, or shows it again with the reason a crate cannot be saved */
+    void crateEditorClosed(int crate, int result);
+    /** Draws a play or next button into a cell */
+    void paintCellButton(juce::Graphics& g, const juce::String& text, int width, int height);
+    
     // a load button to load multiple tracks
     juce::TextButton loadButton{"Load"};
     
-    // a table to display the tracks of a playlist
+    // a table to display the tracks of a playlist, it only makes a
+    // component for each row that fits on screen and draws every cell
     juce::TableListBox tableComponent;
-    
-    // a map to store the title tracks and the url of the track
-    std::map<std::string, juce::URL> tracks;
-    
-    // Deck gui pointer
-    DeckGUI* deck;
+    // the ids of the columns
+    enum ColumnId { titleColumn = 1, playColumn, loudnessColumn, nextColumn, keyColumn, bpmColumn, dupesColumn,
+                    playsColumn, lastPlayedColumn };
+    // the most columns the tracks are sorted by at once
+    static constexpr int maxSortColumns = 3;
+    
+    // the tracks shown in the table
+    TrackLibrary library {TrackLibrary::getDefaultDataFile()};
+    
+    // logs the tracks the decks load and play, its log gives the library
+    // the plays of every track when the app starts
+    PlayHistory history {library.getHistoryFile()};
+    
+    // searches the library as the search box is typed in, it is declared
+    // after the library as it reads its strings
+    TrackSearch trackSearch;
+    // whether tracks were added or analysed since the search was given them
+    bool searchTracksOutOfDate = true;
+    
+    // the decks, the play buttons load into the first one and the next
+    // buttons queue into whichever is idle
+    DeckGUI* deck1;
+    DeckGUI* deck2;
     
     // search box
     juce::TextEditor searchBox;
-
-    // a map to store the tracks that were not searched for
-    std::map<std::string, juce::URL> filteredTracks;
+    
+    // filters the tracks by key, or shows the tracks that mix well after a deck
+    juce::ComboBox keyFilter;
+    // the ids of the choices that are not a key, the keys follow in wheel order
+    enum KeyFilterId { allKeys = 1, matchDeck1, matchDeck2, firstKey };
+    // the tracks loaded into the decks, to match them
+    juce::URL deck1URL;
+    juce::URL deck2URL;
+    
+    // shows the tracks of a smart crate, and makes and changes the crates
+    juce::ComboBox crateFilter;
+    // the ids of the choices that are not a crate, the crates follow in the
+    // order they were made
+    enum CrateChoiceId { allTracks = 1, addCrate, changeCrate, firstCrate };
+    // asks for the name and query of a crate, it stays open until the crate
+    // can be saved so what was typed is not lost
+    std::unique_ptr<juce::AlertWindow> crateEditor;
     
     // A manager that keeps a list of available audio formats and
     // decides which one to use to open a given file
     juce::AudioFormatManager* formatManager;
     
-    // directory in which the data is going to be stored
-    juce::File dataDirectory {
-        juce::File::getSpecialLocation(
-           juce::File::SpecialLocationType::userDocumentsDirectory
-        )
-    };
-    
-    // the file containing the data
-    juce::File dataFile {dataDirectory.getFullPathName() + "/data.txt"} ;
-
-    // the data inside the file
-    juce::StringArray lines;
+    // measures the loudness of new tracks in the background
+    LibraryAnalyser libraryAnalyser {library, *formatManager};
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
 };
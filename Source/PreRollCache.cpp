@@ -0,0 +1,267 @@
+/*
+  ==============================================================================
+
+    PreRollCache.cpp
+    Created: 19 Oct 2026 3:12:08pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "PreRollCache.h"
+
+PreRollCache::PreRollCache(juce::AudioFormatManager& _formatManager)
+: juce::Thread("Pre-roll cache"),
+  formatManager(_formatManager) {}
+
+PreRollCache::~PreRollCache()
+{
+    // the thread checks for exit between chunks, so it is waited for rather
+    // than killed half way through a read
+    stopThread(-1);
+}
+
+//==============================================================================
+// start caching a new track
+void PreRollCache::loadTrack(const juce::URL& url)
+{
+    resetTrack(url);
+    startThread();
+}
+
+// start caching a new track with its start already decoded
+void PreRollCache::loadTrack(const juce::URL& url, juce::AudioBuffer<float>&& intro)
+{
+    resetTrack(url);
+
+    // the decoded start becomes region 0 before the thread sees it, an empty
+    // intro is decoded by the thread as usual
+    auto& start = regions[0];
+
+    if (intro.getNumSamples() > 0) {
+        start.buffer = std::move(intro);
+        start.start = 0;
+        start.length = start.buffer.getNumSamples();
+        start.filled = 0;
+        start.state = ready;
+    }
+
+    startThread();
+}
+
+// stop the thread and forget the old track
+void PreRollCache::resetTrack(const juce::URL& url)
+{
+    // the thread is restarted so nothing of the old track is left, it stops
+    // within a chunk of a region
+    stopThread(-1);
+
+    trackURL = url;
+    reader.reset();
+
+    for (auto& region : regions) {
+        region.state = empty;
+        region.wanted = -1;
+        region.filled = -1;
+    }
+
+    inputState = idle;
+    seekInput = nullptr;
+
+    // the start of the track is always cached
+    regions[0].wanted = 0;
+}
+
+// set the position a region is kept around
+void PreRollCache::setRegion(int index, juce::int64 position)
+{
+    if (! juce::isPositiveAndBelow(index, numRegions))
+        return;
+
+    regions[(size_t) index].wanted = position;
+    notify();
+}
+
+// check if every region that is set has been decoded
+bool PreRollCache::isReady() const
+{
+    for (auto& region : regions) {
+        auto position = region.wanted.load();
+
+        if (position >= 0 && region.filled.load() != position)
+            return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+// copy cached audio into a buffer, called by the audio thread
+int PreRollCache::read(juce::AudioBuffer<float>& buffer,
+                       int startSample,
+                       int numSamples,
+                       juce::int64 from,
+                       juce::int64& cachedEnd)
+{
+    for (auto& region : regions) {
+        // skip regions that are empty or being decoded
+        int expected = ready;
+        if (! region.state.compare_exchange_strong(expected, reading))
+            continue;
+
+        int served = 0;
+
+        if (from >= region.start && from < region.start + region.length) {
+            served = (int) juce::jmin((juce::int64) numSamples, region.start + region.length - from);
+            auto offset = (int) (from - region.start);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                auto source = juce::jmin(channel, region.buffer.getNumChannels() - 1);
+                buffer.copyFrom(channel, startSample, region.buffer, source, offset, served);
+            }
+
+            cachedEnd = region.start + region.length;
+        }
+
+        region.state = ready;
+
+        if (served > 0)
+            return served;
+    }
+
+    return 0;
+}
+
+// hand the reader of the deck to the background thread
+void PreRollCache::seekInputInBackground(juce::PositionableAudioSource* input, juce::int64 position)
+{
+    seekInput = input;
+    seekPosition = position;
+    inputState = seeking;
+}
+
+// check if the background thread is seeking the reader of the deck
+bool PreRollCache::isInputBusy() const
+{
+    return inputState != idle;
+}
+
+//==============================================================================
+// open the track and keep the regions up to date
+void PreRollCache::run()
+{
+    reader.reset(formatManager.createReaderFor(trackURL.createInputStream(false)));
+
+    // another track was loaded while this one was opened
+    if (threadShouldExit())
+        return;
+
+    // the buffers are allocated once per track, never by the audio thread
+    if (reader != nullptr) {
+        auto length = (int) (regionSeconds * reader->sampleRate);
+
+        // a region that was handed over already decoded keeps its audio
+        for (auto& region : regions)
+            if (region.state == empty)
+                region.buffer.setSize(2, length, false, false, true);
+    }
+
+    while (! threadShouldExit()) {
+        serviceInput();
+
+        for (int i = 0; i < numRegions; ++i) {
+            auto position = regions[(size_t) i].wanted.load();
+
+            if (position != regions[(size_t) i].filled.load())
+                fillRegion(i, position);
+
+            if (threadShouldExit())
+                return;
+        }
+
+        // the audio thread cannot wake this thread without locking, so the
+        // seek requests are polled
+        wait(5);
+    }
+}
+
+// seek the reader of the deck if the audio thread asked for it
+void PreRollCache::serviceInput()
+{
+    if (inputState != seeking)
+        return;
+
+    // reading the audio just before the position makes the reader do its
+    // seek now, and leaves it exactly at the position
+    auto warmUp = (int) juce::jmin(seekPosition, (juce::int64) seekBuffer.getNumSamples());
+    seekInput->setNextReadPosition(seekPosition - warmUp);
+
+    if (warmUp > 0) {
+        juce::AudioSourceChannelInfo info {&seekBuffer, 0, warmUp};
+        seekInput->getNextAudioBlock(info);
+    }
+
+    // give the reader back to the audio thread
+    inputState = idle;
+}
+
+// decode a region around a position
+void PreRollCache::fillRegion(int index, juce::int64 position)
+{
+    auto& region = regions[(size_t) index];
+    acquireRegion(index);
+
+    auto lead = reader != nullptr ? (juce::int64) (leadInSeconds * reader->sampleRate) : 0;
+    auto start = juce::jmax((juce::int64) 0, position - lead);
+    auto length = reader != nullptr
+                ? juce::jmin((juce::int64) region.buffer.getNumSamples(), reader->lengthInSamples - start)
+                : 0;
+
+    // nothing to decode if the region was dropped or is past the end of the track
+    if (position < 0 || length <= 0) {
+        region.filled = position;
+        region.state = empty;
+        return;
+    }
+
+    const int chunkSize = 8192;
+
+    for (int done = 0; done < length; done += chunkSize) {
+        // a seek of the deck never waits for a whole region to be decoded
+        serviceInput();
+
+        if (threadShouldExit()) {
+            region.state = empty;
+            return;
+        }
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - done);
+        reader->read(&region.buffer, done, numSamples, start + done, true, true);
+    }
+
+    region.start = start;
+    region.length = (int) length;
+    region.filled = position;
+
+    // the audio thread may read the region from now on
+    region.state = ready;
+}
+
+// take a region away from the audio thread
+void PreRollCache::acquireRegion(int index)
+{
+    auto& state = regions[(size_t) index].state;
+
+    for (;;) {
+        auto current = state.load();
+
+        // the audio thread only holds a region for one copy
+        if (current == reading) {
+            juce::Thread::yield();
+            continue;
+        }
+
+        if (state.compare_exchange_weak(current, filling))
+            return;
+    }
+}
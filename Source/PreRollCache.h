@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    PreRollCache.h
+    Created: 19 Oct 2026 3:12:08pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ Keeps a few seconds of decoded audio around the start of a track and around
+ every cue point, so a jump to one of them can play in the very next block.
+
+ The regions are decoded by a background thread with its own reader. When the
+ audio thread plays from the cache it hands the reader of the deck over to the
+ same thread, which seeks it to the end of the cached audio. Seeking a
+ compressed file can take a long time, this way it never happens in the audio
+ callback.
+
+ Every region has a state that says who may touch its buffer. The background
+ thread only writes to a region it has taken away from the audio thread, and
+ the audio thread only reads a region that is ready, so neither ever waits
+ for the other.
+*/
+class PreRollCache : private juce::Thread
+{
+public:
+    PreRollCache(juce::AudioFormatManager& formatManager);
+    ~PreRollCache() override;
+
+    /** The number of regions, the start of the track and one for each hot cue */
+    static constexpr int numRegions = 9;
+    /** The length of every region */
+    static constexpr double regionSeconds = 3.0;
+    /** How much audio before a cue point is kept as well */
+    static constexpr double leadInSeconds = 0.25;
+
+    /** Starts caching a new track, region 0 is always its start. Only call
+        this while the audio thread is not reading from the cache */
+    void loadTrack(const juce::URL& url);
+    /** Starts caching a new track whose start has already been decoded, so
+        region 0 is ready straight away. The same rules as loadTrack apply */
+    void loadTrack(const juce::URL& url, juce::AudioBuffer<float>&& intro);
+    /** Sets the position a region is kept around, or -1 to drop the region */
+    void setRegion(int index, juce::int64 position);
+    /** Returns true once every region that is set has been decoded */
+    bool isReady() const;
+
+    //==============================================================================
+    /** Copies cached audio starting at a position into a buffer and returns
+        the number of samples copied. cachedEnd is set to the end of the
+        region the audio came from. Called by the audio thread */
+    int read(juce::AudioBuffer<float>& buffer,
+             int startSample,
+             int numSamples,
+             juce::int64 from,
+             juce::int64& cachedEnd);
+
+    /** Hands the reader of the deck to the background thread, which seeks it
+        to a position. Called by the audio thread, which must not touch the
+        input until isInputBusy returns false */
+    void seekInputInBackground(juce::PositionableAudioSource* input, juce::int64 position);
+    /** Returns true while the background thread is seeking the reader of the deck */
+    bool isInputBusy() const;
+
+private:
+    /** Stops the thread and empties every region for a new track */
+    void resetTrack(const juce::URL& url);
+    /** Opens the track and keeps the regions up to date */
+    void run() override;
+    /** Seeks the reader of the deck if the audio thread asked for it */
+    void serviceInput();
+    /** Decodes a region around a position */
+    void fillRegion(int index, juce::int64 position);
+    /** Takes a region away from the audio thread */
+    void acquireRegion(int index);
+
+    // the states of a region
+    enum RegionState { empty = 0, filling = 1, ready = 2, reading = 3 };
+
+    struct Region
+    {
+        // who may touch the buffer
+        std::atomic<int> state {empty};
+        // the position the region should be kept around, -1 if none
+        std::atomic<juce::int64> wanted {-1};
+        // the position the region was last decoded around, -1 if none
+        std::atomic<juce::int64> filled {-1};
+        // the decoded audio and where it starts in the track
+        juce::AudioBuffer<float> buffer;
+        juce::int64 start = 0;
+        int length = 0;
+    };
+
+    // the states of the reader of the deck
+    enum InputState { idle = 0, seeking = 1 };
+
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track being cached and the reader of the background thread
+    juce::URL trackURL;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    // the cached regions
+    std::array<Region, numRegions> regions;
+
+    // the reader of the deck while the background thread is seeking it
+    std::atomic<int> inputState {idle};
+    juce::PositionableAudioSource* seekInput = nullptr;
+    juce::int64 seekPosition = 0;
+    // the audio read while seeking, before the reader ends up at the position
+    juce::AudioBuffer<float> seekBuffer {2, 1024};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreRollCache)
+};
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.cpp
+    Created: 19 Oct 2026 10:03:18am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ProfilerOverlay.h"
+
+//==============================================================================
+ProfilerOverlay::ProfilerOverlay(AudioProfiler& _profiler,
+                                 juce::AudioDeviceManager& _deviceManager
+) : profiler(_profiler),
+    deviceManager(_deviceManager)
+{
+    // make the buttons visible
+    addAndMakeVisible(exportButton);
+    addAndMakeVisible(resetButton);
+
+    // add a button event listener to the buttons
+    exportButton.addListener(this);
+    resetButton.addListener(this);
+
+    // the overlay sits on top of the decks so let clicks through
+    setInterceptsMouseClicks(false, true);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    stopTimer();
+}
+
+// called to draw the component content
+void ProfilerOverlay::paint (juce::Graphics& g)
+{
+    // translucent background so the decks stay visible
+    g.fillAll(juce::Colours::black.withAlpha(0.75f));
+
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+
+    const int lineH = 14;
+    int y = 4;
+
+    // draw a single line of text and move to the next one
+    auto drawLine = [&] (const juce::String& text)
+    {
+        g.drawText(text, 6, y, getWidth() - 12, lineH, juce::Justification::centredLeft, false);
+        y += lineH;
+    };
+
+    auto& cb = callbackStats;
+    drawLine("callback  mean " + juce::String(cb.callback.meanMicros, 1)
+             + "us  max " + juce::String(cb.callback.maxMicros, 1)
+             + "us  load " + juce::String(cb.lastLoad * 100.0, 0)
+             + "%  worst " + juce::String(cb.worstLoad * 100.0, 0) + "%");
+
+    drawLine("overruns " + juce::String(cb.overruns)
+             + "  device xruns " + (cb.deviceXRuns < 0 ? juce::String("n/a") : juce::String(cb.deviceXRuns)));
+
+    // allocations and locks are only tracked in debug builds
+   #if OTODESK_TRACK_ALLOCATIONS || OTODESK_TRACK_LOCKS
+    if (cb.audioThreadAllocations > 0 || cb.audioThreadLocks > 0)
+        g.setColour(juce::Colours::orangered);
+
+    drawLine("audio thread allocations " + juce::String(cb.audioThreadAllocations)
+             + "  locks " + juce::String(cb.audioThreadLocks));
+    g.setColour(juce::Colours::white);
+   #endif
+
+    y += 4;
+    drawLine(juce::String("stage").paddedRight(' ', 18) + "   mean    p99    max (us)");
+
+    // one line for every stage
+    for (auto& stage : stageStats) {
+        drawLine(stage.name.paddedRight(' ', 18)
+                 + juce::String(stage.meanMicros, 1).paddedLeft(' ', 7)
+                 + juce::String(stage.p99Micros, 0).paddedLeft(' ', 7)
+                 + juce::String(stage.maxMicros, 1).paddedLeft(' ', 7));
+    }
+}
+
+// called when the component size changes
+void ProfilerOverlay::resized()
+{
+    // both buttons sit in the top right corner
+    exportButton.setBounds(getWidth() - 150, 4, 70, 20);
+    resetButton.setBounds(getWidth() - 76, 4, 70, 20);
+}
+
+// Button event listener
+void ProfilerOverlay::buttonClicked (juce::Button* button)
+{
+    if (button == &exportButton) {
+        exportStats();
+    }
+
+    if (button == &resetButton) {
+        profiler.reset();
+    }
+}
+
+// read the numbers from the profiler and redraw
+void ProfilerOverlay::timerCallback()
+{
+    profiler.updateDeviceStats(deviceManager.getCurrentAudioDevice());
+
+    stageStats = profiler.getStageStats();
+    callbackStats = profiler.getCallbackStats();
+    repaint();
+}
+
+// only poll the profiler while the overlay can be seen
+void ProfilerOverlay::visibilityChanged()
+{
+    if (isVisible()) {
+        timerCallback();
+        startTimer(250);
+    }
+    else {
+        stopTimer();
+    }
+}
+
+// write the numbers to a CSV and a JSON file in the documents folder
+void ProfilerOverlay::exportStats()
+{
+    profiler.updateDeviceStats(deviceManager.getCurrentAudioDevice());
+
+    auto directory = juce::File::getSpecialLocation(juce::File::SpecialLocationType::userDocumentsDirectory);
+    auto name = "Otodesk profile " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S");
+
+    auto csvFile = directory.getChildFile(name + ".csv");
+    auto jsonFile = directory.getChildFile(name + ".json");
+
+    // print where the numbers went, or that they could not be written
+    if (profiler.writeCsv(csvFile) && profiler.writeJson(jsonFile)) {
+        std::cout << "ProfilerOverlay: exported to " << csvFile.getFullPathName() << std::endl;
+    }
+    else {
+        std::cout << "ProfilerOverlay: export failed" << std::endl;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.h
+    Created: 19 Oct 2026 10:03:18am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioProfiler.h"
+
+//==============================================================================
+/*
+ A small overlay that shows the numbers recorded by the audio profiler and
+ lets them be exported to a CSV and a JSON file
+*/
+class ProfilerOverlay
+    : public juce::Component,
+    public juce::Button::Listener,
+    public juce::Timer
+{
+public:
+    ProfilerOverlay(AudioProfiler& profiler,
+                    juce::AudioDeviceManager& deviceManager);
+    ~ProfilerOverlay() override;
+
+    /** Called to draw component content */
+    void paint (juce::Graphics&) override;
+    /** Called when the component size has been changed */
+    void resized() override;
+
+    /** function called when a button is clicked  */
+    void buttonClicked (juce::Button*) override;
+
+    /** User defined callback that gets called periodically */
+    void timerCallback() override;
+
+    /** Called when the component is shown or hidden */
+    void visibilityChanged() override;
+
+    /** Writes the numbers next to the data file of the playlist */
+    void exportStats();
+
+private:
+    // the profiler to display
+    AudioProfiler& profiler;
+    // used to read the xrun count of the current device
+    juce::AudioDeviceManager& deviceManager;
+
+    // button to write the numbers to disk
+    juce::TextButton exportButton{"EXPORT"};
+    // button to clear the numbers
+    juce::TextButton resetButton{"RESET"};
+
+    // the numbers shown in the last repaint
+    juce::Array<AudioProfiler::StageStats> stageStats;
+    AudioProfiler::CallbackStats callbackStats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerOverlay)
+};
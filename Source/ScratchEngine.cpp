@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    ScratchEngine.cpp
+    Created: 19 Oct 2026 3:58:21pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "ScratchEngine.h"
+
+namespace
+{
+    // 4 point Hermite interpolation between x0 and x1
+    inline float hermite(float xm1, float x0, float x1, float x2, float t)
+    {
+        auto c1 = 0.5f * (x1 - xm1);
+        auto c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        auto c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        return ((c3 * t + c2) * t + c1) * t + x0;
+    }
+}
+
+ScratchEngine::ScratchEngine(juce::AudioFormatManager& _formatManager)
+: juce::Thread("Scratch ring"),
+  formatManager(_formatManager) {}
+
+ScratchEngine::~ScratchEngine()
+{
+    // the thread is never killed, it stops within a chunk
+    stopThread(-1);
+}
+
+//==============================================================================
+// start decoding a new track around its start
+void ScratchEngine::loadTrack(const juce::URL& url, double sampleRate, juce::int64 lengthInSamples)
+{
+    // empty the ring before the old track stops being decoded
+    setRange(0, 0);
+    stopThread(-1);
+
+    trackURL = url;
+    reader.reset();
+    trackSampleRate = sampleRate;
+    trackLength = lengthInSamples;
+    playhead = 0;
+
+    startThread();
+}
+
+// the sample rate of the output
+void ScratchEngine::prepareToPlay(double sampleRate)
+{
+    outputSampleRate = sampleRate;
+}
+
+//==============================================================================
+// the hand touches the platter
+void ScratchEngine::beginScratch()
+{
+    // forget movements from before the touch
+    pendingJog = 0.0;
+    touching = true;
+}
+
+// the hand lets go of the platter
+void ScratchEngine::endScratch()
+{
+    touching = false;
+}
+
+// check if the hand is on the platter
+bool ScratchEngine::isScratching() const
+{
+    return touching;
+}
+
+// move the track by a number of seconds
+void ScratchEngine::addJogMovement(double seconds)
+{
+    // add up the movements until the next block picks them up
+    auto current = pendingJog.load();
+    while (! pendingJog.compare_exchange_weak(current, current + seconds)) {}
+}
+
+//==============================================================================
+// start playing from a position, called by the audio thread
+void ScratchEngine::startAt(juce::int64 newPosition, double velocityRatio)
+{
+    position = (double) newPosition;
+    velocity = velocityRatio * trackSampleRate / outputSampleRate;
+    playhead = newPosition;
+}
+
+// render a block at the motor speed, called by the audio thread
+void ScratchEngine::render(const juce::AudioSourceChannelInfo& bufferToFill, double motorRatio)
+{
+    auto& buffer = *bufferToFill.buffer;
+    const auto numSamples = bufferToFill.numSamples;
+
+    if (numSamples <= 0)
+        return;
+
+    const auto step = trackSampleRate / outputSampleRate;
+    const auto length = trackLength.load();
+
+    // the hand holds the platter still, the jog moves it
+    auto jog = pendingJog.exchange(0.0) * trackSampleRate;
+    auto motor = touching ? 0.0 : motorRatio * step;
+    auto target = motor + jog / numSamples;
+
+    juce::int64 start, end;
+    getRange(start, end);
+
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), ring.getNumChannels());
+    const int mask = ringSize - 1;
+
+    for (int i = 0; i < numSamples; ++i) {
+        // ramp the velocity over the block
+        auto v = velocity + (target - velocity) * (i + 1) / numSamples;
+        auto index = (juce::int64) std::floor(position);
+        auto t = (float) (position - (double) index);
+
+        // the points outside the track are silence, the ones inside must be in the ring
+        auto first = juce::jmax(index - 1, (juce::int64) 0);
+        auto last = juce::jmin(index + 2, length - 1);
+        auto available = first >= start && last < end;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* out = buffer.getWritePointer(channel, bufferToFill.startSample);
+
+            if (! available) {
+                out[i] = 0.0f;
+                continue;
+            }
+
+            auto* in = ring.getReadPointer(channel);
+            auto sample = [&] (juce::int64 p) {
+                return p >= 0 && p < length ? in[p & mask] : 0.0f;
+            };
+
+            out[i] = hermite(sample(index - 1), sample(index), sample(index + 1), sample(index + 2), t);
+        }
+
+        // the record stops at either end
+        position = juce::jlimit(0.0, (double) length, position + v);
+    }
+
+    velocity = target;
+    playhead = (juce::int64) position;
+
+    for (int channel = numChannels; channel < buffer.getNumChannels(); ++channel)
+        buffer.clear(channel, bufferToFill.startSample, numSamples);
+}
+
+// keep the ring around the playhead of the deck
+void ScratchEngine::followPlayhead(juce::int64 newPosition)
+{
+    playhead = newPosition;
+}
+
+// the playhead in samples of the track
+juce::int64 ScratchEngine::getPosition() const
+{
+    return playhead;
+}
+
+//==============================================================================
+// keep the ring filled around the playhead
+void ScratchEngine::run()
+{
+    reader.reset(formatManager.createReaderFor(trackURL.createInputStream(false)));
+
+    // opening a remote track can take a while, another track may have been
+    // loaded in the meantime
+    if (reader == nullptr || threadShouldExit())
+        return;
+
+    while (! threadShouldExit()) {
+        fillRing();
+
+        // the audio thread cannot wake this thread without locking, so the
+        // playhead is polled
+        wait(10);
+    }
+}
+
+// decode the audio missing around the playhead
+void ScratchEngine::fillRing()
+{
+    // keep most of the ring around the playhead, the rest is a safety margin
+    // between what is written and what may still be read
+    const juce::int64 reach = ringSize * 2 / 5;
+    const int chunkSize = 16384;
+
+    auto centre = playhead.load();
+    auto wantedStart = juce::jmax((juce::int64) 0, centre - reach);
+    auto wantedEnd = juce::jmin(reader->lengthInSamples, centre + reach);
+
+    juce::int64 start, end;
+    getRange(start, end);
+
+    // start again if the playhead jumped away from the ring
+    if (wantedStart >= end || wantedEnd <= start) {
+        start = end = wantedStart;
+        setRange(start, end);
+    }
+
+    // most playback is forwards, so fill ahead first
+    while (end < wantedEnd && ! threadShouldExit()) {
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, wantedEnd - end);
+
+        // drop the oldest audio before it is overwritten
+        if (end + numSamples - start > ringSize) {
+            start = end + numSamples - ringSize;
+            setRange(start, end);
+        }
+
+        writeRing(end, numSamples);
+        end += numSamples;
+        setRange(start, end);
+    }
+
+    while (start > wantedStart && ! threadShouldExit()) {
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, start - wantedStart);
+
+        // drop the audio furthest ahead before it is overwritten
+        if (end - (start - numSamples) > ringSize) {
+            end = start - numSamples + ringSize;
+            setRange(start, end);
+        }
+
+        writeRing(start - numSamples, numSamples);
+        start -= numSamples;
+        setRange(start, end);
+    }
+}
+
+// decode part of the track into the ring
+void ScratchEngine::writeRing(juce::int64 from, int numSamples)
+{
+    auto index = (int) (from & (ringSize - 1));
+    auto first = juce::jmin(numSamples, ringSize - index);
+
+    reader->read(&ring, index, first, from, true, true);
+
+    // wrap around to the start of the ring
+    if (first < numSamples)
+        reader->read(&ring, 0, numSamples - first, from + first, true, true);
+}
+
+// the part of the track the ring holds
+void ScratchEngine::getRange(juce::int64& start, juce::int64& end) const
+{
+    auto packed = range.load();
+    start = (juce::int64) (packed >> 32);
+    end = (juce::int64) (packed & 0xffffffff);
+}
+
+// set the part of the track the ring holds, positions fit in 32 bits for
+// tracks of up to 27 hours
+void ScratchEngine::setRange(juce::int64 start, juce::int64 end)
+{
+    range = ((juce::uint64) start << 32) | (juce::uint64) end;
+}
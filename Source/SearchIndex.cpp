@@ -0,0 +1,381 @@
+/*
+  ==============================================================================
+
+    SearchIndex.cpp
+    Created: 19 Oct 2026 11:52:16pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+    // the score of a word of the query by how it matches
+    const float exactScore = 1.0f;
+    const float prefixScore = 0.5f;
+    const float typoScore = 0.35f;
+    const float keyScore = 1.0f;
+    const float bpmScore = 0.8f;
+
+    // a prefix scores more the more of the word it covers
+    const float prefixBoost = 0.4f;
+    // the first word of a field is usually what is typed first
+    const float firstWordBoost = 1.25f;
+    // the title is what is searched for most
+    const float fieldWeights[] = {1.0f, 0.8f, 0.6f};
+
+    // how often shouldStop is asked, in words or tracks
+    const int stopCheckInterval = 4096;
+}
+
+SearchIndex::SearchIndex() {}
+
+SearchIndex::~SearchIndex() {}
+
+//==============================================================================
+// call a function with every lower case word of a text
+template <typename Callback>
+void SearchIndex::forEachWord(std::string_view text, bool escaped, std::string& scratch, Callback&& callback)
+{
+    scratch.clear();
+
+    auto endWord = [&scratch, &callback]
+    {
+        if (! scratch.empty())
+            callback(std::string_view{scratch});
+        scratch.clear();
+    };
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto c = (unsigned char) text[i];
+
+        // an escaped character in a url, such as %20 for a space
+        if (escaped && c == '%' && i + 2 < text.size()) {
+            auto high = juce::CharacterFunctions::getHexDigitValue((juce::juce_wchar) (unsigned char) text[i + 1]);
+            auto low = juce::CharacterFunctions::getHexDigitValue((juce::juce_wchar) (unsigned char) text[i + 2]);
+
+            if (high >= 0 && low >= 0) {
+                c = (unsigned char) (high * 16 + low);
+                i += 2;
+            }
+        }
+
+        // the bytes of other alphabets are kept as they are
+        if (c >= 0x80 || std::isalnum(c))
+            scratch += (char) std::tolower(c);
+        else
+            endWord();
+    }
+
+    endWord();
+}
+
+//==============================================================================
+// index a set of tracks
+bool SearchIndex::build(std::vector<Entry> newEntries, const std::function<bool()>& shouldStop)
+{
+    entries = std::move(newEntries);
+    words.clear();
+    postings.clear();
+    strings.clear();
+
+    // every word found and the tracks it was found in, in the order of the tracks
+    struct Occurrence
+    {
+        int word;
+        Posting posting;
+    };
+
+    std::unordered_map<std::string_view, int> wordIds;
+    std::vector<std::string_view> wordTexts;
+    std::vector<Occurrence> occurrences;
+    occurrences.reserve(entries.size() * 6);
+    std::string scratch;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i % stopCheckInterval == 0 && shouldStop()) {
+            entries.clear();
+            return false;
+        }
+
+        auto& entry = entries[i];
+
+        // the extension of the file is not part of the title
+        auto title = entry.title;
+        auto dot = title.find_last_of('.');
+        if (dot != std::string_view::npos && title.size() - dot <= 5)
+            title = title.substr(0, dot);
+
+        const std::string_view fields[] = {title, entry.artist, entry.album};
+
+        for (int field = 0; field < numFields; ++field) {
+            auto first = true;
+
+            forEachWord(fields[field], field != titleField, scratch, [&] (std::string_view text) {
+                auto found = wordIds.find(text);
+
+                if (found == wordIds.end()) {
+                    auto stored = strings.add(text);
+                    found = wordIds.emplace(stored, (int) wordTexts.size()).first;
+                    wordTexts.push_back(stored);
+                }
+
+                occurrences.push_back({found->second, {(int) i, (Field) field, first}});
+                first = false;
+            });
+        }
+    }
+
+    // the words are sorted so a prefix is a range of them
+    std::vector<int> sorted ((size_t) wordTexts.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [&wordTexts] (int a, int b) { return wordTexts[(size_t) a] < wordTexts[(size_t) b]; });
+
+    std::vector<int> rank (sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        rank[(size_t) sorted[i]] = (int) i;
+
+    // count the postings of every word, then put them in place, which keeps
+    // the postings of a word in the order of the tracks
+    words.resize(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        words[i] = {wordTexts[(size_t) sorted[i]], 0, 0};
+
+    for (auto& occurrence : occurrences)
+        ++words[(size_t) rank[(size_t) occurrence.word]].numPostings;
+
+    int numPostings = 0;
+    for (auto& word : words) {
+        word.firstPosting = numPostings;
+        numPostings += word.numPostings;
+        word.numPostings = 0;
+    }
+
+    postings.resize((size_t) numPostings);
+    for (auto& occurrence : occurrences) {
+        auto& word = words[(size_t) rank[(size_t) occurrence.word]];
+        postings[(size_t) (word.firstPosting + word.numPostings++)] = occurrence.posting;
+    }
+
+    return true;
+}
+
+// replace the keys and tempos of the tracks
+void SearchIndex::updateHarmonies(const std::vector<Entry>& newEntries)
+{
+    jassert (newEntries.size() == entries.size());
+
+    for (size_t i = 0; i < juce::jmin(entries.size(), newEntries.size()); ++i) {
+        entries[i].camelotNumber = newEntries[i].camelotNumber;
+        entries[i].minor = newEntries[i].minor;
+        entries[i].bpm = newEntries[i].bpm;
+    }
+}
+
+// the number of tracks indexed
+int SearchIndex::size() const
+{
+    return (int) entries.size();
+}
+
+// the number of different words
+int SearchIndex::getNumWords() const
+{
+    return (int) words.size();
+}
+
+//==============================================================================
+// find the tracks matching every word of a query
+std::vector<int> SearchIndex::search(const juce::String& query, bool allowTypos, const std::function<bool()>& shouldStop)
+{
+    std::vector<std::string> queryWords;
+    std::string scratch;
+    forEachWord(StringArena::view(query), false, scratch, [&queryWords] (std::string_view text) {
+        queryWords.emplace_back(text);
+    });
+
+    if (queryWords.empty() || entries.empty())
+        return {};
+
+    // the scores keep their memory from one query to the next
+    wordScores.assign(entries.size(), 0.0f);
+    totalScores.assign(entries.size(), 0.0f);
+    numMatched.assign(entries.size(), 0);
+
+    for (auto& queryWord : queryWords) {
+        std::string_view text {queryWord};
+        touched.clear();
+
+        // the words equal to the query word or starting with it are a range
+        auto word = std::lower_bound(words.begin(), words.end(), text, [] (const Word& w, std::string_view value) {
+            return w.text < value;
+        });
+
+        for (int checked = 0; word != words.end() && word->text.compare(0, text.size(), text) == 0; ++word) {
+            if (++checked % stopCheckInterval == 0 && shouldStop())
+                return {};
+
+            auto score = word->text.size() == text.size()
+                ? exactScore
+                : prefixScore + prefixBoost * (float) text.size() / (float) word->text.size();
+            addPostings(*word, score);
+        }
+
+        // the words a typo or two away, a longer word may have more of them
+        if (allowTypos && (int) text.size() >= minTypoLength) {
+            auto maxDistance = text.size() >= 8 ? 2 : 1;
+
+            for (size_t i = 0; i < words.size(); ++i) {
+                if (i % stopCheckInterval == 0 && shouldStop())
+                    return {};
+
+                auto& candidate = words[i];
+                auto lengthDifference = (int) candidate.text.size() - (int) text.size();
+
+                // the words starting with the query word were scored above
+                if (std::abs(lengthDifference) > maxDistance || candidate.text.compare(0, text.size(), text) == 0)
+                    continue;
+
+                auto distance = getEditDistance(candidate.text, text, maxDistance);
+                if (distance <= maxDistance)
+                    addPostings(candidate, typoScore / (float) distance);
+            }
+        }
+
+        // a key in Camelot notation such as 8a
+        auto letter = text.back();
+        auto number = juce::String(juce::CharPointer_UTF8(text.data()), text.size() - 1).getIntValue();
+
+        if ((letter == 'a' || letter == 'b') && number >= 1 && number <= 12 && text.size() <= 3) {
+            for (size_t i = 0; i < entries.size(); ++i)
+                if (entries[i].camelotNumber == number && entries[i].minor == (letter == 'a'))
+                    addScore((int) i, keyScore);
+        }
+
+        // a tempo, the tempos a beat either side score half
+        if (text.find_first_not_of("0123456789") == std::string_view::npos) {
+            auto bpm = juce::String(juce::CharPointer_UTF8(text.data()), text.size()).getIntValue();
+
+            if (bpm >= 40 && bpm <= 250) {
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    if (entries[i].bpm <= 0.0f)
+                        continue;
+
+                    auto difference = std::abs(juce::roundToInt(entries[i].bpm) - bpm);
+                    if (difference <= 1)
+                        addScore((int) i, difference == 0 ? bpmScore : bpmScore * 0.5f);
+                }
+            }
+        }
+
+        // the best score of every track this word matched counts
+        for (auto entry : touched) {
+            totalScores[(size_t) entry] += wordScores[(size_t) entry];
+            ++numMatched[(size_t) entry];
+            wordScores[(size_t) entry] = 0.0f;
+        }
+    }
+
+    if (shouldStop())
+        return {};
+
+    // the tracks every word matched, best first and in their order otherwise
+    std::vector<int> matches;
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (numMatched[i] == (int) queryWords.size())
+            matches.push_back((int) i);
+
+    std::sort(matches.begin(), matches.end(), [this] (int a, int b) {
+        auto scoreA = totalScores[(size_t) a];
+        auto scoreB = totalScores[(size_t) b];
+        return scoreA != scoreB ? scoreA > scoreB : a < b;
+    });
+
+    for (auto& match : matches)
+        match = entries[(size_t) match].id;
+
+    return matches;
+}
+
+// check if a query has a word long enough to have typos
+bool SearchIndex::canHaveTypos(const juce::String& query)
+{
+    auto canHave = false;
+    std::string scratch;
+
+    forEachWord(StringArena::view(query), false, scratch, [&canHave] (std::string_view text) {
+        canHave = canHave || (int) text.size() >= minTypoLength;
+    });
+
+    return canHave;
+}
+
+// the number of edits between two words, up to a maximum
+int SearchIndex::getEditDistance(std::string_view a, std::string_view b, int maxDistance)
+{
+    // words longer than this are never typos of each other
+    constexpr size_t maxLength = 63;
+    if (a.size() > maxLength || b.size() > maxLength)
+        return maxDistance + 1;
+
+    // three rows of the table, the one before the last is for the swaps
+    int rows[3][maxLength + 1];
+    auto* beforeLast = rows[0];
+    auto* last = rows[1];
+    auto* current = rows[2];
+
+    for (size_t j = 0; j <= b.size(); ++j)
+        last[j] = (int) j;
+
+    for (size_t i = 1; i <= a.size(); ++i) {
+        current[0] = (int) i;
+        auto rowMinimum = current[0];
+
+        for (size_t j = 1; j <= b.size(); ++j) {
+            auto cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            current[j] = juce::jmin(last[j] + 1, current[j - 1] + 1, last[j - 1] + cost);
+
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                current[j] = juce::jmin(current[j], beforeLast[j - 2] + 1);
+
+            rowMinimum = juce::jmin(rowMinimum, current[j]);
+        }
+
+        // every path through the rest of the table is longer
+        if (rowMinimum > maxDistance)
+            return maxDistance + 1;
+
+        std::swap(beforeLast, last);
+        std::swap(last, current);
+    }
+
+    return juce::jmin(last[b.size()], maxDistance + 1);
+}
+
+//==============================================================================
+// give the tracks of a word a score
+void SearchIndex::addPostings(const Word& word, float score)
+{
+    for (int i = word.firstPosting; i < word.firstPosting + word.numPostings; ++i) {
+        auto& posting = postings[(size_t) i];
+        addScore(posting.entry, score * fieldWeights[posting.field] * (posting.first ? firstWordBoost : 1.0f));
+    }
+}
+
+// give a track a score, the best one counts
+void SearchIndex::addScore(int entry, float score)
+{
+    auto& best = wordScores[(size_t) entry];
+
+    if (best == 0.0f)
+        touched.push_back(entry);
+
+    best = juce::jmax(best, score);
+}
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    SearchIndex.h
+    Created: 19 Oct 2026 11:52:16pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StringArena.h"
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+//==============================================================================
+/*
+ Finds the tracks matching a query the way it is typed, ranked best first.
+
+ Every word of the title, the artist and the album of the tracks is put into
+ a sorted dictionary once, with the list of tracks it appears in. A word of
+ the query matches the words of the dictionary it is equal to or the start
+ of, which are found by a binary search, and optionally the words one or two
+ typing mistakes away from it. A word can also be a key such as 8A or a
+ tempo. A track matches when every word of the query does, and scores more
+ for whole words than for prefixes or typos, for the title more than for the
+ artist or album, and for the first word of a field.
+
+ The artist and album are the two folders the file is in, the usual layout
+ of a music folder, as the library does not read tags.
+*/
+class SearchIndex
+{
+public:
+    SearchIndex();
+    ~SearchIndex();
+
+    /** A track to index, the strings have to outlive the index */
+    struct Entry
+    {
+        /** The id the results give the track by */
+        int id = 0;
+        /** The title, as it is shown */
+        std::string_view title;
+        /** The artist and album, escaped as they are in a url */
+        std::string_view artist;
+        std::string_view album;
+        /** The key on the Camelot wheel, 0 if it is not known */
+        int camelotNumber = 0;
+        bool minor = false;
+        /** The tempo, 0 if it is not known */
+        float bpm = 0.0f;
+    };
+
+    /** The shortest word of a query that may have typos */
+    static constexpr int minTypoLength = 3;
+
+    /** Indexes a set of tracks, the results keep their order when they
+        score the same. Returns false if shouldStop stopped it, the index is
+        empty then */
+    bool build(std::vector<Entry> entries, const std::function<bool()>& shouldStop);
+    /** Replaces the keys and tempos, the tracks have to be the ones indexed */
+    void updateHarmonies(const std::vector<Entry>& entries);
+    /** Returns the number of tracks indexed */
+    int size() const;
+    /** Returns the number of different words */
+    int getNumWords() const;
+
+    /** Returns the ids of the tracks matching every word of a query, best
+        first. Typos are only looked for if allowed, which is slower. Returns
+        nothing if shouldStop stopped it */
+    std::vector<int> search(const juce::String& query, bool allowTypos, const std::function<bool()>& shouldStop);
+
+    /** Returns true if any word of a query is long enough to have typos */
+    static bool canHaveTypos(const juce::String& query);
+    /** Returns the number of edits, a swap of two letters counting as one,
+        that turn a word into another, or maxDistance + 1 if it is more */
+    static int getEditDistance(std::string_view a, std::string_view b, int maxDistance);
+
+private:
+    /** The fields the words come from */
+    enum Field : juce::uint8 { titleField, artistField, albumField, numFields };
+
+    /** A track a word appears in */
+    struct Posting
+    {
+        int entry;
+        Field field;
+        bool first;
+    };
+
+    /** A word of the dictionary and where its postings are */
+    struct Word
+    {
+        std::string_view text;
+        int firstPosting;
+        int numPostings;
+    };
+
+    /** Calls a function with every lower case word of a text, decoding
+        escaped characters if asked to */
+    template <typename Callback>
+    static void forEachWord(std::string_view text, bool escaped, std::string& scratch, Callback&& callback);
+    /** Gives the tracks of a word a score for the current word of the query */
+    void addPostings(const Word& word, float score);
+    /** Gives a track a score for the current word of the query, the best one counts */
+    void addScore(int entry, float score);
+
+    // the tracks in the order they were given
+    std::vector<Entry> entries;
+    // the words sorted, their postings and their text
+    std::vector<Word> words;
+    std::vector<Posting> postings;
+    StringArena strings;
+
+    // the scores of the query being searched, kept between queries
+    std::vector<float> wordScores;
+    std::vector<float> totalScores;
+    std::vector<int> numMatched;
+    std::vector<int> touched;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SearchIndex)
+};
@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+    SeekCache.cpp
+    Created: 19 Oct 2026 11:05:12pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "SeekCache.h"
+
+#include <algorithm>
+
+namespace
+{
+    // the copies are told apart from the other files in the cache by this
+    const juce::String copyExtension = ".seek.wav";
+    // the size of a page of memory on the systems the app runs on
+    const int pageBytes = 4096;
+    // how often the pages are touched again, in case they were dropped
+    const int touchIntervalMillis = 100;
+}
+
+SeekCache::SeekCache(juce::AudioFormatManager& _formatManager, const juce::URL& _url, juce::int64 _lengthInSamples)
+: juce::ThreadPoolJob("Seek cache"),
+  formatManager(_formatManager),
+  url(_url),
+  lengthInSamples(_lengthInSamples) {}
+
+SeekCache::~SeekCache() {}
+
+//==============================================================================
+// check if a reader decodes a compressed format
+bool SeekCache::isCompressed(const juce::AudioFormatReader& reader)
+{
+    auto name = reader.getFormatName();
+    return name != juce::WavAudioFormat().getFormatName()
+        && name != juce::AiffAudioFormat().getFormatName();
+}
+
+// the decoded copy of a track, named after its path, size and date
+juce::File SeekCache::getCacheFile(const juce::File& track)
+{
+    auto key = track.getFullPathName()
+               + "|" + juce::String(track.getSize())
+               + "|" + juce::String(track.getLastModificationTime().toMilliseconds());
+
+    return AnalysisPool::getCacheDirectory().getChildFile(juce::String::toHexString(key.hashCode64()) + copyExtension);
+}
+
+// delete the copies used longest ago until there is room
+void SeekCache::trimCache(juce::int64 bytesNeeded)
+{
+    auto copies = AnalysisPool::getCacheDirectory().findChildFiles(juce::File::findFiles, false, "*" + copyExtension);
+
+    juce::int64 totalBytes = bytesNeeded;
+    for (auto& copy : copies)
+        totalBytes += copy.getSize();
+
+    // a copy is touched every time it is used, so the oldest date goes first
+    std::sort(copies.begin(), copies.end(), [] (const juce::File& a, const juce::File& b) {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (auto& copy : copies) {
+        if (totalBytes <= maxCacheBytes)
+            break;
+
+        auto size = copy.getSize();
+        // a copy still mapped by a deck cannot be deleted on every system
+        if (copy.deleteFile())
+            totalBytes -= size;
+    }
+}
+
+//==============================================================================
+// decode the track into the cache if needed and map the copy
+juce::ThreadPoolJob::JobStatus SeekCache::runJob()
+{
+    auto track = url.getLocalFile();
+    auto copy = getCacheFile(track);
+
+    // a copy from an earlier load is used as it is, a damaged one is made again
+    if (! (copy.existsAsFile() && map(copy))) {
+        if (decode(copy))
+            map(copy);
+        else if (! shouldExit())
+            std::cout << "SeekCache::runJob  could not decode " << track.getFullPathName() << std::endl;
+    }
+
+    // mark the copy as used, so it is the last to go when the cache is trimmed
+    if (reader != nullptr)
+        copy.setLastModificationTime(juce::Time::getCurrentTime());
+
+    finished = true;
+    return jobHasFinished;
+}
+
+// check if the job is done
+bool SeekCache::isFinished() const
+{
+    return finished;
+}
+
+// the reader of the mapped copy
+juce::MemoryMappedAudioFormatReader* SeekCache::getReader() const
+{
+    return reader.get();
+}
+
+//==============================================================================
+// decode the track into a WAV file
+bool SeekCache::decode(const juce::File& copy)
+{
+    std::unique_ptr<juce::AudioFormatReader> source (formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (source == nullptr || source->lengthInSamples != lengthInSamples)
+        return false;
+
+    // 24 bits only for the tracks that have them, a lossy track does not
+    // need more than 16
+    auto bitsPerSample = source->bitsPerSample > 16 ? 24 : 16;
+    auto numChannels = (int) juce::jmax(1u, source->numChannels);
+    trimCache(lengthInSamples * numChannels * (bitsPerSample / 8));
+
+    // write to a temporary file first, so a crash never leaves half a copy behind
+    juce::TemporaryFile temporary {copy};
+
+    {
+        auto stream = std::make_unique<juce::FileOutputStream>(temporary.getFile());
+
+        if (stream->failedToOpen()) {
+            std::cout << "SeekCache::decode  could not write " << temporary.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            juce::WavAudioFormat().createWriterFor(stream.get(), source->sampleRate, (unsigned int) numChannels, bitsPerSample, {}, 0));
+
+        if (writer == nullptr)
+            return false;
+
+        // the writer owns the stream from now on
+        stream.release();
+
+        juce::AudioBuffer<float> buffer {numChannels, 32768};
+
+        for (juce::int64 start = 0; start < lengthInSamples; start += buffer.getNumSamples()) {
+            // the deck loaded another track
+            if (shouldExit())
+                return false;
+
+            auto numSamples = (int) juce::jmin((juce::int64) buffer.getNumSamples(), lengthInSamples - start);
+            source->read(&buffer, 0, numSamples, start, true, true);
+
+            if (! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+                return false;
+        }
+    }
+
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+// map a copy of the track
+bool SeekCache::map(const juce::File& copy)
+{
+    reader.reset(juce::WavAudioFormat().createMemoryMappedReader(copy));
+
+    // a copy of a different length is from a damaged or unfinished write
+    if (reader == nullptr || reader->lengthInSamples != lengthInSamples || ! reader->mapEntireFile()) {
+        reader.reset();
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+SeekCacheReader::SeekCacheReader(juce::AudioFormatManager& formatManager,
+                                 const juce::URL& url,
+                                 juce::AudioFormatReader* _compressedReader,
+                                 juce::TimeSliceThread& _touchThread)
+: juce::AudioFormatReader(nullptr, _compressedReader->getFormatName()),
+  compressedReader(_compressedReader),
+  touchThread(_touchThread)
+{
+    sampleRate = compressedReader->sampleRate;
+    bitsPerSample = compressedReader->bitsPerSample;
+    lengthInSamples = compressedReader->lengthInSamples;
+    numChannels = compressedReader->numChannels;
+    metadataValues = compressedReader->metadataValues;
+    // the samples of both readers are turned into floats
+    usesFloatingPointData = true;
+
+    // only files on disk can be copied
+    if (url.isLocalFile()) {
+        seekCache = std::make_unique<SeekCache>(formatManager, url, lengthInSamples);
+        analysisPool->addJob(seekCache.get());
+    }
+
+    for (auto& target : touchTargets)
+        target = -1;
+
+    touchThread.addTimeSliceClient(this);
+}
+
+SeekCacheReader::~SeekCacheReader()
+{
+    // waits only for a touch that is under way
+    touchThread.removeTimeSliceClient(this);
+
+    // the pool deletes the job once it has stopped
+    analysisPool->cancelJob(std::move(seekCache));
+}
+
+// read from the copy if it is ready, from the compressed track if not
+bool SeekCacheReader::readSamples(int** destSamples,
+                                  int numDestChannels,
+                                  int startOffsetInDestBuffer,
+                                  juce::int64 startSampleInFile,
+                                  int numSamples)
+{
+    auto* copy = copyReader.load(std::memory_order_acquire);
+
+    // the copy is picked up by the first read after it is ready
+    if (copy == nullptr && seekCache != nullptr && seekCache->isFinished()) {
+        copy = seekCache->getReader();
+        copyReader.store(copy, std::memory_order_release);
+    }
+
+    juce::AudioFormatReader* source = copy != nullptr ? static_cast<juce::AudioFormatReader*>(copy)
+                                                      : compressedReader.get();
+
+    if (! source->readSamples(destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples))
+        return false;
+
+    lastReadEnd.store(startSampleInFile + numSamples, std::memory_order_relaxed);
+
+    // the WAV copy and some compressed formats give integers
+    if (! source->usesFloatingPointData) {
+        for (int channel = 0; channel < numDestChannels; ++channel) {
+            if (destSamples[channel] == nullptr)
+                continue;
+
+            auto* samples = destSamples[channel] + startOffsetInDestBuffer;
+            juce::FloatVectorOperations::convertFixedToFloat(reinterpret_cast<float*>(samples),
+                                                             samples,
+                                                             1.0f / (float) 0x7fffffff,
+                                                             numSamples);
+        }
+    }
+
+    return true;
+}
+
+// check if reads come from the copy
+bool SeekCacheReader::isUsingCopy() const
+{
+    return copyReader.load() != nullptr;
+}
+
+// set a position the pages after are kept in memory
+void SeekCacheReader::setTouchTarget(int index, juce::int64 position)
+{
+    if (juce::isPositiveAndBelow(index, numTouchTargets))
+        touchTargets[(size_t) index] = position;
+}
+
+//==============================================================================
+// touch the pages around the playhead and after the touch targets
+int SeekCacheReader::useTimeSlice()
+{
+    // nothing is mapped until the copy is made
+    if (seekCache == nullptr || ! seekCache->isFinished() || seekCache->getReader() == nullptr)
+        return touchIntervalMillis;
+
+    auto& copy = *seekCache->getReader();
+    auto playhead = lastReadEnd.load(std::memory_order_relaxed);
+    auto behind = (juce::int64) (touchBehindSeconds * sampleRate);
+
+    // the playhead first, it is played from next
+    touchRange(copy, playhead, (juce::int64) (touchAheadSeconds * sampleRate));
+    touchRange(copy, playhead - behind, behind);
+
+    for (auto& target : touchTargets) {
+        auto position = target.load();
+
+        if (position >= 0)
+            touchRange(copy, position, (juce::int64) (touchTargetSeconds * sampleRate));
+    }
+
+    // a page that is in memory costs next to nothing to touch again
+    return touchIntervalMillis;
+}
+
+// touch every page of the copy in a range of samples
+void SeekCacheReader::touchRange(juce::MemoryMappedAudioFormatReader& copy, juce::int64 start, juce::int64 length)
+{
+    auto frameBytes = juce::jmax(1, (int) copy.numChannels * (int) copy.bitsPerSample / 8);
+    auto step = (juce::int64) juce::jmax(1, pageBytes / frameBytes);
+    auto end = juce::jmin(start + length, copy.lengthInSamples);
+
+    for (auto sample = juce::jmax((juce::int64) 0, start); sample < end; sample += step)
+        copy.touchSample(sample);
+}
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    SeekCache.h
+    Created: 19 Oct 2026 11:05:12pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalysisPool.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/*
+ Makes a compressed track as quick to jump around in as a WAV file.
+
+ A decoder for MP3, Ogg or FLAC cannot be started at any byte of the file,
+ so a seek has to find its way through the compressed stream, and a VBR MP3
+ may be scanned from the start. The first time a compressed track is loaded
+ on a deck it is decoded once on the analysis pool into a WAV file in the
+ cache, keyed by the path, size and date of the track like the waveforms.
+ The copy is memory mapped, so a seek is an offset into the map and no
+ frames are decoded at all. A MP3 or Ogg decoder does not say where its
+ frames start, so an index of frame offsets cannot be built through it.
+
+ The cache is kept under maxCacheBytes by deleting the copies that were used
+ longest ago.
+*/
+class SeekCache : public juce::ThreadPoolJob
+{
+public:
+    SeekCache(juce::AudioFormatManager& formatManager, const juce::URL& url, juce::int64 lengthInSamples);
+    ~SeekCache() override;
+
+    /** The most disk space the decoded copies take up */
+    static constexpr juce::int64 maxCacheBytes = (juce::int64) 2 << 30;
+
+    /** Returns true if a reader decodes a compressed format, WAV and AIFF
+        files seek quickly as they are */
+    static bool isCompressed(const juce::AudioFormatReader& reader);
+    /** Returns the decoded copy of a track in the cache, which changes if the track does */
+    static juce::File getCacheFile(const juce::File& track);
+    /** Deletes the copies used longest ago until the cache is small enough
+        for a number of bytes more */
+    static void trimCache(juce::int64 bytesNeeded);
+
+    /** Decodes the track into the cache if it is not there yet, and maps the copy */
+    JobStatus runJob() override;
+
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns the reader of the mapped copy, null if it could not be made.
+        Only use this once isFinished returns true */
+    juce::MemoryMappedAudioFormatReader* getReader() const;
+
+private:
+    /** Decodes the track into a WAV file */
+    bool decode(const juce::File& copy);
+    /** Maps a copy, returns false if it is not a whole copy of the track */
+    bool map(const juce::File& copy);
+
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track and its length, the copy has to be exactly as long
+    juce::URL url;
+    juce::int64 lengthInSamples;
+
+    // the mapped copy and whether the job is done
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SeekCache)
+};
+
+//==============================================================================
+/*
+ The reader a deck plays a compressed track through. It reads the compressed
+ track until its copy in the SeekCache is ready and from the mapped copy from
+ then on, at the same sample positions, so the switch cannot be heard. The
+ copy is picked up by the audio thread, with no lock and no allocation.
+
+ A page of the map that is not in memory is read from disk the first time it
+ is touched, which must not happen in the audio callback. A background
+ thread keeps touching the pages around the playhead, where a scratch lands,
+ and after every touch target, so they are in memory before they are played.
+
+ Samples always come out as floats, whichever of the two readers they are
+ read from.
+*/
+class SeekCacheReader : public juce::AudioFormatReader,
+                        private juce::TimeSliceClient
+{
+public:
+    /** Takes ownership of the compressed reader. The pages of the copy are
+        touched on the given thread, which must outlive the reader */
+    SeekCacheReader(juce::AudioFormatManager& formatManager,
+                    const juce::URL& url,
+                    juce::AudioFormatReader* compressedReader,
+                    juce::TimeSliceThread& touchThread);
+    ~SeekCacheReader() override;
+
+    /** The number of positions the pages after are kept in memory */
+    static constexpr int numTouchTargets = 8;
+    /** How much audio around the playhead is kept in memory, the most a
+        scratch moves it */
+    static constexpr double touchBehindSeconds = 10.0;
+    static constexpr double touchAheadSeconds = 20.0;
+    /** How much audio after a touch target is kept in memory */
+    static constexpr double touchTargetSeconds = 10.0;
+
+    /** Reads from the mapped copy if it is ready, from the compressed track if not */
+    bool readSamples(int** destSamples,
+                     int numDestChannels,
+                     int startOffsetInDestBuffer,
+                     juce::int64 startSampleInFile,
+                     int numSamples) override;
+
+    /** Returns true once reads come from the mapped copy */
+    bool isUsingCopy() const;
+    /** Sets a position the pages after are kept in memory, so a jump to it
+        does not wait for the disk, or -1 to drop it */
+    void setTouchTarget(int index, juce::int64 position);
+
+private:
+    /** Touches the pages around the playhead and after the touch targets */
+    int useTimeSlice() override;
+    /** Touches every page of the copy in a range of samples */
+    static void touchRange(juce::MemoryMappedAudioFormatReader& copy, juce::int64 start, juce::int64 length);
+
+    // the track as it is on disk
+    std::unique_ptr<juce::AudioFormatReader> compressedReader;
+    // makes the copy, null if the track cannot be cached
+    std::unique_ptr<SeekCache> seekCache;
+    // the copy once the audio thread has picked it up
+    std::atomic<juce::MemoryMappedAudioFormatReader*> copyReader {nullptr};
+
+    // the thread the pages are touched on
+    juce::TimeSliceThread& touchThread;
+    // the end of the last read, which the playhead is close to
+    std::atomic<juce::int64> lastReadEnd {0};
+    // the positions the pages after are kept in memory, -1 if none
+    std::array<std::atomic<juce::int64>, numTouchTargets> touchTargets;
+
+    // the background threads the copy is made on
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SeekCacheReader)
+};
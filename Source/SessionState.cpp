@@ -0,0 +1,328 @@
+/*
+  ==============================================================================
+
+    SessionState.cpp
+    Created: 20 Oct 2026 2:24:51am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "SessionState.h"
+
+namespace
+{
+    // the start and the end of a snapshot, a file cut short has no end
+    const int magicNumber = 0x4f545353;
+    const int version = 1;
+    // the most sort keys read, a bigger number is not a snapshot
+    const int maxSortKeys = 16;
+}
+
+//==============================================================================
+SessionState::SessionState(const juce::File& snapshotFile)
+: juce::Thread("Session snapshots"),
+  file(snapshotFile)
+{
+    startThread(2);
+}
+
+SessionState::~SessionState()
+{
+    stopTimer();
+    // the writer is never killed halfway through writing the file
+    stopThread(-1);
+
+    // the writer has stopped, so the last snapshot is written from here
+    writePending();
+}
+
+// the snapshot file sits with the other settings
+juce::File SessionState::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+               .getChildFile("Otodesk")
+               .getChildFile("session.bin");
+}
+
+//==============================================================================
+// take a snapshot every interval
+void SessionState::start(int intervalMillis)
+{
+    startTimer(intervalMillis);
+}
+
+// take a snapshot and hand it to the writer
+void SessionState::capture()
+{
+    if (onCapture == nullptr)
+        return;
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    Snapshot snapshot;
+    onCapture(snapshot);
+
+    {
+        const juce::ScopedLock lock {pendingLock};
+        std::swap(pending, snapshot);
+        hasPending = true;
+    }
+
+    notify();
+
+    lastCaptureMicros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+    maxCaptureMicros = juce::jmax(maxCaptureMicros, lastCaptureMicros);
+}
+
+// read the snapshot in the file
+bool SessionState::read(Snapshot& snapshot) const
+{
+    if (! file.existsAsFile())
+        return false;
+
+    juce::FileInputStream stream {file};
+
+    if (stream.failedToOpen() || ! decode(stream, snapshot)) {
+        std::cout << "SessionState::read  could not read " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+// the state of a deck from a player
+void SessionState::captureDeck(DJAudioPlayer& player, Deck& deck)
+{
+    deck.url = player.getLoadedURL().toString(false);
+    deck.position = player.getTrackPosition();
+    deck.playing = player.isPlaying();
+    deck.gain = player.getGain();
+    deck.speed = player.getSpeed();
+    deck.sync = player.isSyncEnabled();
+    deck.cue = player.isCueEnabled();
+    deck.autoGain = player.isAutoGainEnabled();
+
+    for (int band = 0; band < DeckEqualiser::numBands; ++band)
+        deck.equaliser[(size_t) band] = player.getEqualiser().getGain(band);
+
+    for (int effect = 0; effect < EffectsRack::numEffects; ++effect) {
+        deck.effectsEnabled[(size_t) effect] = player.getEffectsRack().isEffectEnabled(effect);
+        deck.effectAmounts[(size_t) effect] = player.getEffectsRack().getEffectAmount(effect);
+    }
+}
+
+// set the controls of a player to the state of a deck
+void SessionState::applyDeck(const Deck& deck, DJAudioPlayer& player)
+{
+    player.setGain(deck.gain);
+    player.setSpeed(deck.speed);
+    player.setSyncEnabled(deck.sync);
+    player.setCueEnabled(deck.cue);
+    player.setAutoGainEnabled(deck.autoGain);
+
+    for (int band = 0; band < DeckEqualiser::numBands; ++band)
+        player.getEqualiser().setGain(band, deck.equaliser[(size_t) band]);
+
+    for (int effect = 0; effect < EffectsRack::numEffects; ++effect) {
+        player.getEffectsRack().setEffectAmount(effect, deck.effectAmounts[(size_t) effect]);
+        player.getEffectsRack().setEffectEnabled(effect, deck.effectsEnabled[(size_t) effect]);
+    }
+}
+
+//==============================================================================
+// encode a snapshot, the fields in a fixed order
+void SessionState::encode(const Snapshot& snapshot, juce::OutputStream& stream)
+{
+    stream.writeInt(magicNumber);
+    stream.writeInt(version);
+
+    for (auto& deck : snapshot.decks) {
+        stream.writeString(deck.url);
+        stream.writeInt64(deck.position);
+        stream.writeBool(deck.playing);
+        stream.writeDouble(deck.gain);
+        stream.writeDouble(deck.speed);
+        stream.writeBool(deck.sync);
+        stream.writeBool(deck.cue);
+        stream.writeBool(deck.autoGain);
+
+        for (auto gain : deck.equaliser)
+            stream.writeFloat(gain);
+
+        for (size_t effect = 0; effect < deck.effectsEnabled.size(); ++effect) {
+            stream.writeBool(deck.effectsEnabled[effect]);
+            stream.writeFloat(deck.effectAmounts[effect]);
+        }
+    }
+
+    stream.writeBool(snapshot.mixer.splitCue);
+    stream.writeDouble(snapshot.mixer.clockTempo);
+
+    stream.writeString(snapshot.view.searchText);
+    stream.writeInt(snapshot.view.keyFilter);
+    stream.writeString(snapshot.view.crate);
+    stream.writeInt(snapshot.view.sortOrder.size());
+
+    for (auto& key : snapshot.view.sortOrder) {
+        stream.writeInt((int) key.field);
+        stream.writeBool(key.forwards);
+    }
+
+    stream.writeInt(magicNumber);
+}
+
+// decode a snapshot, the snapshot is only changed if it is a whole one
+bool SessionState::decode(juce::InputStream& stream, Snapshot& snapshot)
+{
+    if (stream.readInt() != magicNumber || stream.readInt() != version)
+        return false;
+
+    Snapshot result;
+
+    for (auto& deck : result.decks) {
+        deck.url = stream.readString();
+        deck.position = stream.readInt64();
+        deck.playing = stream.readBool();
+        deck.gain = stream.readDouble();
+        deck.speed = stream.readDouble();
+        deck.sync = stream.readBool();
+        deck.cue = stream.readBool();
+        deck.autoGain = stream.readBool();
+
+        for (auto& gain : deck.equaliser)
+            gain = stream.readFloat();
+
+        for (size_t effect = 0; effect < deck.effectsEnabled.size(); ++effect) {
+            deck.effectsEnabled[effect] = stream.readBool();
+            deck.effectAmounts[effect] = stream.readFloat();
+        }
+    }
+
+    result.mixer.splitCue = stream.readBool();
+    result.mixer.clockTempo = stream.readDouble();
+
+    result.view.searchText = stream.readString();
+    result.view.keyFilter = stream.readInt();
+    result.view.crate = stream.readString();
+
+    auto numSortKeys = stream.readInt();
+    if (numSortKeys < 0 || numSortKeys > maxSortKeys)
+        return false;
+
+    for (int i = 0; i < numSortKeys; ++i) {
+        auto field = stream.readInt();
+        if (field < 0 || field > (int) TrackLibrary::SortField::lastPlayed)
+            return false;
+
+        TrackLibrary::SortKey key;
+        key.field = (TrackLibrary::SortField) field;
+        key.forwards = stream.readBool();
+        result.view.sortOrder.add(key);
+    }
+
+    // a snapshot cut short reads as zeros up to here
+    if (stream.readInt() != magicNumber)
+        return false;
+
+    snapshot = std::move(result);
+    return true;
+}
+
+//==============================================================================
+// the time the last snapshot took on the message thread
+double SessionState::getLastCaptureMicros() const
+{
+    return lastCaptureMicros;
+}
+
+// the longest time a snapshot took on the message thread
+double SessionState::getMaxCaptureMicros() const
+{
+    return maxCaptureMicros;
+}
+
+// the number of snapshots written
+int SessionState::getNumWritten() const
+{
+    return numWritten.load();
+}
+
+// the number of snapshots left out
+int SessionState::getNumUnchanged() const
+{
+    return numUnchanged.load();
+}
+
+// the snapshot file
+const juce::File& SessionState::getFile() const
+{
+    return file;
+}
+
+//==============================================================================
+// take a snapshot every interval
+void SessionState::timerCallback()
+{
+    capture();
+}
+
+// write the snapshots as they are handed over
+void SessionState::run()
+{
+    while (! threadShouldExit()) {
+        wait(-1);
+        writePending();
+    }
+}
+
+// encode the waiting snapshot and replace the file with it
+void SessionState::writePending()
+{
+    Snapshot snapshot;
+
+    {
+        const juce::ScopedLock lock {pendingLock};
+        if (! hasPending)
+            return;
+
+        std::swap(pending, snapshot);
+        hasPending = false;
+    }
+
+    juce::MemoryOutputStream data;
+    encode(snapshot, data);
+
+    // a deck that is not playing and controls that did not move give the
+    // same bytes, which are on disk already
+    if (lastWritten.matches(data.getData(), data.getDataSize())) {
+        ++numUnchanged;
+        return;
+    }
+
+    // the snapshot goes to a file next to it, which then replaces it in one
+    // step, so a crash while writing leaves the last snapshot as it was
+    file.getParentDirectory().createDirectory();
+    juce::TemporaryFile temporary {file};
+
+    {
+        juce::FileOutputStream stream {temporary.getFile()};
+
+        if (stream.failedToOpen()) {
+            std::cout << "SessionState::writePending  could not open " << temporary.getFile().getFullPathName() << std::endl;
+            return;
+        }
+
+        stream.write(data.getData(), data.getDataSize());
+        stream.flush();
+    }
+
+    if (! temporary.overwriteTargetFileWithTemporary()) {
+        std::cout << "SessionState::writePending  could not replace " << file.getFullPathName() << std::endl;
+        return;
+    }
+
+    lastWritten.replaceAll(data.getData(), data.getDataSize());
+    ++numWritten;
+}
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    SessionState.h
+    Created: 20 Oct 2026 2:24:51am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "TrackLibrary.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+
+//==============================================================================
+/*
+ Takes snapshots of the decks, the mixer and the playlist while the app runs
+ and keeps the last one in a file, so a session can be picked up where it was
+ left if the app dies.
+
+ A snapshot is only the values of the controls, taken on the message thread
+ a few times a second, which costs a few microseconds. It is encoded on a
+ thread of its own into a few hundred bytes, and written only if it differs
+ from the last one written, to a temporary file that then replaces the
+ snapshot file, so the file is always a whole snapshot. A newer snapshot
+ replaces one the writer has not got to yet.
+*/
+class SessionState : private juce::Thread,
+                     private juce::Timer
+{
+public:
+    /** Creates a session that keeps its snapshots in the given file */
+    SessionState(const juce::File& snapshotFile);
+    /** Writes the last snapshot taken before returning */
+    ~SessionState() override;
+
+    /** Returns the snapshot file used when no other file is given */
+    static juce::File getDefaultFile();
+
+    /** The number of decks in a snapshot */
+    static constexpr int numDecks = 2;
+
+    /** The state of a deck */
+    struct Deck
+    {
+        /** The loaded track, empty if there is none */
+        juce::String url;
+        /** The playhead in samples of the track */
+        juce::int64 position = 0;
+        bool playing = false;
+        double gain = 1.0;
+        double speed = 1.0;
+        bool sync = false;
+        bool cue = false;
+        bool autoGain = false;
+        /** The gain of every band of the EQ in dB */
+        std::array<float, DeckEqualiser::numBands> equaliser {};
+        /** Whether every effect is on, and its amount */
+        std::array<bool, EffectsRack::numEffects> effectsEnabled {};
+        std::array<float, EffectsRack::numEffects> effectAmounts {};
+    };
+
+    /** The state of the mixer and the master clock */
+    struct Mixer
+    {
+        bool splitCue = false;
+        double clockTempo = 120.0;
+    };
+
+    /** What the playlist shows */
+    struct View
+    {
+        juce::String searchText;
+        /** The id of the choice of the key filter */
+        int keyFilter = 0;
+        /** The name of the smart crate shown, empty for all tracks */
+        juce::String crate;
+        juce::Array<TrackLibrary::SortKey> sortOrder;
+    };
+
+    /** Everything a session is picked up from */
+    struct Snapshot
+    {
+        std::array<Deck, numDecks> decks;
+        Mixer mixer;
+        View view;
+    };
+
+    /** Called on the message thread to fill in a snapshot */
+    std::function<void(Snapshot&)> onCapture;
+
+    /** Takes a snapshot every interval from now on */
+    void start(int intervalMillis);
+    /** Takes a snapshot now and hands it to the writer. Message thread */
+    void capture();
+
+    /** Reads the snapshot in the file. Returns false if there is none or it
+        cannot be read */
+    bool read(Snapshot& snapshot) const;
+
+    /** Fills in the state of a deck from a player */
+    static void captureDeck(DJAudioPlayer& player, Deck& deck);
+    /** Sets the controls of a player to the state of a deck. The track, its
+        position and playing are left to the caller, as the track is loaded
+        in the background */
+    static void applyDeck(const Deck& deck, DJAudioPlayer& player);
+
+    /** Encodes a snapshot in a few hundred bytes */
+    static void encode(const Snapshot& snapshot, juce::OutputStream& stream);
+    /** Decodes a snapshot. Returns false if the data is not a whole one */
+    static bool decode(juce::InputStream& stream, Snapshot& snapshot);
+
+    /** Returns the time the last snapshot took on the message thread in
+        microseconds, and the longest one */
+    double getLastCaptureMicros() const;
+    double getMaxCaptureMicros() const;
+    /** Returns the number of snapshots written to the file, and the number
+        left out because nothing had changed */
+    int getNumWritten() const;
+    int getNumUnchanged() const;
+    /** Returns the snapshot file */
+    const juce::File& getFile() const;
+
+private:
+    /** Takes a snapshot every interval */
+    void timerCallback() override;
+    /** Writes the snapshots handed over until the session is deleted */
+    void run() override;
+    /** Encodes the snapshot waiting and writes it if it has changed. Writer thread */
+    void writePending();
+
+    // the file the snapshots replace
+    juce::File file;
+
+    // the snapshot waiting for the writer, the lock is only held to copy it
+    juce::CriticalSection pendingLock;
+    Snapshot pending;
+    bool hasPending = false;
+
+    // the bytes written last, to leave out a snapshot that has not changed
+    juce::MemoryBlock lastWritten;
+
+    // the time taken on the message thread
+    double lastCaptureMicros = 0.0;
+    double maxCaptureMicros = 0.0;
+    // the snapshots written and left out
+    std::atomic<int> numWritten {0};
+    std::atomic<int> numUnchanged {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionState)
+};
@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    SmartCrate.cpp
+    Created: 20 Oct 2026 1:06:22am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "SmartCrate.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // check if a word of a query is a number
+    bool isNumber(const juce::String& word)
+    {
+        return word.containsOnly("0123456789.-+") && word.containsAnyOf("0123456789");
+    }
+
+    // the top of a range that has none
+    const float noMaximum = std::numeric_limits<float>::max();
+}
+
+//==============================================================================
+// read a query into its clauses
+bool SmartCrate::setQuery(const juce::String& text, juce::String& error)
+{
+    // an en dash or a hyphen after a number is a range, a minus before a
+    // number is not
+    auto lowerCase = text.toLowerCase().replace(juce::String::charToString((juce::juce_wchar) 0x2013), " to ");
+    juce::String spaced;
+
+    for (int i = 0; i < lowerCase.length(); ++i) {
+        auto character = lowerCase[i];
+
+        if (character == '-' && juce::CharacterFunctions::isDigit(spaced.trimEnd().getLastCharacter()))
+            spaced << " to ";
+        else
+            spaced << character;
+    }
+
+    auto words = juce::StringArray::fromTokens(spaced, true);
+    words.removeEmptyStrings();
+
+    std::vector<Rule> newRules;
+
+    for (int i = 0; i < words.size();) {
+        Rule rule;
+        rule.negated = words[i] == "not";
+        if (rule.negated)
+            ++i;
+
+        auto field = words[i++];
+
+        if (field == "bpm" || field == "lufs" || field == "plays") {
+            // a number, or a range of two
+            if (! isNumber(words[i])) {
+                error = "expected a number after " + field;
+                return false;
+            }
+
+            rule.field = field == "bpm" ? bpmField : field == "lufs" ? loudnessField : playsField;
+            rule.minimum = rule.maximum = words[i++].getFloatValue();
+
+            if (words[i] == "to") {
+                if (! isNumber(words[i + 1])) {
+                    error = "expected a number after to";
+                    return false;
+                }
+
+                rule.maximum = words[i + 1].getFloatValue();
+                i += 2;
+
+                if (rule.minimum > rule.maximum)
+                    std::swap(rule.minimum, rule.maximum);
+            }
+            else {
+                // a single value is the values that round to it
+                rule.minimum -= 0.5f;
+                rule.maximum += 0.5f;
+            }
+        }
+        else if (field == "key") {
+            auto key = words[i++];
+            auto letter = key.getLastCharacter();
+            auto number = key.dropLastCharacters(1).getIntValue();
+
+            if ((letter != 'a' && letter != 'b') || number < 1 || number > 12) {
+                error = "expected a key such as 8A after key";
+                return false;
+            }
+
+            rule.field = keyField;
+            rule.minimum = rule.maximum = getKeyValue(number, letter == 'a');
+        }
+        else if (field == "dupes" || field == "duplicates") {
+            rule.field = duplicateField;
+            rule.minimum = rule.maximum = 1.0f;
+        }
+        else if (field == "played") {
+            // the start of the day, and of the week from Monday
+            auto now = juce::Time::getCurrentTime();
+            juce::Time today {now.getYear(), now.getMonth(), now.getDayOfMonth(), 0, 0};
+            juce::Time since;
+
+            if (words[i] == "today") {
+                since = today;
+                i += 1;
+            }
+            else if (words[i] == "this" && words[i + 1] == "week") {
+                since = today - juce::RelativeTime::days((now.getDayOfWeek() + 6) % 7);
+                i += 2;
+            }
+            else if (words[i] == "this" && words[i + 1] == "month") {
+                since = juce::Time {now.getYear(), now.getMonth(), 1, 0, 0};
+                i += 2;
+            }
+            else if (words[i] == "this" && words[i + 1] == "year") {
+                since = juce::Time {now.getYear(), 0, 1, 0, 0};
+                i += 2;
+            }
+            else if (words[i] == "in") {
+                if (! isNumber(words[i + 1]) || ! words[i + 2].startsWith("day")) {
+                    error = "expected a number of days after played in";
+                    return false;
+                }
+
+                since = now - juce::RelativeTime::days(words[i + 1].getDoubleValue());
+                i += 3;
+            }
+
+            // played on its own is played at all
+            if (since.toMilliseconds() == 0) {
+                rule.field = playsField;
+                rule.minimum = 1.0f;
+            }
+            else {
+                rule.field = lastPlayedField;
+                rule.minimum = getDayValue(since.toMilliseconds());
+            }
+
+            rule.maximum = noMaximum;
+        }
+        else {
+            error = field.isEmpty() ? juce::String("expected a clause at the end") : "unknown clause " + field;
+            return false;
+        }
+
+        newRules.push_back(rule);
+
+        // the clauses are joined by and
+        if (i < words.size()) {
+            if (words[i] != "and") {
+                error = "expected and before " + words[i];
+                return false;
+            }
+
+            if (++i == words.size()) {
+                error = "expected a clause after and";
+                return false;
+            }
+        }
+    }
+
+    if (newRules.empty()) {
+        error = "the query is empty";
+        return false;
+    }
+
+    query = text.trim();
+    rules = std::move(newRules);
+    return true;
+}
+
+// the value of a key in the key column
+float SmartCrate::getKeyValue(int camelotNumber, bool minor)
+{
+    return (float) (camelotNumber * 2 - (minor ? 1 : 0));
+}
+
+// the value of a time in the last played column
+float SmartCrate::getDayValue(juce::int64 timeMillis)
+{
+    return (float) ((double) timeMillis / (24.0 * 60.0 * 60.0 * 1000.0));
+}
+
+//==============================================================================
+CrateIndex::CrateIndex() {}
+
+CrateIndex::~CrateIndex() {}
+
+// store the values of a track and update the crates it is in
+void CrateIndex::setTrack(int index, bool trackShown, const Values& values)
+{
+    auto position = (size_t) index;
+
+    // the tracks in between are not shown until they are set
+    if (position >= shown.size()) {
+        for (auto& column : columns)
+            column.resize(position + 1, unknown);
+
+        shown.resize(position + 1, 0);
+
+        for (auto& state : crates)
+            state.matches.resize(position + 1, 0);
+    }
+
+    for (int field = 0; field < SmartCrate::numFields; ++field)
+        columns[(size_t) field][position] = values[(size_t) field];
+
+    shown[position] = trackShown ? 1 : 0;
+
+    // only this track is tested against the crates
+    for (auto& state : crates) {
+        auto matches = (juce::uint8) (matchesTrack(state, position) ? 1 : 0);
+
+        if (matches != state.matches[position]) {
+            state.numMatches += matches != 0 ? 1 : -1;
+            state.matches[position] = matches;
+        }
+    }
+}
+
+// make room for a number of tracks
+void CrateIndex::reserve(int numTracks)
+{
+    for (auto& column : columns)
+        column.reserve((size_t) numTracks);
+
+    shown.reserve((size_t) numTracks);
+
+    for (auto& state : crates)
+        state.matches.reserve((size_t) numTracks);
+}
+
+// the number of tracks in the columns
+int CrateIndex::getNumTracks() const
+{
+    return (int) shown.size();
+}
+
+// add a crate and find its tracks
+void CrateIndex::addCrate(const SmartCrate& crate)
+{
+    crates.push_back({crate, {}, 0});
+    evaluate(crates.back());
+}
+
+// replace a crate and find its tracks again
+void CrateIndex::replaceCrate(int crate, const SmartCrate& newCrate)
+{
+    auto& state = crates[(size_t) crate];
+    state.crate = newCrate;
+    evaluate(state);
+}
+
+// remove a crate
+void CrateIndex::removeCrate(int crate)
+{
+    crates.erase(crates.begin() + crate);
+}
+
+// the number of crates
+int CrateIndex::getNumCrates() const
+{
+    return (int) crates.size();
+}
+
+// a crate
+const SmartCrate& CrateIndex::getCrate(int crate) const
+{
+    return crates[(size_t) crate].crate;
+}
+
+// check if a track is in a crate
+bool CrateIndex::contains(int crate, int index) const
+{
+    auto& matches = crates[(size_t) crate].matches;
+    return (size_t) index < matches.size() && matches[(size_t) index] != 0;
+}
+
+// the number of tracks in a crate
+int CrateIndex::getNumMatches(int crate) const
+{
+    return crates[(size_t) crate].numMatches;
+}
+
+// find the tracks of every crate again
+void CrateIndex::evaluateAll()
+{
+    for (auto& state : crates)
+        evaluate(state);
+}
+
+//==============================================================================
+// find the tracks of a crate from the columns
+void CrateIndex::evaluate(CrateState& state)
+{
+    // only the shown tracks can match
+    state.matches.assign(shown.begin(), shown.end());
+
+    auto* matches = state.matches.data();
+    auto numTracks = state.matches.size();
+
+    for (auto& rule : state.crate.rules) {
+        auto* values = columns[(size_t) rule.field].data();
+        auto minimum = rule.minimum;
+        auto maximum = rule.maximum;
+        auto negated = (juce::uint8) (rule.negated ? 1 : 0);
+
+        // no branches, so the compiler compares a vector of values at a time
+        for (size_t i = 0; i < numTracks; ++i) {
+            auto value = values[i];
+            auto inRange = (juce::uint8) ((value >= minimum) & (value <= maximum));
+            auto known = (juce::uint8) (value != unknown);
+            matches[i] &= (juce::uint8) ((inRange ^ negated) & known);
+        }
+    }
+
+    state.numMatches = (int) std::count(state.matches.begin(), state.matches.end(), (juce::uint8) 1);
+}
+
+// check if a track matches every clause of a crate
+bool CrateIndex::matchesTrack(const CrateState& state, size_t index) const
+{
+    if (shown[index] == 0)
+        return false;
+
+    for (auto& rule : state.crate.rules) {
+        auto value = columns[(size_t) rule.field][index];
+        auto inRange = value >= rule.minimum && value <= rule.maximum;
+
+        if (value == unknown || inRange == rule.negated)
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    SmartCrate.h
+    Created: 20 Oct 2026 1:06:22am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <vector>
+
+//==============================================================================
+/*
+ A saved query such as "bpm 120-128 and key 8A and not dupes", which the
+ tracks matching it are shown by like a playlist that fills itself.
+
+ A query is a number of clauses joined by "and", each of which may start
+ with "not":
+   bpm 120-128    a tempo, or a range of them
+   lufs -14 to -8 a loudness, or a range of them
+   key 8A         a key in Camelot notation
+   dupes          the tracks that sound like another track
+   plays 3-10     a number of plays, or a range of them
+   played         the tracks played at least once
+   played today   the tracks played since a day, also "played this week",
+                  "played this month", "played this year" and
+                  "played in 30 days"
+ A track whose value is not known yet never matches a clause, not even one
+ starting with "not". The plays are always known, so "not played this month"
+ also finds the tracks never played. The day a played clause starts from is
+ worked out when the query is read, which is when the app starts.
+*/
+class SmartCrate
+{
+public:
+    /** The fields a clause can test, every one is a column of a CrateIndex */
+    enum Field : juce::uint8 { bpmField, keyField, loudnessField, duplicateField,
+                               playsField, lastPlayedField, numFields };
+
+    /** A clause of the query, true if the field is in the range */
+    struct Rule
+    {
+        Field field = bpmField;
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+        bool negated = false;
+    };
+
+    /** The name the crate is listed by */
+    juce::String name;
+    /** The query as it was typed */
+    juce::String query;
+    /** The clauses of the query, all of which a track has to match */
+    std::vector<Rule> rules;
+
+    /** Reads a query into its clauses. Returns false and describes the
+        problem if it cannot be read, the crate does not change then */
+    bool setQuery(const juce::String& text, juce::String& error);
+
+    /** Returns the value of a key in the key column, the minor key of a
+        number first so the keys go round the wheel */
+    static float getKeyValue(int camelotNumber, bool minor);
+    /** Returns the value of a time in milliseconds since 1970 in the last
+        played column, the days since 1970 */
+    static float getDayValue(juce::int64 timeMillis);
+};
+
+//==============================================================================
+/*
+ Finds the tracks of a number of smart crates without going through the
+ tracks one record at a time.
+
+ The values the crates test are kept in one array per field, indexed by the
+ tracks of the library, and every crate keeps a flag per track. A crate is
+ evaluated in one pass per clause over the column of its field, a loop
+ without branches the compiler turns into vector instructions. After that a
+ track that is added or analysed again is only tested against the crates on
+ its own, so the crates stay up to date without running their queries again.
+*/
+class CrateIndex
+{
+public:
+    CrateIndex();
+    ~CrateIndex();
+
+    /** The value of a field that is not known */
+    static constexpr float unknown = -1.0e9f;
+
+    /** The values of every field of a track */
+    using Values = std::array<float, SmartCrate::numFields>;
+
+    /** Stores the values of a track and updates the crates it is in or out
+        of. A track that is not shown is in no crate. The columns grow to
+        any index, the tracks in between are not shown */
+    void setTrack(int index, bool shown, const Values& values);
+    /** Makes room for a number of tracks */
+    void reserve(int numTracks);
+    /** Returns the number of tracks in the columns */
+    int getNumTracks() const;
+
+    /** Adds a crate and finds its tracks */
+    void addCrate(const SmartCrate& crate);
+    /** Replaces a crate and finds its tracks again */
+    void replaceCrate(int crate, const SmartCrate& newCrate);
+    /** Removes a crate */
+    void removeCrate(int crate);
+    /** Returns the number of crates */
+    int getNumCrates() const;
+    /** Returns a crate */
+    const SmartCrate& getCrate(int crate) const;
+
+    /** Returns true if a track is in a crate */
+    bool contains(int crate, int index) const;
+    /** Returns the number of tracks in a crate */
+    int getNumMatches(int crate) const;
+
+    /** Finds the tracks of every crate again from the columns */
+    void evaluateAll();
+
+private:
+    /** A crate and the tracks in it */
+    struct CrateState
+    {
+        SmartCrate crate;
+        std::vector<juce::uint8> matches;
+        int numMatches = 0;
+    };
+
+    /** Finds the tracks of a crate from the columns */
+    void evaluate(CrateState& state);
+    /** Returns true if a track matches every clause of a crate */
+    bool matchesTrack(const CrateState& state, size_t index) const;
+
+    // a column per field and whether the track is shown
+    std::array<std::vector<float>, SmartCrate::numFields> columns;
+    std::vector<juce::uint8> shown;
+
+    // the crates in the order they were added
+    std::vector<CrateState> crates;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrateIndex)
+};
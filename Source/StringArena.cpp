@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    StringArena.cpp
+    Created: 19 Oct 2026 11:27:40pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "StringArena.h"
+
+#include <cstring>
+
+StringArena::StringArena(size_t _blockSize)
+: blockSize(juce::jmax((size_t) 256, _blockSize)) {}
+
+StringArena::~StringArena() {}
+
+//==============================================================================
+// copy a string to the end of the current block
+std::string_view StringArena::add(std::string_view text)
+{
+    if (text.empty())
+        return {};
+
+    if (blocks.empty() || blocks.back().size - blocks.back().used < text.size())
+        addBlock(text.size());
+
+    auto& block = blocks.back();
+    auto* copy = block.data.get() + block.used;
+    std::memcpy(copy, text.data(), text.size());
+
+    block.used += text.size();
+    bytesUsed += text.size();
+    return {copy, text.size()};
+}
+
+// copy the UTF-8 of a juce::String
+std::string_view StringArena::add(const juce::String& text)
+{
+    return add(view(text));
+}
+
+// make room for a batch of strings in one block
+void StringArena::reserve(size_t bytes)
+{
+    if (blocks.empty() || blocks.back().size - blocks.back().used < bytes)
+        addBlock(bytes);
+}
+
+// forget every string
+void StringArena::clear()
+{
+    blocks.clear();
+    bytesUsed = 0;
+}
+
+//==============================================================================
+// the bytes of the strings
+size_t StringArena::getBytesUsed() const
+{
+    return bytesUsed;
+}
+
+// the number of blocks allocated
+size_t StringArena::getNumBlocks() const
+{
+    return blocks.size();
+}
+
+// a view of the UTF-8 a juce::String holds, which is its own storage
+std::string_view StringArena::view(const juce::String& text)
+{
+    return {text.toRawUTF8(), text.getNumBytesAsUTF8()};
+}
+
+//==============================================================================
+// add a block, bigger than usual if a string needs it
+void StringArena::addBlock(size_t minimumSize)
+{
+    Block block;
+    block.size = juce::jmax(blockSize, minimumSize);
+    block.data.reset(new char[block.size]);
+    blocks.push_back(std::move(block));
+}
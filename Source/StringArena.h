@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    StringArena.h
+    Created: 19 Oct 2026 11:27:40pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+//==============================================================================
+/*
+ Keeps a large number of strings that are added once and never changed, such
+ as the titles and urls of the library, in a few big blocks of memory.
+
+ A string is copied to the end of the current block and handed back as a
+ view, so adding one costs no allocation unless the block is full. Views stay
+ valid until the arena is cleared or destroyed, blocks are never moved.
+*/
+class StringArena
+{
+public:
+    /** Creates an arena that allocates blocks of at least blockSize bytes */
+    explicit StringArena(size_t blockSize = 64 * 1024);
+    ~StringArena();
+
+    /** Copies a string into the arena and returns a view of the copy */
+    std::string_view add(std::string_view text);
+    /** Copies the UTF-8 of a juce::String into the arena */
+    std::string_view add(const juce::String& text);
+
+    /** Makes sure the next bytes added fit in one block, so adding a batch
+        of strings allocates at most once */
+    void reserve(size_t bytes);
+    /** Forgets every string, views handed out before must not be used again */
+    void clear();
+
+    /** Returns the number of bytes of the strings in the arena */
+    size_t getBytesUsed() const;
+    /** Returns the number of blocks allocated */
+    size_t getNumBlocks() const;
+
+    /** Returns a view of the UTF-8 of a juce::String, without copying it */
+    static std::string_view view(const juce::String& text);
+
+private:
+    /** Adds a block with room for at least a number of bytes */
+    void addBlock(size_t minimumSize);
+
+    /** A block of memory and how much of it is taken */
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    // the blocks, the strings are added to the last one
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t bytesUsed = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StringArena)
+};
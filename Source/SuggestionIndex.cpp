@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    SuggestionIndex.cpp
+    Created: 19 Oct 2026 9:31:08pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "SuggestionIndex.h"
+
+#include <algorithm>
+
+SuggestionIndex::SuggestionIndex()
+: buckets((size_t) (24 * (maxBpm - minBpm + 1))) {}
+
+SuggestionIndex::~SuggestionIndex() {}
+
+//==============================================================================
+// remove every track, the buckets keep their memory
+void SuggestionIndex::clear()
+{
+    for (auto& bucket : buckets)
+        bucket.clear();
+
+    numEntries = 0;
+}
+
+// add a track to the bucket of its key and tempo
+void SuggestionIndex::add(int id, int camelotNumber, bool minor, float bpm)
+{
+    // a track without a key or a tempo cannot be matched
+    if (camelotNumber < 1 || camelotNumber > 12 || bpm <= 0.0f)
+        return;
+
+    buckets[getBucket(camelotNumber, minor, juce::roundToInt(bpm))].push_back({id, bpm});
+    ++numEntries;
+}
+
+// the number of tracks in the index
+int SuggestionIndex::size() const
+{
+    return numEntries;
+}
+
+// the tracks that mix well after a key and tempo, best first
+std::vector<int> SuggestionIndex::findCompatible(int camelotNumber, bool minor, float bpm, int maxResults) const
+{
+    std::vector<int> ids;
+
+    if (camelotNumber < 1 || camelotNumber > 12 || bpm <= 0.0f || maxResults <= 0)
+        return ids;
+
+    // the key itself comes first, then its neighbours on the wheel and the
+    // other letter of its number
+    struct Key { int number; bool minor; float rank; };
+    const Key keys[] = {
+        {camelotNumber, minor, 0.0f},
+        {camelotNumber % 12 + 1, minor, 2.0f},
+        {(camelotNumber + 10) % 12 + 1, minor, 2.0f},
+        {camelotNumber, ! minor, 2.0f}
+    };
+
+    // a track at half or double the tempo mixes as well, but comes after
+    // the ones at the same tempo
+    struct Tempo { float bpm; float rank; };
+    const Tempo tempos[] = {{bpm, 0.0f}, {bpm * 2.0f, 1.0f}, {bpm * 0.5f, 1.0f}};
+
+    // the score of every match, lower is better
+    std::vector<std::pair<float, int>> matches;
+
+    for (auto& key : keys) {
+        for (auto& tempo : tempos) {
+            auto lowest = juce::jmax(minBpm, (int) std::floor(tempo.bpm * (1.0f - bpmTolerance)));
+            auto highest = juce::jmin(maxBpm, (int) std::ceil(tempo.bpm * (1.0f + bpmTolerance)));
+
+            for (auto wholeBpm = lowest; wholeBpm <= highest; ++wholeBpm) {
+                for (auto& entry : buckets[getBucket(key.number, key.minor, wholeBpm)]) {
+                    auto difference = std::abs(entry.bpm - tempo.bpm) / tempo.bpm;
+
+                    if (difference <= bpmTolerance)
+                        matches.push_back({key.rank + tempo.rank + difference / bpmTolerance, entry.id});
+                }
+            }
+        }
+    }
+
+    // only the best ones are sorted
+    auto numResults = juce::jmin((size_t) maxResults, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + (long) numResults, matches.end());
+
+    ids.reserve(numResults);
+    for (size_t i = 0; i < numResults; ++i)
+        ids.push_back(matches[i].second);
+
+    return ids;
+}
+
+// check if two keys are in harmony on the wheel
+bool SuggestionIndex::areCompatible(int camelotNumber1, bool minor1, int camelotNumber2, bool minor2)
+{
+    if (camelotNumber1 < 1 || camelotNumber2 < 1)
+        return false;
+
+    // the other letter of the same number
+    if (minor1 != minor2)
+        return camelotNumber1 == camelotNumber2;
+
+    // the same number or one step either way round the wheel
+    auto steps = std::abs(camelotNumber1 - camelotNumber2);
+    return steps <= 1 || steps == 11;
+}
+
+//==============================================================================
+// the bucket of a key and a tempo, tempos outside the range share the first or last
+size_t SuggestionIndex::getBucket(int camelotNumber, bool minor, int wholeBpm)
+{
+    auto key = (camelotNumber - 1) * 2 + (minor ? 0 : 1);
+    auto tempo = juce::jlimit(minBpm, maxBpm, wholeBpm) - minBpm;
+
+    return (size_t) (key * (maxBpm - minBpm + 1) + tempo);
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    SuggestionIndex.h
+    Created: 19 Oct 2026 9:31:08pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+//==============================================================================
+/*
+ Finds the tracks that mix well after a track, from their keys and tempos,
+ without looking at the whole library.
+
+ The tracks are sorted into buckets by key and by whole beats per minute when
+ they are added. A query only opens the buckets of the four keys that are in
+ harmony with the key asked for (the same key, one step either way on the
+ Camelot wheel, and the other letter of the same number) and of the tempos
+ within reach of the pitch fader, at the tempo asked for and at half and
+ double of it. With 24 keys and a few hundred tempos, a query over a library
+ of 100k tracks only looks at a few thousand of them.
+
+ The tracks are known by an id the caller gives them.
+*/
+class SuggestionIndex
+{
+public:
+    SuggestionIndex();
+    ~SuggestionIndex();
+
+    /** The most the tempo of a suggested track may differ, as a fraction */
+    static constexpr float bpmTolerance = 0.06f;
+    /** The tempos the buckets cover, tracks outside are put in the first or last */
+    static constexpr int minBpm = 40;
+    static constexpr int maxBpm = 240;
+
+    /** Removes every track */
+    void clear();
+    /** Adds a track with a known key and tempo */
+    void add(int id, int camelotNumber, bool minor, float bpm);
+    /** Returns the number of tracks in the index */
+    int size() const;
+
+    /** Returns the ids of the tracks that mix well after a key and tempo,
+        best first: the same key before the neighbouring ones, and the
+        closest tempo first within each. At most maxResults are returned */
+    std::vector<int> findCompatible(int camelotNumber, bool minor, float bpm, int maxResults) const;
+
+    /** Returns true if two keys are in harmony on the Camelot wheel */
+    static bool areCompatible(int camelotNumber1, bool minor1, int camelotNumber2, bool minor2);
+
+private:
+    /** A track in a bucket */
+    struct Entry
+    {
+        int id;
+        float bpm;
+    };
+
+    /** Returns the bucket of a key and a tempo */
+    static size_t getBucket(int camelotNumber, bool minor, int wholeBpm);
+
+    // one bucket per key and whole tempo
+    std::vector<std::vector<Entry>> buckets;
+    int numEntries = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SuggestionIndex)
+};
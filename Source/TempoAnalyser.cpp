@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+    TempoAnalyser.cpp
+    Created: 19 Oct 2026 8:21:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "TempoAnalyser.h"
+
+#include <algorithm>
+#include <numeric>
+
+//==============================================================================
+// the time of a beat of the grid
+double TempoAnalyser::Result::getBeatTime(double beat) const
+{
+    return firstBeatSeconds + beat * 60.0 / bpm;
+}
+
+// the beat of the grid at a time
+double TempoAnalyser::Result::getBeatAt(double seconds) const
+{
+    return (seconds - firstBeatSeconds) * bpm / 60.0;
+}
+
+//==============================================================================
+// work out the tempo, the grid, the intro and the outro of a whole track
+bool TempoAnalyser::analyse(juce::AudioFormatReader& reader,
+                            const std::function<bool()>& shouldStop,
+                            Result& result)
+{
+    const auto sampleRate = reader.sampleRate > 0.0 ? reader.sampleRate : 44100.0;
+    const auto numChannels = (int) juce::jlimit(1u, 2u, reader.numChannels);
+    const auto length = reader.lengthInSamples;
+
+    // the envelope has 100 frames per second, read in chunks of whole frames
+    const int hop = juce::jmax(1, juce::roundToInt(sampleRate / 100.0));
+    const double frameRate = sampleRate / hop;
+    const int chunkSize = hop * 64;
+
+    juce::AudioBuffer<float> buffer {numChannels, chunkSize};
+
+    // the kick is found below 150 Hz
+    juce::dsp::IIR::Filter<float> lowPass;
+    lowPass.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, 150.0f);
+
+    // the mean square of every frame, of the whole signal and of the lows
+    std::vector<float> energy, lowEnergy;
+    energy.reserve((size_t) (length / hop + 1));
+    lowEnergy.reserve(energy.capacity());
+
+    for (juce::int64 start = 0; start < length; start += chunkSize) {
+        if (shouldStop())
+            return false;
+
+        auto numSamples = (int) juce::jmin((juce::int64) chunkSize, length - start);
+        reader.read(&buffer, 0, numSamples, start, true, true);
+
+        // both sides are analysed as one
+        if (numChannels > 1) {
+            buffer.addFrom(0, 0, buffer, 1, 0, numSamples);
+            buffer.applyGain(0, 0, numSamples, 0.5f);
+        }
+
+        auto* mono = buffer.getReadPointer(0);
+
+        for (int offset = 0; offset + hop <= numSamples; offset += hop) {
+            double full = 0.0, low = 0.0;
+
+            for (int i = 0; i < hop; ++i) {
+                auto sample = mono[offset + i];
+                auto filtered = lowPass.processSample(sample);
+                full += sample * sample;
+                low += filtered * filtered;
+            }
+
+            energy.push_back((float) (full / hop));
+            lowEnergy.push_back((float) (low / hop));
+        }
+    }
+
+    result = {};
+    result.lengthSeconds = length / sampleRate;
+    result.outroStartSeconds = result.lengthSeconds;
+
+    // a few seconds are too short to find a tempo in
+    auto numFrames = energy.size();
+    if (numFrames < (size_t) (frameRate * 4.0))
+        return true;
+
+    // the rise of the compressed energy, the lows count double
+    std::vector<float> onsets (numFrames, 0.0f);
+    auto compress = [] (float meanSquare) { return std::log1p(1000.0f * meanSquare); };
+
+    for (size_t i = 1; i < numFrames; ++i) {
+        onsets[i] = juce::jmax(0.0f, compress(lowEnergy[i]) - compress(lowEnergy[i - 1]))
+                  + 0.5f * juce::jmax(0.0f, compress(energy[i]) - compress(energy[i - 1]));
+    }
+
+    auto period = findPeriod(onsets, frameRate);
+    auto phase = findPhase(onsets, period);
+    result.bpm = 60.0 * frameRate / period;
+
+    // the grid starts at the first beat that is not silent, -50 dBFS
+    auto totalFrames = (double) numFrames;
+    auto beatFrame = phase;
+    while (beatFrame < totalFrames && energy[(size_t) beatFrame] < 1.0e-5f)
+        beatFrame += period;
+
+    if (beatFrame >= totalFrames)
+        return true;
+
+    result.firstBeatSeconds = beatFrame / frameRate;
+
+    // the mean square of every bar of four beats
+    std::vector<float> bars;
+    for (auto bar = beatFrame; bar + 4.0 * period <= totalFrames; bar += 4.0 * period) {
+        auto first = (size_t) bar;
+        auto last = (size_t) (bar + 4.0 * period);
+        float sum = 0.0f;
+
+        for (auto i = first; i < last; ++i)
+            sum += energy[i];
+
+        bars.push_back(sum / (float) (last - first));
+    }
+
+    if (bars.empty())
+        return true;
+
+    // a bar is part of the body of the track within 3 dB of the median bar
+    auto sorted = bars;
+    std::nth_element(sorted.begin(), sorted.begin() + (long) sorted.size() / 2, sorted.end());
+    auto threshold = 0.5f * sorted[sorted.size() / 2];
+
+    int firstLoud = 0, lastLoud = (int) bars.size() - 1;
+    while (firstLoud < lastLoud && bars[(size_t) firstLoud] < threshold)
+        ++firstLoud;
+    while (lastLoud > firstLoud && bars[(size_t) lastLoud] < threshold)
+        --lastLoud;
+
+    // the intro is the whole phrases before the body, or four bars to mix
+    // in over if the track starts at full energy
+    auto introBars = firstLoud / 8 * 8;
+    if (introBars == 0)
+        introBars = 4;
+
+    result.introEndSeconds = juce::jmin(result.getBeatTime(introBars * 4.0), result.lengthSeconds);
+
+    // the outro starts on the first phrase after the body, and leaves at
+    // least four bars to mix out over
+    auto outroBars = (lastLoud + 8) / 8 * 8;
+    result.outroStartSeconds = result.getBeatTime(outroBars * 4.0);
+
+    auto latestBar = std::floor(result.getBeatAt(result.lengthSeconds) / 4.0) - 4.0;
+    if (result.outroStartSeconds > result.getBeatTime(latestBar * 4.0))
+        result.outroStartSeconds = result.getBeatTime(juce::jmax(0.0, latestBar) * 4.0);
+
+    result.outroStartSeconds = juce::jlimit(result.introEndSeconds, result.lengthSeconds, result.outroStartSeconds);
+    return true;
+}
+
+// find the beat period in frames of an onset envelope
+double TempoAnalyser::findPeriod(const std::vector<float>& onsets, double frameRate)
+{
+    const double defaultPeriod = frameRate * 60.0 / 120.0;
+    const int harmonics = 4;
+
+    // the envelope without its mean, so the autocorrelation has clear peaks
+    auto mean = std::accumulate(onsets.begin(), onsets.end(), 0.0f) / (float) onsets.size();
+    std::vector<float> centred (onsets.size());
+    for (size_t i = 0; i < onsets.size(); ++i)
+        centred[i] = onsets[i] - mean;
+
+    auto numFrames = (int) centred.size();
+    auto minLag = (int) std::floor(frameRate * 60.0 / maxBpm);
+    auto maxLag = (int) std::ceil(frameRate * 60.0 / minBpm);
+    auto longestLag = juce::jmin(numFrames / 2, maxLag * harmonics + 2);
+
+    if (longestLag <= maxLag)
+        return defaultPeriod;
+
+    // the lags below the fastest tempo are never looked at
+    std::vector<float> correlation ((size_t) longestLag + 1, 0.0f);
+    for (int lag = juce::jmax(1, minLag - 1); lag <= longestLag; ++lag) {
+        double sum = 0.0;
+        for (int i = 0; i + lag < numFrames; ++i)
+            sum += centred[(size_t) i] * centred[(size_t) (i + lag)];
+
+        correlation[(size_t) lag] = (float) (sum / (numFrames - lag));
+    }
+
+    // the strongest whole lag, tempos far from 120 bpm are less likely
+    int bestLag = -1;
+    float bestScore = 0.0f;
+
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        auto octaves = std::log2(frameRate * 60.0 / lag / 120.0);
+        auto score = correlation[(size_t) lag] * (float) std::exp(-0.5 * octaves * octaves);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    if (bestLag < 0)
+        return defaultPeriod;
+
+    // the multiples of the period pin it down to a fraction of a frame
+    double bestPeriod = bestLag;
+    bestScore = -1.0e30f;
+
+    for (double period = bestLag - 1.0; period <= bestLag + 1.0; period += 0.01) {
+        float score = 0.0f;
+        for (int k = 1; k <= harmonics; ++k)
+            score += interpolate(correlation, k * period);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestPeriod = period;
+        }
+    }
+
+    return bestPeriod;
+}
+
+// find the offset of the grid that lands on the most onsets
+double TempoAnalyser::findPhase(const std::vector<float>& onsets, double period)
+{
+    double bestPhase = 0.0;
+    float bestScore = -1.0f;
+
+    for (double phase = 0.0; phase < period; phase += 0.25) {
+        float score = 0.0f;
+        for (auto frame = phase; frame < (double) onsets.size(); frame += period)
+            score += interpolate(onsets, frame);
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestPhase = phase;
+        }
+    }
+
+    return bestPhase;
+}
+
+// an envelope at a fractional frame
+float TempoAnalyser::interpolate(const std::vector<float>& envelope, double frame)
+{
+    auto index = (size_t) frame;
+
+    if (frame < 0.0 || index + 1 >= envelope.size())
+        return 0.0f;
+
+    auto fraction = (float) (frame - index);
+    return envelope[index] + fraction * (envelope[index + 1] - envelope[index]);
+}
+
+//==============================================================================
+TempoJob::TempoJob(juce::AudioFormatManager& _formatManager, const juce::URL& _url)
+: juce::ThreadPoolJob("Tempo analysis"),
+  formatManager(_formatManager),
+  url(_url) {}
+
+TempoJob::~TempoJob() {}
+
+// work out the tempo of the track
+juce::ThreadPoolJob::JobStatus TempoJob::runJob()
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (reader == nullptr)
+        std::cout << "TempoJob::runJob  could not open " << url.toString(false) << std::endl;
+    else
+        successful = TempoAnalyser::analyse(*reader, [this] { return shouldExit(); }, result);
+
+    finished = true;
+    return jobHasFinished;
+}
+
+// the track being analysed
+const juce::URL& TempoJob::getURL() const
+{
+    return url;
+}
+
+// check if the job is done
+bool TempoJob::isFinished() const
+{
+    return finished;
+}
+
+// check if the track could be analysed
+bool TempoJob::wasSuccessful() const
+{
+    return successful;
+}
+
+// the tempo of the track
+const TempoAnalyser::Result& TempoJob::getResult() const
+{
+    return result;
+}
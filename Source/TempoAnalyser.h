@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    TempoAnalyser.h
+    Created: 19 Oct 2026 8:21:37pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Works out the tempo, the beatgrid and the intro and outro of a whole track,
+ everything the automix needs to plan a transition.
+
+ The track is turned into an onset envelope of 100 frames per second, mostly
+ from the energy below 150 Hz where the kick is. The tempo is the lag with the
+ strongest autocorrelation of that envelope, refined over its multiples to a
+ fraction of a frame, and the grid is the phase that lands on the most
+ onsets. The intro and outro are the whole 8 bar phrases at the start and the
+ end that are clearly quieter than the body of the track.
+*/
+class TempoAnalyser
+{
+public:
+    /** The tempo and structure of a track, all times in seconds of the track */
+    struct Result
+    {
+        /** The tempo in beats per minute */
+        double bpm = 120.0;
+        /** The first beat of the grid once the track is no longer silent */
+        double firstBeatSeconds = 0.0;
+        /** Where the intro ends, on a beat */
+        double introEndSeconds = 0.0;
+        /** Where the outro starts, on a beat */
+        double outroStartSeconds = 0.0;
+        /** The length of the track */
+        double lengthSeconds = 0.0;
+
+        /** Returns the time of a beat of the grid, counted from the first beat */
+        double getBeatTime(double beat) const;
+        /** Returns the beat of the grid at a time, with a fraction */
+        double getBeatAt(double seconds) const;
+    };
+
+    /** The slowest and fastest tempo that is reported, a track outside the
+        range is reported at half or double its tempo */
+    static constexpr double minBpm = 70.0;
+    static constexpr double maxBpm = 180.0;
+
+    /** Analyses a whole track. shouldStop is asked between chunks and stops
+        the analysis if it returns true. Returns false if it was stopped */
+    static bool analyse(juce::AudioFormatReader& reader,
+                        const std::function<bool()>& shouldStop,
+                        Result& result);
+
+private:
+    /** Finds the beat period in frames of an onset envelope */
+    static double findPeriod(const std::vector<float>& onsets, double frameRate);
+    /** Finds the offset in frames of the grid that lands on the most onsets */
+    static double findPhase(const std::vector<float>& onsets, double period);
+    /** Returns an envelope at a fractional frame, 0 outside it */
+    static float interpolate(const std::vector<float>& envelope, double frame);
+};
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that works out the tempo of one track
+*/
+class TempoJob : public juce::ThreadPoolJob
+{
+public:
+    TempoJob(juce::AudioFormatManager& formatManager, const juce::URL& url);
+    ~TempoJob() override;
+
+    /** Works out the tempo of the track */
+    JobStatus runJob() override;
+
+    /** Returns the track being analysed */
+    const juce::URL& getURL() const;
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the track could be analysed */
+    bool wasSuccessful() const;
+    /** Returns the tempo, only use this once isFinished returns true */
+    const TempoAnalyser::Result& getResult() const;
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to analyse
+    juce::URL url;
+
+    // the result and whether it is ready
+    TempoAnalyser::Result result;
+    bool successful = false;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoJob)
+};
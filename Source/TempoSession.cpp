@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    TempoSession.cpp
+    Created: 19 Oct 2026 10:14:39pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "TempoSession.h"
+#include "MasterClock.h"
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // every packet starts with this, anything else on the port is ignored
+    const char packetMagic[] = "OTOTEMPO";
+    const int packetSize = 8 + 2 * 8 + 2 * 8;
+}
+
+TempoSession::TempoSession(MasterClock& _clock)
+: juce::Thread("Tempo session"),
+  clock(_clock),
+  peerId(juce::Random::getSystemRandom().nextInt64() & std::numeric_limits<juce::int64>::max()) {}
+
+TempoSession::~TempoSession()
+{
+    stopThread(2000);
+}
+
+//==============================================================================
+// take a tempo set on this copy
+void TempoSession::announceTempo(double bpm)
+{
+    tempo = bpm;
+    ++tempoVersion;
+    tempoChanged = true;
+}
+
+// the number of other copies
+int TempoSession::getNumPeers() const
+{
+    return numPeers;
+}
+
+// send and receive the state of the session
+void TempoSession::run()
+{
+    juce::DatagramSocket socket {true};
+    socket.setEnablePortReuse(true);
+
+    if (! socket.bindToPort(port)) {
+        std::cout << "TempoSession::run  could not listen on port " << port << std::endl;
+        return;
+    }
+
+    char buffer[256];
+    auto nextSend = 0.0;
+
+    while (! threadShouldExit()) {
+        auto now = juce::Time::getMillisecondCounterHiRes();
+
+        if (tempoChanged.exchange(false) || now >= nextSend) {
+            send(socket);
+            nextSend = now + 100.0;
+        }
+
+        updateLeader(now);
+
+        if (socket.waitUntilReady(true, 20) != 1)
+            continue;
+
+        auto numBytes = socket.read(buffer, (int) sizeof(buffer), false);
+        auto arrived = juce::Time::getMillisecondCounterHiRes();
+
+        if (numBytes != packetSize || std::memcmp(buffer, packetMagic, 8) != 0)
+            continue;
+
+        juce::MemoryInputStream stream {buffer + 8, (size_t) numBytes - 8, false};
+        Packet packet;
+        packet.peerId = stream.readInt64();
+        packet.tempoVersion = stream.readInt64();
+        packet.bpm = stream.readDouble();
+        packet.beat = stream.readDouble();
+
+        // the broadcast comes back to this copy as well
+        if (packet.peerId != peerId)
+            receive(packet, arrived);
+    }
+}
+
+//==============================================================================
+// broadcast the state of this copy
+void TempoSession::send(juce::DatagramSocket& socket)
+{
+    juce::MemoryOutputStream stream;
+    stream.write(packetMagic, 8);
+    stream.writeInt64(peerId);
+    stream.writeInt64(tempoVersion);
+    stream.writeDouble(tempo);
+    stream.writeDouble(clock.getBeatAtTime(juce::Time::getMillisecondCounterHiRes()));
+
+    socket.write("255.255.255.255", port, stream.getData(), (int) stream.getDataSize());
+}
+
+// take in a packet from another copy
+void TempoSession::receive(const Packet& packet, double millis)
+{
+    peers[packet.peerId] = {packet, millis};
+
+    // the newest tempo wins, the lower id if two were changed at once
+    auto version = tempoVersion.load();
+    if (packet.tempoVersion > version || (packet.tempoVersion == version && packet.peerId < peerId
+                                          && packet.bpm != tempo)) {
+        tempoVersion = packet.tempoVersion;
+        tempo = packet.bpm;
+        clock.setSessionTempo(packet.bpm);
+    }
+}
+
+// tell the clock which copy leads the beat
+void TempoSession::updateLeader(double millis)
+{
+    // the copies that have gone quiet have left
+    for (auto it = peers.begin(); it != peers.end();) {
+        if (millis - it->second.second > peerTimeoutMillis)
+            it = peers.erase(it);
+        else
+            ++it;
+    }
+
+    numPeers = (int) peers.size();
+
+    // the map is sorted by id, so the first copy leads unless this one is lower
+    if (peers.empty() || peers.begin()->first > peerId) {
+        clock.setSessionPhase(0.0, 0.0, millis);
+        return;
+    }
+
+    auto& leader = peers.begin()->second;
+    clock.setSessionPhase(leader.first.bpm, leader.first.beat, leader.second);
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    TempoSession.h
+    Created: 19 Oct 2026 10:14:39pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <map>
+
+class MasterClock;
+
+//==============================================================================
+/*
+ Shares the tempo and the beat of a MasterClock with the other copies of the
+ program on the local network, in the spirit of Ableton Link but with a
+ protocol of its own.
+
+ Every copy broadcasts its tempo and its beat ten times a second over UDP.
+ A tempo change carries a version one higher than any seen before, and the
+ highest version wins, so the last copy to change the tempo sets it for all
+ of them. The copy with the lowest id leads the beat, and the others pull
+ their bars of four in line with it, taking the time a packet arrives as the
+ time it was sent, which is close enough on a local network.
+*/
+class TempoSession : public juce::Thread
+{
+public:
+    TempoSession(MasterClock& _clock);
+    ~TempoSession() override;
+
+    /** The port every copy listens and broadcasts on */
+    static constexpr int port = 20809;
+    /** A copy that has not been heard from for this long has left */
+    static constexpr double peerTimeoutMillis = 2000.0;
+
+    /** Takes a tempo set on this copy and sends it to the others */
+    void announceTempo(double bpm);
+    /** Returns the number of other copies in the session */
+    int getNumPeers() const;
+
+    /** Sends and receives the state of the session */
+    void run() override;
+
+private:
+    /** The state a copy broadcasts */
+    struct Packet
+    {
+        juce::int64 peerId = 0;
+        juce::int64 tempoVersion = 0;
+        double bpm = 0.0;
+        double beat = 0.0;
+    };
+
+    /** Broadcasts the state of this copy */
+    void send(juce::DatagramSocket& socket);
+    /** Takes in a packet from another copy */
+    void receive(const Packet& packet, double millis);
+    /** Tells the clock which copy leads the beat */
+    void updateLeader(double millis);
+
+    // the clock the session is shared with
+    MasterClock& clock;
+
+    // a random id for this copy, and the tempo and its version
+    const juce::int64 peerId;
+    std::atomic<double> tempo {120.0};
+    std::atomic<juce::int64> tempoVersion {0};
+    // set when the tempo changes here, so it goes out straight away
+    std::atomic<bool> tempoChanged {false};
+
+    // the last packet from every other copy and when it arrived, only
+    // touched by the session thread
+    std::map<juce::int64, std::pair<Packet, double>> peers;
+    std::atomic<int> numPeers {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoSession)
+};
@@ -0,0 +1,1127 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.cpp
+    Created: 19 Oct 2026 11:20:05am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "TrackLibrary.h"
+
+#include <algorithm>
+
+//==============================================================================
+TrackLibrary::TrackLibrary(const juce::File& _dataFile)
+: dataFile(_dataFile)
+{
+    // check if the data file exits or not
+    if (!dataFile.existsAsFile()) { // data file does not exists
+        // create a new file
+        auto result = dataFile.create();
+        // check if file was succesfully created
+        if (result.failed()) {
+            // print error - if any
+            std::cout << result.getErrorMessage() << std::endl;
+        }
+    }
+
+    // read data from the data file in one go, the lines are views into it
+    juce::MemoryBlock data;
+    dataFile.loadFileAsData(data);
+    std::string_view contents {static_cast<const char*>(data.getData()), data.getSize()};
+
+    // make room for every track at once, a title is never longer than its url
+    tracks.reserve((size_t) std::count(contents.begin(), contents.end(), '\n') + 1);
+    strings.reserve(contents.size() * 2);
+    crates.reserve((int) tracks.capacity());
+
+    // iterate over the lines of the data file
+    for (size_t start = 0; start < contents.size();) {
+        auto end = juce::jmin(contents.find('\n', start), contents.size());
+        auto line = contents.substr(start, end - start);
+        start = end + 1;
+
+        if (! line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        // check if line is empty
+        if (! line.empty()) { // line is not empty
+            // add the track without writing it back to the file
+            appendTrack(line, true);
+        }
+    }
+
+    sortTracks(0);
+    updateVisibleTracks();
+    loadAnalysis();
+    loadCrates();
+}
+
+TrackLibrary::~TrackLibrary() {}
+
+// the data file lives in the documents folder of the user
+juce::File TrackLibrary::getDefaultDataFile()
+{
+    // directory in which the data is going to be stored
+    juce::File dataDirectory {
+        juce::File::getSpecialLocation(
+           juce::File::SpecialLocationType::userDocumentsDirectory
+        )
+    };
+
+    return juce::File{dataDirectory.getFullPathName() + "/data.txt"};
+}
+
+//==============================================================================
+// add a track to the library
+void TrackLibrary::addTrack(const juce::URL& trackURL, bool saveToDataFile)
+{
+    auto url = trackURL.toString(false);
+    auto firstNewTrack = (int) tracks.size();
+
+    appendTrack(StringArena::view(url), true);
+    sortTracks(firstNewTrack);
+
+    // add the track to the data file
+    if (saveToDataFile) {
+        dataFile.appendText(url + "\r\n");
+    }
+
+    updateVisibleTracks();
+}
+
+// add a number of tracks, the orders and search results are only rebuilt once
+void TrackLibrary::addTracks(const juce::Array<juce::URL>& trackURLs)
+{
+    auto firstNewTrack = (int) tracks.size();
+
+    // the records, strings and lines of the batch are each allocated once
+    size_t numBytes = 0;
+    for (auto& trackURL : trackURLs)
+        numBytes += trackURL.toString(false).getNumBytesAsUTF8();
+
+    tracks.reserve(tracks.size() + (size_t) trackURLs.size());
+    strings.reserve(numBytes * 2);
+    crates.reserve((int) tracks.capacity());
+
+    juce::String newLines;
+    newLines.preallocateBytes(numBytes + (size_t) trackURLs.size() * 2);
+
+    for (auto& trackURL : trackURLs) {
+        auto url = trackURL.toString(false);
+        appendTrack(StringArena::view(url), true);
+        newLines << url << "\r\n";
+    }
+
+    sortTracks(firstNewTrack);
+
+    // add all the tracks to the data file in one write
+    if (newLines.isNotEmpty()) {
+        dataFile.appendText(newLines);
+    }
+
+    updateVisibleTracks();
+}
+
+// the number of tracks matching the search text
+int TrackLibrary::getNumTracks() const
+{
+    return static_cast<int>(visibleTracks.size());
+}
+
+// the title of a track matching the search text
+std::string_view TrackLibrary::getTrackTitle(int row) const
+{
+    // rows outside the list have no title
+    auto* track = getVisibleTrack(row);
+    return track != nullptr ? track->title : std::string_view{};
+}
+
+// the url of a track matching the search text
+juce::URL TrackLibrary::getTrackURL(int row) const
+{
+    // rows outside the list have no url
+    auto* track = getVisibleTrack(row);
+    if (track == nullptr)
+        return {};
+
+    return juce::URL{juce::String::fromUTF8(track->url.data(), (int) track->url.size())};
+}
+
+// filter the tracks by a text
+void TrackLibrary::setSearchText(const juce::String& text)
+{
+    searchText = text;
+    updateVisibleTracks();
+}
+
+// the text the tracks are filtered by
+const juce::String& TrackLibrary::getSearchText() const
+{
+    return searchText;
+}
+
+// the number of tracks ignoring the search text
+int TrackLibrary::getTotalNumTracks() const
+{
+    return static_cast<int>(titleOrder.size());
+}
+
+// the tracks for a search index
+std::vector<SearchIndex::Entry> TrackLibrary::getSearchEntries() const
+{
+    // the folder a path is in, empty if it is not in one, and the last name of a path
+    auto getFolder = [] (std::string_view path)
+    {
+        auto slash = path.find_last_of('/');
+        return slash == std::string_view::npos ? std::string_view{} : path.substr(0, slash);
+    };
+    auto getName = [] (std::string_view path) { return path.substr(path.find_last_of('/') + 1); };
+
+    std::vector<SearchIndex::Entry> entries;
+    entries.reserve(titleOrder.size());
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+
+        // the album is the folder of the file, the artist the one above it
+        auto albumPath = getFolder(track.url);
+
+        SearchIndex::Entry entry;
+        entry.id = index;
+        entry.title = track.title;
+        entry.album = getName(albumPath);
+        entry.artist = getName(getFolder(albumPath));
+
+        if (track.hasHarmony) {
+            entry.camelotNumber = track.harmony.camelotNumber;
+            entry.minor = track.harmony.minor;
+            entry.bpm = track.harmony.bpm;
+        }
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+// how often tracks were added
+int TrackLibrary::getRevision() const
+{
+    return revision;
+}
+
+// show the tracks of a ranked search
+void TrackLibrary::setSearchResults(const std::vector<int>& trackIds)
+{
+    // the flags of the last results are cleared, not the whole vector
+    for (auto id : searchResults)
+        inSearchResults[(size_t) id] = 0;
+
+    inSearchResults.resize(tracks.size(), 0);
+    searchResults = trackIds;
+
+    for (auto id : searchResults)
+        inSearchResults[(size_t) id] = 1;
+
+    showingSearchResults = true;
+    updateVisibleTracks();
+}
+
+// show all the tracks again
+void TrackLibrary::clearSearchResults()
+{
+    showingSearchResults = false;
+    updateVisibleTracks();
+}
+
+// check if the tracks of a ranked search are shown
+bool TrackLibrary::isShowingSearchResults() const
+{
+    return showingSearchResults;
+}
+
+//==============================================================================
+// store the loudness of a track
+void TrackLibrary::setTrackLoudness(const juce::URL& trackURL, const Loudness& trackLoudness)
+{
+    auto url = trackURL.toString(false);
+    auto index = findOrAddTrack(StringArena::view(url));
+    auto& track = tracks[(size_t) index];
+
+    track.loudness = trackLoudness;
+    track.hasLoudness = true;
+    sortedTracksOutOfDate = true;
+    updateCrateValues(index);
+}
+
+// the loudness of a track, if it has been measured
+bool TrackLibrary::getTrackLoudness(const juce::URL& trackURL, Loudness& trackLoudness) const
+{
+    auto url = trackURL.toString(false);
+    auto index = findTrack(StringArena::view(url));
+
+    if (index < 0 || ! tracks[(size_t) index].hasLoudness)
+        return false;
+
+    trackLoudness = tracks[(size_t) index].loudness;
+    return true;
+}
+
+// the loudness of a track matching the search text, if it has been measured
+bool TrackLibrary::getTrackLoudness(int row, Loudness& trackLoudness) const
+{
+    auto* track = getVisibleTrack(row);
+
+    if (track == nullptr || ! track->hasLoudness)
+        return false;
+
+    trackLoudness = track->loudness;
+    return true;
+}
+
+// the tracks whose loudness has not been measured yet
+juce::Array<juce::URL> TrackLibrary::getTracksWithoutLoudness() const
+{
+    juce::Array<juce::URL> result;
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+        if (! track.hasLoudness)
+            result.add(juce::URL{juce::String::fromUTF8(track.url.data(), (int) track.url.size())});
+    }
+
+    return result;
+}
+
+//==============================================================================
+// the key in Camelot notation
+juce::String TrackLibrary::Harmony::getCamelot() const
+{
+    if (camelotNumber < 1 || camelotNumber > 12)
+        return {};
+
+    return juce::String(camelotNumber) + (minor ? "A" : "B");
+}
+
+// read a key in Camelot notation such as 8A or 12b
+TrackLibrary::Harmony TrackLibrary::Harmony::fromCamelot(const juce::String& camelot, float bpm)
+{
+    Harmony harmony;
+    auto text = camelot.trim().toUpperCase();
+    auto letter = text.getLastCharacter();
+    auto number = text.dropLastCharacters(1).getIntValue();
+
+    if ((letter == 'A' || letter == 'B') && number >= 1 && number <= 12) {
+        harmony.camelotNumber = number;
+        harmony.minor = letter == 'A';
+        harmony.bpm = bpm;
+    }
+
+    return harmony;
+}
+
+// store the key and tempo of a track
+void TrackLibrary::setTrackHarmony(const juce::URL& trackURL, const Harmony& trackHarmony)
+{
+    auto url = trackURL.toString(false);
+    auto index = findOrAddTrack(StringArena::view(url));
+    auto& track = tracks[(size_t) index];
+
+    auto known = track.hasHarmony;
+    track.harmony = trackHarmony;
+    track.hasHarmony = true;
+    sortedTracksOutOfDate = true;
+    updateCrateValues(index);
+
+    // a track whose key changed has to be moved to another bucket, so the
+    // index is built again when it is next used
+    if (known || suggestionIndexOutOfDate) {
+        suggestionIndexOutOfDate = true;
+        return;
+    }
+
+    // a newly analysed track goes straight into its bucket
+    if (isShown(index)) {
+        suggestionIndex.add((int) indexedTracks.size(), trackHarmony.camelotNumber, trackHarmony.minor, trackHarmony.bpm);
+        indexedTracks.push_back(index);
+    }
+}
+
+// the key and tempo of a track, if it has been analysed
+bool TrackLibrary::getTrackHarmony(const juce::URL& trackURL, Harmony& trackHarmony) const
+{
+    auto url = trackURL.toString(false);
+    auto index = findTrack(StringArena::view(url));
+
+    if (index < 0 || ! tracks[(size_t) index].hasHarmony)
+        return false;
+
+    trackHarmony = tracks[(size_t) index].harmony;
+    return true;
+}
+
+// the key and tempo of a track matching the search text, if it has been analysed
+bool TrackLibrary::getTrackHarmony(int row, Harmony& trackHarmony) const
+{
+    auto* track = getVisibleTrack(row);
+
+    if (track == nullptr || ! track->hasHarmony)
+        return false;
+
+    trackHarmony = track->harmony;
+    return true;
+}
+
+// the tracks whose key has not been analysed yet
+juce::Array<juce::URL> TrackLibrary::getTracksWithoutHarmony() const
+{
+    juce::Array<juce::URL> result;
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+        if (! track.hasHarmony)
+            result.add(juce::URL{juce::String::fromUTF8(track.url.data(), (int) track.url.size())});
+    }
+
+    return result;
+}
+
+// the tracks that mix well after a key and tempo
+juce::Array<juce::URL> TrackLibrary::getCompatibleTracks(const Harmony& target, int maxResults)
+{
+    if (suggestionIndexOutOfDate)
+        rebuildSuggestionIndex();
+
+    juce::Array<juce::URL> result;
+
+    for (auto id : suggestionIndex.findCompatible(target.camelotNumber, target.minor, target.bpm, maxResults)) {
+        auto& track = tracks[(size_t) indexedTracks[(size_t) id]];
+        result.add(juce::URL{juce::String::fromUTF8(track.url.data(), (int) track.url.size())});
+    }
+
+    return result;
+}
+
+// filter the tracks by a key
+void TrackLibrary::setKeyFilter(const juce::String& camelot)
+{
+    keyFilterHarmony = Harmony::fromCamelot(camelot);
+    keyFilter = keyFilterHarmony.getCamelot();
+    updateVisibleTracks();
+}
+
+// the key the tracks are filtered by
+const juce::String& TrackLibrary::getKeyFilter() const
+{
+    return keyFilter;
+}
+
+// only show the tracks that mix well after a key and tempo
+void TrackLibrary::setSuggestionTarget(const Harmony& target)
+{
+    suggestionTarget = target;
+    updateVisibleTracks();
+}
+
+//==============================================================================
+// store the fingerprint of a track
+void TrackLibrary::setTrackFingerprint(const juce::URL& trackURL, const AudioFingerprint::Fingerprint& fingerprint)
+{
+    auto url = trackURL.toString(false);
+    auto index = findOrAddTrack(StringArena::view(url));
+    auto& track = tracks[(size_t) index];
+
+    // a track fingerprinted again keeps its place
+    if (track.fingerprint < 0) {
+        track.fingerprint = (int) fingerprints.size();
+        fingerprints.push_back(fingerprint);
+
+        // whether it has duplicates is known from now on
+        updateCrateValues(index);
+    }
+    else {
+        fingerprints[(size_t) track.fingerprint] = fingerprint;
+    }
+}
+
+// the tracks that have not been fingerprinted yet
+juce::Array<juce::URL> TrackLibrary::getTracksWithoutFingerprint() const
+{
+    juce::Array<juce::URL> result;
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+        if (track.fingerprint < 0)
+            result.add(juce::URL{juce::String::fromUTF8(track.url.data(), (int) track.url.size())});
+    }
+
+    return result;
+}
+
+// the fingerprinted tracks for a duplicate index
+std::vector<DuplicateIndex::Entry> TrackLibrary::getFingerprintEntries() const
+{
+    std::vector<DuplicateIndex::Entry> entries;
+    entries.reserve(fingerprints.size());
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+        if (track.fingerprint >= 0)
+            entries.push_back({index, fingerprints[(size_t) track.fingerprint]});
+    }
+
+    return entries;
+}
+
+// replace the groups of tracks that sound the same
+void TrackLibrary::setDuplicateGroups(const std::vector<DuplicateIndex::Group>& groups)
+{
+    // whether every track had duplicates, so only the ones that changed
+    // are tested against the crates again
+    std::vector<char> hadDuplicates (tracks.size());
+
+    for (size_t index = 0; index < tracks.size(); ++index) {
+        hadDuplicates[index] = tracks[index].duplicateGroup > 0 ? 1 : 0;
+        tracks[index].duplicateGroup = 0;
+        tracks[index].duplicateSimilarity = 0.0f;
+    }
+
+    for (size_t group = 0; group < groups.size(); ++group) {
+        for (auto id : groups[group].ids) {
+            // the ids come from a snapshot, so a track always still exists
+            if (id < 0 || id >= (int) tracks.size())
+                continue;
+
+            tracks[(size_t) id].duplicateGroup = (int) group + 1;
+            tracks[(size_t) id].duplicateSimilarity = groups[group].similarity;
+        }
+    }
+
+    for (size_t index = 0; index < tracks.size(); ++index)
+        if ((tracks[index].duplicateGroup > 0) != (hadDuplicates[index] != 0))
+            updateCrateValues((int) index);
+
+    sortedTracksOutOfDate = true;
+}
+
+// the group of a track matching the search text, if it has duplicates
+bool TrackLibrary::getDuplicateGroup(int row, int& group, float& similarity) const
+{
+    auto* track = getVisibleTrack(row);
+
+    if (track == nullptr || track->duplicateGroup == 0)
+        return false;
+
+    group = track->duplicateGroup;
+    similarity = track->duplicateSimilarity;
+    return true;
+}
+
+//==============================================================================
+// count a play of a track
+void TrackLibrary::setTrackPlayed(const juce::URL& trackURL, juce::int64 timeMillis)
+{
+    addTrackPlays(trackURL, 1, timeMillis);
+}
+
+// add the plays of a track counted from the log
+void TrackLibrary::addTrackPlays(const juce::URL& trackURL, int playCount, juce::int64 lastPlayedMillis)
+{
+    auto url = trackURL.toString(false);
+    auto index = findOrAddTrack(StringArena::view(url));
+    auto& track = tracks[(size_t) index];
+
+    track.playCount += playCount;
+    // the plays of the log may come in after the ones of this session
+    track.lastPlayedMillis = juce::jmax(track.lastPlayedMillis, lastPlayedMillis);
+    sortedTracksOutOfDate = true;
+    updateCrateValues(index);
+}
+
+// the plays of a track matching the search text, if it has been played
+bool TrackLibrary::getTrackPlays(int row, int& playCount, juce::int64& lastPlayedMillis) const
+{
+    auto* track = getVisibleTrack(row);
+
+    if (track == nullptr || track->playCount == 0)
+        return false;
+
+    playCount = track->playCount;
+    lastPlayedMillis = track->lastPlayedMillis;
+    return true;
+}
+
+// the history log sits next to the data file
+juce::File TrackLibrary::getHistoryFile() const
+{
+    return dataFile.getSiblingFile(dataFile.getFileNameWithoutExtension() + "-history.log");
+}
+
+//==============================================================================
+// sort the tracks by a number of fields
+void TrackLibrary::setSortOrder(const juce::Array<SortKey>& order)
+{
+    sortOrder = order;
+    sortedTracksOutOfDate = true;
+    updateVisibleTracks();
+}
+
+// the fields the tracks are sorted by
+const juce::Array<TrackLibrary::SortKey>& TrackLibrary::getSortOrder() const
+{
+    return sortOrder;
+}
+
+//==============================================================================
+// add a smart crate or replace the one with the same name
+int TrackLibrary::setCrate(const SmartCrate& crate)
+{
+    auto index = 0;
+    while (index < crates.getNumCrates() && ! crates.getCrate(index).name.equalsIgnoreCase(crate.name))
+        ++index;
+
+    if (index < crates.getNumCrates())
+        crates.replaceCrate(index, crate);
+    else
+        crates.addCrate(crate);
+
+    saveCrates();
+
+    if (crateFilter == index)
+        updateVisibleTracks();
+
+    return index;
+}
+
+// remove a smart crate
+void TrackLibrary::removeCrate(int crate)
+{
+    if (crate < 0 || crate >= crates.getNumCrates())
+        return;
+
+    crates.removeCrate(crate);
+    saveCrates();
+
+    // the crates after it move up one
+    if (crateFilter == crate)
+        crateFilter = -1;
+    else if (crateFilter > crate)
+        --crateFilter;
+
+    updateVisibleTracks();
+}
+
+// the number of smart crates
+int TrackLibrary::getNumCrates() const
+{
+    return crates.getNumCrates();
+}
+
+// a smart crate
+const SmartCrate& TrackLibrary::getCrate(int crate) const
+{
+    return crates.getCrate(crate);
+}
+
+// the number of tracks in a smart crate
+int TrackLibrary::getNumTracksInCrate(int crate) const
+{
+    return crates.getNumMatches(crate);
+}
+
+// only show the tracks of a smart crate
+void TrackLibrary::setCrateFilter(int crate)
+{
+    crateFilter = crate >= 0 && crate < crates.getNumCrates() ? crate : -1;
+    updateVisibleTracks();
+}
+
+// the smart crate the tracks are filtered by
+int TrackLibrary::getCrateFilter() const
+{
+    return crateFilter;
+}
+
+// the crates file sits next to the data file
+juce::File TrackLibrary::getCratesFile() const
+{
+    return dataFile.getSiblingFile(dataFile.getFileNameWithoutExtension() + "-crates.xml");
+}
+
+//==============================================================================
+// write the analysis of every track to the analysis file
+bool TrackLibrary::saveAnalysis() const
+{
+    juce::XmlElement root {"OTODESKANALYSIS"};
+
+    // a track has one element whatever was measured, in url order
+    for (auto index : urlOrder) {
+        auto& track = tracks[(size_t) index];
+        if (! track.hasLoudness && ! track.hasHarmony && track.fingerprint < 0)
+            continue;
+
+        auto* element = root.createNewChildElement("TRACK");
+        element->setAttribute("url", juce::String::fromUTF8(track.url.data(), (int) track.url.size()));
+
+        if (track.hasLoudness) {
+            element->setAttribute("lufs", track.loudness.integratedLufs);
+            element->setAttribute("truePeak", track.loudness.truePeakDb);
+        }
+
+        if (track.hasHarmony) {
+            element->setAttribute("key", track.harmony.getCamelot());
+            element->setAttribute("bpm", track.harmony.bpm);
+        }
+
+        if (track.fingerprint >= 0) {
+            element->setAttribute("fingerprint", fingerprints[(size_t) track.fingerprint].toString());
+            element->setAttribute("fingerprintVersion", AudioFingerprint::version);
+        }
+    }
+
+    // the xml is written to a temporary file first, so a crash never leaves
+    // half a file behind
+    if (! root.writeTo(getAnalysisFile())) {
+        std::cout << "TrackLibrary::saveAnalysis  could not write " << getAnalysisFile().getFullPathName() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// the analysis file sits next to the data file
+juce::File TrackLibrary::getAnalysisFile() const
+{
+    return dataFile.getSiblingFile(dataFile.getFileNameWithoutExtension() + "-analysis.xml");
+}
+
+//==============================================================================
+// append a record, the title is the name of the file
+void TrackLibrary::appendTrack(std::string_view url, bool listed)
+{
+    Track track;
+    track.url = strings.add(url);
+
+    // the name is the last part of the url, npos + 1 is the whole url
+    auto name = track.url.substr(track.url.find_last_of('/') + 1);
+
+    // a name without escaped characters is a view into the url itself
+    if (name.find('%') == std::string_view::npos) {
+        track.title = name;
+    }
+    else {
+        titleScratch.clear();
+
+        for (size_t i = 0; i < name.size(); ++i) {
+            if (name[i] == '%' && i + 2 < name.size()) {
+                auto high = juce::CharacterFunctions::getHexDigitValue((juce::juce_wchar) (unsigned char) name[i + 1]);
+                auto low = juce::CharacterFunctions::getHexDigitValue((juce::juce_wchar) (unsigned char) name[i + 2]);
+
+                if (high >= 0 && low >= 0) {
+                    titleScratch += (char) (high * 16 + low);
+                    i += 2;
+                    continue;
+                }
+            }
+
+            titleScratch += name[i];
+        }
+
+        track.title = strings.add(titleScratch);
+    }
+
+    if (listed)
+        track.listIndex = numListed++;
+
+    tracks.push_back(track);
+}
+
+// sort the indices after records were appended
+void TrackLibrary::sortTracks(int firstNewTrack)
+{
+    urlOrder.reserve(tracks.size());
+    for (auto index = firstNewTrack; index < (int) tracks.size(); ++index)
+        urlOrder.push_back(index);
+
+    // std::sort does not allocate, a record that is there twice is after
+    // the first one because the index breaks ties
+    std::sort(urlOrder.begin(), urlOrder.end(), [this] (int a, int b) {
+        auto& first = tracks[(size_t) a].url;
+        auto& second = tracks[(size_t) b].url;
+        return first != second ? first < second : a < b;
+    });
+
+    // the first record of a url keeps its analysis, and is listed if any of them is
+    size_t numKept = 0;
+    for (auto index : urlOrder) {
+        auto& track = tracks[(size_t) index];
+
+        if (numKept > 0) {
+            auto& first = tracks[(size_t) urlOrder[numKept - 1]];
+
+            if (first.url == track.url) {
+                if (first.listIndex < 0 && track.listIndex >= 0) {
+                    first.listIndex = track.listIndex;
+                    updateCrateValues(urlOrder[numKept - 1]);
+
+                    // a track imported again may already have a key
+                    if (first.hasHarmony)
+                        suggestionIndexOutOfDate = true;
+                }
+
+                track.duplicate = true;
+                continue;
+            }
+        }
+
+        urlOrder[numKept++] = index;
+    }
+
+    urlOrder.resize(numKept);
+
+    // the new records are tested against the smart crates on their own
+    for (auto index = firstNewTrack; index < (int) tracks.size(); ++index)
+        updateCrateValues(index);
+
+    // every listed url is shown
+    titleOrder.clear();
+    titleOrder.reserve(urlOrder.size());
+
+    for (auto index : urlOrder)
+        if (tracks[(size_t) index].listIndex >= 0)
+            titleOrder.push_back(index);
+
+    // tracks with the same name in different folders are all listed, in the
+    // order they were imported
+    std::sort(titleOrder.begin(), titleOrder.end(), [this] (int a, int b) {
+        auto& first = tracks[(size_t) a];
+        auto& second = tracks[(size_t) b];
+        return first.title != second.title ? first.title < second.title : first.listIndex < second.listIndex;
+    });
+
+    ++revision;
+    sortedTracksOutOfDate = true;
+}
+
+// the index of the record of a url
+int TrackLibrary::findTrack(std::string_view url) const
+{
+    auto found = std::lower_bound(urlOrder.begin(), urlOrder.end(), url, [this] (int index, std::string_view value) {
+        return tracks[(size_t) index].url < value;
+    });
+
+    if (found == urlOrder.end() || tracks[(size_t) *found].url != url)
+        return -1;
+
+    return *found;
+}
+
+// the index of the record of a url, a url the library does not list gets one
+int TrackLibrary::findOrAddTrack(std::string_view url)
+{
+    auto found = std::lower_bound(urlOrder.begin(), urlOrder.end(), url, [this] (int index, std::string_view value) {
+        return tracks[(size_t) index].url < value;
+    });
+
+    if (found != urlOrder.end() && tracks[(size_t) *found].url == url)
+        return *found;
+
+    // the record is not listed, so only the url order changes
+    auto index = (int) tracks.size();
+    urlOrder.insert(found, index);
+    appendTrack(url, false);
+    updateCrateValues(index);
+    return index;
+}
+
+// the record of a row matching the search text
+const TrackLibrary::Track* TrackLibrary::getVisibleTrack(int row) const
+{
+    if (row < 0 || row >= getNumTracks())
+        return nullptr;
+
+    return &tracks[(size_t) visibleTracks[(size_t) row]];
+}
+
+// check if a record is a listed track that is shown
+bool TrackLibrary::isShown(int index) const
+{
+    auto& track = tracks[(size_t) index];
+    return track.listIndex >= 0 && ! track.duplicate;
+}
+
+// check if a track goes before another in the sort order
+bool TrackLibrary::isSortedBefore(int first, int second) const
+{
+    auto& a = tracks[(size_t) first];
+    auto& b = tracks[(size_t) second];
+
+    auto isKnown = [] (const Track& track, SortField field)
+    {
+        switch (field) {
+            case SortField::key:        return track.hasHarmony && track.harmony.camelotNumber > 0;
+            case SortField::bpm:        return track.hasHarmony && track.harmony.bpm > 0.0f;
+            case SortField::loudness:   return track.hasLoudness;
+            case SortField::duplicate:  return track.duplicateGroup > 0;
+            case SortField::lastPlayed: return track.playCount > 0;
+            default:                    return true;
+        }
+    };
+
+    for (auto& key : sortOrder) {
+        // a field that is not known goes at the end whatever the direction
+        auto aKnown = isKnown(a, key.field);
+        auto bKnown = isKnown(b, key.field);
+
+        if (aKnown != bKnown)
+            return aKnown;
+        if (! aKnown)
+            continue;
+
+        // -1, 0 or 1 as a is before, level with or after b going forwards
+        int order = 0;
+
+        switch (key.field) {
+            case SortField::title:
+                order = a.title.compare(b.title);
+                break;
+            case SortField::key:
+                // the keys go round the wheel, the minor key before the major one
+                order = a.harmony.camelotNumber != b.harmony.camelotNumber
+                    ? a.harmony.camelotNumber - b.harmony.camelotNumber
+                    : (int) b.harmony.minor - (int) a.harmony.minor;
+                break;
+            case SortField::bpm:
+                order = (a.harmony.bpm > b.harmony.bpm) - (a.harmony.bpm < b.harmony.bpm);
+                break;
+            case SortField::loudness:
+                order = (a.loudness.integratedLufs > b.loudness.integratedLufs) - (a.loudness.integratedLufs < b.loudness.integratedLufs);
+                break;
+            case SortField::duplicate:
+                // the tracks of a group end up next to each other
+                order = a.duplicateGroup - b.duplicateGroup;
+                break;
+            case SortField::plays:
+                order = a.playCount - b.playCount;
+                break;
+            case SortField::lastPlayed:
+                order = (a.lastPlayedMillis > b.lastPlayedMillis) - (a.lastPlayedMillis < b.lastPlayedMillis);
+                break;
+        }
+
+        if (order != 0)
+            return key.forwards ? order < 0 : order > 0;
+    }
+
+    // the title and the import order are unique together, so the order
+    // never depends on how std::sort shuffles equal tracks
+    return a.title != b.title ? a.title < b.title : a.listIndex < b.listIndex;
+}
+
+// rebuild the list of tracks that match the search text
+void TrackLibrary::updateVisibleTracks()
+{
+    // the list keeps its memory, so a search does not allocate once the
+    // list has been as long as the library
+    visibleTracks.clear();
+    visibleTracks.reserve(titleOrder.size());
+
+    // get the value to search for, the UTF-8 of the text is not copied
+    auto value = StringArena::view(searchText);
+    auto matchesSearch = [this, value] (int index)
+    {
+        if (showingSearchResults && inSearchResults[(size_t) index] == 0)
+            return false;
+
+        if (crateFilter >= 0 && ! crates.contains(crateFilter, index))
+            return false;
+
+        return value.empty() || tracks[(size_t) index].title.find(value) != std::string_view::npos;
+    };
+
+    // the suggestions come from the index, best first
+    if (suggestionTarget.camelotNumber > 0) {
+        if (suggestionIndexOutOfDate)
+            rebuildSuggestionIndex();
+
+        for (auto id : suggestionIndex.findCompatible(suggestionTarget.camelotNumber, suggestionTarget.minor,
+                                                      suggestionTarget.bpm, maxSuggestions)) {
+            auto index = indexedTracks[(size_t) id];
+            if (matchesSearch(index))
+                visibleTracks.push_back(index);
+        }
+        return;
+    }
+
+    // the tracks are sorted again only when a track or the order changed,
+    // into the memory of the last sort
+    if (! sortOrder.isEmpty() && sortedTracksOutOfDate) {
+        sortedTracks.assign(titleOrder.begin(), titleOrder.end());
+        std::sort(sortedTracks.begin(), sortedTracks.end(), [this] (int a, int b) { return isSortedBefore(a, b); });
+        sortedTracksOutOfDate = false;
+    }
+
+    // the results of a ranked search keep their order, best first
+    auto& order = showingSearchResults ? searchResults : (sortOrder.isEmpty() ? titleOrder : sortedTracks);
+
+    // iterate over all the tracks
+    for (auto index : order) {
+        // check if the value is in the name of the track
+        if (! matchesSearch(index))
+            continue;
+
+        // check if the track is in the key of the filter
+        if (keyFilterHarmony.camelotNumber > 0) {
+            auto& track = tracks[(size_t) index];
+            if (! track.hasHarmony
+                || track.harmony.camelotNumber != keyFilterHarmony.camelotNumber
+                || track.harmony.minor != keyFilterHarmony.minor)
+                continue;
+        }
+
+        visibleTracks.push_back(index);
+    }
+}
+
+// read the analysis of the tracks from the analysis file
+void TrackLibrary::loadAnalysis()
+{
+    // there is nothing to read before the first track is measured
+    if (! getAnalysisFile().existsAsFile())
+        return;
+
+    auto root = juce::XmlDocument::parse(getAnalysisFile());
+
+    if (root == nullptr || ! root->hasTagName("OTODESKANALYSIS")) {
+        std::cout << "TrackLibrary::loadAnalysis  could not read " << getAnalysisFile().getFullPathName() << std::endl;
+        return;
+    }
+
+    for (auto* element : root->getChildWithTagNameIterator("TRACK")) {
+        auto url = element->getStringAttribute("url");
+        auto& track = tracks[(size_t) findOrAddTrack(StringArena::view(url))];
+
+        // a track may have its loudness, its key, its fingerprint or any of them
+        if (element->hasAttribute("lufs")) {
+            track.loudness.integratedLufs = (float) element->getDoubleAttribute("lufs", -100.0);
+            track.loudness.truePeakDb = (float) element->getDoubleAttribute("truePeak", -100.0);
+            track.hasLoudness = true;
+        }
+
+        if (element->hasAttribute("key")) {
+            track.harmony = Harmony::fromCamelot(element->getStringAttribute("key"),
+                                                 (float) element->getDoubleAttribute("bpm", 0.0));
+            track.hasHarmony = true;
+        }
+
+        // a silent track keeps its empty fingerprint, so it is not worked out
+        // again, one of an older version is
+        if (element->hasAttribute("fingerprint")
+            && element->getIntAttribute("fingerprintVersion", 1) == AudioFingerprint::version) {
+            track.fingerprint = (int) fingerprints.size();
+            fingerprints.push_back(AudioFingerprint::Fingerprint::fromString(element->getStringAttribute("fingerprint")));
+        }
+    }
+
+    // the crates are read after the analysis, so this only fills the columns
+    for (auto index = 0; index < (int) tracks.size(); ++index)
+        updateCrateValues(index);
+
+    suggestionIndexOutOfDate = true;
+    sortedTracksOutOfDate = true;
+}
+
+// put every track with a known key and tempo into the index
+void TrackLibrary::rebuildSuggestionIndex()
+{
+    suggestionIndex.clear();
+    indexedTracks.clear();
+
+    for (auto index : titleOrder) {
+        auto& track = tracks[(size_t) index];
+        if (! track.hasHarmony || track.harmony.camelotNumber == 0)
+            continue;
+
+        suggestionIndex.add((int) indexedTracks.size(), track.harmony.camelotNumber,
+                            track.harmony.minor, track.harmony.bpm);
+        indexedTracks.push_back(index);
+    }
+
+    suggestionIndexOutOfDate = false;
+}
+
+// pass the values of a record on to the smart crates
+void TrackLibrary::updateCrateValues(int index)
+{
+    auto& track = tracks[(size_t) index];
+    CrateIndex::Values values;
+    values.fill(CrateIndex::unknown);
+
+    if (track.hasHarmony && track.harmony.bpm > 0.0f)
+        values[SmartCrate::bpmField] = track.harmony.bpm;
+    if (track.hasHarmony && track.harmony.camelotNumber > 0)
+        values[SmartCrate::keyField] = SmartCrate::getKeyValue(track.harmony.camelotNumber, track.harmony.minor);
+    if (track.hasLoudness)
+        values[SmartCrate::loudnessField] = track.loudness.integratedLufs;
+
+    // a track either has duplicates or not once it is fingerprinted
+    if (track.fingerprint >= 0)
+        values[SmartCrate::duplicateField] = track.duplicateGroup > 0 ? 1.0f : 0.0f;
+    // and has been played a number of times, a track never played was last
+    // played on the first day
+    values[SmartCrate::playsField] = (float) track.playCount;
+    values[SmartCrate::lastPlayedField] = SmartCrate::getDayValue(track.lastPlayedMillis);
+
+    crates.setTrack(index, isShown(index), values);
+}
+
+// read the smart crates from the crates file
+void TrackLibrary::loadCrates()
+{
+    // there are no crates before the first one is saved
+    if (! getCratesFile().existsAsFile())
+        return;
+
+    auto root = juce::XmlDocument::parse(getCratesFile());
+
+    if (root == nullptr || ! root->hasTagName("OTODESKCRATES")) {
+        std::cout << "TrackLibrary::loadCrates  could not read " << getCratesFile().getFullPathName() << std::endl;
+        return;
+    }
+
+    for (auto* element : root->getChildWithTagNameIterator("CRATE")) {
+        SmartCrate crate;
+        juce::String error;
+        crate.name = element->getStringAttribute("name");
+
+        // a query that cannot be read any more is left out
+        if (! crate.setQuery(element->getStringAttribute("query"), error)) {
+            std::cout << "TrackLibrary::loadCrates  " << crate.name << ": " << error << std::endl;
+            continue;
+        }
+
+        crates.addCrate(crate);
+    }
+}
+
+// write the smart crates to the crates file
+bool TrackLibrary::saveCrates() const
+{
+    juce::XmlElement root {"OTODESKCRATES"};
+
+    for (int index = 0; index < crates.getNumCrates(); ++index) {
+        auto* element = root.createNewChildElement("CRATE");
+        element->setAttribute("name", crates.getCrate(index).name);
+        element->setAttribute("query", crates.getCrate(index).query);
+    }
+
+    if (! root.writeTo(getCratesFile())) {
+        std::cout << "TrackLibrary::saveCrates  could not write " << getCratesFile().getFullPathName() << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,327 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.h
+    Created: 19 Oct 2026 11:20:05am
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StringArena.h"
+#include "SuggestionIndex.h"
+#include "SearchIndex.h"
+#include "DuplicateIndex.h"
+#include "SmartCrate.h"
+
+#include <vector>
+#include <string_view>
+
+//==============================================================================
+/*
+ The list of tracks shown in the playlist. It keeps every track that was ever
+ imported with its analysis, its duplicates and its plays, saves them to the
+ data file, and searches, filters and sorts them for the playlist. It does not
+ depend on any GUI class so it can be used headless.
+*/
+class TrackLibrary
+{
+public:
+    /** Creates a library that reads and saves its tracks in the given file */
+    TrackLibrary(const juce::File& dataFile);
+    ~TrackLibrary();
+
+    /** Returns the data file used when no other file is given */
+    static juce::File getDefaultDataFile();
+
+    /** Adds a track to the library and saves it to the data file if asked to */
+    void addTrack(const juce::URL& trackURL, bool saveToDataFile = true);
+    /** Adds a number of tracks at once and saves them to the data file */
+    void addTracks(const juce::Array<juce::URL>& trackURLs);
+
+    /** Returns the number of tracks matching the search text */
+    int getNumTracks() const;
+    /** Returns the title of a track matching the search text, valid as long
+        as the library */
+    std::string_view getTrackTitle(int row) const;
+    /** Returns the url of a track matching the search text */
+    juce::URL getTrackURL(int row) const;
+
+    /** Only keeps the tracks whose title contains the text, empty shows all tracks */
+    void setSearchText(const juce::String& text);
+    /** Returns the current search text */
+    const juce::String& getSearchText() const;
+
+    /** Returns the number of tracks in the library, ignoring the search text */
+    int getTotalNumTracks() const;
+
+    /** Returns the tracks in title order for a SearchIndex, with their
+        current keys and tempos. A track keeps its id and its strings for as
+        long as the library exists */
+    std::vector<SearchIndex::Entry> getSearchEntries() const;
+    /** Returns a number that changes whenever tracks are added */
+    int getRevision() const;
+    /** Shows the tracks of a ranked search in the order given, instead of
+        all the tracks in the sort order. The search text, the key filter
+        and the suggestions still apply */
+    void setSearchResults(const std::vector<int>& trackIds);
+    /** Shows all the tracks again after setSearchResults */
+    void clearSearchResults();
+    /** Returns true if the tracks of a ranked search are shown */
+    bool isShowingSearchResults() const;
+
+    //==============================================================================
+    /** The loudness measured for a track */
+    struct Loudness
+    {
+        /** The integrated loudness in LUFS */
+        float integratedLufs = -100.0f;
+        /** The true peak in dBTP */
+        float truePeakDb = -100.0f;
+    };
+
+    /** Stores the loudness of a track, call saveAnalysis to write it to disk */
+    void setTrackLoudness(const juce::URL& trackURL, const Loudness& trackLoudness);
+    /** Returns true and fills in the loudness if the track has been measured */
+    bool getTrackLoudness(const juce::URL& trackURL, Loudness& trackLoudness) const;
+    /** Returns true and fills in the loudness of a track matching the search text */
+    bool getTrackLoudness(int row, Loudness& trackLoudness) const;
+    /** Returns the tracks whose loudness has not been measured yet */
+    juce::Array<juce::URL> getTracksWithoutLoudness() const;
+
+    //==============================================================================
+    /** The key and tempo of a track, what tracks are mixed in harmony by */
+    struct Harmony
+    {
+        /** The number on the Camelot wheel from 1 to 12, 0 if the key is not known */
+        int camelotNumber = 0;
+        /** True for the minor keys, the A side of the wheel */
+        bool minor = false;
+        /** The tempo in beats per minute, 0 if it is not known */
+        float bpm = 0.0f;
+
+        /** Returns the key in Camelot notation such as 8A, empty if it is not known */
+        juce::String getCamelot() const;
+        /** Reads a key in Camelot notation, the key is not known if it cannot be read */
+        static Harmony fromCamelot(const juce::String& camelot, float bpm = 0.0f);
+    };
+
+    /** Stores the key and tempo of a track, call saveAnalysis to write it to disk */
+    void setTrackHarmony(const juce::URL& trackURL, const Harmony& trackHarmony);
+    /** Returns true and fills in the key and tempo if the track has been analysed */
+    bool getTrackHarmony(const juce::URL& trackURL, Harmony& trackHarmony) const;
+    /** Returns true and fills in the key and tempo of a track matching the search text */
+    bool getTrackHarmony(int row, Harmony& trackHarmony) const;
+    /** Returns the tracks whose key has not been analysed yet */
+    juce::Array<juce::URL> getTracksWithoutHarmony() const;
+
+    /** Returns the tracks that mix well after a key and tempo, best first */
+    juce::Array<juce::URL> getCompatibleTracks(const Harmony& target, int maxResults);
+
+    /** Only keeps the tracks in a key given in Camelot notation, empty shows all keys */
+    void setKeyFilter(const juce::String& camelot);
+    /** Returns the current key filter */
+    const juce::String& getKeyFilter() const;
+    /** Only keeps the tracks that mix well after a key and tempo, best
+        first. A harmony whose key is not known turns this off again */
+    void setSuggestionTarget(const Harmony& target);
+
+    //==============================================================================
+    /** Stores the acoustic fingerprint of a track, call saveAnalysis to write it to disk */
+    void setTrackFingerprint(const juce::URL& trackURL, const AudioFingerprint::Fingerprint& fingerprint);
+    /** Returns the tracks that have not been fingerprinted yet */
+    juce::Array<juce::URL> getTracksWithoutFingerprint() const;
+    /** Returns the fingerprinted tracks for a DuplicateIndex, a track keeps
+        its id for as long as the library exists */
+    std::vector<DuplicateIndex::Entry> getFingerprintEntries() const;
+    /** Replaces the groups of tracks that sound the same, by the ids of
+        getFingerprintEntries. A group is numbered from 1 in the order given */
+    void setDuplicateGroups(const std::vector<DuplicateIndex::Group>& groups);
+    /** Returns true and fills in the group of a track matching the search
+        text and the similarity that joined it, if it has duplicates */
+    bool getDuplicateGroup(int row, int& group, float& similarity) const;
+
+    //==============================================================================
+    /** Counts a play of a track at a time in milliseconds since 1970. The
+        plays are not saved, they are counted again from the history log */
+    void setTrackPlayed(const juce::URL& trackURL, juce::int64 timeMillis);
+    /** Adds a number of plays of a track counted from the history log, the
+        last one at a time in milliseconds since 1970 */
+    void addTrackPlays(const juce::URL& trackURL, int playCount, juce::int64 lastPlayedMillis);
+    /** Returns true and fills in the number of plays and the last time a
+        track matching the search text was played, if it has been played */
+    bool getTrackPlays(int row, int& playCount, juce::int64& lastPlayedMillis) const;
+    /** Returns the history log, which sits next to the data file */
+    juce::File getHistoryFile() const;
+
+    //==============================================================================
+    /** The fields the tracks can be sorted by */
+    enum class SortField { title, key, bpm, loudness, duplicate, plays, lastPlayed };
+
+    /** A field to sort by and its direction */
+    struct SortKey
+    {
+        SortField field = SortField::title;
+        bool forwards = true;
+    };
+
+    /** Sorts the tracks by a number of fields, the first one first and the
+        title last. The tracks whose field is not known go at the end either
+        way. An empty order shows the tracks by title */
+    void setSortOrder(const juce::Array<SortKey>& order);
+    /** Returns the fields the tracks are sorted by */
+    const juce::Array<SortKey>& getSortOrder() const;
+
+    //==============================================================================
+    /** Adds a smart crate, or replaces the crate with the same name, and
+        saves the crates to the crates file. Returns its index */
+    int setCrate(const SmartCrate& crate);
+    /** Removes a smart crate and saves the crates */
+    void removeCrate(int crate);
+    /** Returns the number of smart crates */
+    int getNumCrates() const;
+    /** Returns a smart crate */
+    const SmartCrate& getCrate(int crate) const;
+    /** Returns the number of tracks in a smart crate */
+    int getNumTracksInCrate(int crate) const;
+    /** Only keeps the tracks of a smart crate, -1 shows all tracks */
+    void setCrateFilter(int crate);
+    /** Returns the smart crate the tracks are filtered by, -1 if none */
+    int getCrateFilter() const;
+    /** Returns the crates file, which sits next to the data file */
+    juce::File getCratesFile() const;
+
+    //==============================================================================
+    /** Writes the analysis of every track to the analysis file */
+    bool saveAnalysis() const;
+    /** Returns the analysis file, which sits next to the data file */
+    juce::File getAnalysisFile() const;
+
+private:
+    /** A track, or a url the analysis file knows that is not in the library */
+    struct Track
+    {
+        // views into the arena
+        std::string_view title;
+        std::string_view url;
+
+        Loudness loudness;
+        Harmony harmony;
+        bool hasLoudness = false;
+        bool hasHarmony = false;
+        // the position of the fingerprint in fingerprints, -1 if there is none
+        int fingerprint = -1;
+        // the group of tracks that sound the same by their fingerprints, 0 if
+        // there is none, and the similarity that joined the track to it
+        int duplicateGroup = 0;
+        float duplicateSimilarity = 0.0f;
+        // the number of plays and the last one in milliseconds since 1970,
+        // filled in from the log of a PlayHistory
+        int playCount = 0;
+        juce::int64 lastPlayedMillis = 0;
+        // the order the track was imported in, -1 if it was only analysed
+        int listIndex = -1;
+        // true if the url is there twice, the first record is the one used
+        bool duplicate = false;
+    };
+
+    /** Adds a record for a url to the end of the tracks, the orders are not
+        updated until sortTracks */
+    void appendTrack(std::string_view url, bool listed);
+    /** Sorts the indices by url and title after the records from
+        firstNewTrack on were appended, and merges the records whose url is
+        there twice */
+    void sortTracks(int firstNewTrack);
+    /** Returns the index of the record of a url, -1 if there is none */
+    int findTrack(std::string_view url) const;
+    /** Returns the index of the record of a url, adding one that is not
+        listed if there is none */
+    int findOrAddTrack(std::string_view url);
+    /** Returns the record of a row matching the search text, null outside the rows */
+    const Track* getVisibleTrack(int row) const;
+    /** Returns true if a record is a listed track that is shown */
+    bool isShown(int index) const;
+    /** Returns true if a track goes before another in the sort order */
+    bool isSortedBefore(int first, int second) const;
+    /** Rebuilds the list of tracks matching the search text */
+    void updateVisibleTracks();
+    /** Reads the analysis of the tracks from the analysis file */
+    void loadAnalysis();
+    /** Puts every track with a known key and tempo into the suggestion index */
+    void rebuildSuggestionIndex();
+    /** Passes the values of a record on to the smart crates */
+    void updateCrateValues(int index);
+    /** Reads the smart crates from the crates file */
+    void loadCrates();
+    /** Writes the smart crates to the crates file */
+    bool saveCrates() const;
+
+    // the titles and urls of the tracks, in one arena so loading, importing
+    // and searching allocate a fixed number of times whatever the size of
+    // the library
+    StringArena strings;
+    // reused to decode the title of every track, so it only grows
+    std::string titleScratch;
+
+    // every record in the order it was added, a small record per track
+    // rather than a map node and strings
+    std::vector<Track> tracks;
+    // the shown tracks sorted by title, then in the order they were imported
+    std::vector<int> titleOrder;
+    // every record but the duplicates, sorted by url. Two files are the same
+    // track only if their urls are, so songs with the same name in different
+    // folders are all listed
+    std::vector<int> urlOrder;
+    // the fingerprints of the tracks, kept out of the records as they are
+    // far bigger than the rest of a track
+    std::vector<AudioFingerprint::Fingerprint> fingerprints;
+    // the number of tracks imported so far, and how often tracks were added
+    int numListed = 0;
+    int revision = 0;
+
+    // the tracks that match the search text, in sort order
+    std::vector<int> visibleTracks;
+
+    // the fields the tracks are sorted by, the shown tracks in that order,
+    // and whether a track has changed since they were sorted. The order is
+    // kept until then, so the rows of a sorted library cost the same as an
+    // unsorted one
+    juce::Array<SortKey> sortOrder;
+    std::vector<int> sortedTracks;
+    bool sortedTracksOutOfDate = true;
+
+    // the ids of a ranked search best first, whether they are shown instead
+    // of all tracks, and a flag per record to find them quickly
+    std::vector<int> searchResults;
+    bool showingSearchResults = false;
+    std::vector<char> inSearchResults;
+
+    // the tracks with a known key and tempo, found by their position in
+    // indexedTracks, and whether a track has changed since it was built
+    SuggestionIndex suggestionIndex;
+    std::vector<int> indexedTracks;
+    bool suggestionIndexOutOfDate = true;
+    // the most tracks shown as suggestions
+    static constexpr int maxSuggestions = 200;
+
+    // the smart crates and the values they test, which every change to a
+    // track updates so a crate never runs its query again, and the crate the
+    // tracks are filtered by
+    CrateIndex crates;
+    int crateFilter = -1;
+
+    // the text, key and suggestions the tracks are filtered by, the key is
+    // kept as a harmony too so it is compared without making strings
+    juce::String searchText;
+    juce::String keyFilter;
+    Harmony keyFilterHarmony;
+    Harmony suggestionTarget;
+
+    // the file containing the data
+    juce::File dataFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLibrary)
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    TrackPreloader.cpp
+    Created: 19 Oct 2026 7:58:21pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "TrackPreloader.h"
+
+TrackPreloader::TrackPreloader(juce::AudioFormatManager& _formatManager,
+                               const juce::URL& _url,
+                               double _introSeconds)
+: juce::ThreadPoolJob("Track preload"),
+  formatManager(_formatManager),
+  url(_url),
+  introSeconds(_introSeconds) {}
+
+TrackPreloader::~TrackPreloader() {}
+
+//==============================================================================
+// open the track and decode its intro
+juce::ThreadPoolJob::JobStatus TrackPreloader::runJob()
+{
+    reader.reset(formatManager.createReaderFor(url.createInputStream(false)));
+
+    if (reader == nullptr) {
+        std::cout << "TrackPreloader::runJob  could not open " << url.toString(false) << std::endl;
+        finished = true;
+        return jobHasFinished;
+    }
+
+    auto length = (int) juce::jmin(reader->lengthInSamples, (juce::int64) (introSeconds * reader->sampleRate));
+    intro.setSize(2, juce::jmax(0, length));
+
+    // decoded in chunks so a cancelled preload stops quickly
+    const int chunkSize = 8192;
+
+    for (int done = 0; done < length; done += chunkSize) {
+        // stopped because another track was queued
+        if (shouldExit()) {
+            reader.reset();
+            return jobHasFinished;
+        }
+
+        auto numSamples = juce::jmin(chunkSize, length - done);
+        reader->read(&intro, done, numSamples, done, true, true);
+    }
+
+    finished = true;
+    return jobHasFinished;
+}
+
+// the track being preloaded
+const juce::URL& TrackPreloader::getURL() const
+{
+    return url;
+}
+
+// check if the job is done
+bool TrackPreloader::isFinished() const
+{
+    return finished;
+}
+
+// check if the track could be opened
+bool TrackPreloader::wasSuccessful() const
+{
+    return reader != nullptr;
+}
+
+// hand the open reader over
+std::unique_ptr<juce::AudioFormatReader> TrackPreloader::takeReader()
+{
+    return std::move(reader);
+}
+
+// hand the decoded intro over
+juce::AudioBuffer<float> TrackPreloader::takeIntro()
+{
+    return std::move(intro);
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    TrackPreloader.h
+    Created: 19 Oct 2026 7:58:21pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+
+//==============================================================================
+/*
+ A job for the AnalysisPool that gets the next track of a deck ready while the
+ other deck is playing. It opens the reader, which for a compressed file means
+ scanning the stream, and decodes the intro the pre-roll cache would otherwise
+ decode after the load. The deck then takes both over without touching the
+ disk.
+*/
+class TrackPreloader : public juce::ThreadPoolJob
+{
+public:
+    TrackPreloader(juce::AudioFormatManager& formatManager,
+                   const juce::URL& url,
+                   double introSeconds);
+    ~TrackPreloader() override;
+
+    /** Opens the track and decodes its intro */
+    JobStatus runJob() override;
+
+    /** Returns the track being preloaded */
+    const juce::URL& getURL() const;
+    /** Returns true once the job is done, successful or not */
+    bool isFinished() const;
+    /** Returns true if the track could be opened, only use this once
+        isFinished returns true */
+    bool wasSuccessful() const;
+
+    /** Hands the open reader over, only use this once isFinished returns true */
+    std::unique_ptr<juce::AudioFormatReader> takeReader();
+    /** Hands the decoded intro over, only use this once isFinished returns true */
+    juce::AudioBuffer<float> takeIntro();
+
+private:
+    // used to open the track
+    juce::AudioFormatManager& formatManager;
+    // the track to preload and how much of its start to decode
+    juce::URL url;
+    double introSeconds;
+
+    // the open reader and the decoded intro
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::AudioBuffer<float> intro;
+    std::atomic<bool> finished {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackPreloader)
+};
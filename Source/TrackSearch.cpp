@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    TrackSearch.cpp
+    Created: 19 Oct 2026 11:58:43pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include "TrackSearch.h"
+
+TrackSearch::TrackSearch()
+: juce::Thread("Track search")
+{
+    startThread();
+}
+
+TrackSearch::~TrackSearch()
+{
+    cancelPendingUpdate();
+    stopThread(2000);
+}
+
+//==============================================================================
+// give the tracks to search
+void TrackSearch::setTracks(std::vector<SearchIndex::Entry> entries, int revision)
+{
+    const juce::ScopedLock scopedLock {lock};
+    pendingEntries = std::move(entries);
+    pendingRevision = revision;
+    hasPendingEntries = true;
+    notify();
+}
+
+// search for a query
+void TrackSearch::search(const juce::String& query)
+{
+    const juce::ScopedLock scopedLock {lock};
+    pendingQuery = query;
+    ++generation;
+    notify();
+}
+
+// cancel the search
+void TrackSearch::cancel()
+{
+    const juce::ScopedLock scopedLock {lock};
+    pendingQuery = {};
+    ++generation;
+}
+
+//==============================================================================
+// build the index and search the queries
+void TrackSearch::run()
+{
+    int searchedGeneration = -1;
+
+    while (! threadShouldExit()) {
+        // wait for new tracks or a new query
+        if (! hasPendingEntries && generation == searchedGeneration) {
+            wait(-1);
+            continue;
+        }
+
+        std::vector<SearchIndex::Entry> entries;
+        auto newEntries = false;
+        int revision = 0;
+        juce::String query;
+        int queryGeneration;
+
+        {
+            const juce::ScopedLock scopedLock {lock};
+            newEntries = hasPendingEntries.exchange(false);
+            if (newEntries)
+                std::swap(entries, pendingEntries);
+            revision = pendingRevision;
+            query = pendingQuery;
+            queryGeneration = generation;
+        }
+
+        if (newEntries) {
+            // tracks that were only analysed keep their words
+            if (revision == indexRevision && entries.size() == (size_t) index.size()) {
+                index.updateHarmonies(entries);
+            }
+            else {
+                indexRevision = -1;
+
+                // newer tracks start the index again
+                if (! index.build(std::move(entries), [this] { return threadShouldExit() || hasPendingEntries.load(); }))
+                    continue;
+
+                indexRevision = revision;
+            }
+        }
+
+        // the query is searched again with the new tracks
+        searchedGeneration = queryGeneration;
+        if (query.trim().isEmpty())
+            continue;
+
+        auto shouldStop = [this, queryGeneration]
+        {
+            return threadShouldExit() || generation != queryGeneration || hasPendingEntries.load();
+        };
+
+        // the whole words and prefixes are quick, the typos come after them
+        auto ids = index.search(query, false, shouldStop);
+        if (shouldStop())
+            continue;
+
+        deliver(std::move(ids), queryGeneration);
+
+        if (SearchIndex::canHaveTypos(query)) {
+            ids = index.search(query, true, shouldStop);
+            if (! shouldStop())
+                deliver(std::move(ids), queryGeneration);
+        }
+    }
+}
+
+// deliver the results on the message thread
+void TrackSearch::handleAsyncUpdate()
+{
+    std::vector<int> ids;
+
+    {
+        const juce::ScopedLock scopedLock {lock};
+        // a query typed since has not been searched yet
+        if (resultsGeneration != generation)
+            return;
+
+        std::swap(ids, results);
+        resultsGeneration = -1;
+    }
+
+    if (onResults != nullptr)
+        onResults(ids);
+}
+
+// hand results over to the message thread
+void TrackSearch::deliver(std::vector<int> ids, int queryGeneration)
+{
+    const juce::ScopedLock scopedLock {lock};
+    results = std::move(ids);
+    resultsGeneration = queryGeneration;
+    triggerAsyncUpdate();
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    TrackSearch.h
+    Created: 19 Oct 2026 11:58:43pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SearchIndex.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/*
+ Searches the library on a thread of its own, so typing never waits for a
+ search however big the library is.
+
+ The SearchIndex is built on the thread whenever new tracks are given. A
+ query is searched without typos first and the results are delivered, then
+ again with typos, which takes longer. A new query cancels the one being
+ searched, and the results of a cancelled query are never delivered.
+*/
+class TrackSearch : private juce::Thread,
+                    private juce::AsyncUpdater
+{
+public:
+    TrackSearch();
+    ~TrackSearch() override;
+
+    /** Gives the tracks to search, the index is built again before the next
+        query. Tracks with the same revision as the ones indexed only update
+        their keys and tempos. The strings have to outlive the search */
+    void setTracks(std::vector<SearchIndex::Entry> entries, int revision);
+    /** Starts searching for a query, cancelling the search before it */
+    void search(const juce::String& query);
+    /** Cancels the search, its results are never delivered */
+    void cancel();
+
+    /** Called on the message thread with the ids of the tracks matching the
+        query, best first. It is called once without typos and once with */
+    std::function<void(const std::vector<int>& ids)> onResults;
+
+private:
+    /** Builds the index and searches the queries as they come */
+    void run() override;
+    /** Delivers the results on the message thread */
+    void handleAsyncUpdate() override;
+    /** Hands results over to the message thread if their query is still the latest */
+    void deliver(std::vector<int> ids, int queryGeneration);
+
+    // the index, only used by the search thread, and the revision of its tracks
+    SearchIndex index;
+    int indexRevision = -1;
+
+    // the tracks and the query waiting for the search thread
+    juce::CriticalSection lock;
+    std::vector<SearchIndex::Entry> pendingEntries;
+    int pendingRevision = 0;
+    std::atomic<bool> hasPendingEntries {false};
+    juce::String pendingQuery;
+
+    // goes up with every query, so a search can tell it is out of date
+    std::atomic<int> generation {0};
+
+    // the results waiting for the message thread and the query they are for
+    std::vector<int> results;
+    int resultsGeneration = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackSearch)
+};
@@ -16,7 +16,9 @@ WaveformDisplay::WaveformDisplay(
                                  juce::AudioFormatManager& formatManagerToUse,
                                  juce::AudioThumbnailCache& cacheToUse
 ) :
+    formatManager(formatManagerToUse),
     audioThumb(1000, formatManagerToUse, cacheToUse),
+    preloadThumb(1000, formatManagerToUse, cacheToUse),
     position(0)
 {
     // In your constructor, you should add any child components, and
@@ -26,6 +28,8 @@ WaveformDisplay::WaveformDisplay(
 
 WaveformDisplay::~WaveformDisplay()
 {
+    cancelAnalysis();
+    clearPreload();
 }
 
 // called to draw the content of the component
@@ -46,15 +50,25 @@ void WaveformDisplay::paint (juce::Graphics& g)
     // check if the audio is loaded
     // if audio is loaded set draw the waveform
     if (fileLoaded) {
-        // set the color of the waveform
-        g.setColour (juce::Colours::darkgrey);
-        // draw the waveform
-        audioThumb.drawChannel(g,
-                               getLocalBounds(),
-                               0,
-                               audioThumb.getTotalLength(),
-                               0,
-                               1.0f);
+        // the grey thumbnail to the right of the part the bands have filled in
+        if (renderedColumns < getWidth()) {
+            juce::Graphics::ScopedSaveState state {g};
+            g.reduceClipRegion(getLocalBounds().withTrimmedLeft(renderedColumns));
+            
+            // set the color of the waveform
+            g.setColour (juce::Colours::darkgrey);
+            // draw the waveform
+            audioThumb.drawChannel(g,
+                                   getLocalBounds(),
+                                   0,
+                                   audioThumb.getTotalLength(),
+                                   0,
+                                   1.0f);
+        }
+        
+        // the band waveform, as far as it has been worked out
+        if (bandImage.isValid())
+            g.drawImageAt(bandImage, 0, 0);
         
         // set color for the playhead
         g.setColour(juce::Colours::black);
@@ -78,6 +92,8 @@ void WaveformDisplay::paint (juce::Graphics& g)
 // callad when the component sizes change
 void WaveformDisplay::resized()
 {
+    // the band waveform is drawn at the size of the component
+    renderBandImage();
 }
 
 // function to load the audio file into the thumb nail
@@ -85,8 +101,30 @@ void WaveformDisplay::loadURL (juce::URL audioURL) {
     // clear any previous thumb nail
     audioThumb.clear();
     
-    // set the fileLoaded the value of setting the source of the audio thumb the file
+    // start working out the bands of the new track, unless they are being
+    // worked out already because the track was preloaded
+    cancelAnalysis();
+    
+    if (preloadAnalyser != nullptr && audioURL == preloadedURL) {
+        waveformAnalyser = std::move(preloadAnalyser);
+    }
+    else {
+        waveformAnalyser = std::make_unique<WaveformAnalyser>(formatManager, audioURL);
+        analysisPool->addJob(waveformAnalyser.get());
+    }
+    
+    waveformAnalyser->addChangeListener(this);
+    
+    // a preloaded analysis may have finished before anyone listened
+    renderBandImage();
+    
+    // set the fileLoaded the value of setting the source of the audio thumb the file,
+    // a preloaded thumbnail is found in the cache
     fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL));
+    clearPreload();
+    
+    // a preloaded analysis may know the track is too long for the thumbnail
+    dropLongThumbnail(waveformAnalyser.get(), audioThumb);
     
     if (fileLoaded) { // check if file loaded
         std::cout << "WFD: loaded!" << fileLoaded << std::endl;
@@ -96,8 +134,42 @@ void WaveformDisplay::loadURL (juce::URL audioURL) {
     }
 }
 
+// work out the thumbnail and the bands of the next track
+void WaveformDisplay::preloadURL (juce::URL audioURL) {
+    clearPreload();
+    preloadedURL = audioURL;
+    
+    preloadAnalyser = std::make_unique<WaveformAnalyser>(formatManager, audioURL);
+    preloadAnalyser->addChangeListener(this);
+    analysisPool->addJob(preloadAnalyser.get());
+    
+    preloadThumb.setSource(new juce::URLInputSource(audioURL));
+}
+
+// forget the next track
+void WaveformDisplay::clearPreload() {
+    if (preloadAnalyser != nullptr)
+        preloadAnalyser->removeChangeListener(this);
+    
+    stopJob(preloadAnalyser);
+    preloadThumb.clear();
+    preloadedURL = juce::URL();
+}
+
 // Repaint the whole component if any changes occur
 void WaveformDisplay::changeListenerCallback (juce::ChangeBroadcaster* source) {
+    // the next track is open, a long one is not read twice
+    if (preloadAnalyser != nullptr && source == preloadAnalyser.get()) {
+        dropLongThumbnail(preloadAnalyser.get(), preloadThumb);
+        return;
+    }
+    
+    // more of the bands of the track are ready
+    if (waveformAnalyser != nullptr && source == waveformAnalyser.get()) {
+        dropLongThumbnail(waveformAnalyser.get(), audioThumb);
+        renderNewColumns();
+    }
+    
     repaint();
 }
 
@@ -111,3 +183,97 @@ void WaveformDisplay::setPositionRelative(double pos) {
         repaint();
     }
 }
+
+// start drawing the band waveform into an image at the size of the component
+void WaveformDisplay::renderBandImage() {
+    renderedColumns = 0;
+    
+    if (waveformAnalyser == nullptr || getWidth() <= 0 || getHeight() <= 0) {
+        bandImage = {};
+        return;
+    }
+    
+    bandImage = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    renderNewColumns();
+}
+
+// draw the columns whose buckets have all been worked out since the last
+// time, low is red, mid green and high blue
+void WaveformDisplay::renderNewColumns() {
+    if (waveformAnalyser == nullptr || ! bandImage.isValid())
+        return;
+    
+    auto& waveform = waveformAnalyser->getWaveform();
+    // the buckets can only be looked at once some are ready
+    auto ready = (size_t) waveform.getNumReadyBuckets();
+    if (ready == 0)
+        return;
+    
+    auto& buckets = waveform.getBuckets();
+    auto numBuckets = buckets.size();
+    auto width = bandImage.getWidth();
+    auto centre = bandImage.getHeight() / 2.0f;
+    
+    juce::Graphics g {bandImage};
+    
+    // one line for every column of pixels, from the loudest bucket in it
+    for (int x = renderedColumns; x < width; ++x) {
+        auto first = (size_t) ((double) x * numBuckets / width);
+        auto last = juce::jmin(numBuckets, juce::jmax(first + 1, (size_t) ((double) (x + 1) * numBuckets / width)));
+        
+        // the track is narrower than the component
+        if (first >= numBuckets) {
+            renderedColumns = width;
+            break;
+        }
+        
+        // the rest of the track is still being read
+        if (last > ready)
+            break;
+        
+        BandWaveform::Bucket loudest;
+        for (auto i = first; i < last; ++i) {
+            loudest.peak = juce::jmax(loudest.peak, buckets[i].peak);
+            loudest.low = juce::jmax(loudest.low, buckets[i].low);
+            loudest.mid = juce::jmax(loudest.mid, buckets[i].mid);
+            loudest.high = juce::jmax(loudest.high, buckets[i].high);
+        }
+        
+        // the band with the most energy sets the brightest colour
+        auto strongest = (float) juce::jmax(loudest.low, loudest.mid, loudest.high);
+        auto colour = strongest > 0.0f
+            ? juce::Colour::fromFloatRGBA(loudest.low / strongest, loudest.mid / strongest, loudest.high / strongest, 1.0f)
+            : juce::Colours::darkgrey;
+        
+        auto height = juce::jmax(1.0f, loudest.peak / 255.0f * centre);
+        g.setColour(colour);
+        g.drawVerticalLine(x, centre - height, centre + height);
+        renderedColumns = x + 1;
+    }
+}
+
+// stop reading a thumbnail once its analysis shows the track is long, the
+// band waveform fills in as it goes and the file is only read once
+void WaveformDisplay::dropLongThumbnail(WaveformAnalyser* analyser, juce::AudioThumbnail& thumbnail) {
+    if (analyser != nullptr && analyser->getLengthInSeconds() > BandWaveform::longTrackSeconds
+        && thumbnail.getNumChannels() > 0)
+        thumbnail.clear();
+}
+
+// stop the analysis of the previous track
+void WaveformDisplay::cancelAnalysis() {
+    if (waveformAnalyser == nullptr)
+        return;
+    
+    waveformAnalyser->removeChangeListener(this);
+    stopJob(waveformAnalyser);
+
+    bandImage = {};
+    renderedColumns = 0;
+}
+
+// stop an analysis job and delete it
+void WaveformDisplay::stopJob(std::unique_ptr<WaveformAnalyser>& job) {
+    // the pool deletes the job once it has stopped
+    analysisPool->cancelJob(std::move(job));
+}
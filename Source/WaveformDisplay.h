@@ -11,9 +11,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "AnalysisPool.h"
+#include "BandWaveform.h"
 
 //==============================================================================
 /*
+ Draws the waveform of the loaded track and the playhead. The grey thumbnail
+ is shown straight away, and replaced from the left by a waveform coloured by
+ its low, mid and high bands as the analysis pool works them out.
+
+ Tracks longer than BandWaveform::longTrackSeconds, like recorded mixes and
+ podcasts, get no grey thumbnail, so the file is read once and only the band
+ waveform, which has a fixed size, is kept in memory.
 */
 class WaveformDisplay
     : public juce::Component,
@@ -35,10 +44,45 @@ public:
     
     /** Load the audio file into the audio thumbnail */
     void loadURL (juce::URL audioURL);
+    /** Works out the thumbnail and the bands of the next track in the
+        background, so they are ready when it is loaded */
+    void preloadURL (juce::URL audioURL);
+    /** Forgets the next track */
+    void clearPreload();
     
     /** Set the relative position of the playhead */
     void setPositionRelative(double position);
 private:
+    /** Starts drawing the band waveform into an image at the size of the component */
+    void renderBandImage();
+    /** Draws the columns of the band waveform that have become ready */
+    void renderNewColumns();
+    /** Stops a thumbnail reading a track its analysis has found to be long */
+    void dropLongThumbnail(WaveformAnalyser* analyser, juce::AudioThumbnail& thumbnail);
+    /** Stops the analysis of the previous track */
+    void cancelAnalysis();
+    /** Stops an analysis job and deletes it once the pool lets go of it */
+    void stopJob(std::unique_ptr<WaveformAnalyser>& job);
+    
+    // used to open the track for the analysis
+    juce::AudioFormatManager& formatManager;
+    
+    // the background threads shared by the whole app
+    juce::SharedResourcePointer<AnalysisPool> analysisPool;
+    // works out the bands of the loaded track
+    std::unique_ptr<WaveformAnalyser> waveformAnalyser;
+    // the band waveform, drawn once so painting is only a copy, and the
+    // columns of it drawn so far
+    juce::Image bandImage;
+    int renderedColumns = 0;
+    
+    // the next track and the analysis of its bands, taken over when it loads
+    juce::URL preloadedURL;
+    std::unique_ptr<WaveformAnalyser> preloadAnalyser;
+    // reads the thumbnail of the next track into the shared cache, so the
+    // thumbnail of the deck finds it there when the track loads
+    juce::AudioThumbnail preloadThumb;
+
     // Allows to draw a waveform
     juce::AudioThumbnail audioThumb;
     
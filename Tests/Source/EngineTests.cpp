@@ -0,0 +1,415 @@
+/*
+  ==============================================================================
+
+    EngineTests.cpp
+    Created: 20 Oct 2026 4:12:38pm
+    Author:  Mohammad
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/SmartCrate.h"
+#include "../../Source/SearchIndex.h"
+#include "../../Source/LoudnessAnalyser.h"
+#include "../../Source/KeyAnalyser.h"
+#include "../../Source/SessionState.h"
+#include "../../Source/DuplicateIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <string>
+
+namespace
+{
+    // the category every test of the engine is in
+    const juce::String category {"Otodesk"};
+
+    // never stops a search or an analysis
+    bool neverStop()
+    {
+        return false;
+    }
+
+    // the mean square of a block with a loudness in LUFS
+    double fromLufs(double lufs)
+    {
+        return std::pow(10.0, (lufs + 0.691) / 10.0);
+    }
+}
+
+//==============================================================================
+class SmartCrateTests : public juce::UnitTest
+{
+public:
+    SmartCrateTests() : juce::UnitTest("SmartCrate", category) {}
+
+    void runTest() override
+    {
+        beginTest("Clauses");
+        {
+            SmartCrate crate;
+            juce::String error;
+
+            expect(crate.setQuery("bpm 120-128 and key 8A and not dupes", error), error);
+            expectEquals((int) crate.rules.size(), 3);
+
+            expect(crate.rules[0].field == SmartCrate::bpmField);
+            expectEquals(crate.rules[0].minimum, 120.0f);
+            expectEquals(crate.rules[0].maximum, 128.0f);
+            expect(! crate.rules[0].negated);
+
+            expect(crate.rules[1].field == SmartCrate::keyField);
+            expectEquals(crate.rules[1].minimum, SmartCrate::getKeyValue(8, true));
+
+            expect(crate.rules[2].field == SmartCrate::duplicateField);
+            expect(crate.rules[2].negated);
+        }
+
+        beginTest("Single values and negative ranges");
+        {
+            SmartCrate crate;
+            juce::String error;
+
+            // a single value is the values that round to it
+            expect(crate.setQuery("plays 3", error), error);
+            expectEquals(crate.rules[0].minimum, 2.5f);
+            expectEquals(crate.rules[0].maximum, 3.5f);
+
+            // a minus before a number is not a range, and the range is sorted
+            expect(crate.setQuery("lufs -8 to -14", error), error);
+            expect(crate.rules[0].field == SmartCrate::loudnessField);
+            expectEquals(crate.rules[0].minimum, -14.0f);
+            expectEquals(crate.rules[0].maximum, -8.0f);
+        }
+
+        beginTest("Errors leave the crate as it was");
+        {
+            SmartCrate crate;
+            juce::String error;
+            expect(crate.setQuery("key 8A", error), error);
+
+            for (auto text : {"", "bpm fast", "key 13A", "bpm 120 or key 8A", "bpm 120 and", "tempo 120"}) {
+                error.clear();
+                expect(! crate.setQuery(text, error), text);
+                expect(error.isNotEmpty(), text);
+            }
+
+            expectEquals(crate.query, juce::String("key 8A"));
+            expectEquals((int) crate.rules.size(), 1);
+        }
+    }
+};
+
+static SmartCrateTests smartCrateTests;
+
+//==============================================================================
+class SearchIndexTests : public juce::UnitTest
+{
+public:
+    SearchIndexTests() : juce::UnitTest("SearchIndex", category) {}
+
+    void runTest() override
+    {
+        beginTest("Edit distance");
+        {
+            expectEquals(SearchIndex::getEditDistance("strobe", "strobe", 2), 0);
+            expectEquals(SearchIndex::getEditDistance("strobe", "strobr", 2), 1);
+            expectEquals(SearchIndex::getEditDistance("abc", "", 3), 3);
+
+            // a swap of two letters is one edit
+            expectEquals(SearchIndex::getEditDistance("strobe", "srtobe", 2), 1);
+
+            // more than the maximum is the maximum and one
+            expectEquals(SearchIndex::getEditDistance("kitten", "sitting", 3), 3);
+            expectEquals(SearchIndex::getEditDistance("kitten", "sitting", 2), 3);
+            expectEquals(SearchIndex::getEditDistance("kitten", "sitting", 1), 2);
+        }
+
+        // the strings have to outlive the index
+        const std::string strobe {"Strobe"}, ghosts {"Ghosts n Stuff"}, strings {"Strings of Life"};
+        const std::string deadmau5 {"deadmau5"}, derrickMay {"Derrick%20May"};
+        const std::string forLack {"For%20Lack%20of%20a%20Better%20Name"}, innovator {"Innovator"};
+
+        std::vector<SearchIndex::Entry> entries(3);
+        entries[0].id = 10;
+        entries[0].title = strobe;
+        entries[0].artist = deadmau5;
+        entries[0].album = forLack;
+        entries[0].camelotNumber = 8;
+        entries[0].minor = true;
+        entries[0].bpm = 128.0f;
+
+        entries[1].id = 11;
+        entries[1].title = ghosts;
+        entries[1].artist = deadmau5;
+        entries[1].album = forLack;
+        entries[1].camelotNumber = 10;
+        entries[1].minor = true;
+        entries[1].bpm = 128.0f;
+
+        entries[2].id = 12;
+        entries[2].title = strings;
+        entries[2].artist = derrickMay;
+        entries[2].album = innovator;
+        entries[2].bpm = 125.0f;
+
+        SearchIndex index;
+        index.build(entries, neverStop);
+
+        beginTest("Search");
+        {
+            expectEquals(index.size(), 3);
+
+            expect(index.search("strobe", false, neverStop) == std::vector<int> {10});
+            expect(index.search("STROBE", false, neverStop) == std::vector<int> {10});
+
+            // every word has to match, the results of equal scores keep their order
+            expect(index.search("deadmau5", false, neverStop) == std::vector<int> {10, 11});
+            expect(index.search("deadmau5 stuff", false, neverStop) == std::vector<int> {11});
+            expect(index.search("strobe stuff", false, neverStop).empty());
+
+            // a longer share of the word scores more
+            expect(index.search("str", false, neverStop) == std::vector<int> {10, 12});
+
+            // the words of the artist and album are found too
+            expect(index.search("derrick", false, neverStop) == std::vector<int> {12});
+            expect(index.search("innovator", false, neverStop) == std::vector<int> {12});
+        }
+
+        beginTest("Typos, keys and tempos");
+        {
+            expect(index.search("strobr", false, neverStop).empty());
+            expect(index.search("strobr", true, neverStop) == std::vector<int> {10});
+
+            expect(index.search("8a", false, neverStop) == std::vector<int> {10});
+            expect(index.search("125", false, neverStop) == std::vector<int> {12});
+
+            // a tempo a beat away scores half
+            expect(index.search("127", false, neverStop) == std::vector<int> {10, 11});
+        }
+
+        beginTest("Stopping");
+        {
+            expect(index.search("strobe", true, [] { return true; }).empty());
+        }
+    }
+};
+
+static SearchIndexTests searchIndexTests;
+
+//==============================================================================
+class LoudnessAnalyserTests : public juce::UnitTest
+{
+public:
+    LoudnessAnalyserTests() : juce::UnitTest("LoudnessAnalyser", category) {}
+
+    void runTest() override
+    {
+        beginTest("Gated loudness");
+        {
+            expectEquals(LoudnessAnalyser::getGatedLoudness({}), -100.0f);
+            expectEquals(LoudnessAnalyser::getGatedLoudness({0.0, 0.0}), -100.0f);
+
+            std::vector<double> blocks(10, fromLufs(-23.0));
+            expectWithinAbsoluteError(LoudnessAnalyser::getGatedLoudness(blocks), -23.0f, 0.01f);
+
+            // silence is below the absolute gate and does not count
+            blocks.insert(blocks.end(), 10, fromLufs(-80.0));
+            expectWithinAbsoluteError(LoudnessAnalyser::getGatedLoudness(blocks), -23.0f, 0.01f);
+
+            // a quiet passage more than 10 LU below the rest does not count either
+            blocks.insert(blocks.end(), 10, fromLufs(-45.0));
+            expectWithinAbsoluteError(LoudnessAnalyser::getGatedLoudness(blocks), -23.0f, 0.01f);
+
+            // one less than 10 LU below does
+            std::vector<double> close {fromLufs(-20.0), fromLufs(-26.0)};
+            auto expected = LoudnessAnalyser::toLufs((fromLufs(-20.0) + fromLufs(-26.0)) / 2.0);
+            expectWithinAbsoluteError(LoudnessAnalyser::getGatedLoudness(close), expected, 0.01f);
+        }
+    }
+};
+
+static LoudnessAnalyserTests loudnessAnalyserTests;
+
+//==============================================================================
+class KeyAnalyserTests : public juce::UnitTest
+{
+public:
+    KeyAnalyserTests() : juce::UnitTest("KeyAnalyser", category) {}
+
+    void runTest() override
+    {
+        beginTest("Camelot numbers");
+        {
+            // C major is 8B and its relative minor A minor is 8A
+            expectEquals(KeyAnalyser::getCamelotNumber(0, false), 8);
+            expectEquals(KeyAnalyser::getCamelotNumber(9, true), 8);
+
+            expectEquals(KeyAnalyser::getCamelotNumber(7, false), 9);
+            expectEquals(KeyAnalyser::getCamelotNumber(5, false), 7);
+            expectEquals(KeyAnalyser::getCamelotNumber(6, true), 11);
+            expectEquals(KeyAnalyser::getCamelotNumber(11, false), 1);
+
+            // every number is used once by the major keys and once by the minor ones
+            for (auto minor : {false, true}) {
+                std::array<int, 13> uses {};
+
+                for (int tonic = 0; tonic < 12; ++tonic) {
+                    auto number = KeyAnalyser::getCamelotNumber(tonic, minor);
+                    expect(number >= 1 && number <= 12);
+                    ++uses[(size_t) juce::jlimit(0, 12, number)];
+                }
+
+                expectEquals(std::accumulate(uses.begin() + 1, uses.end(), 0), 12);
+                expect(std::all_of(uses.begin() + 1, uses.end(), [] (int count) { return count == 1; }));
+            }
+        }
+    }
+};
+
+static KeyAnalyserTests keyAnalyserTests;
+
+//==============================================================================
+class SessionStateTests : public juce::UnitTest
+{
+public:
+    SessionStateTests() : juce::UnitTest("SessionState", category) {}
+
+    void runTest() override
+    {
+        SessionState::Snapshot snapshot;
+        snapshot.decks[0].url = "file:///music/Strobe.flac";
+        snapshot.decks[0].position = 1234567;
+        snapshot.decks[0].playing = true;
+        snapshot.decks[0].gain = 0.75;
+        snapshot.decks[0].speed = 1.02;
+        snapshot.decks[0].autoGain = true;
+        snapshot.decks[0].equaliser[0] = -6.0f;
+        snapshot.decks[0].effectsEnabled[0] = true;
+        snapshot.decks[0].effectAmounts[0] = 0.4f;
+        snapshot.decks[1].sync = true;
+        snapshot.decks[1].cue = true;
+        snapshot.mixer.splitCue = true;
+        snapshot.mixer.clockTempo = 126.5;
+        snapshot.view.searchText = "deadmau5";
+        snapshot.view.keyFilter = 3;
+        snapshot.view.crate = "Peak time";
+        snapshot.view.sortOrder.add({TrackLibrary::SortField::bpm, false});
+        snapshot.view.sortOrder.add({TrackLibrary::SortField::key, true});
+
+        juce::MemoryOutputStream output;
+        SessionState::encode(snapshot, output);
+
+        beginTest("Round trip");
+        {
+            juce::MemoryInputStream input {output.getData(), output.getDataSize(), false};
+            SessionState::Snapshot decoded;
+            expect(SessionState::decode(input, decoded));
+
+            for (size_t i = 0; i < snapshot.decks.size(); ++i) {
+                auto& deck = snapshot.decks[i];
+                auto& other = decoded.decks[i];
+
+                expectEquals(other.url, deck.url);
+                expectEquals(other.position, deck.position);
+                expect(other.playing == deck.playing);
+                expectEquals(other.gain, deck.gain);
+                expectEquals(other.speed, deck.speed);
+                expect(other.sync == deck.sync);
+                expect(other.cue == deck.cue);
+                expect(other.autoGain == deck.autoGain);
+                expect(other.equaliser == deck.equaliser);
+                expect(other.effectsEnabled == deck.effectsEnabled);
+                expect(other.effectAmounts == deck.effectAmounts);
+            }
+
+            expect(decoded.mixer.splitCue);
+            expectEquals(decoded.mixer.clockTempo, 126.5);
+            expectEquals(decoded.view.searchText, snapshot.view.searchText);
+            expectEquals(decoded.view.keyFilter, 3);
+            expectEquals(decoded.view.crate, snapshot.view.crate);
+
+            expectEquals(decoded.view.sortOrder.size(), 2);
+            expect(decoded.view.sortOrder[0].field == TrackLibrary::SortField::bpm);
+            expect(! decoded.view.sortOrder[0].forwards);
+            expect(decoded.view.sortOrder[1].field == TrackLibrary::SortField::key);
+            expect(decoded.view.sortOrder[1].forwards);
+        }
+
+        beginTest("Cut short");
+        {
+            // a snapshot cut short is not read and leaves the one given alone
+            juce::MemoryInputStream input {output.getData(), output.getDataSize() - 4, false};
+            SessionState::Snapshot decoded;
+            decoded.view.searchText = "unchanged";
+
+            expect(! SessionState::decode(input, decoded));
+            expectEquals(decoded.view.searchText, juce::String("unchanged"));
+
+            juce::MemoryInputStream empty {nullptr, 0, false};
+            expect(! SessionState::decode(empty, decoded));
+        }
+    }
+};
+
+static SessionStateTests sessionStateTests;
+
+//==============================================================================
+class DuplicateIndexTests : public juce::UnitTest
+{
+public:
+    DuplicateIndexTests() : juce::UnitTest("DuplicateIndex", category) {}
+
+    void runTest() override
+    {
+        // a track is a range of landmarks, tracks of the same range sound the same
+        auto makeEntry = [] (int id, juce::uint32 first, juce::uint32 numLandmarks) {
+            std::vector<juce::uint32> landmarks(numLandmarks);
+            std::iota(landmarks.begin(), landmarks.end(), first);
+
+            DuplicateIndex::Entry entry;
+            entry.id = id;
+            entry.fingerprint = AudioFingerprint::fromLandmarks(std::move(landmarks));
+            return entry;
+        };
+
+        beginTest("Groups");
+        {
+            std::vector<DuplicateIndex::Entry> entries {makeEntry(10, 0, 2000),
+                                                        makeEntry(20, 100000, 2000),
+                                                        makeEntry(30, 0, 2000),
+                                                        makeEntry(40, 200000, 2000),
+                                                        makeEntry(50, 100000, 2000),
+                                                        makeEntry(60, 0, 2000)};
+
+            auto groups = DuplicateIndex::findGroups(entries, neverStop);
+
+            // the groups are in the order of their first track, the ids in the order given
+            expectEquals((int) groups.size(), 2);
+            expect(groups[0].ids == std::vector<int> {10, 30, 60});
+            expect(groups[1].ids == std::vector<int> {20, 50});
+
+            for (auto& group : groups)
+                expect(group.similarity >= DuplicateIndex::duplicateSimilarity);
+        }
+
+        beginTest("No duplicates");
+        {
+            std::vector<DuplicateIndex::Entry> entries;
+            for (int i = 0; i < 20; ++i)
+                entries.push_back(makeEntry(i, (juce::uint32) i * 100000, 2000));
+
+            // a silent track has no landmarks and is never a duplicate
+            entries.push_back(makeEntry(20, 0, 0));
+            entries.push_back(makeEntry(21, 0, 0));
+
+            expect(DuplicateIndex::findGroups(entries, neverStop).empty());
+            expect(DuplicateIndex::findGroups({}, neverStop).empty());
+        }
+    }
+};
+
+static DuplicateIndexTests duplicateIndexTests;
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    This file contains the startup code for the unit tests.
+
+    Usage: OtodeskTests [--category=<name>] [--seed=<n>]
+    runs every test of the engine, or the ones of a category, and exits with
+    1 if any of them failed
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the engine sends change messages, so a message manager has to exist
+    // even though nothing ever dispatches them
+    juce::MessageManager::getInstance();
+
+    juce::ArgumentList args {argc, argv};
+
+    auto seed = args.containsOption("--seed") ? args.getValueForOption("--seed").getLargeIntValue()
+                                              : juce::Random::getSystemRandom().nextInt64();
+    auto category = args.getValueForOption("--category");
+
+    int numFailures = 0;
+
+    {
+        juce::UnitTestRunner runner;
+
+        if (category.isEmpty())
+            runner.runAllTests(seed);
+        else
+            runner.runTestsInCategory(category, seed);
+
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            numFailures += runner.getResult(i)->failures;
+    }
+
+    juce::MessageManager::deleteInstance();
+    return numFailures > 0 ? 1 : 0;
+}